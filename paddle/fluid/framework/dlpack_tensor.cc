@@ -12,7 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include "paddle/fluid/framework/dlpack_tensor.h"
+#include <vector>
 #include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/tensor_util.h"
 
 namespace paddle {
 namespace platform {
@@ -106,9 +108,82 @@ struct DLContextVisitor : public boost::static_visitor<::DLContext> {
 #endif
   }
 };
+static proto::VarType::Type GetProtoTypeFromDLDataType(::DLDataType type) {
+  switch (type.bits) {
+    case 8:
+      if (type.code == kDLInt) return proto::VarType::INT8;
+      if (type.code == kDLUInt) return proto::VarType::UINT8;
+      break;
+    case 16:
+      if (type.code == kDLInt) return proto::VarType::INT16;
+      if (type.code == kDLFloat) return proto::VarType::FP16;
+      break;
+    case 32:
+      if (type.code == kDLInt) return proto::VarType::INT32;
+      if (type.code == kDLFloat) return proto::VarType::FP32;
+      break;
+    case 64:
+      if (type.code == kDLInt) return proto::VarType::INT64;
+      if (type.code == kDLFloat) return proto::VarType::FP64;
+      break;
+  }
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "Unsupported DLDataType with code <%d> and bits <%d>.", type.code,
+      type.bits));
+}
+
+// Whether the tensor can be shared, i.e. its elements are dense in the
+// row-major order on a supported device.
+static bool CanShareDLTensor(const ::DLTensor &dl_tensor) {
+  if (dl_tensor.dtype.lanes != 1) return false;
+  if (dl_tensor.ctx.device_type != kDLCPU) {
+#ifdef PADDLE_WITH_CUDA
+    if (dl_tensor.ctx.device_type != kDLGPU &&
+        dl_tensor.ctx.device_type != kDLCPUPinned) {
+      return false;
+    }
+#else
+    return false;
+#endif
+  }
+  if (dl_tensor.strides == nullptr) return true;
+  int64_t stride = 1;
+  for (int i = dl_tensor.ndim - 1; i >= 0; --i) {
+    if (dl_tensor.shape[i] != 1 && dl_tensor.strides[i] != stride) {
+      return false;
+    }
+    stride *= dl_tensor.shape[i];
+  }
+  return true;
+}
+
+static platform::Place GetPlaceFromDLContext(const ::DLContext &ctx) {
+#ifdef PADDLE_WITH_CUDA
+  if (ctx.device_type == kDLGPU) return platform::CUDAPlace(ctx.device_id);
+  if (ctx.device_type == kDLCPUPinned) return platform::CUDAPinnedPlace();
+#endif
+  return platform::CPUPlace();
+}
+
+// Borrows the memory of a DLManagedTensor.
+class DLPackAllocation : public memory::Allocation {
+ public:
+  DLPackAllocation(::DLManagedTensor *dlmtensor, void *ptr, size_t size,
+                   const platform::Place &place)
+      : Allocation(ptr, size, place), dlmtensor_(dlmtensor) {}
+
+  ~DLPackAllocation() override {
+    if (dlmtensor_->deleter) dlmtensor_->deleter(dlmtensor_);
+  }
+
+ private:
+  ::DLManagedTensor *dlmtensor_;
+};
 }  // namespace internal
 
 DLPackTensor::DLPackTensor(const Tensor &tensor, LaneType lanes) {
+  holder_ = tensor.Holder();
+
   // init data, data buffer
   t_.data = const_cast<void *>(tensor.data<void>());
 
@@ -169,13 +244,33 @@ DLPackTensor::DLPackTensor(const Tensor &tensor, LaneType lanes) {
   tensor->deleter = [](DLManagedTensor *arg) {
     delete[] arg->dl_tensor.shape;
     delete[] arg->dl_tensor.strides;
+    delete static_cast<std::shared_ptr<memory::Allocation> *>(
+        arg->manager_ctx);
     delete arg;
   };
 
-  tensor->manager_ctx = nullptr;
+  tensor->manager_ctx = new std::shared_ptr<memory::Allocation>(holder_);
 
   return tensor;
 }
 
+void TensorFromDLManagedTensor(::DLManagedTensor *dlmtensor, Tensor *dst) {
+  const ::DLTensor &dl_tensor = dlmtensor->dl_tensor;
+  if (!internal::CanShareDLTensor(dl_tensor)) {
+    TensorFromDLPack(dl_tensor, dst);
+    if (dlmtensor->deleter) dlmtensor->deleter(dlmtensor);
+    return;
+  }
+  auto type = internal::GetProtoTypeFromDLDataType(dl_tensor.dtype);
+  std::vector<int64_t> dims(dl_tensor.shape, dl_tensor.shape + dl_tensor.ndim);
+  dst->clear();
+  dst->Resize(make_ddim(dims));
+  size_t size = product(dst->dims()) * SizeOfType(type);
+  auto holder = std::make_shared<internal::DLPackAllocation>(
+      dlmtensor, static_cast<uint8_t *>(dl_tensor.data) + dl_tensor.byte_offset,
+      size, internal::GetPlaceFromDLContext(dl_tensor.ctx));
+  dst->ResetHolderWithType(holder, type);
+}
+
 }  // namespace framework
 }  // namespace paddle
@@ -16,6 +16,8 @@
 
 #include <dlpack/dlpack.h>
 
+#include <memory>
+
 #include "paddle/fluid/framework/tensor.h"
 
 namespace paddle {
@@ -36,15 +38,23 @@ class DLPackTensor {
 
   inline operator ::DLTensor&() { return t_; }
 
+  // The returned tensor holds the memory of the source tensor until its
+  // deleter is called.
   ::DLManagedTensor* ToCudfCompatibleDLManagedTensor();
 
  private:
   ::DLTensor t_;
+  std::shared_ptr<memory::Allocation> holder_;
 
   // The shape in DLTensor is defined as int64_t*
   // Add this member to make TVMTensor init without heap allocation
   ShapeType shape_[DDim::kMaxRank];
 };
 
+// Makes dst share the memory of a compact dlmtensor, whose deleter is called
+// when dst and the tensors sharing with it release the memory. A strided or
+// vectorized dlmtensor is copied and released at once instead.
+void TensorFromDLManagedTensor(::DLManagedTensor* dlmtensor, Tensor* dst);
+
 }  // namespace framework
 }  // namespace paddle
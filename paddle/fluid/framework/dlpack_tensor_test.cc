@@ -90,7 +90,8 @@ void TestToCudfCompatibleDLManagedTensor(const platform::Place &place,
   ::DLManagedTensor *dl_managed_tensor =
       dlpack_tensor.ToCudfCompatibleDLManagedTensor();
 
-  CHECK_EQ(dl_managed_tensor->manager_ctx == nullptr, true);
+  // The managed tensor keeps the memory of the tensor.
+  CHECK_EQ(dl_managed_tensor->manager_ctx != nullptr, true);
 
   for (auto i = 0; i < dims.size(); ++i) {
     CHECK_EQ(dims[i], dl_managed_tensor->dl_tensor.shape[i]);
@@ -101,6 +102,59 @@ void TestToCudfCompatibleDLManagedTensor(const platform::Place &place,
   dl_managed_tensor->deleter(dl_managed_tensor);
 }
 
+template <typename T>
+void TestTensorFromDLManagedTensor(const platform::Place &place) {
+  Tensor src;
+  src.Resize({6});
+  void *p = src.mutable_data<T>(place);
+  DLPackTensor dlpack_tensor(src, 1);
+  ::DLManagedTensor *dl_managed_tensor =
+      dlpack_tensor.ToCudfCompatibleDLManagedTensor();
+  src.clear();
+
+  // A compact tensor is shared, and the memory is released by the last
+  // tensor sharing it.
+  Tensor dst;
+  TensorFromDLManagedTensor(dl_managed_tensor, &dst);
+  CHECK_EQ(p, dst.data<void>());
+  CHECK_EQ(dst.dims(), make_ddim({6}));
+  CHECK_EQ(dst.type(), DataTypeTrait<T>::DataType());
+  CHECK_EQ(platform::is_same_place(dst.place(), place), true);
+  std::weak_ptr<memory::Allocation> holder = dst.Holder();
+  Tensor shared;
+  shared.ShareDataWith(dst);
+  dst.clear();
+  CHECK_EQ(holder.expired(), false);
+  shared.clear();
+  CHECK_EQ(holder.expired(), true);
+}
+
+TEST(dlpack, share_compact_tensor) {
+  TestTensorFromDLManagedTensor<float>(platform::CPUPlace());
+  TestTensorFromDLManagedTensor<int64_t>(platform::CPUPlace());
+#ifdef PADDLE_WITH_CUDA
+  TestTensorFromDLManagedTensor<float>(platform::CUDAPlace(0));
+#endif
+}
+
+TEST(dlpack, copy_strided_tensor) {
+  Tensor src;
+  src.Resize({2, 3});
+  auto *data = src.mutable_data<float>(platform::CPUPlace());
+  for (int i = 0; i < 6; ++i) data[i] = i;
+  DLPackTensor dlpack_tensor(src, 1);
+  // The cudf compatible tensor of rank 2 is not row-major.
+  ::DLManagedTensor *dl_managed_tensor =
+      dlpack_tensor.ToCudfCompatibleDLManagedTensor();
+  Tensor dst;
+  TensorFromDLManagedTensor(dl_managed_tensor, &dst);
+  CHECK_NE(data, dst.data<float>());
+  CHECK_EQ(dst.dims(), make_ddim({2, 3}));
+  for (int i = 0; i < 6; ++i) CHECK_EQ(dst.data<float>()[i], i);
+  // Only src and dlpack_tensor hold the memory after the copy.
+  CHECK_EQ(src.Holder().use_count(), 2);
+}
+
 template <typename T>
 void TestMainLoop() {
 #ifdef PADDLE_WITH_CUDA
@@ -0,0 +1,82 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/fc_gelu_fuse_pass.h"
+
+#include <string>
+
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/op_version_registry.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+void FCGeluFusePass::ApplyImpl(ir::Graph* graph) const {
+  PADDLE_ENFORCE_NOT_NULL(
+      graph, platform::errors::InvalidArgument("Graph cannot be nullptr."));
+  FusePassBase::Init("fc_gelu_fuse", graph);
+
+  GraphPatternDetector gpd;
+  // The pattern of fc followed by an activation, which is shared with
+  // fc_act_mkldnn_fuse_pass.
+  patterns::FCActOneDNN fc_act_pattern(gpd.mutable_pattern(), "fc_gelu");
+  fc_act_pattern("gelu");
+
+  int found_count = 0;
+  auto handler = [&](const GraphPatternDetector::subgraph_t& subgraph,
+                     Graph* g) {
+    GET_IR_NODE_FROM_SUBGRAPH(fc, fc, fc_act_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(fc_out, fc_out, fc_act_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(act, act, fc_act_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(act_out, act_out, fc_act_pattern);
+
+    auto* fc_op = fc->Op();
+    // fc_out is removed, so it should only be used by gelu, and the fc should
+    // not have an activation yet.
+    if (fc_out->outputs.size() != 1) return;
+    if (fc_op->HasAttr("activation_type") &&
+        !BOOST_GET_CONST(std::string, fc_op->GetAttr("activation_type"))
+             .empty()) {
+      return;
+    }
+    VLOG(4) << "fuse fc with gelu";
+
+    auto* act_op = act->Op();
+    bool approximate =
+        act_op->HasAttr("approximate") &&
+        BOOST_GET_CONST(bool, act_op->GetAttr("approximate"));
+    fc_op->SetAttr("activation_type",
+                   std::string(approximate ? "gelu_tanh" : "gelu_erf"));
+    fc_op->SetOutput("Out", {act_out->Name()});
+
+    IR_OP_VAR_LINK(fc, act_out);
+    GraphSafeRemoveNodes(g, {act, fc_out});
+    ++found_count;
+  };
+
+  gpd(graph, handler);
+  AddStatis(found_count);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(fc_gelu_fuse_pass, paddle::framework::ir::FCGeluFusePass);
+REGISTER_PASS_CAPABILITY(fc_gelu_fuse_pass)
+    .AddCombination(
+        paddle::framework::compatible::OpVersionComparatorCombination()
+            .LE("fc", 0)
+            .LE("gelu", 0));
@@ -0,0 +1,80 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/fc_gelu_fuse_pass.h"
+
+#include <gtest/gtest.h>
+
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+TEST(FCGeluFusePass, basic) {
+  // inputs                           operator            output
+  // --------------------------------------------------------------------
+  // (x, weights_0, bias_0)           fc               -> fc_out_0
+  // (fc_out_0)                       gelu             -> gelu_out
+  // (gelu_out, weights_1, bias_1)    fc               -> fc_out_1
+  // (fc_out_1)                       gelu             -> gelu_out_1
+  // (fc_out_1)                       relu             -> relu_out
+  Layers layers;
+  auto* x = layers.data("x", {128, 768});
+  auto* weights_0 = layers.data("weights_0", {768, 3072}, true);
+  auto* bias_0 = layers.data("bias_0", {3072}, true);
+  auto* fc_out_0 = layers.fc(x, weights_0, bias_0);
+  auto* gelu_out = layers.gelu(fc_out_0);
+  auto* weights_1 = layers.data("weights_1", {3072, 768}, true);
+  auto* bias_1 = layers.data("bias_1", {768}, true);
+  // fc_out_1 is used twice, so it is not fused.
+  auto* fc_out_1 = layers.fc(gelu_out, weights_1, bias_1);
+  layers.gelu(fc_out_1);
+  layers.relu(fc_out_1);
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(layers.main_program()));
+  auto pass = PassRegistry::Instance().Get("fc_gelu_fuse_pass");
+  int num_nodes_before = graph->Nodes().size();
+  VLOG(3) << DebugString(graph);
+
+  graph.reset(pass->Apply(graph.release()));
+  int num_nodes_after = graph->Nodes().size();
+  VLOG(3) << DebugString(graph);
+
+  PADDLE_ENFORCE_EQ(
+      num_nodes_before, num_nodes_after + 2,
+      platform::errors::InvalidArgument(
+          "After pass, the number of nodes should be reduced by 2, but the "
+          "number before pass is %d, after pass is %d.",
+          num_nodes_before, num_nodes_after));
+  PADDLE_ENFORCE_EQ(GetNumOpNodes(graph, "gelu"), 1,
+                    platform::errors::InvalidArgument(
+                        "After pass, the number of nodes of type 'gelu' "
+                        "should be 1, not %d.",
+                        GetNumOpNodes(graph, "gelu")));
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == "fc" &&
+        node->Op()->Input("Input")[0] == "x") {
+      EXPECT_EQ(BOOST_GET_CONST(std::string,
+                                node->Op()->GetAttr("activation_type")),
+                "gelu_erf");
+    }
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(fc_gelu_fuse_pass);
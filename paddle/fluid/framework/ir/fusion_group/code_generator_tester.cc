@@ -28,8 +28,6 @@ class LoDTensor;
 }  // namespace framework
 }  // namespace paddle
 
-#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
-
 namespace paddle {
 namespace framework {
 namespace ir {
@@ -171,6 +169,7 @@ void SetupRandomCPUTensor(LoDTensor* tensor) {
 
 namespace fusion_group = paddle::framework::ir::fusion_group;
 
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 template <typename T>
 void TestMainImpl(std::string func_name, std::string code_str,
                   std::vector<paddle::framework::LoDTensor> cpu_tensors, int n,
@@ -368,6 +367,7 @@ TEST(code_generator, elementwise_grad) {
              dtype);
   }
 }
+#endif
 
 std::unique_ptr<paddle::framework::ir::Graph> BuildGraph(bool backward,
                                                          std::string dtype) {
@@ -467,6 +467,7 @@ std::unordered_set<paddle::framework::ir::Node*> DistilGradNodes(
   return grad_nodes;
 }
 
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 TEST(code_generator, subgraph) {
   for (std::string dtype : {"float", "__half"}) {
     std::unique_ptr<paddle::framework::ir::Graph> graph =
@@ -505,3 +506,94 @@ TEST(code_generator, subgraph_grad) {
   }
 }
 #endif
+
+void TestCPUElementwiseMain(
+    std::string func_name, std::string code_str,
+    std::vector<fusion_group::OperationExpression> expressions,
+    std::vector<int> input_ids, std::vector<int> output_ids) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceCode device_code(place, func_name, code_str);
+  if (!device_code.Compile()) {
+    LOG(WARNING) << "Skip the test because no host compiler is available.";
+    return;
+  }
+
+  std::unordered_set<int> ids(input_ids.begin(), input_ids.end());
+  ids.insert(output_ids.begin(), output_ids.end());
+
+  std::vector<paddle::framework::LoDTensor> cpu_tensors(ids.size());
+  std::vector<float*> ptrs(cpu_tensors.size());
+  auto dims = paddle::framework::make_ddim(
+      {static_cast<int64_t>(256), static_cast<int64_t>(1024)});
+  for (size_t i = 0; i < cpu_tensors.size(); ++i) {
+    ptrs[i] = cpu_tensors[i].mutable_data<float>(dims, place);
+  }
+
+  int n = cpu_tensors[0].numel();
+  std::vector<void*> args;
+  args.push_back(&n);
+  for (auto id : input_ids) {
+    if (id >= 0) {
+      fusion_group::SetupRandomCPUTensor<float>(&cpu_tensors[id]);
+      args.push_back(&ptrs[id]);
+    }
+  }
+  for (auto id : output_ids) {
+    args.push_back(&ptrs[id]);
+  }
+  device_code.Launch(n, &args);
+
+  for (int i = 0; i < n; i++) {
+    fusion_group::CheckOutput(expressions, cpu_tensors, input_ids, output_ids,
+                              i, 1E-5);
+  }
+}
+
+TEST(code_generator, elementwise_cpu) {
+  // t2 = t0 * t1
+  // t4 = t2 + t3
+  // t6 = t4 - t5
+  // t7 = relu(t6)
+  // t8 = sigmoid(t7)
+  fusion_group::OperationExpression exp1("elementwise_mul", {0, 1}, {2},
+                                         "float", "float");
+  fusion_group::OperationExpression exp2("elementwise_add", {2, 3}, {4},
+                                         "float", "float");
+  fusion_group::OperationExpression exp3("elementwise_sub", {4, 5}, {6},
+                                         "float", "float");
+  fusion_group::OperationExpression exp4("relu", {6}, {7}, "float", "float");
+  fusion_group::OperationExpression exp5("sigmoid", {7}, {8}, "float",
+                                         "float");
+  std::vector<fusion_group::OperationExpression> expressions = {
+      exp1, exp2, exp3, exp4, exp5};
+
+  fusion_group::OperationMap::Init();
+  fusion_group::CodeGenerator code_generator(/* use_gpu= */ false);
+  std::string code_str =
+      code_generator.Generate("elementwise_kernel_cpu_0", expressions);
+  VLOG(3) << code_str;
+
+  std::vector<int> input_ids = {0, 1, 3, 5};
+  std::vector<int> output_ids = {2, 4, 6, 7, 8};
+  TestCPUElementwiseMain("elementwise_kernel_cpu_0", code_str, expressions,
+                         input_ids, output_ids);
+}
+
+TEST(code_generator, subgraph_grad_cpu) {
+  std::unique_ptr<paddle::framework::ir::Graph> graph =
+      BuildGraph(true, "float");
+  fusion_group::SubGraph subgraph(0, "elementwise_grad_kernel_cpu_1", true,
+                                  DistilGradNodes(graph));
+
+  fusion_group::OperationMap::Init();
+  fusion_group::CodeGenerator code_generator(/* use_gpu= */ false);
+  std::string code_str = code_generator.Generate(&subgraph);
+  VLOG(3) << code_str;
+
+  std::vector<fusion_group::OperationExpression> expressions =
+      code_generator.ConvertToExpressions(&subgraph);
+  std::vector<int> input_ids = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  std::vector<int> output_ids = {10, 11, 12, 13, 14, 15, 16, 17};
+  TestCPUElementwiseMain(subgraph.GetFuncName(), code_str, expressions,
+                         input_ids, output_ids);
+}
@@ -0,0 +1,63 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+namespace paddle {
+namespace framework {
+namespace ir {
+namespace fusion_group {
+
+static constexpr char predefined_cpu_headers[] = R"(
+#include <cmath>
+#include <cstddef>
+)";
+
+static constexpr char predefined_cpu_functions_fp32[] = R"(
+static inline float Max(float x, float y) { return std::fmax(x, y); }
+static inline float Exp(float x) { return std::exp(x); }
+static inline float Log(float x) { return std::log(x); }
+static inline float Sqrt(float x) { return std::sqrt(x); }
+)";
+
+static constexpr char predefined_cpu_functions_fp64[] = R"(
+static inline double Max(double x, double y) { return std::fmax(x, y); }
+static inline double Exp(double x) { return std::exp(x); }
+static inline double Log(double x) { return std::log(x); }
+static inline double Sqrt(double x) { return std::sqrt(x); }
+)";
+
+// The elements are computed by one loop, which is vectorized by the compiler
+// and parallelized by OpenMP when it is large enough. The exported function
+// unpacks the arguments in the same layout as the ones of the CUDA kernel:
+// args[0] points to N, and args[i] points to the pointer of a tensor.
+static constexpr char cpu_kernel_template_1d[] = R"(
+static void $func_name_kernel($parameters) {
+#pragma omp parallel for simd if (N >= 16384)
+  for(int idx = 0;
+      idx < N;
+      ++idx) {
+    $compute_body
+  }
+}
+
+extern "C" void $func_name(void** args) {
+  $func_name_kernel($arguments);
+}
+)";
+
+}  // namespace fusion_group
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
@@ -210,6 +210,55 @@ std::shared_ptr<Graph> Graph::Clone() {
   return cloned_graph;
 }
 
+static std::string NodeIndexKey(const ir::Node *node) {
+  if (node->IsOp() && node->Op()) return node->Op()->Type();
+  return node->Name();
+}
+
+void Graph::IndexNode(ir::Node *node) {
+  auto key = NodeIndexKey(node);
+  auto &index = node->IsOp() ? op_index_ : var_index_;
+  index[key].insert(node);
+  index_keys_[node] = std::move(key);
+}
+
+void Graph::UnindexNode(ir::Node *node) {
+  auto it = index_keys_.find(node);
+  if (it == index_keys_.end()) return;
+  auto &index = node->IsOp() ? op_index_ : var_index_;
+  auto bucket = index.find(it->second);
+  if (bucket != index.end()) {
+    bucket->second.erase(node);
+    if (bucket->second.empty()) index.erase(bucket);
+  }
+  index_keys_.erase(it);
+}
+
+const std::unordered_set<ir::Node *> &Graph::OpNodesOfType(
+    const std::string &op_type) const {
+  static const std::unordered_set<ir::Node *> kEmpty;
+  auto it = op_index_.find(op_type);
+  return it == op_index_.end() ? kEmpty : it->second;
+}
+
+const std::unordered_set<ir::Node *> &Graph::VarNodesNamed(
+    const std::string &var_name) const {
+  static const std::unordered_set<ir::Node *> kEmpty;
+  auto it = var_index_.find(var_name);
+  return it == var_index_.end() ? kEmpty : it->second;
+}
+
+void Graph::RefreshNodeIndex() {
+  std::vector<ir::Node *> stale;
+  for (auto &item : index_keys_) {
+    if (item.second != NodeIndexKey(item.first)) stale.push_back(item.first);
+  }
+  for (auto *node : stale) {
+    UnindexNode(node);
+    IndexNode(node);
+  }
+}
+
 bool IsControlDepVar(const ir::Node &var) {
   return var.Name().find(ir::Node::kControlDepVarName) != std::string::npos;
 }
@@ -17,6 +17,7 @@ limitations under the License. */
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -204,6 +205,9 @@ class Graph {
     }
     nodes_.clear();
     node_set_.clear();
+    op_index_.clear();
+    var_index_.clear();
+    index_keys_.clear();
     return ret;
   }
 
@@ -215,9 +219,22 @@ class Graph {
     ret.reset(nodes_.at(node).release());
     nodes_.erase(node);
     node_set_.erase(node);
+    UnindexNode(node);
     return ret;
   }
 
+  // Operator nodes of type `op_type` and variable nodes named `var_name`.
+  // The index follows AddNode/RemoveNode; call RefreshNodeIndex() first if
+  // op types or var names may have been changed in place.
+  const std::unordered_set<ir::Node *> &OpNodesOfType(
+      const std::string &op_type) const;
+  const std::unordered_set<ir::Node *> &VarNodesNamed(
+      const std::string &var_name) const;
+
+  // Re-file the nodes whose op type or var name changed since they were
+  // indexed.
+  void RefreshNodeIndex();
+
   // NOTE low performance, but simple and secure.
   Node *RetrieveNode(int id) {
     for (auto &node : nodes_) {
@@ -241,6 +258,7 @@ class Graph {
                           "The node to be added already exists."));
     nodes_[node].reset(node);
     node_set_.insert(node);
+    IndexNode(node);
     return node;
   }
 
@@ -255,12 +273,19 @@ class Graph {
   std::map<std::string, std::vector<ir::Node *>> InitFromProgram(
       const ProgramDesc &program);
 
+  void IndexNode(ir::Node *node);
+  void UnindexNode(ir::Node *node);
+
   // NOTE: program_ shouldn't be exposed to user.
   const ProgramDesc program_;
   std::map<std::string, boost::any> attrs_;
   std::map<std::string, std::function<void(void)>> attr_dels_;
   std::map<ir::Node *, std::unique_ptr<ir::Node>> nodes_;
   std::unordered_set<ir::Node *> node_set_;
+  // Nodes by op type / var name, and the key each node is filed under.
+  std::unordered_map<std::string, std::unordered_set<ir::Node *>> op_index_;
+  std::unordered_map<std::string, std::unordered_set<ir::Node *>> var_index_;
+  std::unordered_map<ir::Node *, std::string> index_keys_;
   size_t num_node_created_{0};  // help to generate a unique node id.
 };
 
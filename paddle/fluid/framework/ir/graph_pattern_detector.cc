@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+
 #include "paddle/fluid/framework/ir/graph_pattern_detector.h"
 #include "paddle/fluid/framework/ir/graph_traits.h"
 #include "paddle/fluid/framework/ir/graph_viz_pass.h"
@@ -77,6 +79,7 @@ void PDPattern::AddEdge(PDNode *a, PDNode *b) {
 
 void GraphPatternDetector::operator()(Graph *graph,
                                       GraphPatternDetector::handle_t handler) {
+  graph->RefreshNodeIndex();
   if (!MarkPDNodesInGraph(*graph)) {
     return;
   }
@@ -100,11 +103,23 @@ bool GraphPatternDetector::MarkPDNodesInGraph(const ir::Graph &graph) {
   VLOG(3) << "mark pdnodes in graph";
   if (graph.Nodes().empty()) return false;
 
-  for (auto &node : GraphTraits::DFS(graph)) {
-    for (const auto &pdnode : pattern_.nodes()) {
-      if (pdnode->Tell(&node)) {
-        VLOG(4) << "Node " << node.Name() << " marked as " << pdnode->name();
-        pdnodes2nodes_[pdnode.get()].insert(&node);
+  // PDNodes asserting an op type take their candidates from the graph's node
+  // index; only the remaining ones need a scan over the whole graph.
+  std::vector<const PDNode *> unhinted;
+  for (const auto &pdnode : pattern_.nodes()) {
+    if (!pdnode->teller_ && pdnode->hint_ != PDNode::Hint::kNone) {
+      MarkHintedPDNode(graph, pdnode.get());
+    } else {
+      unhinted.push_back(pdnode.get());
+    }
+  }
+  if (!unhinted.empty()) {
+    for (auto &node : GraphTraits::DFS(graph)) {
+      for (auto *pdnode : unhinted) {
+        if (pdnode->Tell(&node)) {
+          VLOG(4) << "Node " << node.Name() << " marked as " << pdnode->name();
+          pdnodes2nodes_[pdnode].insert(&node);
+        }
       }
     }
   }
@@ -120,6 +135,33 @@ bool GraphPatternDetector::MarkPDNodesInGraph(const ir::Graph &graph) {
   return !pdnodes2nodes_.empty();
 }
 
+void GraphPatternDetector::MarkHintedPDNode(const ir::Graph &graph,
+                                            const PDNode *pdnode) {
+  auto mark = [&](Node *node) {
+    if (pdnode->Tell(node)) {
+      VLOG(4) << "Node " << node->Name() << " marked as " << pdnode->name();
+      pdnodes2nodes_[pdnode].insert(node);
+    }
+  };
+  for (auto &op_type : pdnode->hint_types_) {
+    for (auto *op : graph.OpNodesOfType(op_type)) {
+      switch (pdnode->hint_) {
+        case PDNode::Hint::kIsOp:
+          mark(op);
+          break;
+        case PDNode::Hint::kInputOf:
+          for (auto *var : op->inputs) mark(var);
+          break;
+        case PDNode::Hint::kOutputOf:
+          for (auto *var : op->outputs) mark(var);
+          break;
+        default:
+          break;
+      }
+    }
+  }
+}
+
 // The intermediate Nodes can only link to the nodes inside the pattern, or this
 // subgraph will be dropped.
 void GraphPatternDetector::ValidateByNodeRole(
@@ -160,12 +202,11 @@ struct HitGroup {
   std::map<PDNode *, Node *> roles;
 
   bool Match(Node *node, PDNode *pat) {
+    auto *bound = Role(pat);
     if (nodes_.count(node)) {
-      if (roles.count(pat) && roles[pat] == node) return true;
-      return false;
+      return bound == node;
     } else {
-      if (roles.count(pat) && roles[pat] != node) return false;
-      return true;
+      return bound == nullptr || bound == node;
     }
   }
 
@@ -174,6 +215,11 @@ struct HitGroup {
     nodes_.insert(node);
   }
 
+  Node *Role(PDNode *pat) const {
+    auto it = roles.find(pat);
+    return it == roles.end() ? nullptr : it->second;
+  }
+
  private:
   std::set<Node *> nodes_;
 };
@@ -188,6 +234,19 @@ bool IsNodesLink(Node *a, Node *b) {
   return false;
 }
 
+// The nodes of `links` that are in `candidates`, in ascending order and
+// without duplicates.
+static std::vector<Node *> LinkedCandidates(const std::vector<Node *> &links,
+                                            const std::set<Node *> &candidates) {
+  std::vector<Node *> result;
+  for (auto *node : links) {
+    if (candidates.count(node)) result.push_back(node);
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
 std::vector<GraphPatternDetector::subgraph_t>
 GraphPatternDetector::DetectPatterns() {
   // Init empty subgraphs.
@@ -197,42 +256,90 @@ GraphPatternDetector::DetectPatterns() {
   auto *first_pnode = pattern_.edges().empty() ? pattern().nodes().front().get()
                                                : pattern_.edges().front().first;
   if (!pdnodes2nodes_.count(first_pnode)) return result;
-  for (auto *node : pdnodes2nodes_[first_pnode]) {
+
+  // Seed from the PDNode with the fewest candidates, and visit the edges so
+  // that each one touches a PDNode bound earlier when the pattern allows. The
+  // groups are then extended by walking the links of the bound nodes instead
+  // of trying every pair of candidates.
+  PDNode *seed = first_pnode;
+  for (const auto &edge : pattern_.edges()) {
+    for (auto *pdnode : {edge.first, edge.second}) {
+      if (pdnodes2nodes_[pdnode].size() < pdnodes2nodes_[seed].size()) {
+        seed = pdnode;
+      }
+    }
+  }
+  if (pdnodes2nodes_[seed].empty()) return result;
+  for (auto *node : pdnodes2nodes_[seed]) {
     HitGroup group;
-    group.roles[first_pnode] = node;
+    group.roles[seed] = node;
     init_groups.emplace_back(group);
   }
 
+  std::vector<std::pair<PDNode *, PDNode *>> edges;
+  std::set<PDNode *> bound{seed};
+  std::vector<bool> visited(pattern_.edges().size(), false);
+  while (edges.size() < pattern_.edges().size()) {
+    size_t next = pattern_.edges().size();
+    for (size_t i = 0; i < pattern_.edges().size(); ++i) {
+      if (visited[i]) continue;
+      if (next == pattern_.edges().size()) next = i;
+      const auto &edge = pattern_.edges()[i];
+      if (bound.count(edge.first) || bound.count(edge.second)) {
+        next = i;
+        break;
+      }
+    }
+    visited[next] = true;
+    edges.push_back(pattern_.edges()[next]);
+    bound.insert(edges.back().first);
+    bound.insert(edges.back().second);
+  }
+
   int step = 0;
   bi_records[0] = std::move(init_groups);
 
   // Extend a PDNode to subgraphs by deducing the connection relations defined
   // in edges of PDNodes.
-  for (const auto &edge : pattern_.edges()) {
+  for (const auto &edge : edges) {
     VLOG(4) << "check " << edge.first->name() << " -> " << edge.second->name();
-    // TODO(Superjomn) Fix bug here, the groups might be duplicate here.
     // Each role has two PDNodes, which indicates two roles.
     // Detect two Nodes that can match these two roles and they are connected.
     auto &pre_groups = bi_records[step % 2];
     auto &cur_groups = bi_records[1 - (step++ % 2)];
     cur_groups.clear();
     if (pre_groups.empty()) break;
-    // source -> target
-    for (Node *source : pdnodes2nodes_[edge.first]) {
-      for (Node *target : pdnodes2nodes_[edge.second]) {
-        VLOG(8) << "check " << source->id() << " -- " << target->id();
-        // TODO(Superjomn) add some prune strategies.
-        for (const auto &group : pre_groups) {
-          if (IsNodesLink(source, target)) {
-            HitGroup new_group = group;
-            bool flag = new_group.Match(source, edge.first) &&
-                        new_group.Match(target, edge.second);
-            if (flag) {
-              new_group.Register(source, edge.first);
-              new_group.Register(target, edge.second);
-              cur_groups.push_back(new_group);
-              // TODO(Superjomn) need to unique
-            }
+    const auto &sources = pdnodes2nodes_[edge.first];
+    const auto &targets = pdnodes2nodes_[edge.second];
+    for (const auto &group : pre_groups) {
+      Node *bound_source = group.Role(edge.first);
+      Node *bound_target = group.Role(edge.second);
+      std::vector<Node *> source_nodes;
+      if (bound_source) {
+        source_nodes.push_back(bound_source);
+      } else if (bound_target) {
+        source_nodes = LinkedCandidates(bound_target->inputs, sources);
+      } else {
+        source_nodes.assign(sources.begin(), sources.end());
+      }
+      for (Node *source : source_nodes) {
+        std::vector<Node *> target_nodes;
+        if (bound_target) {
+          if (IsNodesLink(source, bound_target)) {
+            target_nodes.push_back(bound_target);
+          }
+        } else {
+          target_nodes = LinkedCandidates(source->outputs, targets);
+        }
+        for (Node *target : target_nodes) {
+          VLOG(8) << "check " << source->id() << " -- " << target->id();
+          HitGroup new_group = group;
+          bool flag = new_group.Match(source, edge.first) &&
+                      new_group.Match(target, edge.second);
+          if (flag) {
+            new_group.Register(source, edge.first);
+            new_group.Register(target, edge.second);
+            cur_groups.push_back(new_group);
           }
         }
       }
@@ -246,9 +353,28 @@ GraphPatternDetector::DetectPatterns() {
     }
   }
 
-  for (auto &group : bi_records[step % 2]) {
+  // Order the hits as an exhaustive match over the edges in declaration
+  // order would, so that overlapped matches are resolved the same way
+  // regardless of the seed: by the last edge's source and target first, down
+  // to the first edge and finally the first PDNode.
+  auto &groups = bi_records[step % 2];
+  std::vector<std::pair<std::vector<Node *>, size_t>> keys;
+  keys.reserve(groups.size());
+  for (size_t i = 0; i < groups.size(); ++i) {
+    std::vector<Node *> key;
+    for (auto it = pattern_.edges().rbegin(); it != pattern_.edges().rend();
+         ++it) {
+      key.push_back(groups[i].Role(it->first));
+      key.push_back(groups[i].Role(it->second));
+    }
+    key.push_back(groups[i].Role(first_pnode));
+    keys.emplace_back(std::move(key), i);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  for (auto &key : keys) {
     GraphPatternDetector::subgraph_t subgraph;
-    for (auto &role : group.roles) {
+    for (auto &role : groups[key.second].roles) {
       subgraph.emplace(role.first, role.second);
     }
     result.emplace_back(subgraph);
@@ -396,12 +522,29 @@ PDNode &PDNode::LinksFrom(const std::vector<PDNode *> &others) {
   return *this;
 }
 
+void PDNode::AddHint(Hint hint,
+                     const std::unordered_set<std::string> &types) {
+  if (hint_ == Hint::kNone) {
+    hint_ = hint;
+    hint_types_ = types;
+  } else if (hint_ == Hint::kIsOp && hint == Hint::kIsOp) {
+    // Both assertions must hold for the same op, so narrow the types. The
+    // input/output hints may be satisfied by different ops and are kept as is.
+    std::unordered_set<std::string> both;
+    for (auto &type : types) {
+      if (hint_types_.count(type)) both.insert(type);
+    }
+    hint_types_.swap(both);
+  }
+}
+
 PDNode *PDNode::assert_is_op() {
   asserts_.emplace_back([](Node *x) { return x && x->IsOp(); });
   return this;
 }
 
 PDNode *PDNode::assert_is_op(const std::string &op_type) {
+  AddHint(Hint::kIsOp, {op_type});
   asserts_.emplace_back([op_type](Node *x) {
     return x && x->IsOp() && x->Op()->Type() == op_type;
   });
@@ -455,6 +598,7 @@ PDNode *PDNode::assert_is_op_nth_input(const std::string &op_type,
 PDNode *PDNode::assert_is_op_nth_output(const std::string &op_type,
                                         const std::string &argument, int nth) {
   assert_is_var();
+  AddHint(Hint::kOutputOf, {op_type});
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
       if (op->IsOp() && op->Op()->Type() == op_type &&
@@ -468,6 +612,7 @@ PDNode *PDNode::assert_is_op_nth_output(const std::string &op_type,
 
 PDNode *PDNode::assert_is_only_input_of_op(const std::string &op_type) {
   assert_is_var();
+  AddHint(Hint::kInputOf, {op_type});
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
       if (op && op->IsOp() && op->Op() && op->Op()->Type() == op_type &&
@@ -482,6 +627,7 @@ PDNode *PDNode::assert_is_only_input_of_op(const std::string &op_type) {
 
 PDNode *PDNode::assert_is_only_output_of_op(const std::string &op_type) {
   assert_is_var();
+  AddHint(Hint::kOutputOf, {op_type});
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
       if (op && op->IsOp() && op->Op() && op->Op()->Type() == op_type &&
@@ -496,6 +642,7 @@ PDNode *PDNode::assert_is_only_output_of_op(const std::string &op_type) {
 
 PDNode *PDNode::assert_is_op_output(const std::string &op_type) {
   assert_is_var();
+  AddHint(Hint::kOutputOf, {op_type});
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
       if (op && op->IsOp() && op->Op() && op->Op()->Type() == op_type) {
@@ -516,6 +663,7 @@ PDNode *PDNode::assert_is_op_output(const std::string &op_type,
 
 PDNode *PDNode::assert_is_op_input(const std::string &op_type) {
   assert_is_var();
+  AddHint(Hint::kInputOf, {op_type});
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
       if (op && op->IsOp() && op->Op() && op->Op()->Type() == op_type) {
@@ -572,6 +720,7 @@ PDNode *PDNode::assert_more(PDNode::teller_t &&teller) {
 }
 
 PDNode *PDNode::assert_is_ops(const std::unordered_set<std::string> &op_types) {
+  AddHint(Hint::kIsOp, op_types);
   asserts_.emplace_back([op_types](Node *x) {
     return x && x->IsOp() && op_types.count(x->Op()->Type());
   });
@@ -598,6 +747,7 @@ PDNode *PDNode::assert_is_ops_nth_output(
     const std::unordered_set<std::string> &op_types,
     const std::string &argument, int nth) {
   assert_is_var();
+  AddHint(Hint::kOutputOf, op_types);
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
       if (op->IsOp() && op_types.count(op->Op()->Type()) &&
@@ -611,6 +761,7 @@ PDNode *PDNode::assert_is_ops_nth_output(
 PDNode *PDNode::assert_is_ops_output(
     const std::unordered_set<std::string> &op_types) {
   assert_is_var();
+  AddHint(Hint::kOutputOf, op_types);
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
       if (op && op->IsOp() && op->Op() && op_types.count(op->Op()->Type())) {
@@ -633,6 +784,7 @@ PDNode *PDNode::assert_is_ops_output(
 PDNode *PDNode::assert_is_ops_input(
     const std::unordered_set<std::string> &op_types) {
   assert_is_var();
+  AddHint(Hint::kInputOf, op_types);
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
       if (op && op->IsOp() && op->Op() && op_types.count(op->Op()->Type())) {
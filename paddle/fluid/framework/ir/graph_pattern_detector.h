@@ -176,6 +176,13 @@ struct PDNode {
   PDNode(PDNode&& other) = default;
 
   friend class PDPattern;
+  friend class GraphPatternDetector;
+
+  // What the op-type assertions say about the matched node: it is one of
+  // `hint_types_`, or an input/output of one of them. The detector uses this
+  // to look candidates up in the graph's node index.
+  enum class Hint { kNone, kIsOp, kInputOf, kOutputOf };
+  void AddHint(Hint hint, const std::unordered_set<std::string>& types);
 
   // Will removed latter.
   teller_t teller_;
@@ -184,6 +191,8 @@ struct PDNode {
   std::string name_;
   Type type_;
   Role role_{Role::kUnknown};
+  Hint hint_{Hint::kNone};
+  std::unordered_set<std::string> hint_types_;
 };
 
 /*
@@ -288,6 +297,9 @@ class GraphPatternDetector {
   // Mark the nodes that fits the pattern.
   bool MarkPDNodesInGraph(const ir::Graph& graph);
 
+  // Collect the candidates of a hinted PDNode from the graph's node index.
+  void MarkHintedPDNode(const ir::Graph& graph, const PDNode* pdnode);
+
   // Detect all the pattern and output the hit records.
   std::vector<subgraph_t> DetectPatterns();
 
@@ -311,6 +323,7 @@ class GraphPatternDetector {
 #ifdef PADDLE_WITH_TESTING
   FRIEND_TEST(GraphPatternDetecter, MarkPDNodesInGraph);
   FRIEND_TEST(GraphPatternDetecter, DetectPatterns);
+  FRIEND_TEST(GraphPatternDetecter, IndexedMarking);
 #endif
 
  private:
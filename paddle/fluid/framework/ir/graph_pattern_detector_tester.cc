@@ -203,6 +203,62 @@ TEST(GraphPatternDetector, IntermediateCheck) {
   ASSERT_EQ(count, 1);
 }
 
+TEST(GraphPatternDetecter, IndexedMarking) {
+  ProgramDesc program;
+  Graph graph(program);
+  OpDesc mul_desc, add_desc, relu_desc;
+  mul_desc.SetType("mul");
+  add_desc.SetType("elementwise_add");
+  relu_desc.SetType("relu");
+  VarDesc x_desc("x"), y_desc("y"), z_desc("z");
+
+  // mul -> x -> elementwise_add -> y, relu -> z
+  auto* mul = graph.CreateOpNode(&mul_desc);
+  auto* add = graph.CreateOpNode(&add_desc);
+  auto* relu = graph.CreateOpNode(&relu_desc);
+  auto* x = graph.CreateVarNode(&x_desc);
+  auto* y = graph.CreateVarNode(&y_desc);
+  auto* z = graph.CreateVarNode(&z_desc);
+  IR_NODE_LINK_TO(mul, x);
+  IR_NODE_LINK_TO(x, add);
+  IR_NODE_LINK_TO(add, y);
+  IR_NODE_LINK_TO(relu, z);
+
+  ASSERT_EQ(graph.OpNodesOfType("mul").size(), 1UL);
+  ASSERT_EQ(graph.OpNodesOfType("mul").count(mul), 1UL);
+  ASSERT_EQ(graph.VarNodesNamed("x").count(x), 1UL);
+  ASSERT_EQ(graph.VarNodesNamed("y").count(y), 1UL);
+  ASSERT_EQ(graph.VarNodesNamed("z").count(z), 1UL);
+  ASSERT_TRUE(graph.OpNodesOfType("conv2d").empty());
+
+  GraphPatternDetector detector;
+  auto* pattern = detector.mutable_pattern();
+  auto* mul_pd = pattern->NewNode("mul")->assert_is_op("mul");
+  auto* x_pd = pattern->NewNode("x")
+                   ->assert_is_op_output("mul")
+                   ->assert_is_op_input("elementwise_add");
+  auto* add_pd = pattern->NewNode("add")->assert_is_op("elementwise_add");
+  mul_pd->LinksTo({x_pd});
+  add_pd->LinksFrom({x_pd});
+
+  ASSERT_TRUE(detector.MarkPDNodesInGraph(graph));
+  ASSERT_EQ(detector.pdnodes2nodes_.size(), 3UL);
+  ASSERT_EQ(detector.pdnodes2nodes_[x_pd].size(), 1UL);
+  ASSERT_EQ(detector.pdnodes2nodes_[x_pd].count(x), 1UL);
+  auto subgraphs = detector.DetectPatterns();
+  ASSERT_EQ(subgraphs.size(), 1UL);
+  ASSERT_EQ(subgraphs.front().at(add_pd), add);
+
+  // In-place type changes are picked up on refresh, removals immediately.
+  relu_desc.SetType("mul");
+  graph.RefreshNodeIndex();
+  ASSERT_EQ(graph.OpNodesOfType("mul").size(), 2UL);
+  ASSERT_TRUE(graph.OpNodesOfType("relu").empty());
+  graph.RemoveNode(mul);
+  ASSERT_EQ(graph.OpNodesOfType("mul").size(), 1UL);
+  ASSERT_EQ(graph.OpNodesOfType("mul").count(relu), 1UL);
+}
+
 }  // namespace ir
 }  // namespace framework
 }  // namespace paddle
@@ -121,6 +121,10 @@ struct Layers {
     return unary_op("tanh", x, out);
   }
 
+  VarDesc* gelu(VarDesc* x, VarDesc* out = nullptr) {
+    return unary_op("gelu", x, out);
+  }
+
   VarDesc* fc(VarDesc* input, VarDesc* w, VarDesc* bias,
               int in_num_col_dims = 1, std::string activation_type = "") {
     VarDesc* out = lod_tensor(unique_name());
@@ -246,6 +246,14 @@ void DeserializeFromStream(std::istream& is, LoDTensor* tensor,
                            const size_t& seek,
                            const std::vector<int64_t>& shape);
 
+/*
+ * Read the LoD and the description of a serialized LoDTensor, and leave the
+ * stream at the data of the tensor, so that the data can be read by pieces
+ * or skipped.
+ */
+void DeserializeDescFromStream(std::istream& is, LoD* lod,
+                               proto::VarType::TensorDesc* desc);
+
 /*
  * Convert between length-based LoD and offset-based LoD.
  * The implementation of LoDTensor class use offset-based LoD.
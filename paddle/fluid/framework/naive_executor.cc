@@ -13,7 +13,10 @@
 // limitations under the License.
 
 #include "paddle/fluid/framework/naive_executor.h"
+#include <algorithm>
 #include <string>
+#include <unordered_set>
+#include "paddle/fluid/framework/feed_fetch_type.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/variable_helper.h"
 #include "paddle/fluid/platform/denormal.h"
@@ -35,17 +38,164 @@ void NaiveExecutor::Prepare(Scope *scope, const ProgramDesc &program_desc,
   CreateOps(program_desc, block_id, with_feed_fetch_ops);
 }
 
+void NaiveExecutor::Prepare(Scope *scope, const PreparedBlock &block) {
+  PADDLE_ENFORCE_NOT_NULL(scope,
+                          platform::errors::InvalidArgument(
+                              "The Scope to hold variables is nullptr."));
+  scope_ = scope;
+  for (auto &var : block.temp_vars) {
+    InitializeVariable(scope->Var(var.first), var.second);
+  }
+  ops_.reserve(block.ops.size());
+  for (auto &op : block.ops) {
+    ops_.emplace_back(OpRegistry::CreateOp(op.type, op.inputs, op.outputs,
+                                           op.attrs, false /*attr_check*/));
+  }
+  VLOG(3) << "NaiveExecutor init with scope " << scope << " from "
+          << block.ops.size() << " prepared ops";
+}
+
+std::shared_ptr<const NaiveExecutor::PreparedBlock>
+NaiveExecutor::ExportPreparedBlock(const ProgramDesc &desc,
+                                   int block_id) const {
+  auto block = std::make_shared<PreparedBlock>();
+  block->ops.reserve(ops_.size());
+  for (auto &op : ops_) {
+    block->ops.push_back(
+        {op->Type(), op->Inputs(), op->Outputs(), op->Attrs()});
+  }
+  for (auto *var : desc.Block(block_id).AllVars()) {
+    if (var->Name() != framework::kEmptyVarName && !var->Persistable()) {
+      block->temp_vars.emplace_back(var->Name(), var->GetType());
+    }
+  }
+  return block;
+}
+
 void NaiveExecutor::Run() {
 #ifdef PADDLE_WITH_MKLDNN
   platform::AttachPointerHashToMKLDNNKey(this, place_);
 #endif
   platform::ScopedFlushDenormal flush;
-  for (auto &op : ops_) {
+  ShapePlan *plan = nullptr;
+  std::unique_ptr<ShapePlan> recording;
+  std::string signature;
+  if (shape_plan_capacity_ > 0) {
+    PrepareShapePlan();
+    signature = ShapeSignature();
+    auto it = shape_plans_.find(signature);
+    if (it != shape_plans_.end()) {
+      plan = it->second.get();
+    } else if (shape_plans_.size() < shape_plan_capacity_) {
+      recording.reset(new ShapePlan(ops_.size()));
+    }
+  }
+  for (size_t i = 0; i < ops_.size(); ++i) {
+    auto &op = ops_[i];
     VLOG(4) << std::this_thread::get_id() << " run "
             << op->DebugStringEx(scope_) << " on scope " << scope_;
+    if (shape_plan_capacity_ > 0 && kernel_ops_[i] != nullptr) {
+      if (recording) {
+        kernel_ops_[i]->SetShapePlan(&(*recording)[i], false);
+      } else if (plan && (*plan)[i].cacheable) {
+        kernel_ops_[i]->SetShapePlan(&(*plan)[i], true);
+      } else {
+        kernel_ops_[i]->SetShapePlan(nullptr, false);
+      }
+    }
     op->SetIsCalledByExecutor(false);
     op->Run(*scope_, place_);
   }
+  if (recording) {
+    FinalizeShapePlan(recording.get());
+    shape_plans_.emplace(signature, std::move(recording));
+  }
+}
+
+void NaiveExecutor::EnableShapePlanCache(size_t capacity) {
+  ClearShapePlanCache();
+  shape_plan_capacity_ = capacity;
+}
+
+void NaiveExecutor::ClearShapePlanCache() {
+  for (auto *op : kernel_ops_) {
+    if (op) op->SetShapePlan(nullptr, false);
+  }
+  shape_plans_.clear();
+  shape_plan_inputs_.clear();
+  kernel_ops_.clear();
+}
+
+void NaiveExecutor::PrepareShapePlan() {
+  if (kernel_ops_.size() == ops_.size()) return;
+  std::unordered_set<std::string> written;
+  std::unordered_set<std::string> inputs;
+  for (auto &op : ops_) {
+    kernel_ops_.push_back(dynamic_cast<OperatorWithKernel *>(op.get()));
+    for (auto &name : op->InputVars()) {
+      // The persistable variables are in the ancestor scopes, except for the
+      // feed list.
+      bool is_input = op->Type() == "feed" || scope_->FindLocalVar(name);
+      if (!written.count(name) && is_input && inputs.insert(name).second) {
+        shape_plan_inputs_.push_back(name);
+      }
+    }
+    for (auto &name : op->OutputVars(true)) {
+      written.insert(name);
+    }
+  }
+}
+
+static void AppendShape(const LoDTensor &tensor, std::string *signature) {
+  auto append = [signature](int64_t value) {
+    signature->append(reinterpret_cast<const char *>(&value), sizeof(value));
+  };
+  auto dims = framework::vectorize(tensor.dims());
+  append(dims.size());
+  for (auto d : dims) append(d);
+  append(tensor.lod().size());
+  for (auto &level : tensor.lod()) {
+    append(level.size());
+    for (auto offset : level) append(offset);
+  }
+}
+
+std::string NaiveExecutor::ShapeSignature() const {
+  std::string signature;
+  for (auto &name : shape_plan_inputs_) {
+    auto *var = scope_->FindVar(name);
+    if (var == nullptr) {
+      continue;
+    } else if (var->IsType<LoDTensor>()) {
+      AppendShape(var->Get<LoDTensor>(), &signature);
+    } else if (var->IsType<FeedList>()) {
+      for (auto &tensor : var->Get<FeedList>()) {
+        AppendShape(tensor, &signature);
+      }
+    }
+    signature.push_back('|');
+  }
+  return signature;
+}
+
+void NaiveExecutor::FinalizeShapePlan(ShapePlan *plan) const {
+  std::unordered_set<std::string> uncached_vars;
+  for (size_t i = 0; i < ops_.size(); ++i) {
+    auto &op = ops_[i];
+    if (op->Type() == "feed" || op->Type() == "fetch") continue;
+    bool cacheable = kernel_ops_[i] != nullptr && (*plan)[i].cacheable;
+    for (auto &name : op->InputVars()) {
+      if (uncached_vars.count(name)) cacheable = false;
+    }
+    (*plan)[i].cacheable = cacheable;
+    if (!cacheable) {
+      for (auto &name : op->OutputVars(true)) uncached_vars.insert(name);
+    }
+  }
+  VLOG(3) << "Record a shape plan of " << ops_.size() << " ops, "
+          << std::count_if(plan->begin(), plan->end(),
+                           [](const OpShapePlan &p) { return p.cacheable; })
+          << " of them are cacheable";
 }
 
 void NaiveExecutor::CreateVariables(const ProgramDesc &desc, int block_id,
@@ -122,6 +272,7 @@ void NaiveExecutor::CleanFeedFetchOps() {
     }
   }
   ops_.swap(ops);
+  ClearShapePlanCache();
 }
 
 NaiveExecutor::~NaiveExecutor() {
@@ -16,6 +16,8 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "paddle/fluid/framework/operator.h"
@@ -37,6 +39,20 @@ class Scope;
 
 class NaiveExecutor {
  public:
+  // The checked ops and the temporary variables of a prepared block. It is
+  // never modified, so the executors of one program can share it instead of
+  // parsing the program and checking the attributes again.
+  struct PreparedBlock {
+    struct Op {
+      std::string type;
+      VariableNameMap inputs;
+      VariableNameMap outputs;
+      AttributeMap attrs;
+    };
+    std::vector<Op> ops;
+    std::vector<std::pair<std::string, proto::VarType::Type>> temp_vars;
+  };
+
   explicit NaiveExecutor(const platform::Place& place) : place_(place) {}
 
   ~NaiveExecutor();
@@ -47,6 +63,14 @@ class NaiveExecutor {
   void Prepare(Scope* scope, const ProgramDesc& program_desc, int block_id,
                bool with_feed_fetch_ops);
 
+  // Create the temporary variables of `block` in `scope` and its ops.
+  void Prepare(Scope* scope, const PreparedBlock& block);
+
+  // Export the ops of this prepared executor together with the temporary
+  // variables of the block they come from.
+  std::shared_ptr<const PreparedBlock> ExportPreparedBlock(
+      const ProgramDesc& desc, int block_id) const;
+
   // Create variables before head.
   // Create parameters if persistable is ture, or create the temporary variables
   // instead.
@@ -63,15 +87,37 @@ class NaiveExecutor {
 
   void CleanFeedFetchOps();
 
+  // Cache the output shapes of the operators for up to `capacity` different
+  // shapes and LoD of the inputs, so that the runs with a cached input
+  // signature skip InferShape. Zero disables it.
+  void EnableShapePlanCache(size_t capacity);
+
+  // Drop the cached shapes, e.g. after the parameters are replaced.
+  void ClearShapePlanCache();
+
  protected:
   void CreateOps(const ProgramDesc& desc, int block_id,
                  bool with_feed_fetch_ops);
 
  private:
+  using ShapePlan = std::vector<OpShapePlan>;
+
+  void PrepareShapePlan();
+  std::string ShapeSignature() const;
+  // Disables the plans of the ops whose inputs come from an op without a
+  // cacheable plan.
+  void FinalizeShapePlan(ShapePlan* plan) const;
+
   const platform::Place place_;
   // Catch the required resource to avoid recreate.
   std::vector<std::unique_ptr<OperatorBase>> ops_;
   Scope* scope_;
+
+  size_t shape_plan_capacity_{0};
+  // The non-persistable variables read before they are written.
+  std::vector<std::string> shape_plan_inputs_;
+  std::vector<OperatorWithKernel*> kernel_ops_;
+  std::unordered_map<std::string, std::unique_ptr<ShapePlan>> shape_plans_;
 };
 
 }  // namespace framework
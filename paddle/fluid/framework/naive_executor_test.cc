@@ -64,7 +64,74 @@ TEST(NaiveExecutor, Basic) {
   }
 }
 
+TEST(NaiveExecutor, ShapePlanCache) {
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto name : {"a", "b", "c", "cond", "index", "out"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+
+  auto* add = main_block->AppendOp();
+  add->SetType("elementwise_add");
+  add->SetInput("X", {"a"});
+  add->SetInput("Y", {"b"});
+  add->SetOutput("Out", {"c"});
+  // The shape of index depends on the data of cond, so its consumer must not
+  // reuse the shape of a previous run.
+  auto* where = main_block->AppendOp();
+  where->SetType("where_index");
+  where->SetInput("Condition", {"cond"});
+  where->SetOutput("Out", {"index"});
+  auto* cast = main_block->AppendOp();
+  cast->SetType("cast");
+  cast->SetInput("X", {"index"});
+  cast->SetOutput("Out", {"out"});
+  cast->SetAttr("in_dtype", static_cast<int>(proto::VarType::INT64));
+  cast->SetAttr("out_dtype", static_cast<int>(proto::VarType::FP32));
+
+  auto place = platform::CPUPlace();
+  NaiveExecutor exe(place);
+  exe.Prepare(nullptr, program, 0, false);
+  exe.CreateVariables(program, 0, false, exe.scope());
+  exe.EnableShapePlanCache(4);
+
+  auto run = [&](int rows, const std::vector<bool>& cond) {
+    auto* a_tensor = exe.FindTensor("a");
+    auto* b_tensor = exe.FindTensor("b");
+    auto* cond_tensor = exe.FindTensor("cond");
+    a_tensor->Resize({rows, 4});
+    b_tensor->Resize({rows, 4});
+    auto* a_data = a_tensor->mutable_data<float>(place);
+    auto* b_data = b_tensor->mutable_data<float>(place);
+    for (int i = 0; i < rows * 4; ++i) {
+      a_data[i] = i;
+      b_data[i] = 0.1 * i;
+    }
+    cond_tensor->Resize({static_cast<int64_t>(cond.size())});
+    std::copy(cond.begin(), cond.end(), cond_tensor->mutable_data<bool>(place));
+
+    exe.Run();
+
+    auto* c_tensor = exe.FindTensor("c");
+    ASSERT_EQ(c_tensor->dims(), make_ddim({rows, 4}));
+    for (int i = 0; i < rows * 4; ++i) {
+      EXPECT_NEAR(c_tensor->data<float>()[i], 1.1 * i, 1e-3);
+    }
+    int64_t true_num = std::count(cond.begin(), cond.end(), true);
+    ASSERT_EQ(exe.FindTensor("out")->dims(), make_ddim({true_num, 1}));
+  };
+
+  // Records a plan for each input signature, then replays them.
+  for (int repeat = 0; repeat < 3; ++repeat) {
+    run(1, {true, false, true});
+    run(2, {true, false, true});
+    run(1, {true, true, true});
+  }
+}
+
 }  // namespace framework
 }  // namespace paddle
 
 USE_OP(elementwise_add);
+USE_OP(where_index);
+USE_OP(cast);
@@ -17,6 +17,7 @@ limitations under the License. */
 #include <glog/logging.h>
 #include <sstream>
 #include <string>
+#include <unordered_set>
 
 #include "gflags/gflags.h"
 #include "paddle/fluid/framework/data_transform.h"
@@ -1058,6 +1059,84 @@ bool OperatorWithKernel::CanMKLDNNBeUsed(const framework::ExecutionContext& ctx,
   return use_mkldnn_ctx && this->SupportsMKLDNN(data_type);
 }
 
+// Collects the outputs in the order of OpShapePlan, returns false if one of
+// them is not a LoDTensor.
+static bool ShapePlanOutputs(const RuntimeContext& ctx,
+                             std::vector<LoDTensor*>* outs) {
+  for (auto& pair : ctx.outputs) {
+    for (auto* var : pair.second) {
+      if (var == nullptr) continue;
+      if (!var->IsType<LoDTensor>()) return false;
+      outs->push_back(var->GetMutable<LoDTensor>());
+    }
+  }
+  return true;
+}
+
+// Resets the outputs that are not inputs too, so that the shapes left by a
+// previous run can not hide a kernel that sets them.
+static void ResetShapePlanOutputs(const RuntimeContext& ctx) {
+  std::unordered_set<const Variable*> inputs;
+  for (auto& pair : ctx.inputs) {
+    inputs.insert(pair.second.begin(), pair.second.end());
+  }
+  for (auto& pair : ctx.outputs) {
+    for (auto* var : pair.second) {
+      if (var == nullptr || inputs.count(var) || !var->IsType<LoDTensor>()) {
+        continue;
+      }
+      auto* tensor = var->GetMutable<LoDTensor>();
+      tensor->Resize(DDim());
+      tensor->set_lod(LoD());
+    }
+  }
+}
+
+static void RecordShapePlan(const RuntimeContext& ctx, OpShapePlan* plan) {
+  std::vector<LoDTensor*> outs;
+  plan->dims.clear();
+  plan->lods.clear();
+  if (!ShapePlanOutputs(ctx, &outs)) {
+    plan->cacheable = false;
+    return;
+  }
+  for (auto* out : outs) {
+    plan->dims.push_back(out->dims());
+    plan->lods.push_back(out->lod());
+  }
+}
+
+static void CheckShapePlan(const RuntimeContext& ctx, OpShapePlan* plan) {
+  std::vector<LoDTensor*> outs;
+  if (!plan->cacheable || !ShapePlanOutputs(ctx, &outs) ||
+      outs.size() != plan->dims.size()) {
+    plan->cacheable = false;
+    return;
+  }
+  for (size_t i = 0; i < outs.size(); ++i) {
+    if (outs[i]->dims() != plan->dims[i] || outs[i]->lod() != plan->lods[i]) {
+      plan->cacheable = false;
+      return;
+    }
+  }
+}
+
+static void ApplyShapePlan(const RuntimeContext& ctx,
+                           const OpShapePlan& plan) {
+  std::vector<LoDTensor*> outs;
+  bool all_tensors = ShapePlanOutputs(ctx, &outs);
+  PADDLE_ENFORCE_EQ(
+      all_tensors && outs.size() == plan.dims.size(), true,
+      platform::errors::PreconditionNotMet(
+          "The outputs of the operator do not match its shape plan, %d "
+          "outputs are planned but %d are found.",
+          plan.dims.size(), outs.size()));
+  for (size_t i = 0; i < outs.size(); ++i) {
+    outs[i]->Resize(plan.dims[i]);
+    outs[i]->set_lod(plan.lods[i]);
+  }
+}
+
 void OperatorWithKernel::RuntimeInferShape(const Scope& scope,
                                            const platform::Place& place,
                                            const RuntimeContext& ctx) const {
@@ -1123,8 +1202,14 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
   if (!all_kernels_must_compute_runtime_shape_) {
     platform::RecordEvent record_event("infer_shape",
                                        platform::EventRole::kInnerOp);
-    RuntimeInferShapeContext infer_shape_ctx(*this, *runtime_ctx);
-    this->InferShape(&infer_shape_ctx);
+    if (shape_plan_ != nullptr && shape_plan_replay_) {
+      ApplyShapePlan(*runtime_ctx, *shape_plan_);
+    } else {
+      if (shape_plan_ != nullptr) ResetShapePlanOutputs(*runtime_ctx);
+      RuntimeInferShapeContext infer_shape_ctx(*this, *runtime_ctx);
+      this->InferShape(&infer_shape_ctx);
+      if (shape_plan_ != nullptr) RecordShapePlan(*runtime_ctx, shape_plan_);
+    }
   }
 
   if (FLAGS_enable_unused_var_check) {
@@ -1140,6 +1225,11 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
         ExecutionContext(*this, exec_scope, *dev_ctx, *runtime_ctx));
   }
 
+  if (shape_plan_ != nullptr && !shape_plan_replay_ &&
+      !all_kernels_must_compute_runtime_shape_) {
+    CheckShapePlan(*runtime_ctx, shape_plan_);
+  }
+
   if (!transfered_inplace_vars.empty()) {
     // there is inplace variable has been transferred.
     TransferInplaceVarsBack(scope, transfered_inplace_vars, *transfer_scope);
@@ -130,6 +130,17 @@ class RuntimeContext {
   VariableValueMap outputs;
 };
 
+// The output shapes of one op in a shape plan of NaiveExecutor, in the order
+// of RuntimeContext::outputs. While recording, RunImpl stores them after
+// InferShape and clears `cacheable` if the kernel changes them, i.e. they
+// depend on the input data. While replaying, RunImpl resizes the outputs to
+// them instead of calling InferShape.
+struct OpShapePlan {
+  std::vector<DDim> dims;
+  std::vector<LoD> lods;
+  bool cacheable{true};
+};
+
 /**
  * OperatorBase has the basic elements that Net will call to do computation.
  * Only CreateOperator from OpRegistry will new Operator directly. User
@@ -520,6 +531,13 @@ class OperatorWithKernel : public OperatorBase {
     return kernel_type_->place_;
   }
 
+  // Record or replay the output shapes of the next runs, see OpShapePlan.
+  // A null plan runs InferShape as usual.
+  void SetShapePlan(OpShapePlan* plan, bool replay) const {
+    shape_plan_ = plan;
+    shape_plan_replay_ = replay;
+  }
+
  private:
   void RunImpl(const Scope& scope, const platform::Place& place) const final;
   void RunImpl(const Scope& scope, const platform::Place& place,
@@ -568,6 +586,8 @@ class OperatorWithKernel : public OperatorBase {
   mutable bool all_kernels_must_compute_runtime_shape_ = false;
   mutable std::mutex cache_update_mutex_;
   mutable bool enable_cache_transfer_scope_ = false;
+  mutable OpShapePlan* shape_plan_ = nullptr;
+  mutable bool shape_plan_replay_ = false;
 };
 
 extern bool OpSupportGPU(const std::string& op_type);
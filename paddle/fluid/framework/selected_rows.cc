@@ -14,6 +14,9 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/selected_rows.h"
 
+#include <limits>
+#include <thread>  // NOLINT
+
 namespace paddle {
 namespace platform {
 class DeviceContext;
@@ -148,70 +151,223 @@ bool SelectedRows::HasKey(int64_t key) const {
                                                                    : true;
 }
 
-int64_t SelectedRows::AutoGrownIndex(int64_t key, bool auto_grown,
-                                     bool is_test) {
-  if (is_test) {
-    auto iter = id_to_index_.find(key);
-    if (iter == id_to_index_.end()) {
-      return -1;
-    } else {
-      return iter->second;
+// The id of the empty slots, which can not be indexed, and the index of the
+// slots being inserted, or failed to be inserted.
+static constexpr int64_t kEmptyId = std::numeric_limits<int64_t>::min();
+static constexpr int64_t kPendingIndex = -1;
+static constexpr int64_t kInvalidIndex = -2;
+
+static inline size_t HashId(int64_t id) {
+  // The finalizer of MurmurHash3, since the ids are often sequential.
+  uint64_t h = static_cast<uint64_t>(id);
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return static_cast<size_t>(h);
+}
+
+struct RowIndex::Table {
+  struct Slot {
+    std::atomic<int64_t> id;
+    std::atomic<int64_t> index;
+  };
+
+  explicit Table(size_t num_slots) : mask(num_slots - 1) {
+    slots.reset(new Slot[num_slots]);
+    for (size_t i = 0; i < num_slots; ++i) {
+      slots[i].id.store(kEmptyId, std::memory_order_relaxed);
+      slots[i].index.store(kPendingIndex, std::memory_order_relaxed);
     }
+    next_index.store(0, std::memory_order_relaxed);
+    appended.store(0, std::memory_order_relaxed);
   }
 
-  rwlock_->RDLock();
-  auto iter = id_to_index_.find(key);
-  if (iter == id_to_index_.end()) {
-    rwlock_->UNLock();
-    PADDLE_ENFORCE_EQ(
-        auto_grown, true,
-        platform::errors::NotFound("Input key(%lld) is not found.", key));
-    rwlock_->WRLock();
-    auto map_size = id_to_index_.size();
-    auto vector_size = rows_.size();
-    if (map_size != vector_size) {
-      rwlock_->UNLock();
-      PADDLE_THROW(platform::errors::InvalidArgument(
-          "Row map size(%zu) should be equal to rows size(%zu).", map_size,
-          vector_size));
+  // The smallest table whose load factor is at most 1/2 for num_ids ids.
+  static Table* New(size_t num_ids) {
+    size_t num_slots = 16;
+    while (num_slots < 2 * num_ids) num_slots <<= 1;
+    return new Table(num_slots);
+  }
+
+  // Sets the index of id, which is not shared by the other threads yet.
+  void Put(int64_t id, int64_t index) {
+    size_t pos = HashId(id) & mask;
+    while (slots[pos].id.load(std::memory_order_relaxed) != kEmptyId &&
+           slots[pos].id.load(std::memory_order_relaxed) != id) {
+      pos = (pos + 1) & mask;
+    }
+    slots[pos].id.store(id, std::memory_order_relaxed);
+    slots[pos].index.store(index, std::memory_order_relaxed);
+  }
+
+  // Ids are inserted without the exclusive lock until half of the slots
+  // are used.
+  bool IsFull() const {
+    return static_cast<size_t>(next_index.load(std::memory_order_relaxed)) >=
+           (mask + 1) / 2;
+  }
+
+  size_t mask;
+  std::unique_ptr<Slot[]> slots;
+  // The index of the next new id, and the number of the ids appended to
+  // the rows.
+  std::atomic<int64_t> next_index;
+  std::atomic<int64_t> appended;
+};
+
+RowIndex::RowIndex() = default;
+
+RowIndex::~RowIndex() = default;
+
+int64_t RowIndex::Find(int64_t id) const {
+  AutoRDLock lock(&lock_);
+  if (table_ == nullptr) return -1;
+  const Table* table = table_.get();
+  size_t pos = HashId(id) & table->mask;
+  for (size_t probes = 0; probes <= table->mask; ++probes) {
+    auto& slot = table->slots[pos];
+    int64_t slot_id = slot.id.load(std::memory_order_acquire);
+    if (slot_id == id) {
+      int64_t index = slot.index.load(std::memory_order_acquire);
+      return index >= 0 ? index : -1;
+    }
+    if (slot_id == kEmptyId) return -1;
+    pos = (pos + 1) & table->mask;
+  }
+  return -1;
+}
+
+int64_t RowIndex::FindOrInsert(int64_t id, bool auto_grown, int64_t capacity,
+                               Vector<int64_t>* rows) {
+  PADDLE_ENFORCE_NE(id, kEmptyId,
+                    platform::errors::InvalidArgument(
+                        "Input key(%lld) is reserved by the index.", id));
+  while (true) {
+    {
+      AutoRDLock lock(&lock_);
+      if (table_ != nullptr) {
+        int64_t index = TryFindOrInsert(id, auto_grown, capacity, rows);
+        if (index != kPendingIndex) return index;
+      } else {
+        PADDLE_ENFORCE_EQ(
+            auto_grown, true,
+            platform::errors::NotFound("Input key(%lld) is not found.", id));
+      }
+    }
+    Grow();
+  }
+}
+
+int64_t RowIndex::TryFindOrInsert(int64_t id, bool auto_grown,
+                                  int64_t capacity, Vector<int64_t>* rows) {
+  Table* table = table_.get();
+  size_t pos = HashId(id) & table->mask;
+  for (size_t probes = 0; probes <= table->mask; ++probes) {
+    auto& slot = table->slots[pos];
+    int64_t slot_id = slot.id.load(std::memory_order_acquire);
+    if (slot_id == kEmptyId) {
+      PADDLE_ENFORCE_EQ(
+          auto_grown, true,
+          platform::errors::NotFound("Input key(%lld) is not found.", id));
+      // Leaves the new id to the table grown by the exclusive lock.
+      if (table->IsFull()) return kPendingIndex;
+      if (slot.id.compare_exchange_strong(slot_id, id,
+                                          std::memory_order_acq_rel)) {
+        int64_t index = table->next_index.fetch_add(1);
+        // The ids are appended to rows in the order of their indices.
+        while (table->appended.load(std::memory_order_acquire) != index) {
+          std::this_thread::yield();
+        }
+        int64_t row_num = static_cast<int64_t>(rows->size());
+        bool valid = index < capacity && index == row_num;
+        if (valid) rows->push_back(id);
+        table->appended.store(index + 1, std::memory_order_release);
+        slot.index.store(valid ? index : kInvalidIndex,
+                         std::memory_order_release);
+        PADDLE_ENFORCE_LT(
+            index, capacity,
+            platform::errors::InvalidArgument(
+                "Selected rows is full, then length exceed the length of "
+                "first dimension (%d).",
+                row_num));
+        PADDLE_ENFORCE_EQ(
+            index, row_num,
+            platform::errors::InvalidArgument(
+                "Row map size(%lld) should be equal to rows size(%lld).", index,
+                row_num));
+        return index;
+      }
+      // Another thread claimed the slot, whose id is in slot_id now.
     }
-    auto write_iter = id_to_index_.find(key);
-    if (write_iter == id_to_index_.end()) {
-      int row_num = rows_.size();
-      if (row_num == value_->dims()[0]) {
-        rwlock_->UNLock();
-        PADDLE_THROW(platform::errors::InvalidArgument(
-            "Selected rows is full, then length exceed the length of first "
-            "dimension (%d).",
-            row_num));
+    if (slot_id == id) {
+      int64_t index;
+      while ((index = slot.index.load(std::memory_order_acquire)) ==
+             kPendingIndex) {
+        std::this_thread::yield();
       }
-      // key logic to put a key into id_to_index_
-      rows_.push_back(key);
-      auto index = static_cast<int64_t>(rows_.size() - 1);
-      id_to_index_[key] = index;
-      rwlock_->UNLock();
-      return index;
-    } else {
-      auto index = write_iter->second;
-      rwlock_->UNLock();
+      PADDLE_ENFORCE_GE(index, 0,
+                        platform::errors::InvalidArgument(
+                            "Failed to insert key(%lld) into the index.", id));
       return index;
     }
-  } else {
-    auto index = iter->second;
-    rwlock_->UNLock();
-    return index;
+    pos = (pos + 1) & table->mask;
   }
+  PADDLE_ENFORCE_EQ(
+      auto_grown, true,
+      platform::errors::NotFound("Input key(%lld) is not found.", id));
+  return kPendingIndex;
 }
 
-void SelectedRows::SyncIndex() {
-  rwlock_->WRLock();
-  id_to_index_.clear();
-  for (size_t i = 0; i < rows_.size(); ++i) {
-    id_to_index_[rows_[i]] = i;
+void RowIndex::Grow() {
+  AutoWRLock lock(&lock_);
+  if (table_ == nullptr) {
+    table_.reset(Table::New(0));
+    return;
   }
-  rwlock_->UNLock();
+  // Another thread may have grown the table.
+  if (!table_->IsFull()) return;
+  size_t num_slots = table_->mask + 1;
+  std::unique_ptr<Table> table(new Table(num_slots * 2));
+  for (size_t i = 0; i < num_slots; ++i) {
+    auto& slot = table_->slots[i];
+    int64_t slot_id = slot.id.load(std::memory_order_relaxed);
+    int64_t index = slot.index.load(std::memory_order_relaxed);
+    if (slot_id != kEmptyId && index >= 0) {
+      table->Put(slot_id, index);
+    }
+  }
+  table->next_index.store(table_->next_index.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+  table->appended.store(table_->appended.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+  table_ = std::move(table);
+}
+
+void RowIndex::Reset(const Vector<int64_t>& rows) {
+  // The rows are read under the exclusive lock as well, since the inserts
+  // append to them.
+  AutoWRLock lock(&lock_);
+  std::unique_ptr<Table> table(Table::New(rows.size()));
+  for (size_t i = 0; i < rows.size(); ++i) {
+    table->Put(rows[i], static_cast<int64_t>(i));
+  }
+  table->next_index.store(rows.size(), std::memory_order_relaxed);
+  table->appended.store(rows.size(), std::memory_order_relaxed);
+  table_ = std::move(table);
 }
 
+int64_t SelectedRows::AutoGrownIndex(int64_t key, bool auto_grown,
+                                     bool is_test) {
+  if (is_test) {
+    return index_->Find(key);
+  }
+  return index_->FindOrInsert(key, auto_grown, Capacity(), &rows_);
+}
+
+void SelectedRows::SyncIndex() { index_->Reset(rows_); }
+
 void SelectedRows::Get(const framework::Tensor& ids, framework::Tensor* value,
                        bool auto_grown, bool is_test) {
   PADDLE_ENFORCE_EQ(value->IsInitialized(), true,
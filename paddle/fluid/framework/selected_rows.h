@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <unordered_map>
@@ -38,6 +39,47 @@ namespace framework {
 
 class Tensor;
 
+/*
+ * @brief A hash index from the ids to the rows of a SelectedRows. The ids
+ * are looked up and inserted under the shared lock: an id claims a slot of
+ * an open addressing table by CAS and its index by an atomic counter, and
+ * the new ids are appended to the rows in the order of their indices. The
+ * table starts small, and is grown and rebuilt under the exclusive lock.
+ */
+class RowIndex {
+ public:
+  RowIndex();
+  ~RowIndex();
+
+  /*
+   * @brief The index of id, or -1 if id is not in the index.
+   */
+  int64_t Find(int64_t id) const;
+
+  /*
+   * @brief The index of id. If id is not in the index and auto_grown, id is
+   * appended to rows, which has capacity rows at most.
+   */
+  int64_t FindOrInsert(int64_t id, bool auto_grown, int64_t capacity,
+                       Vector<int64_t>* rows);
+
+  /*
+   * @brief Rebuild the index by rows.
+   */
+  void Reset(const Vector<int64_t>& rows);
+
+ private:
+  struct Table;
+
+  // The index of id, or kPendingIndex if the table must grow first.
+  int64_t TryFindOrInsert(int64_t id, bool auto_grown, int64_t capacity,
+                          Vector<int64_t>* rows);
+  void Grow();
+
+  mutable RWLock lock_;
+  std::unique_ptr<Table> table_;
+};
+
 class SelectedRows {
   /*
    * @brief We can use the SelectedRows structure to reproduce a sparse table.
@@ -58,13 +100,13 @@ class SelectedRows {
   SelectedRows(const std::vector<int64_t>& rows, const int64_t& height)
       : rows_(rows), height_(height) {
     value_.reset(new Tensor());
-    rwlock_.reset(new RWLock);
+    index_.reset(new RowIndex);
   }
 
   SelectedRows() {
     height_ = 0;
     value_.reset(new Tensor());
-    rwlock_.reset(new RWLock);
+    index_.reset(new RowIndex);
   }
 
   const platform::Place& place() const { return value_->place(); }
@@ -117,9 +159,11 @@ class SelectedRows {
            bool auto_grown = false, bool is_test = false);
 
   /*
-   * @brief Get the index of the key from id_to_index_ map. If the key not
+   * @brief Get the index of the key from the index of rows. If the key not
    * exist,
-   * add the key into id_to_index_.
+   * add the key into the index and rows. It is thread safe: the lookups and
+   * the insertions share the read lock of the index, and only growing the
+   * index takes its write lock.
    *
    * Note!!! this interface is only used when selected_rows is used as
    * parameters
@@ -130,17 +174,15 @@ class SelectedRows {
   int64_t AutoGrownIndex(int64_t key, bool auto_grown, bool is_test = false);
 
   /*
-   * @brief Get the index of the key from id_to_index_ map.
+   * @brief Get the index of the key from the index of rows.
    */
   inline int64_t GetIndexFromId(int64_t key) const {
-    auto iter = id_to_index_.find(key);
-    if (iter == id_to_index_.end()) {
-      return -1;
-    } else {
-      return iter->second;
-    }
+    return index_->Find(key);
   }
 
+  /*
+   * @brief Rebuild the index of rows after rows are changed.
+   */
   void SyncIndex();
   /*
    * @brief Get complete Dims before
@@ -155,12 +197,15 @@ class SelectedRows {
   // Notice: rows can be duplicate. We can have {0, 4, 7, 0, 5, 7, 9} here.
   // SelectedRows are simply concated when adding together. Until a
   // SelectedRows add a Tensor, will the duplicate rows be handled.
+  int64_t Capacity() const {
+    return value_->dims().size() > 0 ? value_->dims()[0] : 0;
+  }
+
   Vector<int64_t> rows_;
-  std::unordered_map<int64_t, int64_t>
-      id_to_index_;  // should not be used when rows_ has duplicate member
+  // should not be used when rows_ has duplicate member
+  std::unique_ptr<RowIndex> index_{nullptr};
   std::unique_ptr<Tensor> value_{nullptr};
   int64_t height_;  // height indicates the underline tensor's height
-  std::unique_ptr<RWLock> rwlock_{nullptr};
 };
 
 /*
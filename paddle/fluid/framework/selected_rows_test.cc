@@ -192,6 +192,10 @@ TEST(SelectedRows, MultiThreadAutoIndex) {
   t11.join();
   t2.join();
   t22.join();
+  ASSERT_EQ(table.rows().size(), static_cast<size_t>(table_size));
+  for (int64_t i = 0; i < table_size; ++i) {
+    ASSERT_EQ(table.GetIndexFromId(table.rows()[i]), i);
+  }
   std::thread t3(f3, &table, table_size);
   std::thread t4(f4, &table, table_size);
   t3.join();
@@ -15,7 +15,11 @@
 #include "paddle/fluid/imperative/basic_engine.h"
 
 #include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <exception>
+#include <functional>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <sstream>
 #include <string>
@@ -24,6 +28,7 @@
 #include <utility>
 #include <vector>
 
+#include "paddle/fluid/framework/threadpool.h"
 #include "paddle/fluid/imperative/gradient_accumulator.h"
 #include "paddle/fluid/imperative/layer.h"
 #include "paddle/fluid/imperative/op_base.h"
@@ -32,6 +37,7 @@
 #include "paddle/fluid/platform/profiler.h"
 
 DECLARE_bool(sort_sum_gradient);
+DECLARE_int32(backward_num_threads);
 
 namespace paddle {
 namespace imperative {
@@ -114,6 +120,21 @@ void BasicEngine::CheckBackwardInputs(const OpBase& op) {
   }
 }
 
+std::unique_ptr<GradientAccumulator> BasicEngine::CreateGradientAccumulator(
+    VariableWrapper* var) const {
+  // NOTE: The summation order of EagerGradientAccumulator depends on the
+  // finishing order of grad ops, which is not fixed when grad nodes run
+  // in parallel. Use SortedGradientAccumulator to keep the result
+  // deterministic.
+  if (FLAGS_sort_sum_gradient || use_parallel_) {
+    return std::unique_ptr<GradientAccumulator>(
+        new SortedGradientAccumulator(var));
+  } else {
+    return std::unique_ptr<GradientAccumulator>(
+        new EagerGradientAccumulator(var));
+  }
+}
+
 void BasicEngine::PrepareGradAccumulators(
     const OpBase& op,
     const std::vector<std::shared_ptr<GradOpNode>>& grad_pending_nodes) {
@@ -128,11 +149,7 @@ void BasicEngine::PrepareGradAccumulators(
       if (!var->HasGradNode()) {
         auto& accumulator = accumulators_[var.get()];
         if (!accumulator) {
-          if (FLAGS_sort_sum_gradient) {
-            accumulator.reset(new SortedGradientAccumulator(var.get()));
-          } else {
-            accumulator.reset(new EagerGradientAccumulator(var.get()));
-          }
+          accumulator = CreateGradientAccumulator(var.get());
         }
 
         accumulator->IncreaseRefCnt();
@@ -192,11 +209,7 @@ void BasicEngine::PrepareGradAccumulators(
                 accumulators_with_grad_node_[grad_pending_node][var.get()];
 
             if (!accumulator) {
-              if (FLAGS_sort_sum_gradient) {
-                accumulator.reset(new SortedGradientAccumulator(var.get()));
-              } else {
-                accumulator.reset(new EagerGradientAccumulator(var.get()));
-              }
+              accumulator = CreateGradientAccumulator(var.get());
             }
 
             accumulator->IncreaseRefCnt();
@@ -262,193 +275,236 @@ void BasicEngine::PrepareDeps() {
   }
 }
 
-void BasicEngine::Execute() {
-  if (init_node_ == nullptr) {
-    return;
-  }
-
-  PrepareDeps();
-  // Start execute Computation graph
-  std::queue<std::shared_ptr<GradOpNode>> q;
-  q.push(std::move(init_node_));
-
+size_t BasicEngine::RunGradNode(const std::shared_ptr<GradOpNode>& node) {
   size_t op_num = 0;
+  auto& inplace_grad_name_map = node->InplaceGradNameMap();
+
+  for (auto& cur_op : *node) {
+    // The output grad var of Inplace grad op. Because Inplace grad op does
+    // not use the Inplace strategy, a new output grad var needs to be
+    // created.
+    std::vector<std::pair<std::shared_ptr<VariableWrapper>,
+                          std::shared_ptr<VariableWrapper>>>
+        inplace_output_grad_var_list;
+    std::vector<
+        std::pair<GradientAccumulator*, std::shared_ptr<VariableWrapper>>>
+        need_accu_var_list;
+    // leaf_accumulators is only for leaf tensor(hooks/accumulate grad)
+    // It should be orderly and not repeated, because multiple cards must
+    // ensure that the order of vars is the same.
+    std::vector<GradientAccumulator*> leaf_accumulators;
+
+    platform::RecordEvent op_type_record_event(cur_op.Type());
+
+    ++op_num;
+
+    // CheckBackWardInput
+    CheckBackwardInputs(cur_op);
+
+    // Step 1: Run Backward OP
+    auto& bwd_ins = cur_op.GetInsMap();
+    auto& bwd_outs = cur_op.GetOutsMap();
+
+    NameVarMap<VariableWrapper> tmp_outs(bwd_outs);
+    // 1. construct the temp output map, avoid to disrupt graph
+    // 2. replace the element in the map by temp var, because a
+    // var may be coresponding to several grad var in one op
+    for (auto& pair : tmp_outs) {
+      if (!pair.second.IsGrad()) {
+        continue;
+      }
 
-  while (!q.empty()) {
-    auto shared_cur_node = std::move(q.front());
-    q.pop();
-
-    auto& inplace_grad_name_map = shared_cur_node->InplaceGradNameMap();
-
-    for (auto& cur_op : *shared_cur_node) {
-      platform::RecordEvent op_type_record_event(cur_op.Type());
-
-      ++op_num;
-
-      // CheckBackWardInput
-      CheckBackwardInputs(cur_op);
-
-      // Step 1: Run Backward OP
-      auto& bwd_ins = cur_op.GetInsMap();
-      auto& bwd_outs = cur_op.GetOutsMap();
-
-      NameVarMap<VariableWrapper> tmp_outs(bwd_outs);
-      // 1. construct the temp output map, avoid to disrupt graph
-      // 2. replace the element in the map by temp var, because a
-      // var may be coresponding to several grad var in one op
-      for (auto& pair : tmp_outs) {
-        if (!pair.second.IsGrad()) {
+      for (auto& var : pair.second) {
+        if (!var) {
           continue;
         }
 
-        for (auto& var : pair.second) {
-          if (!var) {
-            continue;
-          }
-
-          std::unordered_map<VariableWrapper*,
-                             std::unique_ptr<GradientAccumulator>>::iterator
-              iter;
-          if (!var->HasGradNode()) {
-            VLOG(10) << "Find gradient of var (" << var->Name()
-                     << ") with no grad_node.";
-            iter = accumulators_.find(var.get());
-            PADDLE_ENFORCE_EQ(
-                iter != accumulators_.end(), true,
-                platform::errors::NotFound(
-                    "Cannot find gradient of variable %s", var->Name()));
-          } else {
-            bool flag_find_grad = false;
-            VLOG(10) << "Find gradient of var (" << var->Name()
-                     << ") with grad_node.";
-            for (auto& grad_pending_node :
-                 shared_cur_node->GradPendingNodes()) {
-              const auto& iter_grad_node =
-                  accumulators_with_grad_node_.find(grad_pending_node);
-              if (iter_grad_node != accumulators_with_grad_node_.end()) {
-                iter = iter_grad_node->second.find(var.get());
-                if (iter != iter_grad_node->second.end()) {
-                  flag_find_grad = true;
-                  break;
-                }
+        std::unordered_map<VariableWrapper*,
+                           std::unique_ptr<GradientAccumulator>>::iterator
+            iter;
+        if (!var->HasGradNode()) {
+          VLOG(10) << "Find gradient of var (" << var->Name()
+                   << ") with no grad_node.";
+          iter = accumulators_.find(var.get());
+          PADDLE_ENFORCE_EQ(
+              iter != accumulators_.end(), true,
+              platform::errors::NotFound(
+                  "Cannot find gradient of variable %s", var->Name()));
+        } else {
+          bool flag_find_grad = false;
+          VLOG(10) << "Find gradient of var (" << var->Name()
+                   << ") with grad_node.";
+          for (auto& grad_pending_node : node->GradPendingNodes()) {
+            const auto& iter_grad_node =
+                accumulators_with_grad_node_.find(grad_pending_node);
+            if (iter_grad_node != accumulators_with_grad_node_.end()) {
+              iter = iter_grad_node->second.find(var.get());
+              if (iter != iter_grad_node->second.end()) {
+                flag_find_grad = true;
+                break;
               }
             }
-            PADDLE_ENFORCE_EQ(
-                flag_find_grad, true,
-                platform::errors::NotFound(
-                    "Cannot find gradient of variable %s", var->Name()));
           }
+          PADDLE_ENFORCE_EQ(
+              flag_find_grad, true,
+              platform::errors::NotFound(
+                  "Cannot find gradient of variable %s", var->Name()));
+        }
 
-          // leaf_accumulators_ : hooks and accumulate-grad for leaf tensor,
-          // it should be orderly and not reapeated.
-          if (var->IsLeafGrad()) {
-            if (std::find(leaf_accumulators_.begin(), leaf_accumulators_.end(),
-                          iter->second.get()) == leaf_accumulators_.end()) {
-              leaf_accumulators_.push_back(iter->second.get());
-            }
+        // leaf_accumulators : hooks and accumulate-grad for leaf tensor,
+        // it should be orderly and not reapeated.
+        if (var->IsLeafGrad()) {
+          if (std::find(leaf_accumulators.begin(), leaf_accumulators.end(),
+                        iter->second.get()) == leaf_accumulators.end()) {
+            leaf_accumulators.push_back(iter->second.get());
+          }
 
-            if (iter->second->HasInnerVar()) {
-              var = iter->second->InnerVar();
-            }
+          if (iter->second->HasInnerVar()) {
+            var = iter->second->InnerVar();
           }
+        }
 
-          if (var->OverridedStopGradient() || iter->second->RefCnt() > 1) {
-            auto tmp_var = std::make_shared<VariableWrapper>(var->Name());
-            tmp_var->SetType(var->Type());
-            tmp_var->SetForwardDataType(var->ForwardDataType());
-            var = tmp_var;
-            need_accu_var_list_.emplace_back(iter->second.get(), var);
-            VLOG(10) << "create temporary var of " << var->Name()
-                     << " for sum gradient within this graph!";
-          } else if (!inplace_grad_name_map.empty() &&
-                     inplace_grad_name_map.count(pair.first)) {
-            // When calculate Inplace grad op, create a new output var.
-            // If a tmp var has been created, there is no need to create it
-            // again.
-            for (auto& in_var :
-                 bwd_ins.at(inplace_grad_name_map.at(pair.first))) {
-              if (in_var == var) {
-                auto tmp_var = std::make_shared<VariableWrapper>(var->Name());
-                tmp_var->SetType(var->Type());
-                tmp_var->SetForwardDataType(var->ForwardDataType());
-                inplace_output_grad_var_list_.emplace_back(var, tmp_var);
-                var = tmp_var;
-                VLOG(10) << "Inplace grad op does not use the Inplace "
-                            "strategy, a temporary output var ("
-                         << var->Name() << ") will be created.";
-                break;
-              }
+        if (var->OverridedStopGradient() || iter->second->RefCnt() > 1) {
+          auto tmp_var = std::make_shared<VariableWrapper>(var->Name());
+          tmp_var->SetType(var->Type());
+          tmp_var->SetForwardDataType(var->ForwardDataType());
+          var = tmp_var;
+          need_accu_var_list.emplace_back(iter->second.get(), var);
+          VLOG(10) << "create temporary var of " << var->Name()
+                   << " for sum gradient within this graph!";
+        } else if (!inplace_grad_name_map.empty() &&
+                   inplace_grad_name_map.count(pair.first)) {
+          // When calculate Inplace grad op, create a new output var.
+          // If a tmp var has been created, there is no need to create it
+          // again.
+          for (auto& in_var :
+               bwd_ins.at(inplace_grad_name_map.at(pair.first))) {
+            if (in_var == var) {
+              auto tmp_var = std::make_shared<VariableWrapper>(var->Name());
+              tmp_var->SetType(var->Type());
+              tmp_var->SetForwardDataType(var->ForwardDataType());
+              inplace_output_grad_var_list.emplace_back(var, tmp_var);
+              var = tmp_var;
+              VLOG(10) << "Inplace grad op does not use the Inplace "
+                          "strategy, a temporary output var ("
+                       << var->Name() << ") will be created.";
+              break;
             }
           }
         }
       }
+    }
 
-      VLOG(4) << "Check whether there is any inplace operation affecting "
-                 "gradient calculation.";
-      for (auto& pair : bwd_ins) {
-        for (auto& var_wrapper : pair.second) {
-          auto wrapper_version_snapshot = var_wrapper->InplaceVersionSnapshot();
-          auto tensor_version =
-              var_wrapper->MutableVar()->CurrentInplaceVersion();
-          PADDLE_ENFORCE_EQ(
-              tensor_version, wrapper_version_snapshot,
-              platform::errors::PermissionDenied(
-                  "Tensor '%s' used in gradient computation in grad op '%s' "
-                  "has been "
-                  "modified by an inplace operation. "
-                  "Its version is %s but the expected version is %s. "
-                  "Please fix your code to void calling an inplace operator "
-                  "after using the Tensor which will used in gradient "
-                  "computation.",
-                  var_wrapper->Name(), cur_op.Type(), tensor_version,
-                  wrapper_version_snapshot));
-
-          VLOG(6) << " The version of Tensor '" << var_wrapper->Name()
-                  << "' is [ " << wrapper_version_snapshot << " ]";
-        }
+    VLOG(4) << "Check whether there is any inplace operation affecting "
+               "gradient calculation.";
+    for (auto& pair : bwd_ins) {
+      for (auto& var_wrapper : pair.second) {
+        auto wrapper_version_snapshot = var_wrapper->InplaceVersionSnapshot();
+        auto tensor_version =
+            var_wrapper->MutableVar()->CurrentInplaceVersion();
+        PADDLE_ENFORCE_EQ(
+            tensor_version, wrapper_version_snapshot,
+            platform::errors::PermissionDenied(
+                "Tensor '%s' used in gradient computation in grad op '%s' "
+                "has been "
+                "modified by an inplace operation. "
+                "Its version is %s but the expected version is %s. "
+                "Please fix your code to void calling an inplace operator "
+                "after using the Tensor which will used in gradient "
+                "computation.",
+                var_wrapper->Name(), cur_op.Type(), tensor_version,
+                wrapper_version_snapshot));
+
+        VLOG(6) << " The version of Tensor '" << var_wrapper->Name()
+                << "' is [ " << wrapper_version_snapshot << " ]";
       }
+    }
 
-      {
-        VLOG(3) << "Start to execute grad op " << cur_op.Type();
-        OpBase::Run(cur_op.InnerOp(), bwd_ins, tmp_outs, cur_op.Attrs(),
-                    cur_op.place());
-      }
+    {
+      VLOG(3) << "Start to execute grad op " << cur_op.Type();
+      OpBase::Run(cur_op.InnerOp(), bwd_ins, tmp_outs, cur_op.Attrs(),
+                  cur_op.place());
+    }
 
-      for (auto& pair : inplace_output_grad_var_list_) {
-        *pair.first = std::move(*pair.second);
-      }
+    for (auto& pair : inplace_output_grad_var_list) {
+      *pair.first = std::move(*pair.second);
+    }
 
-      // Step 2: Sum Gradient of This graph
-      for (auto& pair : need_accu_var_list_) {
+    // Step 2: Sum Gradient of This graph
+    for (auto& pair : need_accu_var_list) {
+      if (use_parallel_) {
+        std::lock_guard<std::mutex> guard(pair.first->Mutex());
+        pair.first->SumGrad(std::move(pair.second), cur_op.id());
+      } else {
         pair.first->SumGrad(std::move(pair.second), cur_op.id());
       }
+    }
 
-      // Step 3: Call Hooks && Sum Gradient with Pre-Graph && Call BackwardHooks
-      for (auto* accumulator : leaf_accumulators_) {
-        if (!accumulator->SumGradCompleted()) {
+    // Step 3: Call Hooks && Sum Gradient with Pre-Graph && Call BackwardHooks
+    for (auto* accumulator : leaf_accumulators) {
+      std::unique_lock<std::mutex> guard;
+      if (use_parallel_) {
+        // NOTE: several grad nodes may finish the same leaf accumulator
+        // concurrently, only the first one which sees the completed sum
+        // should accumulate the gradient and call the hooks.
+        guard = std::unique_lock<std::mutex>(accumulator->Mutex());
+        if (!accumulator->SumGradCompleted() ||
+            !MarkLeafAccumulated(accumulator)) {
           continue;
         }
-        // 1. Call Hooks for **inner_var_**
-
-        // 2. Sum Gradient with Previous Graph
-        accumulator->AccumulateGrad();
-
-        // 3. Call backward Hooks for **var_**
-        if (accumulator->HasPostHooks()) {
-          accumulator->CallBackwardPostHooks();
-        }
+      } else if (!accumulator->SumGradCompleted()) {
+        continue;
       }
+      // 1. Call Hooks for **inner_var_**
 
-      need_accu_var_list_.clear();
-      inplace_output_grad_var_list_.clear();
-      leaf_accumulators_.clear();
+      // 2. Sum Gradient with Previous Graph
+      accumulator->AccumulateGrad();
 
-      if (!retain_graph_) {
-        VLOG(3) << "Remove op after op " << cur_op.Type() << " runs";
-        cur_op.ClearBackwardTrace();
+      // 3. Call backward Hooks for **var_**
+      if (accumulator->HasPostHooks()) {
+        accumulator->CallBackwardPostHooks();
       }
     }
 
+    if (!retain_graph_) {
+      VLOG(3) << "Remove op after op " << cur_op.Type() << " runs";
+      cur_op.ClearBackwardTrace();
+    }
+  }
+
+  return op_num;
+}
+
+bool BasicEngine::MarkLeafAccumulated(GradientAccumulator* accumulator) {
+  std::lock_guard<std::mutex> guard(accumulated_leaf_mutex_);
+  return accumulated_leaf_accumulators_.insert(accumulator).second;
+}
+
+void BasicEngine::Execute() {
+  if (init_node_ == nullptr) {
+    return;
+  }
+
+  use_parallel_ = FLAGS_backward_num_threads > 1;
+  PrepareDeps();
+
+  if (use_parallel_) {
+    ExecuteParallel();
+    return;
+  }
+
+  // Start execute Computation graph
+  std::queue<std::shared_ptr<GradOpNode>> q;
+  q.push(std::move(init_node_));
+
+  size_t op_num = 0;
+
+  while (!q.empty()) {
+    auto shared_cur_node = std::move(q.front());
+    q.pop();
+
+    op_num += RunGradNode(shared_cur_node);
+
     // Step 3: Collect ready ops
     for (auto& grad_pending_node : shared_cur_node->GradPendingNodes()) {
       PADDLE_ENFORCE_NOT_NULL(
@@ -469,13 +525,93 @@ void BasicEngine::Execute() {
   VLOG(1) << "Backward op number: " << op_num;
 }
 
+// The pool is shared by the engines, an engine holds the pool it runs on
+// until its backward finishes, so that changing the number of threads does
+// not free a pool still running the grad nodes of another engine.
+static std::shared_ptr<framework::ThreadPool> GetBackwardThreadPool(
+    int num_threads) {
+  static std::mutex mutex;
+  static std::shared_ptr<framework::ThreadPool> pool;
+  static int pool_size = 0;
+  std::lock_guard<std::mutex> guard(mutex);
+  if (pool == nullptr || pool_size != num_threads) {
+    VLOG(3) << "Create backward thread pool with " << num_threads
+            << " threads";
+    pool = std::make_shared<framework::ThreadPool>(num_threads);
+    pool_size = num_threads;
+  }
+  return pool;
+}
+
+void BasicEngine::ExecuteParallel() {
+  auto pool = GetBackwardThreadPool(FLAGS_backward_num_threads);
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  size_t running_num = 0;
+  size_t op_num = 0;
+  std::exception_ptr exception = nullptr;
+
+  // The grad nodes are dispatched as soon as all their dependencies are
+  // finished, node_deps_ is only read and written with `mutex` held.
+  std::function<void(std::shared_ptr<GradOpNode>)> run_node;
+  run_node = [&](std::shared_ptr<GradOpNode> node) {
+    pool->Run([&, node] {
+      std::vector<std::shared_ptr<GradOpNode>> ready_nodes;
+      size_t node_op_num = 0;
+      std::exception_ptr node_exception = nullptr;
+      try {
+        node_op_num = RunGradNode(node);
+      } catch (...) {
+        node_exception = std::current_exception();
+      }
+
+      std::lock_guard<std::mutex> guard(mutex);
+      op_num += node_op_num;
+      if (node_exception != nullptr) {
+        if (exception == nullptr) {
+          exception = node_exception;
+        }
+      } else if (exception == nullptr) {
+        for (auto& grad_pending_node : node->GradPendingNodes()) {
+          auto iter = node_deps_.find(grad_pending_node.get());
+          if (iter == node_deps_.end()) {
+            continue;
+          }
+          if (--(iter->second) == 0) {
+            ++running_num;
+            run_node(grad_pending_node);
+          }
+        }
+      }
+      if (--running_num == 0) {
+        cv.notify_all();
+      }
+    });
+  };
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    ++running_num;
+    run_node(std::move(init_node_));
+    cv.wait(lock, [&] { return running_num == 0; });
+  }
+  Clear();
+
+  if (exception != nullptr) {
+    std::rethrow_exception(exception);
+  }
+
+  VLOG(1) << "Backward op number: " << op_num << ", with "
+          << FLAGS_backward_num_threads << " threads";
+}
+
 void BasicEngine::Clear() {
   init_node_.reset();
   node_deps_.clear();
   accumulators_.clear();
   accumulators_with_grad_node_.clear();
-  need_accu_var_list_.clear();
-  leaf_accumulators_.clear();
+  accumulated_leaf_accumulators_.clear();
 }
 
 }  // namespace imperative
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>  // NOLINT
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -37,6 +38,19 @@ class BasicEngine : public Engine {
  private:
   void PrepareDeps();
 
+  // Dispatch the grad nodes whose dependencies are all finished to a thread
+  // pool, which is enabled by FLAGS_backward_num_threads > 1.
+  void ExecuteParallel();
+
+  // Run all grad ops of one grad node, return the number of ops run.
+  size_t RunGradNode(const std::shared_ptr<GradOpNode>& node);
+
+  // Return true if the leaf accumulator has not been accumulated yet.
+  bool MarkLeafAccumulated(GradientAccumulator* accumulator);
+
+  std::unique_ptr<GradientAccumulator> CreateGradientAccumulator(
+      VariableWrapper* var) const;
+
   void CheckBackwardInputs(const OpBase& op);
 
   void PrepareGradAccumulators(
@@ -61,19 +75,13 @@ class BasicEngine : public Engine {
   // `var` as the key.
   std::unordered_map<VariableWrapper*, std::unique_ptr<GradientAccumulator>>
       accumulators_;
-  // The output grad var of Inplace grad op. Because Inplace grad op does not
-  // use the Inplace strategy, a new output grad var needs to be created.
-  std::vector<std::pair<std::shared_ptr<VariableWrapper>,
-                        std::shared_ptr<VariableWrapper>>>
-      inplace_output_grad_var_list_;
-  std::vector<std::pair<GradientAccumulator*, std::shared_ptr<VariableWrapper>>>
-      need_accu_var_list_;
-  // leaf_accumulators_ is only for leaf tensor(hooks/accumulate grad)
-  // It should be orderly and not repeated, because multiple cards must ensure
-  // that the order of vars is the same.
-  std::vector<GradientAccumulator*> leaf_accumulators_;
+  // Leaf accumulators that have accumulated the gradient and called the
+  // hooks, only used when grad nodes run in parallel.
+  std::unordered_set<GradientAccumulator*> accumulated_leaf_accumulators_;
+  std::mutex accumulated_leaf_mutex_;
 
   bool retain_graph_;
+  bool use_parallel_{false};
 };
 
 }  // namespace imperative
@@ -0,0 +1,255 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/imperative/gloo_context.h"
+
+#if defined(PADDLE_WITH_GLOO)
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+
+#include "paddle/fluid/framework/fleet/gloo_wrapper.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/framework/variable.h"
+#include "paddle/fluid/platform/float16.h"
+#include "paddle/fluid/string/string_helper.h"
+
+namespace paddle {
+namespace imperative {
+
+// The options of the gloo context are given by the environment, since the
+// strategy is shared with the other parallel contexts. The defaults are the
+// same as those of platform::GlooParallelContext in init_parallel_env.
+static std::string GetGlooEnv(const char *name, const std::string &value) {
+  const char *env = std::getenv(name);
+  return env != nullptr ? std::string(env) : value;
+}
+
+void GLOOParallelContext::Init() {
+  PADDLE_ENFORCE_EQ(
+      platform::is_cpu_place(place_), true,
+      platform::errors::InvalidArgument(
+          "GLOOParallelContext only supports CPUPlace, but got %s.", place_));
+  PADDLE_ENFORCE_GT(strategy_.trainer_endpoints_.size(), 0,
+                    platform::errors::InvalidArgument(
+                        "The trainer endpoints of GLOOParallelContext should "
+                        "not be empty."));
+  // The rendezvous uses the same http store as platform::GlooParallelContext,
+  // which is served on the first trainer endpoint, but in the scope of its
+  // own, so that both of them can be initialized in one process.
+  auto addr =
+      string::split_string<std::string>(strategy_.trainer_endpoints_[0], ":");
+  PADDLE_ENFORCE_EQ(addr.size(), 2UL,
+                    platform::errors::InvalidArgument(
+                        "The trainer endpoint should be ip:port, but got %s.",
+                        strategy_.trainer_endpoints_[0]));
+  VLOG(0) << "init gloo context nranks: " << strategy_.nranks_
+          << " local rank: " << strategy_.local_rank_
+          << " http store: " << strategy_.trainer_endpoints_[0];
+
+  gloo_wrapper_ = std::make_shared<framework::GlooWrapper>();
+  gloo_wrapper_->SetSize(strategy_.nranks_);
+  gloo_wrapper_->SetRank(strategy_.local_rank_);
+  // An empty iface selects the interface by the hostname, so that the ranks
+  // on different nodes can connect.
+  gloo_wrapper_->SetPrefix(GetGlooEnv("PADDLE_GLOO_PREFIX", ""));
+  gloo_wrapper_->SetIface(GetGlooEnv("PADDLE_GLOO_IFACE", ""));
+  gloo_wrapper_->SetTimeoutSeconds(
+      std::stoi(GetGlooEnv("PADDLE_GLOO_INIT_TIMEOUT_SECONDS", "3600")),
+      std::stoi(GetGlooEnv("PADDLE_GLOO_RUN_TIMEOUT_SECONDS", "9999999")));
+  gloo_wrapper_->SetHttpStore(addr[0], std::stoi(addr[1]), "dygraph");
+  gloo_wrapper_->Init();
+
+  device_.reset(new platform::CPUDeviceContext(platform::CPUPlace()));
+}
+
+template <typename T>
+static void GlooAllReduceSum(framework::GlooWrapper *gloo_wrapper, T *data,
+                             size_t count) {
+  gloo::AllreduceOptions opts(gloo_wrapper->GetContext());
+  opts.setOutput(data, count);
+  opts.setReduceFunction(
+      static_cast<void (*)(void *, const void *, const void *, size_t)>(
+          &gloo::sum<T>));
+  gloo::allreduce(opts);
+}
+
+template <typename T>
+static void GlooAllGather(framework::GlooWrapper *gloo_wrapper, const T *in,
+                          size_t count, T *out) {
+  gloo::AllgatherOptions opts(gloo_wrapper->GetContext());
+  opts.setInput(const_cast<T *>(in), count);
+  opts.setOutput(out, count * gloo_wrapper->Size());
+  gloo::allgather(opts);
+}
+
+void GLOOParallelContext::AllReduce(const framework::Tensor &src,
+                                    framework::Tensor *dst) {
+  // Gloo allreduce is done in-place on the output buffer.
+  if (&src != dst) {
+    framework::TensorCopySync(src, platform::CPUPlace(), dst);
+  }
+  auto numel = static_cast<size_t>(dst->numel());
+  auto *gloo_wrapper = gloo_wrapper_.get();
+  switch (dst->type()) {
+    case framework::proto::VarType::FP32:
+      GlooAllReduceSum(gloo_wrapper, dst->data<float>(), numel);
+      break;
+    case framework::proto::VarType::FP64:
+      GlooAllReduceSum(gloo_wrapper, dst->data<double>(), numel);
+      break;
+    case framework::proto::VarType::INT32:
+      GlooAllReduceSum(gloo_wrapper, dst->data<int>(), numel);
+      break;
+    case framework::proto::VarType::INT64:
+      GlooAllReduceSum(gloo_wrapper, dst->data<int64_t>(), numel);
+      break;
+    case framework::proto::VarType::FP16: {
+      // Summed in float, which gloo has the reduce function of and which
+      // does not lose the precision of the partial sums.
+      auto *data = dst->data<platform::float16>();
+      std::vector<float> buffer(numel);
+      for (size_t i = 0; i < numel; ++i) {
+        buffer[i] = static_cast<float>(data[i]);
+      }
+      GlooAllReduceSum(gloo_wrapper, buffer.data(), numel);
+      for (size_t i = 0; i < numel; ++i) {
+        data[i] = static_cast<platform::float16>(buffer[i]);
+      }
+      break;
+    }
+    default:
+      PADDLE_THROW(platform::errors::Unimplemented(
+          "Data type (%s) is not supported when it allreduces tensors with "
+          "gloo.",
+          framework::DataTypeToString(dst->type())));
+  }
+}
+
+// Gloo only provides the fixed-size allgather, so the rows of each rank are
+// padded to the maximum rows number before gathering.
+void GLOOParallelContext::AllReduce(const framework::SelectedRows &src,
+                                    framework::SelectedRows *dst) {
+  VLOG(3) << "SelectedRows AllReduce start";
+  const auto &src_tensor = src.value();
+  const auto &src_rows = src.rows();
+  auto nranks = static_cast<size_t>(strategy_.nranks_);
+  auto dtype = src_tensor.type();
+  auto sizeof_dtype = framework::SizeOfType(dtype);
+  auto dims = src_tensor.dims();
+  auto feature_size = framework::product(
+      framework::slice_ddim(dims, 1, dims.size()));
+  auto row_bytes = static_cast<size_t>(feature_size) * sizeof_dtype;
+
+  // 1. Gather rows number from all workers.
+  int64_t local_rows_num = static_cast<int64_t>(src_rows.size());
+  std::vector<int64_t> rows_num(nranks);
+  GlooAllGather(gloo_wrapper_.get(), &local_rows_num, 1, rows_num.data());
+  auto max_rows_num =
+      static_cast<size_t>(*std::max_element(rows_num.begin(), rows_num.end()));
+  auto total_rows_num = std::accumulate(rows_num.begin(), rows_num.end(),
+                                        static_cast<int64_t>(0));
+  VLOG(3) << "Gather rows: " << string::join_strings(rows_num, ',')
+          << ", total rows number: " << total_rows_num
+          << ", height: " << src.height();
+
+  // 2. Gather the padded rows and values.
+  std::vector<int64_t> send_rows(max_rows_num, 0);
+  std::copy(src_rows.begin(), src_rows.end(), send_rows.begin());
+  std::vector<int64_t> recv_rows(max_rows_num * nranks);
+  std::vector<uint8_t> send_values(max_rows_num * row_bytes, 0);
+  if (local_rows_num > 0) {
+    std::memcpy(send_values.data(), src_tensor.data<void>(),
+                local_rows_num * row_bytes);
+  }
+  std::vector<uint8_t> recv_values(send_values.size() * nranks);
+  if (max_rows_num > 0) {
+    GlooAllGather(gloo_wrapper_.get(), send_rows.data(), send_rows.size(),
+                  recv_rows.data());
+    GlooAllGather(gloo_wrapper_.get(), send_values.data(), send_values.size(),
+                  recv_values.data());
+  }
+
+  // 3. Remove the padding. src may be the same as dst, so all the reads of
+  // src must be done before here.
+  dst->set_height(src.height());
+  auto *dst_rows = dst->mutable_rows();
+  dst_rows->resize(total_rows_num);
+  auto *dst_tensor = dst->mutable_value();
+  dims[0] = total_rows_num;
+  dst_tensor->Resize(dims);
+  auto *dst_ptr = reinterpret_cast<uint8_t *>(
+      dst_tensor->mutable_data(platform::CPUPlace(), dtype));
+  int64_t row_offset = 0;
+  for (size_t i = 0; i < nranks; ++i) {
+    std::copy(recv_rows.begin() + i * max_rows_num,
+              recv_rows.begin() + i * max_rows_num + rows_num[i],
+              dst_rows->begin() + row_offset);
+    std::memcpy(dst_ptr + row_offset * row_bytes,
+                recv_values.data() + i * max_rows_num * row_bytes,
+                rows_num[i] * row_bytes);
+    row_offset += rows_num[i];
+  }
+}
+
+void GLOOParallelContext::AllReduceByStream(const framework::Variable &src,
+                                            framework::Variable *dst,
+                                            int ring_id, bool use_calc_stream) {
+  // The ring_id and use_calc_stream are meaningless for gloo, all the
+  // collective communications are done in the calling thread.
+  if (src.IsType<framework::LoDTensor>()) {
+    if (!dst->IsType<framework::LoDTensor>()) {
+      dst->Clear();
+    }
+    AllReduce(src.Get<framework::LoDTensor>(),
+              dst->GetMutable<framework::LoDTensor>());
+  } else if (src.IsType<framework::SelectedRows>()) {
+    if (&src != dst && !dst->IsType<framework::SelectedRows>()) {
+      dst->Clear();
+    }
+    AllReduce(src.Get<framework::SelectedRows>(),
+              dst->GetMutable<framework::SelectedRows>());
+  } else {
+    PADDLE_THROW(platform::errors::InvalidArgument(
+        "Unsupported variable type %s for imperative allreduce, only "
+        "LoDTensor and SelectedRows are supported.",
+        platform::demangle(framework::ToTypeName(src.Type()))));
+  }
+}
+
+paddle::platform::DeviceContext *GLOOParallelContext::GetDeviceContext(
+    int ring_id) {
+  PADDLE_ENFORCE_NOT_NULL(device_, platform::errors::PreconditionNotMet(
+                                       "GLOOParallelContext is not "
+                                       "initialized, please call Init() "
+                                       "first."));
+  return device_.get();
+}
+
+void GLOOParallelContext::WaitCompute(int ring_id) {
+  // do nothing because cpu don't need sync
+  return;
+}
+
+void GLOOParallelContext::WaitComm(int ring_id) {
+  // do nothing because cpu don't need sync
+  return;
+}
+
+}  //  namespace imperative
+}  //  namespace paddle
+
+#endif
@@ -0,0 +1,77 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#pragma once
+
+#if defined(PADDLE_WITH_GLOO)
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/imperative/parallel_context.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace framework {
+class GlooWrapper;
+class Variable;
+}  // namespace framework
+}  // namespace paddle
+
+namespace paddle {
+namespace imperative {
+
+// The ParallelContext for the multi-CPU data parallel training, all the
+// collective communications are done by its own GlooWrapper, which is apart
+// from the global one of platform::GlooParallelContext. Gloo ops are
+// synchronous, the Reducer runs them on its own comm thread to overlap with
+// the backward computation. The iface, the prefix and the timeouts of gloo are
+// set by PADDLE_GLOO_IFACE, PADDLE_GLOO_PREFIX,
+// PADDLE_GLOO_INIT_TIMEOUT_SECONDS and PADDLE_GLOO_RUN_TIMEOUT_SECONDS.
+class GLOOParallelContext : public ParallelContext {
+ public:
+  explicit GLOOParallelContext(const ParallelStrategy& strategy,
+                               const platform::Place& place)
+      : ParallelContext(strategy, place) {}
+
+  ~GLOOParallelContext() override = default;
+
+  void Init() override;
+
+  void AllReduceByStream(const framework::Variable& src,
+                         framework::Variable* dst, int ring_id,
+                         bool use_calc_stream) override;
+
+  paddle::platform::DeviceContext* GetDeviceContext(int ring_id) override;
+
+  void WaitCompute(int ring_id) override;
+
+  void WaitComm(int ring_id) override;
+
+ private:
+  void AllReduce(const framework::Tensor& src, framework::Tensor* dst);
+
+  void AllReduce(const framework::SelectedRows& src,
+                 framework::SelectedRows* dst);
+
+ private:
+  std::unique_ptr<platform::CPUDeviceContext> device_;
+  std::shared_ptr<framework::GlooWrapper> gloo_wrapper_;
+};
+
+}  //  namespace imperative
+}  //  namespace paddle
+
+#endif
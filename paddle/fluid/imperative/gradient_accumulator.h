@@ -15,6 +15,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>  // NOLINT
 #include <utility>
 #include <vector>
 
@@ -93,6 +94,9 @@ class GradientAccumulator {
 
   inline bool HasInnerVar() const { return inner_var_ != nullptr; }
 
+  // Guard SumGrad and AccumulateGrad when grad ops run in multiple threads.
+  std::mutex& Mutex() { return mutex_; }
+
   /* Hook related methods */
   inline bool HasPostHooks() const { return !post_hooks_.expired(); }
 
@@ -138,6 +142,7 @@ class GradientAccumulator {
   size_t ref_cnt_{0};
   size_t cur_cnt_{0};
   std::weak_ptr<LeafVarHookPipeline> post_hooks_;
+  std::mutex mutex_;
 };
 
 class EagerGradientAccumulator : public GradientAccumulator {
@@ -0,0 +1,277 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/imperative/jit/lazy_executor.h"
+
+#include <tuple>
+#include <utility>
+
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+#include "paddle/fluid/imperative/jit/program_desc_tracer.h"
+#include "paddle/fluid/platform/profiler.h"
+
+namespace paddle {
+namespace imperative {
+namespace jit {
+
+static constexpr char kLazyFeedPrefix[] = "lazy_feed_";
+static constexpr char kLazyFetchPrefix[] = "lazy_fetch_";
+static constexpr char kLazyTmpPrefix[] = "lazy_tmp_";
+static constexpr char kLazyFetchHolder[] = "lazy_fetch_holder";
+
+// The fuse passes applied to each flushed segment. They only rewrite the
+// graph and do not need a parameter scope.
+static const std::vector<std::string> kLazyFusePasses = {
+    "fc_fuse_pass", "fuse_elewise_add_act_pass"};
+
+LazyExecutor::LazyExecutor() : executor_(platform::CPUPlace()) {}
+
+LazyExecutor::~LazyExecutor() = default;
+
+bool LazyExecutor::CanDefer(const NameVarBaseMap& ins,
+                            const NameVarBaseMap& outs,
+                            const platform::Place& place) const {
+  if (!platform::is_cpu_place(place)) {
+    return false;
+  }
+
+  std::unordered_set<VarBase*> in_vars;
+  for (auto& pair : ins) {
+    for (auto& var : pair.second) {
+      if (var == nullptr) {
+        return false;
+      }
+      in_vars.insert(var.get());
+      if (pending_vars_.count(var.get()) > 0) {
+        continue;
+      }
+      // ProgramDescTracer only supports the initialized LoDTensor inputs.
+      if (!var->Var().IsInitialized() ||
+          !var->Var().IsType<framework::LoDTensor>()) {
+        return false;
+      }
+    }
+  }
+
+  for (auto& pair : outs) {
+    for (auto& var : pair.second) {
+      if (var == nullptr || var->Persistable() || in_vars.count(var.get()) ||
+          pending_vars_.count(var.get())) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void LazyExecutor::Record(const std::string& type, const NameVarBaseMap& ins,
+                          const NameVarBaseMap& outs,
+                          const framework::AttributeMap& attrs) {
+  VLOG(5) << "Defer op " << type << " in lazy mode";
+  for (auto* var_map : {&ins, &outs}) {
+    for (auto& pair : *var_map) {
+      for (auto& var : pair.second) {
+        pending_vars_.insert(var.get());
+      }
+    }
+  }
+  pending_ops_.emplace_back(PendingOp{type, ins, outs, attrs});
+}
+
+std::unique_ptr<LazyExecutor::CompiledProgram> LazyExecutor::Compile(
+    const framework::ProgramDesc& traced_program,
+    const std::vector<std::string>& feed_names,
+    const std::vector<std::string>& fetch_names) const {
+  platform::RecordEvent record_event("LazyExecutor::Compile");
+  framework::ProgramDesc program(traced_program);
+  auto* block = program.MutableBlock(0);
+
+  // NOTE: The fetch ops are only used to keep the fetched vars from being
+  // fused as intermediate vars, they are removed before execution.
+  auto* holder = block->Var(kLazyFetchHolder);
+  holder->SetType(framework::proto::VarType::FETCH_LIST);
+  holder->SetPersistable(true);
+  for (size_t i = 0; i < fetch_names.size(); ++i) {
+    auto* fetch_op = block->AppendOp();
+    fetch_op->SetType("fetch");
+    fetch_op->SetInput("X", {fetch_names[i]});
+    fetch_op->SetOutput("Out", {kLazyFetchHolder});
+    fetch_op->SetAttr("col", static_cast<int>(i));
+  }
+  program.Flush();
+
+  std::unique_ptr<framework::ir::Graph> graph(
+      new framework::ir::Graph(program));
+  for (auto& pass_name : kLazyFusePasses) {
+    auto pass = framework::ir::PassRegistry::Instance().Get(pass_name);
+    if (pass_name == "fc_fuse_pass") {
+      pass->Set("use_gpu", new bool(false));
+      pass->Set("use_fc_padding", new bool(false));
+    }
+    VLOG(4) << "Apply " << pass_name << " to lazy segment";
+    graph.reset(pass->Apply(graph.release()));
+  }
+
+  std::unique_ptr<CompiledProgram> compiled(new CompiledProgram());
+  compiled->program.reset(new framework::ProgramDesc());
+  auto graph_to_program_pass =
+      framework::ir::PassRegistry::Instance().Get("graph_to_program_pass");
+  graph_to_program_pass->SetNotOwned<framework::ProgramDesc>(
+      "program", compiled->program.get());
+  graph_to_program_pass->Apply(graph.get());
+
+  auto* optimized_block = compiled->program->MutableBlock(0);
+  for (int i = static_cast<int>(optimized_block->OpSize()) - 1; i >= 0; --i) {
+    if (optimized_block->Op(i)->Type() == "fetch") {
+      optimized_block->RemoveOp(i, i + 1);
+    }
+  }
+  optimized_block->RemoveVar(kLazyFetchHolder);
+  compiled->program->Flush();
+
+  VLOG(3) << "Compile lazy segment with " << traced_program.Block(0).OpSize()
+          << " ops into " << optimized_block->OpSize() << " ops";
+
+  std::vector<std::string> skip_vars(feed_names);
+  skip_vars.insert(skip_vars.end(), fetch_names.begin(), fetch_names.end());
+  compiled->ctx =
+      framework::Executor::Prepare(*compiled->program, 0, skip_vars);
+  return compiled;
+}
+
+void LazyExecutor::Flush() {
+  if (pending_ops_.empty()) {
+    return;
+  }
+  platform::RecordEvent record_event("LazyExecutor::Flush");
+
+  auto ops = std::move(pending_ops_);
+  pending_ops_.clear();
+  pending_vars_.clear();
+
+  // The references of each var held by the segment itself. An output var
+  // which is referenced by others is still alive outside the segment and
+  // should be fetched, the others are intermediate vars.
+  std::unordered_map<VarBase*, size_t> segment_ref_cnts;
+  std::unordered_set<VarBase*> produced_vars;
+  for (auto& op : ops) {
+    for (auto* var_map : {&op.ins, &op.outs}) {
+      for (auto& pair : *var_map) {
+        for (auto& var : pair.second) {
+          ++segment_ref_cnts[var.get()];
+        }
+      }
+    }
+    for (auto& pair : op.outs) {
+      for (auto& var : pair.second) {
+        produced_vars.insert(var.get());
+      }
+    }
+  }
+
+  std::vector<VarBase*> alive_outs;
+  std::unordered_set<VarBase*> visited;
+  for (auto& op : ops) {
+    for (auto& pair : op.outs) {
+      for (auto& var : pair.second) {
+        if (static_cast<size_t>(var.use_count()) >
+                segment_ref_cnts[var.get()] &&
+            visited.insert(var.get()).second) {
+          alive_outs.emplace_back(var.get());
+        }
+      }
+    }
+  }
+
+  std::vector<std::shared_ptr<VarBase>> feed_vars;
+  std::vector<std::shared_ptr<VarBase>> fetch_vars;
+  std::unordered_set<VarBase*> alive_out_set(alive_outs.begin(),
+                                             alive_outs.end());
+  visited.clear();
+  ProgramDescTracer tracer;
+  for (auto& op : ops) {
+    for (auto& pair : op.ins) {
+      for (auto& var : pair.second) {
+        if (!var->Persistable() && produced_vars.count(var.get()) == 0 &&
+            visited.insert(var.get()).second) {
+          feed_vars.emplace_back(var);
+        }
+      }
+    }
+    for (auto& pair : op.outs) {
+      for (auto& var : pair.second) {
+        if (alive_out_set.erase(var.get()) > 0) {
+          fetch_vars.emplace_back(var);
+        }
+      }
+    }
+    tracer.InsertOp(op.type, op.ins, op.outs, op.attrs);
+  }
+
+  auto traced = tracer.CreateProgramDesc(feed_vars, kLazyFeedPrefix,
+                                         fetch_vars, kLazyFetchPrefix,
+                                         kLazyTmpPrefix);
+  auto& traced_program = std::get<0>(traced);
+  auto& feed_names = std::get<1>(traced);
+  auto& fetch_names = std::get<2>(traced);
+  auto& persistable_vars = std::get<3>(traced);
+
+  auto key = traced_program->Proto()->SerializeAsString();
+  auto iter = programs_.find(key);
+  if (iter == programs_.end()) {
+    VLOG(3) << "Cache miss of lazy segment with " << ops.size() << " ops";
+    iter = programs_
+               .emplace(std::move(key),
+                        Compile(*traced_program, feed_names, fetch_names))
+               .first;
+  }
+  auto& compiled = iter->second;
+
+  auto& run_scope = scope_.NewScope();
+  for (size_t i = 0; i < feed_vars.size(); ++i) {
+    *run_scope.Var(feed_names[i])->GetMutable<framework::LoDTensor>() =
+        feed_vars[i]->Var().Get<framework::LoDTensor>();
+  }
+  for (auto& var : persistable_vars) {
+    *run_scope.Var(var->Name())->GetMutable<framework::LoDTensor>() =
+        var->Var().Get<framework::LoDTensor>();
+  }
+
+  executor_.RunPreparedContext(compiled->ctx.get(), &run_scope,
+                               /*create_local_scope=*/false,
+                               /*create_vars=*/true, /*keep_kids=*/false);
+
+  for (size_t i = 0; i < fetch_vars.size(); ++i) {
+    auto* src = run_scope.FindVar(fetch_names[i]);
+    PADDLE_ENFORCE_NOT_NULL(
+        src, platform::errors::NotFound(
+                 "The output %s of lazy segment is not found in scope.",
+                 fetch_vars[i]->Name()));
+    // The run scope is dropped after flushing, so move the result out.
+    *fetch_vars[i]->MutableVar() = std::move(*src);
+    if (fetch_vars[i]->Var().IsType<framework::SelectedRows>()) {
+      fetch_vars[i]->SetType(framework::proto::VarType::SELECTED_ROWS);
+    }
+  }
+  scope_.DeleteScope(&run_scope);
+}
+
+}  // namespace jit
+}  // namespace imperative
+}  // namespace paddle
+
+USE_PASS(fc_fuse_pass);
+USE_PASS(fuse_elewise_add_act_pass);
+USE_PASS(graph_to_program_pass);
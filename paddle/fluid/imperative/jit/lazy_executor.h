@@ -0,0 +1,95 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/imperative/layer.h"
+#include "paddle/fluid/imperative/type_defs.h"
+#include "paddle/fluid/platform/macros.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace imperative {
+namespace jit {
+
+// LazyExecutor records the ops traced in lazy mode into a pending segment
+// instead of running them eagerly. The segment is flushed when any of its
+// values is observed: it is converted into a ProgramDesc by
+// ProgramDescTracer, optimized by the IR fuse passes and run by a prepared
+// executor. The optimized programs are cached by the serialized traced
+// program, which contains the shapes of all the input vars.
+class LazyExecutor {
+  DISABLE_COPY_AND_ASSIGN(LazyExecutor);
+
+ public:
+  LazyExecutor();
+
+  ~LazyExecutor();
+
+  // Whether the op can be recorded into the pending segment. Only the CPU
+  // ops without inplace outputs are deferred.
+  bool CanDefer(const NameVarBaseMap& ins, const NameVarBaseMap& outs,
+                const platform::Place& place) const;
+
+  void Record(const std::string& type, const NameVarBaseMap& ins,
+              const NameVarBaseMap& outs, const framework::AttributeMap& attrs);
+
+  // Run all the pending ops, and share the results to the output vars.
+  void Flush();
+
+  bool HasPendingOps() const { return !pending_ops_.empty(); }
+
+  size_t PendingOpNum() const { return pending_ops_.size(); }
+
+  size_t CachedProgramNum() const { return programs_.size(); }
+
+ private:
+  struct PendingOp {
+    std::string type;
+    NameVarBaseMap ins;
+    NameVarBaseMap outs;
+    framework::AttributeMap attrs;
+  };
+
+  struct CompiledProgram {
+    std::unique_ptr<framework::ProgramDesc> program;
+    std::unique_ptr<framework::ExecutorPrepareContext> ctx;
+  };
+
+  std::unique_ptr<CompiledProgram> Compile(
+      const framework::ProgramDesc& traced_program,
+      const std::vector<std::string>& feed_names,
+      const std::vector<std::string>& fetch_names) const;
+
+ private:
+  std::vector<PendingOp> pending_ops_;
+  // All the vars read or written by the pending ops.
+  std::unordered_set<VarBase*> pending_vars_;
+  std::unordered_map<std::string, std::unique_ptr<CompiledProgram>> programs_;
+  framework::Scope scope_;
+  framework::Executor executor_;
+};
+
+}  // namespace jit
+}  // namespace imperative
+}  // namespace paddle
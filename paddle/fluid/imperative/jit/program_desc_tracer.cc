@@ -219,6 +219,14 @@ void ProgramDescTracer::InsertVarIfNotExist(
   }
 
   const auto &inner_var = new_var->Var();
+  if (!is_input && !inner_var.IsInitialized()) {
+    // NOTE: The outputs of the ops deferred in lazy mode have not been
+    // computed yet, only the var type and data type are known.
+    VLOG(10) << "Insert uninitialized output var " << new_var->Name();
+    new_var_desc->SetType(new_var->Type());
+    new_var_desc->SetDataType(new_var->DataType());
+    return;
+  }
   PADDLE_ENFORCE_EQ(inner_var.IsInitialized(), true,
                     platform::errors::InvalidArgument(
                         "The variable to insert is not initialized."));
@@ -14,10 +14,14 @@
 
 #pragma once
 
+#include <ThreadPool.h>
+
 #include <algorithm>
+#include <future>  // NOLINT
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
 #include <unordered_map>
@@ -48,7 +52,7 @@ namespace paddle {
 namespace imperative {
 
 #if defined(PADDLE_WITH_NCCL) || defined(PADDLE_WITH_RCCL) || \
-    defined(PADDLE_WITH_XPU_BKCL)
+    defined(PADDLE_WITH_XPU_BKCL) || defined(PADDLE_WITH_GLOO)
 
 template <typename T>
 struct DivNRanksFunctor {
@@ -153,6 +157,8 @@ class Reducer {
 
   void MarkGroupReady(size_t group_index);
 
+  void FusedAllReduceSchedule(int run_order, Group* p_group);
+
   void FinalizeBackward();
 
   std::vector<std::vector<size_t>> RebuildGruops();
@@ -187,6 +193,15 @@ class Reducer {
   bool has_marked_unused_vars_{false};
   bool find_unused_vars_{false};
   bool all_group_ready_{false};
+
+  // The grad hooks may be called by multiple backward threads.
+  std::mutex mutex_;
+
+  // The gloo allreduce is synchronous, so the CPU groups are reduced on a
+  // single comm thread, which keeps the same group order on all ranks and
+  // overlaps the communication with the rest of backward.
+  std::unique_ptr<::ThreadPool> comm_pool_{nullptr};
+  std::vector<std::future<void>> comm_futures_;
 };
 
 std::vector<std::vector<size_t>> AssignGroupBySize(
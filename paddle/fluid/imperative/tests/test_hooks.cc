@@ -30,6 +30,7 @@ namespace framework = paddle::framework;
 namespace memory = paddle::memory;
 
 DECLARE_bool(sort_sum_gradient);
+DECLARE_int32(backward_num_threads);
 
 namespace paddle {
 namespace imperative {
@@ -231,6 +232,77 @@ TEST(TestHooks, TestGradVarLeafBackwardHookWithSortedGradAccmulated) {
   FLAGS_sort_sum_gradient = false;
 }
 
+TEST(TestHooks, TestGradVarLeafBackwardHookWithParallelBackward) {
+  FLAGS_backward_num_threads = 4;
+  GradVarLeafBackwardHookWithGradAccmulatedTest();
+  FLAGS_backward_num_threads = 1;
+}
+
+// Returns the gradients of x, y and z of out = x * y + x * z, computed by the
+// backward with num_threads threads.
+static std::vector<std::vector<float>> ParallelBackwardGrads(int num_threads) {
+  FLAGS_backward_num_threads = num_threads;
+  Tracer tracer;
+  platform::CPUPlace place;
+  std::vector<std::shared_ptr<VarBase>> params;
+  std::vector<std::vector<int64_t>> dims = {{3, 7}, {7, 5}, {7, 5}};
+  std::vector<std::string> names = {"x", "y", "z"};
+  for (size_t i = 0; i < names.size(); ++i) {
+    params.emplace_back(new VarBase(true, names[i]));
+    params[i]->SetOverridedStopGradient(false);
+    auto* tensor = params[i]->MutableVar()->GetMutable<framework::LoDTensor>();
+    tensor->Resize(framework::make_ddim(dims[i]));
+    auto* data = tensor->mutable_data<float>(place);
+    // The values sum differently in another order.
+    for (int64_t j = 0; j < tensor->numel(); ++j) {
+      data[j] = 1.0f / (j * 3 + i + 1) - 0.1f * (j % 7);
+    }
+  }
+  std::shared_ptr<VarBase> out_xy(new VarBase(true, "out_xy"));
+  std::shared_ptr<VarBase> out_xz(new VarBase(true, "out_xz"));
+  std::shared_ptr<VarBase> out(new VarBase(true, "out"));
+  framework::AttributeMap mul_attr_map;
+  mul_attr_map["use_mkldnn"] = false;
+  tracer.TraceOp("mul", {var_pair("X", vb_vector(1, params[0])),
+                         var_pair("Y", vb_vector(1, params[1]))},
+                 {var_pair("Out", vb_vector(1, out_xy))}, mul_attr_map, place,
+                 true);
+  tracer.TraceOp("mul", {var_pair("X", vb_vector(1, params[0])),
+                         var_pair("Y", vb_vector(1, params[2]))},
+                 {var_pair("Out", vb_vector(1, out_xz))}, mul_attr_map, place,
+                 true);
+  framework::AttributeMap add_attr_map;
+  tracer.TraceOp("elementwise_add", {var_pair("X", vb_vector(1, out_xy)),
+                                     var_pair("Y", vb_vector(1, out_xz))},
+                 {var_pair("Out", vb_vector(1, out))}, add_attr_map, place,
+                 true);
+
+  BasicEngine engine;
+  engine.Init(out.get());
+  engine.Execute();
+  FLAGS_backward_num_threads = 1;
+
+  std::vector<std::vector<float>> grads;
+  for (auto& param : params) {
+    auto& grad = param->GradVar().Get<framework::LoDTensor>();
+    grads.emplace_back(grad.data<float>(), grad.data<float>() + grad.numel());
+  }
+  return grads;
+}
+
+TEST(TestHooks, TestParallelBackwardSameAsSerial) {
+  auto expected = ParallelBackwardGrads(1);
+  // The pool is recreated when the number of threads changes.
+  for (int num_threads : {4, 2, 4}) {
+    auto grads = ParallelBackwardGrads(num_threads);
+    ASSERT_EQ(grads.size(), expected.size());
+    for (size_t i = 0; i < grads.size(); ++i) {
+      ASSERT_EQ(grads[i], expected[i]) << "with " << num_threads
+                                       << " threads";
+    }
+  }
+}
+
 }  // namespace imperative
 }  // namespace paddle
 
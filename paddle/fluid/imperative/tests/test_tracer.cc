@@ -525,6 +525,62 @@ TEST(test_tracer, test_var_op_destruction) {
 #endif
 }
 
+TEST(test_tracer, test_lazy_mode) {
+  imperative::Tracer tracer;
+  tracer.SetEnableLazyMode(true);
+  platform::CPUPlace place;
+  std::vector<float> src_data(10, 2.0);
+  std::vector<int64_t> dims = {2, 5};
+
+  std::shared_ptr<imperative::VarBase> x_in(
+      new imperative::VarBase(true, "x_in"));
+  std::shared_ptr<imperative::VarBase> y_in(
+      new imperative::VarBase(true, "y_in"));
+  x_in->SetOverridedStopGradient(true);
+  y_in->SetOverridedStopGradient(true);
+  for (auto& var : {x_in, y_in}) {
+    auto* tensor = var->MutableVar()->GetMutable<framework::LoDTensor>();
+    tensor->Resize(framework::make_ddim(dims));
+    auto* mutable_data = tensor->mutable_data<float>(place);
+    paddle::memory::Copy(place, mutable_data, place, src_data.data(),
+                         sizeof(float) * src_data.size());
+  }
+
+  framework::AttributeMap attr_map;
+  for (int i = 0; i < 2; ++i) {
+    std::shared_ptr<imperative::VarBase> tmp(
+        new imperative::VarBase(true, "tmp"));
+    std::shared_ptr<imperative::VarBase> vout(
+        new imperative::VarBase(true, "vout"));
+    imperative::NameVarBaseMap add_ins = {var_pair("X", vb_vector(1, x_in)),
+                                          var_pair("Y", vb_vector(1, y_in))};
+    imperative::NameVarBaseMap add_outs = {var_pair("Out", vb_vector(1, tmp))};
+    tracer.TraceOp("elementwise_add", add_ins, add_outs, attr_map, place,
+                   true);
+    imperative::NameVarBaseMap add2_ins = {var_pair("X", vb_vector(1, tmp)),
+                                           var_pair("Y", vb_vector(1, y_in))};
+    imperative::NameVarBaseMap add2_outs = {
+        var_pair("Out", vb_vector(1, vout))};
+    tracer.TraceOp("elementwise_add", add2_ins, add2_outs, attr_map, place,
+                   true);
+
+    ASSERT_EQ(tracer.GetLazyExecutor()->PendingOpNum(), 2UL);
+    ASSERT_FALSE(vout->Var().IsInitialized());
+
+    tracer.FlushLazyOps();
+    ASSERT_FALSE(tracer.GetLazyExecutor()->HasPendingOps());
+    // The program is compiled once and reused by the same shapes.
+    ASSERT_EQ(tracer.GetLazyExecutor()->CachedProgramNum(), 1UL);
+
+    const auto& out_tensor = vout->Var().Get<framework::LoDTensor>();
+    ASSERT_EQ(out_tensor.numel(), 10);
+    for (int j = 0; j < out_tensor.numel(); j++) {
+      ASSERT_EQ(out_tensor.data<float>()[j], 6.0);
+    }
+  }
+  tracer.SetEnableLazyMode(false);
+}
+
 }  // namespace imperative
 }  // namespace paddle
 
@@ -29,6 +29,10 @@ DECLARE_string(tracer_mkldnn_ops_off);
 namespace paddle {
 namespace imperative {
 
+// The pending segment is flushed when it grows to this size, to bound the
+// lifetime of the intermediate vars held by it.
+static constexpr size_t kMaxLazySegmentOpNum = 1024;
+
 static std::shared_ptr<Tracer> g_current_tracer(nullptr);
 
 const std::shared_ptr<Tracer>& GetCurrentTracer() { return g_current_tracer; }
@@ -161,6 +165,20 @@ void Tracer::TraceOp(const std::string& type, const NameVarBaseMap& ins,
     new_ins = AutoCastInputs(type, ins);
   }
 
+  if (enable_lazy_mode_) {
+    if (!enable_program_desc_tracing_ && inplace_map.empty() &&
+        !ComputeRequiredGrad(new_ins, outs, trace_backward) &&
+        lazy_executor_->CanDefer(new_ins, outs, place)) {
+      lazy_executor_->Record(type, new_ins, outs, attrs);
+      if (lazy_executor_->PendingOpNum() >= kMaxLazySegmentOpNum) {
+        FlushLazyOps();
+      }
+      return;
+    }
+    // The inputs of this op may be produced by the pending ops.
+    FlushLazyOps();
+  }
+
   try {
     if (platform::is_gpu_place(place)) {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
@@ -215,6 +233,13 @@ void Tracer::TraceOp(const std::string& type, const NameVarBaseMap& ins,
           inplace_map);
 }
 
+void Tracer::SetEnableLazyMode(bool enabled) {
+  if (!enabled) {
+    FlushLazyOps();
+  }
+  enable_lazy_mode_ = enabled;
+}
+
 void Tracer::SetExpectedPlace(platform::Place place) {
   expected_place_ = place;
 }
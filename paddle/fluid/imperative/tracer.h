@@ -24,6 +24,7 @@
 #include "ThreadPool.h"
 #include "paddle/fluid/framework/garbage_collector.h"
 #include "paddle/fluid/imperative/basic_engine.h"
+#include "paddle/fluid/imperative/jit/lazy_executor.h"
 #include "paddle/fluid/imperative/jit/program_desc_tracer.h"
 #include "paddle/fluid/imperative/layer.h"
 #include "paddle/fluid/platform/macros.h"
@@ -54,6 +55,7 @@ class Tracer {
   Tracer()
       : basic_engine_(new BasicEngine()),
         program_desc_tracer_(new jit::ProgramDescTracer()),
+        lazy_executor_(new jit::LazyExecutor()),
         generator_(new UniqueNameGenerator()) {
     expected_place_ = platform::CPUPlace();
   }
@@ -84,6 +86,17 @@ class Tracer {
     return program_desc_tracer_.get();
   }
 
+  // In lazy mode, the ops which do not require grad are recorded into a
+  // pending segment, and run when FlushLazyOps is called, i.e., when any
+  // value is observed or an op that cannot be deferred is traced.
+  void SetEnableLazyMode(bool enabled);
+
+  bool IsLazyModeEnabled() const { return enable_lazy_mode_; }
+
+  void FlushLazyOps() { lazy_executor_->Flush(); }
+
+  jit::LazyExecutor* GetLazyExecutor() { return lazy_executor_.get(); }
+
   // Note(Aurelius84): The `tmp` is used as prefix key while naming a temporary
   // intermediate var both in imperative and static mode. But the
   // `UniqueNameGenerator` in C++ and `unique_name.py` in Python doesn't share
@@ -116,6 +129,8 @@ class Tracer {
   std::unique_ptr<BasicEngine> basic_engine_;
   std::unique_ptr<jit::ProgramDescTracer> program_desc_tracer_;
   bool enable_program_desc_tracing_{false};
+  std::unique_ptr<jit::LazyExecutor> lazy_executor_;
+  bool enable_lazy_mode_{false};
   std::unique_ptr<UniqueNameGenerator> generator_;
   platform::Place expected_place_;
   bool has_grad_{true};
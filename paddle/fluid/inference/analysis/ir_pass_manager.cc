@@ -20,10 +20,12 @@
 #include <unordered_set>
 #include <utility>
 #include <vector>
+#include <algorithm>
 #include "paddle/fluid/framework/ir/fuse_pass_base.h"
 #include "paddle/fluid/framework/ir/graph.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/inference/analysis/argument.h"
+#include "paddle/fluid/platform/timer.h"
 #include "paddle/fluid/string/pretty_log.h"
 
 namespace paddle {
@@ -198,11 +200,35 @@ std::unique_ptr<Graph> IRPassManager::Apply(std::unique_ptr<Graph> graph) {
   PADDLE_ENFORCE_NOT_NULL(graph.get(), platform::errors::PreconditionNotMet(
                                            "Graph cannot be NULL."));
   // Apply all the passes
+  std::vector<std::pair<double, std::string>> costs;
+  double total_ms = 0.;
+  platform::Timer timer;
   for (const auto &pass : passes_) {
     if (pass->Type() != "graph_viz_pass" && !disable_logs_) {
       PrettyLogEndl(Style::H2(), "--- Running IR pass [%s]", pass->Type());
     }
+    timer.Start();
     graph.reset(pass->Apply(graph.release()));
+    timer.Pause();
+    double ms = timer.ElapsedMS();
+    VLOG(3) << "IR pass [" << pass->Type() << "] costs " << ms << " ms";
+    costs.emplace_back(ms, pass->Type());
+    total_ms += ms;
+  }
+
+  if (!disable_logs_) {
+    std::sort(costs.begin(), costs.end(),
+              [](const std::pair<double, std::string> &a,
+                 const std::pair<double, std::string> &b) {
+                return a.first > b.first;
+              });
+    PrettyLogEndl(Style::H2(), "--- IR passes cost %.3f ms in total",
+                  total_ms);
+    const size_t kSlowest = 5;
+    for (size_t i = 0; i < std::min(kSlowest, costs.size()); ++i) {
+      PrettyLogEndl(Style::detail(), "    %-40s %10.3f ms",
+                    costs[i].second.c_str(), costs[i].first);
+    }
   }
   return graph;
 }
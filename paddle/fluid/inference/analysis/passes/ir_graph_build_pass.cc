@@ -13,11 +13,18 @@
 // limitations under the License.
 
 #include "paddle/fluid/inference/analysis/passes/ir_graph_build_pass.h"
+#include <sys/stat.h>
+#include <algorithm>
+#include <functional>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <unordered_set>
 #include "paddle/fluid/framework/executor.h"
 #include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/inference/analysis/helper.h"
 #include "paddle/fluid/inference/io.h"
+#include "paddle/fluid/operators/math/disk_embedding_table.h"
 #include "paddle/fluid/platform/enforce.h"
 
 namespace paddle {
@@ -41,22 +48,34 @@ void IrGraphBuildPass::RunImpl(Argument *argument) {
   platform::Place place;
   place = platform::CPUPlace();
 
+  // The embedding tables kept on disk are never loaded into memory.
+  std::unordered_set<std::string> skip_vars;
+  if (argument->disk_embedding_tables_valid()) {
+    for (auto &table : argument->disk_embedding_tables()) {
+      skip_vars.insert(table.first);
+    }
+  }
+
   if (argument->model_dir_valid()) {
-    auto program =
-        LoadModel(argument->model_dir(), argument->scope_ptr(), place);
+    auto program = LoadModel(argument->model_dir(), argument->scope_ptr(),
+                             place, skip_vars);
     argument->SetMainProgram(program.release());
   } else if (argument->model_program_path_valid() &&
              argument->model_params_path_valid()) {
     auto program = LoadModel(
         argument->model_program_path(), argument->model_params_path(),
         argument->scope_ptr(), place,
-        argument->model_from_memory_valid() && argument->model_from_memory());
+        argument->model_from_memory_valid() && argument->model_from_memory(),
+        skip_vars);
     argument->SetMainProgram(program.release());
   } else {
     PADDLE_THROW(platform::errors::PreconditionNotMet(
         "either model_dir or (program path and parameter path) should be "
         "set."));
   }
+  if (!skip_vars.empty()) {
+    PrepareDiskEmbeddingTables(argument);
+  }
 
   auto graph = std::unique_ptr<Graph>(new Graph(argument->main_program()));
   argument->SetMainGraph(graph.release());
@@ -69,20 +88,136 @@ void IrGraphBuildPass::RunImpl(Argument *argument) {
 
 std::unique_ptr<framework::ProgramDesc> IrGraphBuildPass::LoadModel(
     const std::string &path, framework::Scope *scope,
-    const platform::Place &place) {
+    const platform::Place &place,
+    const std::unordered_set<std::string> &skip_vars) {
   framework::Executor exe(place);
-  return Load(&exe, scope, path);
+  return Load(&exe, scope, path, skip_vars);
 }
 
 std::unique_ptr<framework::ProgramDesc> IrGraphBuildPass::LoadModel(
     const std::string &program_path, const std::string &params_path,
     framework::Scope *scope, const platform::Place &place,
-    bool model_from_memory) {
+    bool model_from_memory,
+    const std::unordered_set<std::string> &skip_vars) {
   framework::Executor exe(place);
   if (!model_from_memory) {
-    return Load(&exe, scope, program_path, params_path);
+    return Load(&exe, scope, program_path, params_path, skip_vars);
   } else {
-    return LoadFromMemory(&exe, scope, program_path, params_path);
+    return LoadFromMemory(&exe, scope, program_path, params_path, skip_vars);
+  }
+}
+
+// Identifies the parameter file by its path, size and modification time, or
+// returns 0 if it cannot be read.
+static uint64_t ParameterFileSource(const std::string &path) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) return 0;
+  std::ostringstream os;
+  os << path << ":" << st.st_size << ":" << st.st_mtime;
+  return std::max<uint64_t>(std::hash<std::string>()(os.str()), 1);
+}
+
+void IrGraphBuildPass::PrepareDiskEmbeddingTables(Argument *argument) {
+  auto &program = argument->main_program();
+  bool model_from_memory =
+      argument->model_from_memory_valid() && argument->model_from_memory();
+  for (auto &item : argument->disk_embedding_tables()) {
+    const std::string &name = item.first;
+    const auto &config = item.second;
+    auto *var = program.Block(0).FindVar(name);
+    PADDLE_ENFORCE_NOT_NULL(
+        var, platform::errors::NotFound(
+                 "The disk embedding table %s is not a variable of the "
+                 "program.",
+                 name));
+    if (!PathExists(config.dir)) {
+      PADDLE_ENFORCE_NE(MKDIR(config.dir.c_str()), -1,
+                        platform::errors::PreconditionNotMet(
+                            "Can not create the directory %s of the disk "
+                            "embedding table %s.",
+                            config.dir, name));
+    }
+    // The table is rebuilt when the parameter file has changed since it was
+    // built, which is unknown for the model loaded from memory.
+    uint64_t source = 0;
+    if (!model_from_memory) {
+      source = ParameterFileSource(argument->model_dir_valid()
+                                       ? argument->model_dir() + "/" + name
+                                       : argument->model_params_path());
+    }
+    uint64_t built_source = 0;
+    if (!operators::math::DiskEmbeddingTable::Exists(config.dir,
+                                                     &built_source) ||
+        (source != 0 && built_source != source)) {
+      PADDLE_ENFORCE_EQ(
+          model_from_memory, false,
+          platform::errors::PreconditionNotMet(
+              "The disk embedding table %s should be built in %s "
+              "before loading the model from memory.",
+              name, config.dir));
+      LOG(INFO) << "Build the disk embedding table " << name << " in "
+                << config.dir;
+      if (argument->model_dir_valid()) {
+        BuildDiskEmbeddingTable(program, argument->model_dir(), "", name,
+                                config.dir, config.num_shards, source);
+      } else {
+        BuildDiskEmbeddingTable(program, "", argument->model_params_path(),
+                                name, config.dir, config.num_shards, source);
+      }
+      operators::math::DiskEmbeddingTables::Instance().Remove(config.dir);
+    }
+    auto table = operators::math::DiskEmbeddingTables::Instance().Get(
+        config.dir, config.cache_rows);
+    auto dims = var->GetShape();
+    int64_t width = 1;
+    for (size_t i = 1; i < dims.size(); ++i) width *= dims[i];
+    PADDLE_ENFORCE_EQ(
+        dims.size() >= 2 && table->height() == dims[0] &&
+            table->width() == width && table->type() == var->GetDataType(),
+        true,
+        platform::errors::PreconditionNotMet(
+            "The disk embedding table in %s of [%d, %d] and %s does not "
+            "match the variable %s of %s and %s. Please remove the table "
+            "to build it again.",
+            config.dir, table->height(), table->width(),
+            framework::DataTypeToString(table->type()), name,
+            framework::make_ddim(dims),
+            framework::DataTypeToString(var->GetDataType())));
+
+    bool used = false;
+    for (size_t i = 0; i < program.Size(); ++i) {
+      auto *block = program.MutableBlock(i);
+      for (auto *op : block->AllOps()) {
+        if ((op->Type() != "lookup_table" &&
+             op->Type() != "lookup_table_v2") ||
+            op->Input("W") != std::vector<std::string>{name}) {
+          continue;
+        }
+        framework::AttributeMap attrs;
+        attrs["table_dir"] = config.dir;
+        attrs["cache_rows"] = config.cache_rows;
+        attrs["width"] = table->width();
+        attrs["dtype"] = static_cast<int>(table->type());
+        attrs["squeeze_ids"] = op->Type() == "lookup_table";
+        attrs["padding_idx"] =
+            op->HasAttr("padding_idx")
+                ? BOOST_GET_CONST(int64_t, op->GetAttr("padding_idx"))
+                : static_cast<int64_t>(-1);
+        framework::OpDesc disk_op("lookup_table_disk",
+                                  {{"Ids", op->Input("Ids")}},
+                                  {{"Out", op->Output("Out")}}, attrs);
+        op->CopyFrom(disk_op);
+        used = true;
+      }
+      block->RemoveVar(name);
+    }
+    PADDLE_ENFORCE_EQ(used, true,
+                      platform::errors::NotFound(
+                          "The disk embedding table %s is not the table of "
+                          "any lookup_table op.",
+                          name));
+    VLOG(3) << "Look up " << name << " from the disk embedding table in "
+            << config.dir;
   }
 }
 
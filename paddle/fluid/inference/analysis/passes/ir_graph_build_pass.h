@@ -15,6 +15,7 @@
 #pragma once
 
 #include <string>
+#include <unordered_set>
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/inference/analysis/analysis_pass.h"
 #include "paddle/fluid/platform/place.h"
@@ -35,11 +36,16 @@ class IrGraphBuildPass : public AnalysisPass {
  private:
   std::unique_ptr<framework::ProgramDesc> LoadModel(
       const std::string &path, framework::Scope *scope,
-      const platform::Place &place);
+      const platform::Place &place,
+      const std::unordered_set<std::string> &skip_vars);
   std::unique_ptr<framework::ProgramDesc> LoadModel(
       const std::string &program_path, const std::string &params_path,
       framework::Scope *scope, const platform::Place &place,
-      bool model_from_memory);
+      bool model_from_memory,
+      const std::unordered_set<std::string> &skip_vars);
+  // Build the disk embedding tables missing on disk, and replace the lookups
+  // of them with the lookup_table_disk ops.
+  void PrepareDiskEmbeddingTables(Argument *argument);
 
   std::string model_binary_str_;
 };
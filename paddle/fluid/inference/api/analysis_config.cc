@@ -110,6 +110,7 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
                                   // params_file_ fields.
 
   CP_MEMBER(opt_cache_dir_);
+  CP_MEMBER(use_optim_program_cache_);
   CP_MEMBER(prog_file_);
   CP_MEMBER(params_file_);
 
@@ -122,6 +123,9 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(memory_pool_init_size_mb_);
 
   CP_MEMBER(enable_memory_optim_);
+  CP_MEMBER(shape_plan_cache_capacity_);
+  CP_MEMBER(params_hot_swap_);
+  CP_MEMBER(disk_embedding_tables_);
   // TensorRT related.
   CP_MEMBER(use_tensorrt_);
   CP_MEMBER(tensorrt_workspace_size_);
@@ -171,6 +175,8 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(specify_input_name_);
 
   CP_MEMBER(cpu_math_library_num_threads_);
+  CP_MEMBER(cpu_core_binding_);
+  CP_MEMBER(cpu_bind_cores_);
 
   CP_MEMBER(serialized_info_cache_);
 
@@ -486,6 +492,13 @@ std::string AnalysisConfig::SerializeInfoCache() {
   ss << trt_dla_core_;
 
   ss << enable_memory_optim_;
+  ss << use_optim_program_cache_;
+  ss << shape_plan_cache_capacity_;
+  ss << params_hot_swap_;
+  for (auto &table : disk_embedding_tables_) {
+    ss << table.first << table.second.dir << table.second.cache_rows
+       << table.second.num_shards;
+  }
 
   ss << use_mkldnn_;
   ss << mkldnn_cache_capacity_;
@@ -508,6 +521,8 @@ std::string AnalysisConfig::SerializeInfoCache() {
 
   ss << specify_input_name_;
   ss << cpu_math_library_num_threads_;
+  ss << cpu_core_binding_;
+  for (int core : cpu_bind_cores_) ss << core;
 
   ss << use_lite_;
   ss << use_xpu_;
@@ -525,6 +540,13 @@ void AnalysisConfig::SetCpuMathLibraryNumThreads(
   Update();
 }
 
+void AnalysisConfig::EnableCpuCoreBinding(const std::vector<int> &cores) {
+  cpu_core_binding_ = true;
+  cpu_bind_cores_ = cores;
+
+  Update();
+}
+
 float AnalysisConfig::fraction_of_gpu_memory_for_pool() const {
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   // Get the GPU memory details and calculate the fraction of memory for the
@@ -554,6 +576,26 @@ bool AnalysisConfig::enable_memory_optim() const {
   return enable_memory_optim_;
 }
 
+void AnalysisConfig::SetDiskEmbeddingTable(const std::string &param_name,
+                                           const std::string &table_dir,
+                                           int64_t cache_rows,
+                                           int num_shards) {
+  PADDLE_ENFORCE_EQ(
+      table_dir.empty(), false,
+      platform::errors::InvalidArgument(
+          "The directory of the embedding table %s should not be empty.",
+          param_name));
+  PADDLE_ENFORCE_GT(num_shards, 0,
+                    platform::errors::InvalidArgument(
+                        "The number of the shards of the embedding table %s "
+                        "should be greater than 0, but got %d.",
+                        param_name, num_shards));
+  auto &table = disk_embedding_tables_[param_name];
+  table.dir = table_dir;
+  table.cache_rows = cache_rows;
+  table.num_shards = num_shards;
+}
+
 void AnalysisConfig::SetModelBuffer(const char *prog_buffer,
                                     size_t prog_buffer_size,
                                     const char *param_buffer,
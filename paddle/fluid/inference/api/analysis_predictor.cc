@@ -14,19 +14,26 @@
 
 #include "paddle/fluid/inference/api/analysis_predictor.h"
 #include <glog/logging.h>
+#include <xxhash.h>
 #include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <memory>
 #include <set>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
+#include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/feed_fetch_method.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
 #include "paddle/fluid/framework/ir/fuse_pass_base.h"
 #include "paddle/fluid/framework/ir/pass.h"
 #include "paddle/fluid/framework/naive_executor.h"
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/framework/var_type_traits.h"
 #include "paddle/fluid/framework/version.h"
 #include "paddle/fluid/inference/analysis/helper.h"
@@ -36,6 +43,7 @@
 #include "paddle/fluid/inference/utils/singleton.h"
 #include "paddle/fluid/memory/memcpy.h"
 #include "paddle/fluid/platform/cpu_helper.h"
+#include "paddle/fluid/platform/cpu_topology.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/gpu_info.h"
 #include "paddle/fluid/platform/place.h"
@@ -155,8 +163,13 @@ bool AnalysisPredictor::Init(
                  "generated.";
   }
 
+  // The weights are loaded by the bound thread, so that they are first
+  // touched on the NUMA node of the cores.
+  ReserveCpuCores();
+  platform::ScopedCpuBinding cpu_binding(cpu_bind_cores_);
+
   // no matter with or without MKLDNN
-  paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  SetMathLibraryNumThreads(config_.cpu_math_library_num_threads());
 
   if (!PrepareScope(parent_scope)) {
     return false;
@@ -176,6 +189,47 @@ bool AnalysisPredictor::Init(
   // Get the feed_target_names and fetch_target_names
   PrepareFeedFetch();
 
+  InitParamVersions();
+  return true;
+}
+
+bool AnalysisPredictor::InitFromPrototype(
+    const AnalysisPredictor &prototype) {
+  VLOG(3) << "Predictor::InitFromPrototype()";
+  if (config_.with_profile_) {
+    auto tracking_device = config_.use_gpu() ? platform::ProfilerState::kAll
+                                             : platform::ProfilerState::kCPU;
+    platform::EnableProfiler(tracking_device);
+  }
+
+  ReserveCpuCores();
+  platform::ScopedCpuBinding cpu_binding(cpu_bind_cores_);
+  SetMathLibraryNumThreads(config_.cpu_math_library_num_threads());
+
+  if (!PrepareScope(prototype.scope_)) {
+    return false;
+  }
+  if (!CreateExecutor()) {
+    return false;
+  }
+  inference_program_ = prototype.inference_program_;
+  prepared_block_ = prototype.prepared_block_;
+  executor_->Prepare(sub_scope_, *prepared_block_);
+  if (config_.shape_plan_cache_capacity() > 0) {
+    executor_->EnableShapePlanCache(config_.shape_plan_cache_capacity());
+  }
+
+  CreateFeedFetchVar(sub_scope_);
+  feeds_ = prototype.feeds_;
+  feed_names_ = prototype.feed_names_;
+  idx2feeds_ = prototype.idx2feeds_;
+  fetches_ = prototype.fetches_;
+  idx2fetches_ = prototype.idx2fetches_;
+
+  packed_gemm_weights_ = prototype.packed_gemm_weights_;
+  gemm_weight_col_dims_ = prototype.gemm_weight_col_dims_;
+  param_versions_ = prototype.param_versions_;
+  if (param_versions_ != nullptr) ShadowParams();
   return true;
 }
 
@@ -222,12 +276,18 @@ bool AnalysisPredictor::PrepareProgram(
     // If config_.ir_optim() is False, parameters is loaded in LoadParameters(),
     // still need to create other persistable variables.
     // So in both case, create persistable variables at first.
-    executor_->CreateVariables(*inference_program_, 0, true, sub_scope_);
-
-    // if enable_ir_optim_ is false,
-    // the analysis pass(op fuse, graph analysis, trt subgraph, mkldnn etc) will
-    // not be executed.
-    OptimizeInferenceProgram();
+    // If the optimized program is in the cache, the passes are skipped.
+    optim_program_cache_dir_ = GetOptimProgramCacheDir();
+    if (!LoadOptimProgramCache()) {
+      executor_->CreateVariables(*inference_program_, 0, true, sub_scope_);
+
+      // if enable_ir_optim_ is false,
+      // the analysis pass(op fuse, graph analysis, trt subgraph, mkldnn etc)
+      // will not be executed.
+      OptimizeInferenceProgram();
+      SaveOptimProgramCache();
+    }
+    PackGemmWeights();
   } else {
     // If the program is passed from external, no need to optimize it, this
     // logic is used in the clone scenario.
@@ -283,9 +343,473 @@ bool AnalysisPredictor::CreateExecutor() {
   executor_.reset(new paddle::framework::NaiveExecutor(place_));
   return true;
 }
+void AnalysisPredictor::PackGemmWeights() {
+  if (!platform::is_cpu_place(place_)) return;
+  auto &block = inference_program_->Block(0);
+  for (auto *op : block.AllOps()) {
+    std::string weight_name;
+    int num_col_dims = 1;
+    if (op->Type() == "fc") {
+      // The padded weights are not [K, N] matrices.
+      if (op->HasAttr("padding_weights") &&
+          BOOST_GET_CONST(bool, op->GetAttr("padding_weights"))) {
+        continue;
+      }
+      weight_name = op->Input("W")[0];
+    } else if (op->Type() == "mul") {
+      weight_name = op->Input("Y")[0];
+      num_col_dims = BOOST_GET_CONST(int, op->GetAttr("y_num_col_dims"));
+    } else {
+      continue;
+    }
+    if (op->HasAttr("use_mkldnn") &&
+        BOOST_GET_CONST(bool, op->GetAttr("use_mkldnn"))) {
+      continue;
+    }
+    auto *var_desc = block.FindVar(weight_name);
+    auto *var = sub_scope_->FindVar(weight_name);
+    if (var_desc == nullptr || !var_desc->Persistable() || var == nullptr ||
+        !var->IsType<framework::LoDTensor>()) {
+      continue;
+    }
+    auto packed =
+        PackGemmWeight(var->Get<framework::LoDTensor>(), num_col_dims);
+    if (packed != nullptr) {
+      packed_gemm_weights_[weight_name] = packed;
+      gemm_weight_col_dims_[weight_name] = num_col_dims;
+    }
+  }
+  VLOG(3) << "Packed " << packed_gemm_weights_.size()
+          << " weights of fc and mul.";
+}
+
+std::shared_ptr<operators::math::PackedGemmWeight>
+AnalysisPredictor::PackGemmWeight(const framework::LoDTensor &weight,
+                                  int num_col_dims) {
+  if (!platform::is_cpu_place(place_) || !weight.IsInitialized() ||
+      weight.dims().size() < 2 || num_col_dims >= weight.dims().size()) {
+    return nullptr;
+  }
+  auto dims = framework::flatten_to_2d(weight.dims(), num_col_dims);
+  auto &cache = operators::math::PackedGemmWeightCache::Instance();
+  if (weight.type() == framework::proto::VarType::FP32) {
+    return cache.Pack<float>(weight, dims[0], dims[1]);
+  } else if (weight.type() == framework::proto::VarType::FP64) {
+    return cache.Pack<double>(weight, dims[0], dims[1]);
+  }
+  return nullptr;
+}
+
+void AnalysisPredictor::InitParamVersions() {
+  // The predictors initialized in the scope of another one do not share its
+  // versions, only the ones created by Clone do.
+  if (!config_.params_hot_swap_enabled() || status_is_cloned_) return;
+  if (config_.tensorrt_engine_enabled() || config_.lite_engine_enabled() ||
+      config_.mkldnn_enabled()) {
+    LOG(WARNING) << "The parameters can not be updated with TensorRT, Lite "
+                    "or MKLDNN, which keep their own copies of the weights.";
+    return;
+  }
+  auto version = std::make_shared<details::ParamVersion>();
+  auto &block = inference_program_->Block(0);
+  for (auto *var_desc : block.AllVars()) {
+    if (!IsPersistable(var_desc)) continue;
+    auto *var = scope_->FindVar(var_desc->Name());
+    if (var == nullptr || !var->IsType<framework::LoDTensor>() ||
+        !var->Get<framework::LoDTensor>().IsInitialized()) {
+      continue;
+    }
+    auto &tensor = var->Get<framework::LoDTensor>();
+    auto shared = std::make_shared<framework::LoDTensor>();
+    shared->ShareDataWith(tensor);
+    shared->set_lod(tensor.lod());
+    version->tensors[var_desc->Name()] = shared;
+  }
+  version->packed.swap(packed_gemm_weights_);
+  VLOG(3) << "The parameters have " << version->tensors.size()
+          << " tensors to update.";
+  param_versions_ = std::make_shared<details::ParamVersions>(version);
+  ShadowParams();
+}
+
+void AnalysisPredictor::ShadowParams() {
+  applied_params_ = param_versions_->Latest();
+  for (auto &pair : applied_params_->tensors) {
+    auto *shadow =
+        sub_scope_->Var(pair.first)->GetMutable<framework::LoDTensor>();
+    shadow->ShareDataWith(*pair.second);
+    shadow->set_lod(pair.second->lod());
+  }
+}
+
+void AnalysisPredictor::SyncParams() {
+  if (param_versions_ == nullptr ||
+      param_versions_->latest_id() == applied_params_->id) {
+    return;
+  }
+  auto latest = param_versions_->Latest();
+  bool dims_changed = false;
+  for (auto &pair : latest->tensors) {
+    auto &applied = applied_params_->tensors.at(pair.first);
+    if (applied == pair.second) continue;
+    auto *shadow = sub_scope_->FindLocalVar(pair.first)
+                       ->GetMutable<framework::LoDTensor>();
+    dims_changed |= shadow->dims() != pair.second->dims();
+    shadow->ShareDataWith(*pair.second);
+    shadow->set_lod(pair.second->lod());
+  }
+  // The cached shapes of the outputs may depend on the dims of the weights.
+  if (dims_changed) executor_->ClearShapePlanCache();
+  applied_params_ = std::move(latest);
+  VLOG(3) << "Predictor " << predictor_id_ << " runs with the parameters of "
+          << "version " << applied_params_->id;
+}
+
+void AnalysisPredictor::PublishParams(
+    std::shared_ptr<details::ParamVersion> version,
+    const std::vector<std::string> &names) {
+  for (auto &name : names) {
+    auto col_dims = gemm_weight_col_dims_.find(name);
+    if (col_dims == gemm_weight_col_dims_.end()) continue;
+    auto packed = PackGemmWeight(*version->tensors.at(name), col_dims->second);
+    if (packed != nullptr) {
+      version->packed[name] = packed;
+    } else {
+      version->packed.erase(name);
+    }
+  }
+  // The persistable variables are only read by the utilities such as
+  // SaveOptimModel, the runs read the shadows.
+  for (auto &name : names) {
+    auto &tensor = version->tensors.at(name);
+    auto *var = scope_->FindVar(name)->GetMutable<framework::LoDTensor>();
+    var->ShareDataWith(*tensor);
+    var->set_lod(tensor->lod());
+  }
+  param_versions_->Publish(std::move(version));
+}
+
+bool AnalysisPredictor::UpdateParams(const std::vector<PaddleTensor> &params) {
+  if (param_versions_ == nullptr) {
+    LOG(ERROR) << "The parameters can not be updated, please enable it by "
+                  "AnalysisConfig::EnableParamsHotSwap.";
+    return false;
+  }
+  auto lock = param_versions_->LockWriter();
+  auto version =
+      std::make_shared<details::ParamVersion>(*param_versions_->Latest());
+  std::vector<std::string> names;
+  for (auto &param : params) {
+    auto it = version->tensors.find(param.name);
+    if (it == version->tensors.end()) {
+      LOG(ERROR) << "The parameter " << param.name
+                 << " is not a persistable tensor of the program.";
+      return false;
+    }
+    auto tensor = std::make_shared<framework::LoDTensor>();
+    if (!PaddleTensorToLoDTensor(param, tensor.get(), place_)) return false;
+    if (tensor->type() != it->second->type()) {
+      LOG(ERROR) << "The parameter " << param.name << " should be of "
+                 << framework::DataTypeToString(it->second->type())
+                 << ", but got "
+                 << framework::DataTypeToString(tensor->type());
+      return false;
+    }
+    it->second = tensor;
+    names.push_back(param.name);
+  }
+  PublishParams(std::move(version), names);
+  return true;
+}
+
+bool AnalysisPredictor::UpdateParamRows(const std::string &name,
+                                        const std::vector<int64_t> &rows,
+                                        const PaddleTensor &values) {
+  if (param_versions_ == nullptr) {
+    LOG(ERROR) << "The parameters can not be updated, please enable it by "
+                  "AnalysisConfig::EnableParamsHotSwap.";
+    return false;
+  }
+  auto lock = param_versions_->LockWriter();
+  auto version =
+      std::make_shared<details::ParamVersion>(*param_versions_->Latest());
+  auto it = version->tensors.find(name);
+  if (it == version->tensors.end()) {
+    LOG(ERROR) << "The parameter " << name
+               << " is not a persistable tensor of the program.";
+    return false;
+  }
+  const auto &table = *it->second;
+  framework::LoDTensor value;
+  if (!PaddleTensorToLoDTensor(values, &value, platform::CPUPlace())) {
+    return false;
+  }
+  int64_t height = table.dims().size() > 0 ? table.dims()[0] : 0;
+  int64_t row_numel = height > 0 ? table.numel() / height : 0;
+  if (value.type() != table.type() || value.dims().size() == 0 ||
+      value.dims()[0] != static_cast<int64_t>(rows.size()) ||
+      value.numel() != row_numel * static_cast<int64_t>(rows.size())) {
+    LOG(ERROR) << "The rows of " << name << " should be of "
+               << framework::DataTypeToString(table.type()) << " and shape ["
+               << rows.size() << ", " << row_numel << "], but got "
+               << framework::DataTypeToString(value.type()) << " and shape ["
+               << value.dims() << "].";
+    return false;
+  }
+  for (auto row : rows) {
+    if (row < 0 || row >= height) {
+      LOG(ERROR) << "The row " << row << " is out of the range [0, " << height
+                 << ") of " << name;
+      return false;
+    }
+  }
+
+  // Copy on write by blocks of rows, the runs reading the current table are
+  // not affected.
+  it->second = param_versions_->MutableRowTable(name)->Update(it->second, rows,
+                                                              value, place_);
+  PublishParams(std::move(version), {name});
+  return true;
+}
+
+// Hashes the content of the file, and returns false if it can not be read.
+static bool HashFile(const std::string &path, XXH64_state_t *state) {
+  std::ifstream fin(path, std::ios::in | std::ios::binary);
+  if (!fin.is_open()) return false;
+  std::vector<char> buffer(1 << 20);
+  while (fin) {
+    fin.read(buffer.data(), buffer.size());
+    XXH64_update(state, buffer.data(), fin.gcount());
+  }
+  return true;
+}
+
+// Returns the digest of the names and the content of the parameter files.
+// Reading them costs about as much as loading the parameters, so the digest
+// is memoized in \param cache_root with a stamp of the paths, sizes and
+// modification times of the files, and the files are only read again when
+// the stamp changes.
+static std::string DigestParamFiles(const std::vector<std::string> &files,
+                                    const std::string &cache_root) {
+  auto *state = XXH64_createState();
+  XXH64_reset(state, 0);
+  for (auto &file : files) {
+    XXH64_update(state, file.data(), file.size() + 1);
+    struct stat info;
+    if (stat(file.c_str(), &info) == 0) {
+      int64_t stamp[2] = {static_cast<int64_t>(info.st_size),
+                          static_cast<int64_t>(info.st_mtime)};
+      XXH64_update(state, stamp, sizeof(stamp));
+    }
+  }
+  std::string stamp = string::Sprintf(
+      "%016llx", static_cast<unsigned long long>(XXH64_digest(state)));
+  std::string memo = cache_root + "/params_digest";
+  std::string memo_stamp, digest;
+  std::ifstream fin(memo);
+  if (fin >> memo_stamp >> digest && memo_stamp == stamp &&
+      digest.size() == stamp.size()) {
+    XXH64_freeState(state);
+    return digest;
+  }
+  fin.close();
+
+  XXH64_reset(state, 0);
+  for (auto &file : files) {
+    XXH64_update(state, file.data(), file.size() + 1);
+    HashFile(file, state);
+  }
+  digest = string::Sprintf(
+      "%016llx", static_cast<unsigned long long>(XXH64_digest(state)));
+  XXH64_freeState(state);
+  std::ofstream fout(memo);
+  fout << stamp << " " << digest;
+  return digest;
+}
+
+std::string AnalysisPredictor::GetOptimProgramCacheDir() {
+  if (!config_.optim_program_cache_enabled() || !config_.ir_optim() ||
+      config_.use_gpu() || config_.use_xpu() ||
+      config_.lite_engine_enabled() || config_.mkldnn_quantizer_enabled()) {
+    return "";
+  }
+  std::string cache_root = config_.opt_cache_dir_;
+  if (cache_root.empty()) {
+    if (config_.model_from_memory()) return "";
+    cache_root = (config_.model_dir().empty()
+                      ? inference::analysis::GetDirRoot(config_.prog_file())
+                      : config_.model_dir()) +
+                 "/_opt_cache";
+  }
+  auto make_dir = [](const std::string &path) {
+    if (inference::analysis::PathExists(path) || MKDIR(path.c_str()) != -1 ||
+        inference::analysis::PathExists(path)) {
+      return true;
+    }
+    LOG(WARNING) << "Can not create the optimized program cache " << path
+                 << ", the program is not cached.";
+    return false;
+  };
+  // The digest of the parameters is memoized in the root.
+  if (!make_dir(cache_root)) return "";
+
+  // The key is the hash of the program, the parameters, the passes and the
+  // options the passes read, so that a changed model or config misses.
+  auto *state = XXH64_createState();
+  XXH64_reset(state, 0);
+  auto update = [state](const std::string &data) {
+    XXH64_update(state, data.data(), data.size() + 1);
+  };
+  update(get_version());
+  update(std::to_string(framework::kCurProgramVersion));
+  update(inference_program_->Proto()->SerializeAsString());
+  for (auto &pass : config_.pass_builder()->AllPasses()) update(pass);
+  for (auto &pass : config_.pass_builder()->AnalysisPasses()) update(pass);
+  std::stringstream options;
+  options << config_.use_fc_padding() << config_.enable_memory_optim()
+          << config_.use_mkldnn_ << config_.use_mkldnn_bfloat16_;
+  // The sets are sorted, so that the key does not depend on their order.
+  for (auto &op : std::set<std::string>(
+           config_.mkldnn_enabled_op_types_.begin(),
+           config_.mkldnn_enabled_op_types_.end())) {
+    options << op << ";";
+  }
+  for (auto &op : std::set<std::string>(
+           config_.bfloat16_enabled_op_types_.begin(),
+           config_.bfloat16_enabled_op_types_.end())) {
+    options << op << ";";
+  }
+  for (auto &table : config_.disk_embedding_tables()) {
+    options << table.first << ";" << table.second.dir << ";"
+            << table.second.cache_rows << ";" << table.second.num_shards
+            << ";";
+  }
+  update(options.str());
+  if (config_.model_from_memory()) {
+    update(config_.params_file());
+  } else if (!config_.params_file().empty()) {
+    update(DigestParamFiles({config_.params_file()}, cache_root));
+  } else {
+    std::vector<std::string> params;
+    for (auto *var : inference_program_->Block(0).AllVars()) {
+      if (IsPersistable(var)) {
+        params.push_back(config_.model_dir() + "/" + var->Name());
+      }
+    }
+    std::sort(params.begin(), params.end());
+    update(DigestParamFiles(params, cache_root));
+  }
+  auto key = XXH64_digest(state);
+  XXH64_freeState(state);
+
+  std::string dir = string::Sprintf("%s/optim_program_%016llx", cache_root,
+                                    static_cast<unsigned long long>(key));
+  return make_dir(dir) ? dir : "";
+}
+
+bool AnalysisPredictor::LoadOptimProgramCache() {
+  if (optim_program_cache_dir_.empty()) return false;
+  std::string model_file = optim_program_cache_dir_ + "/model";
+  std::string params_file = optim_program_cache_dir_ + "/params";
+  // The model is written after the params, so the params are complete if
+  // the model exists.
+  if (!inference::analysis::FileExists(model_file)) return false;
+  try {
+    inference_program_.reset(new framework::ProgramDesc(
+        inference::analysis::LoadProgramDesc(model_file)));
+    executor_->CreateVariables(*inference_program_, 0, true, sub_scope_);
+
+    framework::ProgramDesc load_program;
+    auto *load_block = load_program.MutableBlock(0);
+    std::vector<std::string> params;
+    for (auto *var : inference_program_->Block(0).AllVars()) {
+      if (IsPersistable(var)) {
+        auto *new_var = load_block->Var(var->Name());
+        new_var->SetShape(var->GetShape());
+        new_var->SetDataType(var->GetDataType());
+        new_var->SetType(var->GetType());
+        new_var->SetLoDLevel(var->GetLoDLevel());
+        new_var->SetPersistable(true);
+        params.push_back(var->Name());
+      }
+    }
+    // The same order as SaveProgramAndParams.
+    std::sort(params.begin(), params.end());
+    auto *op = load_block->AppendOp();
+    op->SetType("load_combine");
+    op->SetOutput("Out", params);
+    op->SetAttr("file_path", params_file);
+    op->CheckAttrs();
+    framework::NaiveExecutor e(place_);
+    e.Prepare(scope_.get(), load_program, 0, false);
+    e.Run();
+  } catch (const std::exception &e) {
+    LOG(WARNING) << "Failed to load the optimized program cache "
+                 << optim_program_cache_dir_ << ": " << e.what();
+    LoadProgramDesc();
+    return false;
+  }
+  config_.PartiallyRelease();
+  LOG(INFO) << "Load the optimized program from the cache "
+            << optim_program_cache_dir_;
+  return true;
+}
+
+void AnalysisPredictor::SaveOptimProgramCache() {
+  if (optim_program_cache_dir_.empty()) return;
+  std::string model_file = optim_program_cache_dir_ + "/model";
+  std::string params_file = optim_program_cache_dir_ + "/params";
+  // The files are written under the temporary names and renamed, the model
+  // last, so that the processes sharing the cache never load a partial one.
+  std::string suffix = string::Sprintf(
+      ".tmp%d_%d", predictor_id_,
+      std::chrono::steady_clock::now().time_since_epoch().count());
+  try {
+    SaveProgramAndParams(model_file + suffix, params_file + suffix);
+  } catch (const std::exception &e) {
+    LOG(WARNING) << "Failed to save the optimized program cache "
+                 << optim_program_cache_dir_ << ": " << e.what();
+    std::remove((model_file + suffix).c_str());
+    std::remove((params_file + suffix).c_str());
+    return;
+  }
+  if (std::rename((params_file + suffix).c_str(), params_file.c_str()) != 0 ||
+      std::rename((model_file + suffix).c_str(), model_file.c_str()) != 0) {
+    std::remove((model_file + suffix).c_str());
+    std::remove((params_file + suffix).c_str());
+  }
+}
+
+void AnalysisPredictor::ReserveCpuCores() {
+  if (!config_.cpu_core_binding_enabled() || config_.use_gpu() ||
+      config_.use_xpu()) {
+    return;
+  }
+  if (!config_.cpu_bind_cores().empty()) {
+    cpu_bind_cores_ = config_.cpu_bind_cores();
+  } else {
+    cpu_bind_cores_ = platform::CpuSetAllocator::Instance().Reserve(
+        config_.cpu_math_library_num_threads(), cpu_numa_node_);
+    cpu_cores_reserved_ = true;
+  }
+  VLOG(3) << "Bind the predictor to " << cpu_bind_cores_.size()
+          << " CPU cores.";
+}
+
+void AnalysisPredictor::SetMathLibraryNumThreads(int num_threads) {
+  if (cpu_bind_cores_.empty()) {
+    paddle::platform::SetNumThreads(num_threads);
+  } else {
+    paddle::platform::SetNumThreadsLocal(num_threads);
+  }
+}
+
 bool AnalysisPredictor::PrepareExecutor() {
   executor_->Prepare(sub_scope_, *inference_program_, 0,
                      config_.use_feed_fetch_ops_);
+  if (config_.shape_plan_cache_capacity() > 0) {
+    executor_->EnableShapePlanCache(config_.shape_plan_cache_capacity());
+  }
 
   PADDLE_ENFORCE_NOT_NULL(sub_scope_,
                           platform::errors::PreconditionNotMet(
@@ -353,13 +877,15 @@ void AnalysisPredictor::MkldnnPostReset() {
 bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
                             std::vector<PaddleTensor> *output_data,
                             int batch_size) {
-  paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  platform::ScopedCpuBinding cpu_binding(cpu_bind_cores_);
+  SetMathLibraryNumThreads(config_.cpu_math_library_num_threads());
 #ifdef PADDLE_WITH_MKLDNN
   if (config_.use_mkldnn_) MkldnnPreSet(inputs);
 #endif
   VLOG(3) << "Predictor::predict";
   inference::Timer timer;
   timer.tic();
+  SyncParams();
   // set feed variable
   framework::Scope *scope = sub_scope_ ? sub_scope_ : scope_.get();
   PADDLE_ENFORCE_NOT_NULL(scope, platform::errors::PreconditionNotMet(
@@ -393,7 +919,7 @@ bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
 
   // recover the cpu_math_library_num_threads to 1, in order to avoid thread
   // conflict when integrating it into deployment service.
-  paddle::platform::SetNumThreads(1);
+  SetMathLibraryNumThreads(1);
 #ifdef PADDLE_WITH_MKLDNN
   if (config_.use_mkldnn_) MkldnnPostReset();
 #endif
@@ -473,25 +999,30 @@ bool AnalysisPredictor::GetFetch(std::vector<PaddleTensor> *outputs,
     framework::FetchType &fetch_var =
         framework::GetFetchVariable(*scope, "fetch", idx);
     auto &fetch = BOOST_GET(framework::LoDTensor, fetch_var);
-    auto type = fetch.type();
     auto output = &(outputs->at(i));
     output->name = fetches_[idx]->Input("X")[0];
-    if (type == framework::proto::VarType::FP32) {
-      GetFetchOne<float>(fetch, output);
-      output->dtype = PaddleDType::FLOAT32;
-    } else if (type == framework::proto::VarType::INT64) {
-      GetFetchOne<int64_t>(fetch, output);
-      output->dtype = PaddleDType::INT64;
-    } else if (type == framework::proto::VarType::INT32) {
-      GetFetchOne<int32_t>(fetch, output);
-      output->dtype = PaddleDType::INT32;
-    } else {
-      LOG(ERROR) << "unknown type, only support float32, int64 and int32 now.";
-    }
+    GetFetchTensor(fetch, output);
   }
   return true;
 }
 
+void AnalysisPredictor::GetFetchTensor(const framework::LoDTensor &fetch,
+                                       PaddleTensor *output) {
+  auto type = fetch.type();
+  if (type == framework::proto::VarType::FP32) {
+    GetFetchOne<float>(fetch, output);
+    output->dtype = PaddleDType::FLOAT32;
+  } else if (type == framework::proto::VarType::INT64) {
+    GetFetchOne<int64_t>(fetch, output);
+    output->dtype = PaddleDType::INT64;
+  } else if (type == framework::proto::VarType::INT32) {
+    GetFetchOne<int32_t>(fetch, output);
+    output->dtype = PaddleDType::INT32;
+  } else {
+    LOG(ERROR) << "unknown type, only support float32, int64 and int32 now.";
+  }
+}
+
 void AnalysisPredictor::PrepareArgument() {
   argument_.SetUseGPU(config_.use_gpu());
   argument_.SetUseFcPadding(config_.use_fc_padding());
@@ -499,6 +1030,7 @@ void AnalysisPredictor::PrepareArgument() {
   argument_.SetEnableAnalysisOptim(config_.enable_ir_optim_);
   argument_.SetEnableMemoryOptim(config_.enable_memory_optim());
   argument_.SetModelFromMemory(config_.model_from_memory_);
+  argument_.SetDiskEmbeddingTables(config_.disk_embedding_tables());
   // Analyze inference_program
   argument_.SetPredictorID(predictor_id_);
   argument_.SetOptimCacheDir(config_.opt_cache_dir_);
@@ -840,7 +1372,8 @@ std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetOutputTensor(
 }
 
 bool AnalysisPredictor::ZeroCopyRun() {
-  paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
+  platform::ScopedCpuBinding cpu_binding(cpu_bind_cores_);
+  SetMathLibraryNumThreads(config_.cpu_math_library_num_threads());
 #ifdef PADDLE_WITH_MKLDNN
   if (config_.use_mkldnn_) {
     std::vector<std::vector<int>> shape_vector;
@@ -853,6 +1386,7 @@ bool AnalysisPredictor::ZeroCopyRun() {
   }
 #endif
 
+  SyncParams();
   executor_->Run();
   // Fix TensorArray reuse not cleaned bug.
   tensor_array_batch_cleaner_.CollectTensorArrays(sub_scope_);
@@ -860,7 +1394,7 @@ bool AnalysisPredictor::ZeroCopyRun() {
 
   // recover the cpu_math_library_num_threads to 1, in order to avoid thread
   // conflict when integrating it into deployment service.
-  paddle::platform::SetNumThreads(1);
+  SetMathLibraryNumThreads(1);
 #ifdef PADDLE_WITH_MKLDNN
   if (config_.use_mkldnn_) MkldnnPostReset();
 #endif
@@ -873,6 +1407,136 @@ bool AnalysisPredictor::ZeroCopyRun() {
   return true;
 }
 
+std::future<bool> AnalysisPredictor::RunAsync(
+    const std::vector<PaddleTensor> &inputs,
+    std::vector<PaddleTensor> *output_data) {
+  if (config_.use_feed_fetch_ops_enabled()) {
+    return PaddlePredictor::RunAsync(inputs, output_data);
+  }
+  PADDLE_ENFORCE_EQ(
+      platform::is_cpu_place(place_), true,
+      platform::errors::Unimplemented("RunAsync only supports CPU now."));
+  PADDLE_ENFORCE_EQ(inputs.size(), feeds_.size(),
+                    platform::errors::InvalidArgument(
+                        "The predictor needs %d inputs, but got %d.",
+                        feeds_.size(), inputs.size()));
+  PADDLE_ENFORCE_NOT_NULL(
+      output_data, platform::errors::InvalidArgument(
+                       "The output_data of RunAsync should not be null."));
+  std::call_once(async_init_flag_, [this] { InitAsyncPipeline(); });
+
+  // Stage the inputs while the previous request runs.
+  size_t slot = async_inputs_->Acquire();
+  auto &staged = (*async_inputs_)[slot];
+  bool staged_ok = true;
+  try {
+    for (size_t i = 0; i < inputs.size() && staged_ok; ++i) {
+      size_t idx = i;
+      if (!inputs[i].name.empty()) {
+        auto it = feed_names_.find(inputs[i].name);
+        PADDLE_ENFORCE_EQ(
+            it != feed_names_.end(), true,
+            platform::errors::NotFound("The predictor has no input named %s.",
+                                       inputs[i].name));
+        idx = it->second;
+      }
+      staged_ok = PaddleTensorToLoDTensor(inputs[i], &staged[idx], place_);
+    }
+  } catch (...) {
+    async_inputs_->Release(slot);
+    throw;
+  }
+  if (!staged_ok) {
+    async_inputs_->Release(slot);
+    std::promise<bool> failure;
+    failure.set_value(false);
+    return failure.get_future();
+  }
+
+  auto success = std::make_shared<std::promise<bool>>();
+  auto future = success->get_future();
+  async_run_pool_->Run([this, slot, output_data, success] {
+    RunStaged(slot, output_data, success);
+  });
+  return future;
+}
+
+void AnalysisPredictor::InitAsyncPipeline() {
+  const size_t num_buffers = 2;
+  async_inputs_.reset(new details::TensorSlots(num_buffers, feeds_.size()));
+  async_outputs_.reset(new details::TensorSlots(num_buffers, fetches_.size()));
+  async_run_pool_.reset(new framework::ThreadPool(1));
+  async_fetch_pool_.reset(new framework::ThreadPool(1));
+}
+
+void AnalysisPredictor::RunStaged(size_t slot,
+                                  std::vector<PaddleTensor> *output_data,
+                                  std::shared_ptr<std::promise<bool>> success) {
+  framework::Scope *scope = executor_->scope();
+  // The staged inputs are swapped into the scope, and the slot takes the
+  // buffers of the previous request to stage a later one. A buffer shared
+  // with other variables, like the input of an inplace reshape, is dropped
+  // rather than written while they still point to it.
+  auto &staged = (*async_inputs_)[slot];
+  for (auto &item : idx2feeds_) {
+    auto *tensor =
+        scope->FindVar(item.second)->GetMutable<framework::LoDTensor>();
+    auto &buffer = staged[item.first];
+    std::swap(*tensor, buffer);
+    if (buffer.Holder().use_count() > 1) {
+      buffer = framework::LoDTensor();
+    }
+  }
+  async_inputs_->Release(slot);
+
+  bool ok = false;
+  try {
+    ok = ZeroCopyRun();
+  } catch (const std::exception &e) {
+    LOG(ERROR) << "Failed to run the request asynchronously: " << e.what();
+  }
+  if (!ok) {
+    success->set_value(false);
+    return;
+  }
+
+  // The outputs are moved to a slot, so the next request runs while they are
+  // copied out, and the slot gives its buffers back to the scope. An output
+  // shared with other variables is copied instead, as they are written by
+  // the next request.
+  size_t out_slot = async_outputs_->Acquire();
+  auto &fetched = (*async_outputs_)[out_slot];
+  for (auto &item : idx2fetches_) {
+    auto *tensor =
+        scope->FindVar(item.second)->GetMutable<framework::LoDTensor>();
+    auto &buffer = fetched[item.first];
+    if (tensor->Holder().use_count() > 1) {
+      framework::TensorCopySync(*tensor, platform::CPUPlace(), &buffer);
+      buffer.set_lod(tensor->lod());
+    } else {
+      std::swap(*tensor, buffer);
+    }
+  }
+  async_fetch_pool_->Run([this, out_slot, output_data, success] {
+    auto &fetched = (*async_outputs_)[out_slot];
+    bool ok = true;
+    try {
+      output_data->resize(fetched.size());
+      for (auto &item : idx2fetches_) {
+        auto &output = output_data->at(item.first);
+        output.name = item.second;
+        GetFetchTensor(fetched[item.first], &output);
+      }
+    } catch (const std::exception &e) {
+      LOG(ERROR) << "Failed to fetch the outputs asynchronously: "
+                 << e.what();
+      ok = false;
+    }
+    async_outputs_->Release(out_slot);
+    success->set_value(ok);
+  });
+}
+
 bool AnalysisPredictor::LoadProgramDesc() {
   // Initialize the inference program
   std::string filename;
@@ -1057,6 +1721,9 @@ bool AnalysisPredictor::SaveTrtCalibToDisk() {
 #endif
 
 AnalysisPredictor::~AnalysisPredictor() {
+  // Finish the requests in flight, the runs before their fetches.
+  async_run_pool_.reset();
+  async_fetch_pool_.reset();
 #if PADDLE_WITH_TENSORRT
   if (config_.tensorrt_engine_enabled() &&
       config_.tensorrt_precision_mode_ == AnalysisConfig::Precision::kInt8 &&
@@ -1079,13 +1746,25 @@ AnalysisPredictor::~AnalysisPredictor() {
   }
 #endif
 
+  if (cpu_cores_reserved_) {
+    platform::CpuSetAllocator::Instance().Release(cpu_bind_cores_);
+  }
+
   memory::Release(place_);
 }
 
 std::unique_ptr<PaddlePredictor> AnalysisPredictor::Clone() {
   std::lock_guard<std::mutex> lk(clone_mutex_);
   auto *x = new AnalysisPredictor(config_);
-  x->Init(scope_, inference_program_);
+  // The clone shares the weights, so it prefers the node of the predictor.
+  if (!cpu_bind_cores_.empty()) {
+    x->cpu_numa_node_ =
+        platform::CpuTopology::Instance().NumaNodeOf(cpu_bind_cores_[0]);
+  }
+  if (!prepared_block_) {
+    prepared_block_ = executor_->ExportPreparedBlock(*inference_program_, 0);
+  }
+  x->InitFromPrototype(*this);
   return std::unique_ptr<PaddlePredictor>(x);
 }
 
@@ -1095,12 +1774,17 @@ std::string AnalysisPredictor::GetSerializedProgram() const {
 
 // Add SaveOptimModel
 void AnalysisPredictor::SaveOptimModel(const std::string &dir) {
+  SaveProgramAndParams(dir + "/model", dir + "/params");
+}
+
+void AnalysisPredictor::SaveProgramAndParams(const std::string &model_file,
+                                             const std::string &params_file) {
   // save model
-  std::string model_name = dir + "/model";
   std::ofstream outfile;
-  outfile.open(model_name, std::ios::out | std::ios::binary);
+  outfile.open(model_file, std::ios::out | std::ios::binary);
   std::string inference_prog_desc = GetSerializedProgram();
   outfile << inference_prog_desc;
+  outfile.close();
   // save params
   framework::ProgramDesc save_program;
   auto *save_block = save_program.MutableBlock(0);
@@ -1124,7 +1808,7 @@ void AnalysisPredictor::SaveOptimModel(const std::string &dir) {
   auto *op = save_block->AppendOp();
   op->SetType("save_combine");
   op->SetInput("X", save_var_list);
-  op->SetAttr("file_path", dir + "/params");
+  op->SetAttr("file_path", params_file);
   op->CheckAttrs();
 
   platform::CPUPlace place;
@@ -1192,6 +1876,10 @@ void Tensor::Reshape(const std::vector<int> &shape) { tensor_->Reshape(shape); }
 
 std::vector<int> Tensor::shape() const { return tensor_->shape(); }
 
+std::shared_ptr<void> Tensor::memory_owner() const {
+  return tensor_->memory_owner();
+}
+
 void Tensor::SetLoD(const std::vector<std::vector<size_t>> &x) {
   return tensor_->SetLoD(x);
 }
@@ -1243,6 +1931,16 @@ void Predictor::ClearIntermediateTensor() {
 
 uint64_t Predictor::TryShrinkMemory() { return predictor_->TryShrinkMemory(); }
 
+bool Predictor::UpdateParams(const std::vector<paddle::PaddleTensor> &params) {
+  return predictor_->UpdateParams(params);
+}
+
+bool Predictor::UpdateParamRows(const std::string &name,
+                                const std::vector<int64_t> &rows,
+                                const paddle::PaddleTensor &values) {
+  return predictor_->UpdateParamRows(name, rows, values);
+}
+
 int GetNumBytesOfDataType(DataType dtype) {
   switch (dtype) {
     case DataType::FLOAT32:
@@ -1274,7 +1972,8 @@ std::shared_ptr<Predictor> CreatePredictor(const Config &config) {  // NOLINT
 }
 
 namespace services {
-PredictorPool::PredictorPool(const Config &config, size_t size) {
+PredictorPool::PredictorPool(const Config &config, size_t size)
+    : config_(config) {
   PADDLE_ENFORCE_GE(
       size, 1UL,
       paddle::platform::errors::InvalidArgument(
@@ -1304,5 +2003,19 @@ Predictor *PredictorPool::Retrive(size_t idx) {
   }
   return preds_[idx - 1].get();
 }
+
+Predictor *PredictorPool::RetriveForCurrentThread() {
+  std::lock_guard<std::mutex> lock(thread_preds_mutex_);
+  auto &pred = thread_preds_[std::this_thread::get_id()];
+  if (!pred) {
+    if (config_.tensorrt_engine_enabled()) {
+      Config config_tmp(config_);
+      pred.reset(new Predictor(config_tmp));
+    } else {
+      pred = main_pred_->Clone();
+    }
+  }
+  return pred.get();
+}
 }  // namespace services
 }  // namespace paddle_infer
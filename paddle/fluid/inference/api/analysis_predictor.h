@@ -17,14 +17,19 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "paddle/fluid/framework/naive_executor.h"
 #include "paddle/fluid/framework/op_compatible_info.h"
+#include "paddle/fluid/framework/threadpool.h"
 #include "paddle/fluid/inference/analysis/analyzer.h"
 #include "paddle/fluid/inference/api/api_impl.h"
+#include "paddle/fluid/inference/api/details/param_versions.h"
 #include "paddle/fluid/inference/api/details/reset_tensor_array.h"
+#include "paddle/fluid/inference/api/details/tensor_slots.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/operators/math/packed_gemm.h"
 #include "paddle/fluid/string/printf.h"
 #ifdef PADDLE_WITH_TESTING
 #include <gtest/gtest.h>
@@ -164,6 +169,23 @@ class AnalysisPredictor : public PaddlePredictor {
   ///
   bool ZeroCopyRun() override;
 
+  ///
+  /// \brief Run the prediction engine asynchronously, as ZeroCopyRun does.
+  ///
+  /// The inputs of a request are copied into one of two staging buffers
+  /// before returning, while the previous request runs. The requests are run
+  /// in order by a pipeline thread, and their outputs are copied out by
+  /// another thread, which completes the future. The GetInputTensor and
+  /// GetOutputTensor tensors should not be used while requests are in
+  /// flight. With the feed and fetch ops, the run is synchronous.
+  ///
+  /// \param[in] inputs input tensors, matched by their names if set
+  /// \param[out] output_data output tensors
+  /// \return The future of whether the run is successful
+  ///
+  std::future<bool> RunAsync(const std::vector<PaddleTensor> &inputs,
+                             std::vector<PaddleTensor> *output_data) override;
+
   ///
   /// \brief Create feed fetch variables
   ///
@@ -204,6 +226,30 @@ class AnalysisPredictor : public PaddlePredictor {
   ///
   uint64_t TryShrinkMemory() override;
 
+  ///
+  /// \brief Replace persistable tensors of the predictor and its clones.
+  /// The tensors are copied to the place of the predictor and published as
+  /// a new version of the parameters, which each predictor picks up at the
+  /// start of its next run.
+  ///
+  /// \param[in] params the new tensors, matched by their names
+  /// \return Whether all the tensors are replaced.
+  ///
+  bool UpdateParams(const std::vector<PaddleTensor> &params) override;
+  ///
+  /// \brief Replace some rows of a persistable tensor of the predictor and
+  /// its clones. The tensor is copied with the new rows, so the runs that
+  /// still read the old version are not affected.
+  ///
+  /// \param[in] name the name of the tensor
+  /// \param[in] rows the indices of the rows to replace
+  /// \param[in] values the new rows, one for each index
+  /// \return Whether the rows are replaced.
+  ///
+  bool UpdateParamRows(const std::string &name,
+                       const std::vector<int64_t> &rows,
+                       const PaddleTensor &values) override;
+
   ///
   /// \brief Get the argument used by predictor
   ///
@@ -278,6 +324,83 @@ class AnalysisPredictor : public PaddlePredictor {
   /// \return Whether the function executed successfully
   ///
   bool PrepareExecutor();
+  ///
+  /// \brief Initialize a clone of the predictor. The clone reads the weights
+  /// in the scope of \param prototype and creates its ops and temporary
+  /// variables from the prepared block of \param prototype, without parsing
+  /// and checking the program again.
+  ///
+  /// \return Whether the function executed successfully
+  ///
+  bool InitFromPrototype(const AnalysisPredictor &prototype);
+  ///
+  /// \brief Pack the persistable weights of the CPU fc and mul ops for the
+  /// packed GEMM, which are shared with the clones of the predictor.
+  ///
+  void PackGemmWeights();
+  ///
+  /// \brief Pack \param weight for the packed GEMM of a CPU fc or mul op,
+  /// whose input is flattened to a matrix by \param num_col_dims.
+  ///
+  /// \return The packed weight, or null if it can not be packed.
+  ///
+  std::shared_ptr<operators::math::PackedGemmWeight> PackGemmWeight(
+      const framework::LoDTensor &weight, int num_col_dims);
+  ///
+  /// \brief Make the first version of the parameters from the persistable
+  /// tensors in the scope, if the hot swap of the parameters is enabled.
+  ///
+  void InitParamVersions();
+  ///
+  /// \brief Create the variables in the sub scope that shadow the
+  /// persistable variables, and share them with the latest version of the
+  /// parameters. The ops only read the shadows, so an update never writes
+  /// the tensors read by a run.
+  ///
+  void ShadowParams();
+  ///
+  /// \brief Share the shadows with the latest version of the parameters if
+  /// it changed since the last run.
+  ///
+  void SyncParams();
+  ///
+  /// \brief Repack the GEMM weights of \param names in \param version,
+  /// publish it and point the persistable variables to the new tensors.
+  ///
+  void PublishParams(std::shared_ptr<details::ParamVersion> version,
+                     const std::vector<std::string> &names);
+  ///
+  /// \brief Pick the CPU cores to bind if the core binding is enabled.
+  ///
+  void ReserveCpuCores();
+  ///
+  /// \brief Set the number of cpu math library threads, for the calling
+  /// thread only if the cores are bound.
+  ///
+  void SetMathLibraryNumThreads(int num_threads);
+  ///
+  /// \brief The directory of the optimized program of this model and config
+  /// in the cache, or empty if the cache is not used.
+  ///
+  /// \return The directory named by the hash of the model, the config and
+  /// the passes.
+  ///
+  std::string GetOptimProgramCacheDir();
+  ///
+  /// \brief Load the optimized program and its parameters from the cache.
+  ///
+  /// \return Whether they are in the cache and loaded.
+  ///
+  bool LoadOptimProgramCache();
+  ///
+  /// \brief Save the optimized program and its parameters to the cache.
+  ///
+  void SaveOptimProgramCache();
+  ///
+  /// \brief Save the program and its persistable variables to two files.
+  ///
+  void SaveProgramAndParams(const std::string &model_file,
+                            const std::string &params_file);
 
   ///
   /// \brief Load model program.
@@ -320,6 +443,27 @@ class AnalysisPredictor : public PaddlePredictor {
   void GetFetchOne(const framework::LoDTensor &fetchs,
                    PaddleTensor *output_data);
   ///
+  /// \brief Copy an output to PaddleTensor, used in GetFetch() and RunAsync()
+  ///
+  /// \param[in] fetch output tensor
+  /// \param[out] output_data output tensor
+  ///
+  void GetFetchTensor(const framework::LoDTensor &fetch,
+                      PaddleTensor *output_data);
+  ///
+  /// \brief Create the buffers and threads of RunAsync() on its first call
+  ///
+  void InitAsyncPipeline();
+  ///
+  /// \brief Run the request staged in a slot, on the pipeline thread
+  ///
+  /// \param[in] slot the slot of the staged inputs
+  /// \param[out] output_data output tensors
+  /// \param[out] success whether the run is successful
+  ///
+  void RunStaged(size_t slot, std::vector<PaddleTensor> *output_data,
+                 std::shared_ptr<std::promise<bool>> success);
+  ///
   /// \brief PreSet for Mkldnn multi-thread and dynamic shape input.
   ///
   /// Used in AnalysisPredictor::Run(), do not support
@@ -371,6 +515,10 @@ class AnalysisPredictor : public PaddlePredictor {
   FRIEND_TEST(AnalysisPredictor, analysis_off);
   FRIEND_TEST(AnalysisPredictor, analysis_on);
   FRIEND_TEST(AnalysisPredictor, with_gpu);
+  FRIEND_TEST(AnalysisPredictor, CloneFromPreparedBlock);
+  FRIEND_TEST(AnalysisPredictor, ParamsHotSwap);
+  FRIEND_TEST(AnalysisPredictor, RunAsync);
+  FRIEND_TEST(AnalysisPredictor, OptimProgramCache);
 #endif
 
  private:
@@ -405,11 +553,41 @@ class AnalysisPredictor : public PaddlePredictor {
   details::TensorArrayBatchCleaner tensor_array_batch_cleaner_;
   // A mutex help to make Clone thread safe.
   std::mutex clone_mutex_;
+  // The ops and temporary variables of the program, exported on the first
+  // Clone and shared by all the clones.
+  std::shared_ptr<const framework::NaiveExecutor::PreparedBlock>
+      prepared_block_;
 
   // For memory optimization.
   const size_t max_shape_collect_count_{1000};
   int need_collect_var_shapes_{-1};  // -1 for default, 0 for false, 1 for true.
   std::vector<std::map<std::string, std::vector<int>>> batch_var_shapes_;
+  // The packed weights of fc and mul, shared by the clones, and the
+  // num_col_dims of the packed weights. The packed weights are moved to the
+  // versions of the parameters if they can be updated.
+  std::unordered_map<std::string,
+                     std::shared_ptr<operators::math::PackedGemmWeight>>
+      packed_gemm_weights_;
+  std::unordered_map<std::string, int> gemm_weight_col_dims_;
+  // The versions of the parameters shared by the clones, and the version
+  // the shadows of this predictor share, if the parameters can be updated.
+  std::shared_ptr<details::ParamVersions> param_versions_;
+  std::shared_ptr<const details::ParamVersion> applied_params_;
+  // The double buffers of the inputs and outputs of RunAsync, and the
+  // threads running the requests and copying their outputs, one each to keep
+  // the requests in order.
+  std::once_flag async_init_flag_;
+  std::unique_ptr<details::TensorSlots> async_inputs_;
+  std::unique_ptr<details::TensorSlots> async_outputs_;
+  std::unique_ptr<framework::ThreadPool> async_run_pool_;
+  std::unique_ptr<framework::ThreadPool> async_fetch_pool_;
+  // The directory of the optimized program in the cache, or empty.
+  std::string optim_program_cache_dir_;
+  // The CPU cores bound while the predictor runs, the NUMA node preferred
+  // when picking them, and whether they are reserved from CpuSetAllocator.
+  std::vector<int> cpu_bind_cores_;
+  int cpu_numa_node_{-1};
+  bool cpu_cores_reserved_{false};
   int predictor_id_;
 
  private:
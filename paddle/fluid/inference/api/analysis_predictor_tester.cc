@@ -15,9 +15,15 @@
 #include "paddle/fluid/inference/api/analysis_predictor.h"
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <future>  // NOLINT
 #include <thread>  // NOLINT
 #include "paddle/fluid/framework/ir/pass.h"
 #include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/inference/analysis/helper.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/tests/api/tester_helper.h"
@@ -139,6 +145,46 @@ TEST(AnalysisPredictor, ZeroCopy) {
   predictor->TryShrinkMemory();
 }
 
+TEST(AnalysisPredictor, ShareExternalData) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SwitchUseFeedFetchOps(false);
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+
+  std::vector<std::string> names{"firstw", "secondw", "thirdw", "forthw"};
+  auto run = [&](bool share, std::vector<float>* out) {
+    auto data = std::make_shared<std::vector<int64_t>>(
+        std::vector<int64_t>{1, 2, 3, 4});
+    for (auto& name : names) {
+      auto input = predictor->GetInputTensor(name);
+      if (share) {
+        input->ShareExternalData(data->data(), {4, 1}, data);
+        PaddlePlace place;
+        int size = 0;
+        ASSERT_EQ(input->data<int64_t>(&place, &size), data->data());
+      } else {
+        input->Reshape({4, 1});
+        input->copy_from_cpu(data->data());
+      }
+    }
+    ASSERT_TRUE(predictor->ZeroCopyRun());
+    auto output = predictor->GetOutputTensor("fc_1.tmp_2");
+    PaddlePlace place;
+    int size = 0;
+    auto* out_data = output->data<float>(&place, &size);
+    out->assign(out_data, out_data + size);
+    // The owner keeps the output memory.
+    EXPECT_NE(output->memory_owner(), nullptr);
+  };
+  std::vector<float> copied, shared;
+  run(false, &copied);
+  run(true, &shared);
+  ASSERT_EQ(copied.size(), shared.size());
+  for (size_t i = 0; i < copied.size(); ++i) {
+    EXPECT_NEAR(copied[i], shared[i], 1e-5);
+  }
+}
+
 TEST(AnalysisPredictor, Clone) {
   AnalysisConfig config;
   config.SetModel(FLAGS_dirname);
@@ -195,6 +241,346 @@ TEST(AnalysisPredictor, Clone) {
   }
 }
 
+TEST(AnalysisPredictor, CloneFromPreparedBlock) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SwitchUseFeedFetchOps(true);
+  config.SwitchIrOptim(true);
+  auto main_predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+
+  const int num_clones = 8;
+  std::vector<std::unique_ptr<PaddlePredictor>> clones;
+  inference::Timer timer;
+  timer.tic();
+  for (int i = 0; i < num_clones; ++i) {
+    clones.emplace_back(main_predictor->Clone());
+  }
+  LOG(INFO) << "Clone takes " << timer.toc() / num_clones << "ms";
+
+  auto* main = static_cast<AnalysisPredictor*>(main_predictor.get());
+  ASSERT_TRUE(main->prepared_block_ != nullptr);
+  // A clone of a clone shares the same block, weights and program.
+  clones.emplace_back(clones.front()->Clone());
+  for (auto& clone : clones) {
+    auto* x = static_cast<AnalysisPredictor*>(clone.get());
+    ASSERT_EQ(x->prepared_block_, main->prepared_block_);
+    ASSERT_EQ(x->inference_program_, main->inference_program_);
+    ASSERT_EQ(x->scope(), main->scope());
+    ASSERT_EQ(x->GetInputNames(), main->GetInputNames());
+    ASSERT_EQ(x->GetOutputNames(), main->GetOutputNames());
+  }
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+  std::vector<PaddleTensor> outputs;
+  ASSERT_TRUE(main_predictor->Run(inputs, &outputs));
+
+  std::vector<std::thread> threads;
+  for (auto& clone : clones) {
+    threads.emplace_back([&clone, &inputs, &outputs] {
+      std::vector<PaddleTensor> clone_outputs;
+      for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(clone->Run(inputs, &clone_outputs));
+        inference::CompareTensor(outputs.front(), clone_outputs.front());
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+TEST(AnalysisPredictor, ParamsHotSwap) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SwitchUseFeedFetchOps(true);
+  config.SwitchIrOptim(true);
+  config.EnableParamsHotSwap();
+  auto main_predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  auto clone = main_predictor->Clone();
+  auto* main = static_cast<AnalysisPredictor*>(main_predictor.get());
+  ASSERT_TRUE(main->param_versions_ != nullptr);
+
+  std::string table_name;
+  for (auto* op : main->program().Block(0).AllOps()) {
+    if (op->Type() == "lookup_table") table_name = op->Input("W")[0];
+  }
+  ASSERT_FALSE(table_name.empty());
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+  auto same_outputs = [](const PaddleTensor& a, const PaddleTensor& b) {
+    return a.data.length() == b.data.length() &&
+           std::equal(static_cast<float*>(a.data.data()),
+                      static_cast<float*>(a.data.data()) +
+                          a.data.length() / sizeof(float),
+                      static_cast<float*>(b.data.data()));
+  };
+  std::vector<PaddleTensor> outputs, main_outputs, clone_outputs;
+  ASSERT_TRUE(main_predictor->Run(inputs, &outputs));
+
+  // The clone keeps the version it ran with until its next run.
+  ASSERT_TRUE(clone->Run(inputs, &clone_outputs));
+  auto* x = static_cast<AnalysisPredictor*>(clone.get());
+  auto snapshot = x->applied_params_;
+  const auto& table = *snapshot->tensors.at(table_name);
+  int64_t row_numel = table.numel() / table.dims()[0];
+  std::vector<float> old_table(table.data<float>(),
+                               table.data<float>() + table.numel());
+
+  std::vector<float> zeros(4 * row_numel, 0.f);
+  PaddleTensor rows;
+  rows.name = table_name;
+  rows.shape = std::vector<int>({4, static_cast<int>(row_numel)});
+  rows.data.Reset(zeros.data(), zeros.size() * sizeof(float));
+  rows.dtype = PaddleDType::FLOAT32;
+  ASSERT_TRUE(main->UpdateParamRows(table_name, {1, 2, 3, 4}, rows));
+  ASSERT_EQ(x->applied_params_, snapshot);
+  ASSERT_TRUE(std::equal(old_table.begin(), old_table.end(),
+                         snapshot->tensors.at(table_name)->data<float>()));
+
+  ASSERT_TRUE(main_predictor->Run(inputs, &main_outputs));
+  ASSERT_TRUE(clone->Run(inputs, &clone_outputs));
+  ASSERT_NE(x->applied_params_, snapshot);
+  ASSERT_FALSE(same_outputs(outputs.front(), main_outputs.front()));
+  ASSERT_TRUE(same_outputs(main_outputs.front(), clone_outputs.front()));
+
+  // Restore the whole table from the clone.
+  PaddleTensor param;
+  param.name = table_name;
+  param.shape = framework::vectorize<int>(table.dims());
+  param.data.Reset(old_table.data(), old_table.size() * sizeof(float));
+  param.dtype = PaddleDType::FLOAT32;
+  ASSERT_TRUE(clone->UpdateParams({param}));
+  snapshot.reset();
+  ASSERT_TRUE(main_predictor->Run(inputs, &main_outputs));
+  ASSERT_TRUE(clone->Run(inputs, &clone_outputs));
+  ASSERT_TRUE(same_outputs(outputs.front(), main_outputs.front()));
+  ASSERT_TRUE(same_outputs(outputs.front(), clone_outputs.front()));
+  ASSERT_EQ(main->applied_params_, x->applied_params_);
+  ASSERT_EQ(main->applied_params_->id, 2UL);
+
+  // The rows out of range and the unknown tensors are rejected.
+  ASSERT_FALSE(main->UpdateParamRows(table_name, {-1, 2, 3, 4}, rows));
+  param.name = "not_a_param";
+  ASSERT_FALSE(main->UpdateParams({param}));
+  ASSERT_EQ(main->param_versions_->latest_id(), 2UL);
+}
+
+TEST(AnalysisPredictor, ParamsHotSwapDisabled) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SwitchUseFeedFetchOps(true);
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  ASSERT_FALSE(predictor->UpdateParams({}));
+}
+
+TEST(AnalysisPredictor, RunAsync) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SwitchUseFeedFetchOps(true);
+  auto sync_predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  config.SwitchUseFeedFetchOps(false);
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+
+  // Several requests of different inputs are in flight at once.
+  const int num_requests = 6;
+  std::vector<std::vector<int64_t>> data(num_requests);
+  std::vector<std::vector<PaddleTensor>> inputs(num_requests);
+  std::vector<std::vector<PaddleTensor>> outputs(num_requests);
+  std::vector<std::future<bool>> futures;
+  const char* names[] = {"firstw", "secondw", "thirdw", "forthw"};
+  for (int i = 0; i < num_requests; ++i) {
+    data[i] = {i, i + 1, i + 2, i + 3};
+    for (auto* name : names) {
+      PaddleTensor tensor;
+      tensor.name = name;
+      tensor.shape = std::vector<int>({4, 1});
+      tensor.data.Reset(data[i].data(), data[i].size() * sizeof(int64_t));
+      tensor.dtype = PaddleDType::INT64;
+      inputs[i].push_back(tensor);
+    }
+    futures.push_back(predictor->RunAsync(inputs[i], &outputs[i]));
+  }
+  auto* x = static_cast<AnalysisPredictor*>(predictor.get());
+  ASSERT_TRUE(x->async_run_pool_ != nullptr);
+
+  for (int i = 0; i < num_requests; ++i) {
+    ASSERT_TRUE(futures[i].get());
+    std::vector<PaddleTensor> expected;
+    ASSERT_TRUE(sync_predictor->Run(inputs[i], &expected));
+    ASSERT_EQ(outputs[i].size(), expected.size());
+    ASSERT_EQ(outputs[i][0].shape, expected[0].shape);
+    ASSERT_EQ(outputs[i][0].data.length(), expected[0].data.length());
+    auto* out = static_cast<float*>(outputs[i][0].data.data());
+    auto* ref = static_cast<float*>(expected[0].data.data());
+    for (size_t j = 0; j < expected[0].data.length() / sizeof(float); ++j) {
+      ASSERT_NEAR(out[j], ref[j], 1e-5);
+    }
+  }
+
+  // The unknown inputs are rejected before being staged.
+  inputs[0][0].name = "not_an_input";
+  ASSERT_ANY_THROW(predictor->RunAsync(inputs[0], &outputs[0]));
+  inputs[0][0].name = "firstw";
+  ASSERT_TRUE(predictor->RunAsync(inputs[0], &outputs[0]).get());
+}
+
+TEST(AnalysisPredictor, OptimProgramCache) {
+  std::string cache_dir =
+      "./optim_program_cache_test_" +
+      std::to_string(
+          std::chrono::steady_clock::now().time_since_epoch().count());
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SwitchUseFeedFetchOps(true);
+  config.SwitchIrOptim(true);
+  config.SetOptimCacheDir(cache_dir);
+  config.EnableOptimProgramCache();
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+
+  // The first predictor optimizes the program and caches it, the second one
+  // loads it.
+  auto optimized = CreatePaddlePredictor<AnalysisConfig>(config);
+  auto cached = CreatePaddlePredictor<AnalysisConfig>(config);
+
+  auto* cached_predictor = static_cast<AnalysisPredictor*>(cached.get());
+  ASSERT_EQ(cached_predictor->GetSerializedProgram(),
+            static_cast<AnalysisPredictor*>(optimized.get())
+                ->GetSerializedProgram());
+  std::vector<PaddleTensor> outputs, cached_outputs;
+  ASSERT_TRUE(optimized->Run(inputs, &outputs));
+  ASSERT_TRUE(cached->Run(inputs, &cached_outputs));
+  inference::CompareTensor(outputs.front(), cached_outputs.front());
+
+  // A changed config misses the cache.
+  AnalysisConfig other_config(config);
+  other_config.SwitchIrOptim(true);
+  other_config.pass_builder()->DeletePass("fc_fuse_pass");
+  auto other = CreatePaddlePredictor<AnalysisConfig>(other_config);
+  auto* other_predictor = static_cast<AnalysisPredictor*>(other.get());
+  ASSERT_NE(other_predictor->GetSerializedProgram(),
+            cached_predictor->GetSerializedProgram());
+
+  // Remove the cache, including the memoized digest of the params.
+  std::string dirs[2] = {cached_predictor->optim_program_cache_dir_,
+                         other_predictor->optim_program_cache_dir_};
+  ASSERT_NE(dirs[0], dirs[1]);
+  for (auto& dir : dirs) {
+    ASSERT_EQ(std::remove((dir + "/model").c_str()), 0);
+    ASSERT_EQ(std::remove((dir + "/params").c_str()), 0);
+    ASSERT_EQ(RMDIR(dir.c_str()), 0);
+  }
+  ASSERT_EQ(std::remove((cache_dir + "/params_digest").c_str()), 0);
+  ASSERT_EQ(RMDIR(cache_dir.c_str()), 0);
+}
+
+TEST(AnalysisPredictor, ShapePlanCache) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SwitchUseFeedFetchOps(true);
+  config.SwitchIrOptim(true);
+  AnalysisConfig plan_config(config);
+  plan_config.EnableShapePlanCache(2);
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(config);
+  auto plan_predictor = CreatePaddlePredictor<AnalysisConfig>(plan_config);
+
+  int64_t data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  const int repeat = 1000;
+  double times[2] = {0, 0};
+  // The third batch size exceeds the capacity and runs without a plan.
+  for (int batch_size : {4, 8, 2, 4}) {
+    PaddleTensor tensor;
+    tensor.shape = std::vector<int>({batch_size, 1});
+    tensor.data.Reset(data, batch_size * sizeof(int64_t));
+    tensor.dtype = PaddleDType::INT64;
+    std::vector<PaddleTensor> inputs(4, tensor);
+    std::vector<PaddleTensor> outputs, plan_outputs;
+    inference::Timer timer;
+    timer.tic();
+    for (int i = 0; i < repeat; ++i) {
+      ASSERT_TRUE(predictor->Run(inputs, &outputs));
+    }
+    times[0] += timer.toc();
+    timer.tic();
+    for (int i = 0; i < repeat; ++i) {
+      ASSERT_TRUE(plan_predictor->Run(inputs, &plan_outputs));
+    }
+    times[1] += timer.toc();
+    ASSERT_EQ(plan_outputs.front().shape, outputs.front().shape);
+    inference::CompareTensor(outputs.front(), plan_outputs.front());
+  }
+  LOG(INFO) << "The run time without the shape plans: " << times[0]
+            << "ms, with the shape plans: " << times[1] << "ms";
+}
+
+TEST(AnalysisPredictor, CpuCoreBinding) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.SwitchUseFeedFetchOps(true);
+  config.SetCpuMathLibraryNumThreads(1);
+  auto unbound = CreatePaddlePredictor(config);
+  config.EnableCpuCoreBinding();
+  ASSERT_TRUE(config.cpu_core_binding_enabled());
+  ASSERT_TRUE(config.cpu_bind_cores().empty());
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+  std::vector<PaddleTensor> expected;
+  ASSERT_TRUE(unbound->Run(inputs, &expected));
+
+  // The throughput of num_predictors predictors running together, cloned
+  // from main_predictor.
+  const int num_predictors = 4;
+  const int num_runs = 100;
+  auto throughput = [&](PaddlePredictor* main_predictor) {
+    std::vector<std::unique_ptr<PaddlePredictor>> predictors;
+    for (int i = 0; i < num_predictors; ++i) {
+      predictors.emplace_back(main_predictor->Clone());
+    }
+    inference::Timer timer;
+    timer.tic();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_predictors; ++i) {
+      threads.emplace_back([&, i] {
+        std::vector<PaddleTensor> outputs;
+        for (int j = 0; j < num_runs; ++j) {
+          ASSERT_TRUE(predictors[i]->Run(inputs, &outputs));
+        }
+        inference::CompareTensor(outputs.front(), expected.front());
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    return num_predictors * num_runs * 1000 / timer.toc();
+  };
+  auto bound = CreatePaddlePredictor(config);
+  double unbound_throughput = throughput(unbound.get());
+  double bound_throughput = throughput(bound.get());
+  LOG(INFO) << "The throughput of " << num_predictors
+            << " predictors: " << unbound_throughput << " runs/s unbound, "
+            << bound_throughput << " runs/s bound";
+}
+
 // This function is not released yet, will fail on some machine.
 // TODO(Superjomn) Turn on it latter.
 /*
@@ -552,4 +938,43 @@ TEST(Predictor, Run) {
   predictor->TryShrinkMemory();
 }
 
+TEST(PredictorPool, RetriveForCurrentThread) {
+  Config config;
+  config.SetModel(FLAGS_dirname);
+  services::PredictorPool pool(config, 1);
+
+  const int num_threads = 4;
+  std::vector<Predictor*> preds(num_threads, nullptr);
+  // Keep the threads alive together, so that their ids are not reused.
+  std::atomic<int> retrived{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&pool, &preds, &retrived, i] {
+      preds[i] = pool.RetriveForCurrentThread();
+      EXPECT_EQ(pool.RetriveForCurrentThread(), preds[i]);
+      auto input_names = preds[i]->GetInputNames();
+      for (auto& name : input_names) {
+        auto input = preds[i]->GetInputHandle(name);
+        input->Reshape({4, 1});
+        std::vector<int64_t> data = {1, 2, 3, 4};
+        input->CopyFromCpu(data.data());
+      }
+      EXPECT_TRUE(preds[i]->Run());
+      ++retrived;
+      while (retrived.load() < num_threads) {
+        std::this_thread::yield();
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (int i = 0; i < num_threads; ++i) {
+    ASSERT_NE(preds[i], pool.Retrive(0));
+    for (int j = i + 1; j < num_threads; ++j) {
+      ASSERT_NE(preds[i], preds[j]);
+    }
+  }
+}
+
 }  // namespace paddle_infer
@@ -0,0 +1,154 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/details/param_versions.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <utility>
+
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace details {
+
+constexpr int64_t RowBlockTable::kBlockRows;
+constexpr size_t RowBlockTable::kMaxBuffers;
+
+std::shared_ptr<framework::LoDTensor> RowBlockTable::Update(
+    const std::shared_ptr<const framework::LoDTensor>& latest,
+    const std::vector<int64_t>& rows, const framework::LoDTensor& value,
+    const platform::Place& place) {
+  int64_t height = latest->dims().size() > 0 ? latest->dims()[0] : 0;
+  int64_t num_blocks = (height + kBlockRows - 1) / kBlockRows;
+  // The table is updated by rows the first time, or was replaced as a whole.
+  if (buffers_.empty() ||
+      buffers_[latest_].tensor.Holder() != latest->Holder() ||
+      buffers_[latest_].tensor.dims() != latest->dims()) {
+    buffers_.clear();
+    Buffer buffer;
+    buffer.tensor.ShareDataWith(*latest);
+    buffer.stamps.assign(num_blocks, 0);
+    buffers_.push_back(std::move(buffer));
+    latest_ = 0;
+  }
+
+  size_t target = AcquireBuffer(place);
+  auto& buffer = buffers_[target];
+  const auto& current = buffers_[latest_];
+  for (int64_t begin = 0; begin < num_blocks;) {
+    if (buffer.stamps[begin] == current.stamps[begin]) {
+      ++begin;
+      continue;
+    }
+    // Copy the consecutive stale blocks at once.
+    int64_t end = begin + 1;
+    while (end < num_blocks && buffer.stamps[end] != current.stamps[end]) {
+      ++end;
+    }
+    CopyBlocks(current.tensor, begin, end, place, &buffer.tensor);
+    std::copy(current.stamps.begin() + begin, current.stamps.begin() + end,
+              buffer.stamps.begin() + begin);
+    begin = end;
+  }
+
+  uint64_t stamp = ++last_stamp_;
+  if (platform::is_cpu_place(place)) {
+    size_t row_size =
+        value.numel() / std::max<int64_t>(value.dims()[0], 1) *
+        framework::SizeOfType(value.type());
+    auto* dst = static_cast<char*>(buffer.tensor.data<void>());
+    auto* src = static_cast<const char*>(value.data<void>());
+    for (size_t i = 0; i < rows.size(); ++i) {
+      std::memcpy(dst + rows[i] * row_size, src + i * row_size, row_size);
+    }
+  } else {
+    for (size_t i = 0; i < rows.size(); ++i) {
+      auto dst = buffer.tensor.Slice(rows[i], rows[i] + 1);
+      framework::TensorCopySync(value.Slice(i, i + 1), place, &dst);
+    }
+  }
+  for (auto row : rows) {
+    buffer.stamps[row / kBlockRows] = stamp;
+  }
+  latest_ = target;
+
+  auto updated = std::make_shared<framework::LoDTensor>();
+  updated->ShareDataWith(buffer.tensor);
+  updated->set_lod(latest->lod());
+  return updated;
+}
+
+size_t RowBlockTable::AcquireBuffer(const platform::Place& place) {
+  for (size_t i = 0; i < buffers_.size(); ++i) {
+    // No version reads a buffer whose memory is only held by the table, and
+    // none can read it again since it is not the latest one.
+    if (i != latest_ && buffers_[i].tensor.Holder().use_count() == 1) {
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return i;
+    }
+  }
+  Buffer buffer;
+  framework::TensorCopySync(buffers_[latest_].tensor, place, &buffer.tensor);
+  buffer.stamps = buffers_[latest_].stamps;
+  if (buffers_.size() < kMaxBuffers) {
+    buffers_.push_back(std::move(buffer));
+    return buffers_.size() - 1;
+  }
+  // Leave a buffer to the predictors still reading it, and forget it.
+  size_t evicted = latest_ == 0 ? 1 : 0;
+  buffers_[evicted] = std::move(buffer);
+  return evicted;
+}
+
+void RowBlockTable::CopyBlocks(const framework::LoDTensor& src,
+                               int64_t begin_block, int64_t end_block,
+                               const platform::Place& place,
+                               framework::LoDTensor* dst) {
+  int64_t begin = begin_block * kBlockRows;
+  int64_t end = std::min(end_block * kBlockRows, src.dims()[0]);
+  auto dst_blocks = dst->Slice(begin, end);
+  framework::TensorCopySync(src.Slice(begin, end), place, &dst_blocks);
+}
+
+ParamVersions::ParamVersions(std::shared_ptr<ParamVersion> initial) {
+  PADDLE_ENFORCE_NOT_NULL(initial,
+                          platform::errors::InvalidArgument(
+                              "The initial version of the parameters should "
+                              "not be null."));
+  latest_id_.store(initial->id, std::memory_order_release);
+  std::atomic_store(&latest_,
+                    std::shared_ptr<const ParamVersion>(std::move(initial)));
+}
+
+std::shared_ptr<const ParamVersion> ParamVersions::Latest() const {
+  return std::atomic_load(&latest_);
+}
+
+void ParamVersions::Publish(std::shared_ptr<ParamVersion> version) {
+  PADDLE_ENFORCE_NOT_NULL(
+      version, platform::errors::InvalidArgument(
+                   "The published version of the parameters should not be "
+                   "null."));
+  version->id = latest_id() + 1;
+  uint64_t id = version->id;
+  std::atomic_store(&latest_,
+                    std::shared_ptr<const ParamVersion>(std::move(version)));
+  latest_id_.store(id, std::memory_order_release);
+}
+
+}  // namespace details
+}  // namespace paddle
@@ -0,0 +1,118 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/operators/math/packed_gemm.h"
+
+namespace paddle {
+namespace details {
+
+// The persistable tensors of a predictor at one point of time. A version is
+// never changed after it is published, so the runs that started with it keep
+// reading the same weights while newer versions are published.
+struct ParamVersion {
+  uint64_t id{0};
+  std::unordered_map<std::string, std::shared_ptr<const framework::LoDTensor>>
+      tensors;
+  // The packed weights of the CPU fc and mul ops, which live as long as the
+  // tensors they are packed from.
+  std::unordered_map<std::string,
+                     std::shared_ptr<operators::math::PackedGemmWeight>>
+      packed;
+};
+
+// The copy on write buffers of a table updated by rows. The ops read a table
+// as one contiguous tensor, so rather than a list of chunks the table keeps a
+// few buffers of its whole height, each stamped per block of rows with the
+// update that last wrote the block. An update reuses a buffer that no run
+// reads any more and copies into it only the blocks written since the buffer
+// was the latest one, so its cost scales with the rows updated instead of the
+// height of the table. Only a buffer still read by a lagging predictor makes
+// the update copy the whole table into a new one.
+class RowBlockTable {
+ public:
+  static constexpr int64_t kBlockRows = 256;
+  // The latest buffer, the one read by the predictors which have not run with
+  // it yet, and a spare one.
+  static constexpr size_t kMaxBuffers = 3;
+
+  // Returns the table of \param latest with the \param rows replaced by the
+  // ones of \param value, which is a CPU tensor of the same type and row size.
+  std::shared_ptr<framework::LoDTensor> Update(
+      const std::shared_ptr<const framework::LoDTensor>& latest,
+      const std::vector<int64_t>& rows, const framework::LoDTensor& value,
+      const platform::Place& place);
+
+ private:
+  struct Buffer {
+    // Shares the memory with the versions which read the buffer.
+    framework::LoDTensor tensor;
+    std::vector<uint64_t> stamps;
+  };
+
+  // Returns the index of a buffer to write the next update into.
+  size_t AcquireBuffer(const platform::Place& place);
+  // Copies the rows of the blocks [begin_block, end_block) of \param src.
+  void CopyBlocks(const framework::LoDTensor& src, int64_t begin_block,
+                  int64_t end_block, const platform::Place& place,
+                  framework::LoDTensor* dst);
+
+  std::vector<Buffer> buffers_;
+  size_t latest_{0};
+  uint64_t last_stamp_{0};
+};
+
+// The versions of the parameters shared by a predictor and its clones. The
+// writers are serialized by a mutex, and a reader only checks the id of the
+// latest version before each run, picking the version up when it changed.
+// The memory of a version is freed when the last predictor moves past it.
+class ParamVersions {
+ public:
+  explicit ParamVersions(std::shared_ptr<ParamVersion> initial);
+
+  uint64_t latest_id() const {
+    return latest_id_.load(std::memory_order_acquire);
+  }
+  std::shared_ptr<const ParamVersion> Latest() const;
+
+  // Hold the returned lock while building and publishing a new version.
+  std::unique_lock<std::mutex> LockWriter() {
+    return std::unique_lock<std::mutex>(writer_mutex_);
+  }
+  // Give \param version the next id and make it the latest one.
+  void Publish(std::shared_ptr<ParamVersion> version);
+  // The buffers of the tables updated by rows, hold the writer lock to use it.
+  RowBlockTable* MutableRowTable(const std::string& name) {
+    return &row_tables_[name];
+  }
+
+ private:
+  std::shared_ptr<const ParamVersion> latest_;
+  std::atomic<uint64_t> latest_id_{0};
+  std::mutex writer_mutex_;
+  std::unordered_map<std::string, RowBlockTable> row_tables_;
+};
+
+}  // namespace details
+}  // namespace paddle
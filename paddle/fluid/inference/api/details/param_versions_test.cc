@@ -0,0 +1,112 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/details/param_versions.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace paddle {
+namespace details {
+
+static constexpr int64_t kHeight = 1000;
+static constexpr int64_t kWidth = 4;
+
+static std::shared_ptr<framework::LoDTensor> MakeTable() {
+  auto table = std::make_shared<framework::LoDTensor>();
+  table->Resize(framework::make_ddim({kHeight, kWidth}));
+  auto* data = table->mutable_data<float>(platform::CPUPlace());
+  for (int64_t i = 0; i < table->numel(); ++i) data[i] = i;
+  return table;
+}
+
+static framework::LoDTensor MakeRows(size_t num_rows, float value) {
+  framework::LoDTensor rows;
+  rows.Resize(framework::make_ddim({static_cast<int64_t>(num_rows), kWidth}));
+  auto* data = rows.mutable_data<float>(platform::CPUPlace());
+  std::fill(data, data + rows.numel(), value);
+  return rows;
+}
+
+// Checks the table against the value each row was updated with, or the
+// initial values of the rows whose update is negative one.
+static void ExpectTable(const framework::LoDTensor& table,
+                        const std::vector<float>& updates) {
+  const auto* data = table.data<float>();
+  for (int64_t i = 0; i < kHeight; ++i) {
+    for (int64_t j = 0; j < kWidth; ++j) {
+      float expected = updates[i] != -1.f ? updates[i] : i * kWidth + j;
+      ASSERT_EQ(data[i * kWidth + j], expected) << "row " << i;
+    }
+  }
+}
+
+TEST(RowBlockTable, update_rows) {
+  RowBlockTable row_table;
+  platform::CPUPlace place;
+  std::shared_ptr<const framework::LoDTensor> v0 = MakeTable();
+  const float* v0_data = v0->data<float>();
+  std::vector<float> updates(kHeight, -1.f);
+
+  // The first update copies the table, and leaves the snapshot unchanged.
+  std::shared_ptr<const framework::LoDTensor> v1 =
+      row_table.Update(v0, {1, 600}, MakeRows(2, -2.f), place);
+  ExpectTable(*v0, updates);
+  updates[1] = updates[600] = -2.f;
+  ExpectTable(*v1, updates);
+
+  // The memory of the snapshot nobody reads any more is reused.
+  v0.reset();
+  std::shared_ptr<const framework::LoDTensor> v2 =
+      row_table.Update(v1, {2, 999}, MakeRows(2, -3.f), place);
+  ASSERT_EQ(v2->data<float>(), v0_data);
+  updates[2] = updates[999] = -3.f;
+  ExpectTable(*v2, updates);
+  auto v1_updates = updates;
+  v1_updates[2] = v1_updates[999] = -1.f;
+  ExpectTable(*v1, v1_updates);
+
+  // The snapshot still read gets a new buffer.
+  std::shared_ptr<const framework::LoDTensor> v3 =
+      row_table.Update(v2, {600}, MakeRows(1, -4.f), place);
+  ASSERT_NE(v3->data<float>(), v1->data<float>());
+  ASSERT_NE(v3->data<float>(), v2->data<float>());
+  updates[600] = -4.f;
+  ExpectTable(*v3, updates);
+  ExpectTable(*v1, v1_updates);
+
+  // Both the older buffers are free, the stale blocks of one are refreshed.
+  v1.reset();
+  v2.reset();
+  std::shared_ptr<const framework::LoDTensor> v4 =
+      row_table.Update(v3, {0}, MakeRows(1, -5.f), place);
+  updates[0] = -5.f;
+  ExpectTable(*v4, updates);
+  auto v3_updates = updates;
+  v3_updates[0] = -1.f;
+  ExpectTable(*v3, v3_updates);
+
+  // A table replaced as a whole starts over.
+  std::shared_ptr<const framework::LoDTensor> replaced = MakeTable();
+  auto v5 = row_table.Update(replaced, {3}, MakeRows(1, -6.f), place);
+  std::vector<float> replaced_updates(kHeight, -1.f);
+  ExpectTable(*replaced, replaced_updates);
+  replaced_updates[3] = -6.f;
+  ExpectTable(*v5, replaced_updates);
+}
+
+}  // namespace details
+}  // namespace paddle
@@ -0,0 +1,55 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/details/tensor_slots.h"
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace details {
+
+TensorSlots::TensorSlots(size_t num_slots, size_t num_tensors)
+    : slots_(num_slots, std::vector<framework::LoDTensor>(num_tensors)) {
+  PADDLE_ENFORCE_GT(num_slots, 0,
+                    platform::errors::InvalidArgument(
+                        "The number of tensor slots should be greater than "
+                        "0, but got %d.",
+                        num_slots));
+  for (size_t i = num_slots; i > 0; --i) {
+    free_.push_back(i - 1);
+  }
+}
+
+size_t TensorSlots::Acquire() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  released_.wait(lock, [this] { return !free_.empty(); });
+  size_t slot = free_.back();
+  free_.pop_back();
+  return slot;
+}
+
+void TensorSlots::Release(size_t slot) {
+  PADDLE_ENFORCE_LT(slot, slots_.size(),
+                    platform::errors::OutOfRange(
+                        "The tensor slot %d is out of range [0, %d).", slot,
+                        slots_.size()));
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(slot);
+  }
+  released_.notify_one();
+}
+
+}  // namespace details
+}  // namespace paddle
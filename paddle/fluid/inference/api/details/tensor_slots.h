@@ -0,0 +1,51 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <vector>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace details {
+
+// A fixed number of slots, each holding the tensors of one request in a
+// stage of the async pipeline of a predictor. A slot is acquired by the stage
+// filling it and released by the one consuming it, so the buffers of the
+// tensors are reused by the later requests, and a stage waits when all the
+// slots are in flight.
+class TensorSlots {
+ public:
+  TensorSlots(size_t num_slots, size_t num_tensors);
+
+  // Blocks until a slot is free.
+  size_t Acquire();
+  void Release(size_t slot);
+
+  std::vector<framework::LoDTensor>& operator[](size_t slot) {
+    return slots_[slot];
+  }
+
+ private:
+  std::vector<std::vector<framework::LoDTensor>> slots_;
+  std::vector<size_t> free_;
+  std::mutex mutex_;
+  std::condition_variable released_;
+};
+
+}  // namespace details
+}  // namespace paddle
@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
+#include <utility>
+#include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
@@ -20,6 +23,18 @@
 
 namespace paddle {
 
+namespace {
+// The host memory shared by ZeroCopyTensor::ShareExternalData.
+class ExternalAllocation : public memory::Allocation {
+ public:
+  ExternalAllocation(void *ptr, size_t size, std::shared_ptr<void> owner)
+      : Allocation(ptr, size, platform::CPUPlace()), owner_(std::move(owner)) {}
+
+ private:
+  std::shared_ptr<void> owner_;
+};
+}  // namespace
+
 void ZeroCopyTensor::Reshape(const std::vector<int> &shape) {
   PADDLE_ENFORCE_EQ(
       name_.empty(), false,
@@ -37,6 +52,11 @@ void ZeroCopyTensor::Reshape(const std::vector<int> &shape) {
       var, platform::errors::PreconditionNotMet(
                "No tensor called [%s] in the runtime scope", name_));
   auto *tensor = var->GetMutable<framework::LoDTensor>();
+  // The memory shared by ShareExternalData is not written by mutable_data
+  // and copy_from_cpu after reshaping.
+  if (dynamic_cast<ExternalAllocation *>(tensor->Holder().get())) {
+    tensor->clear();
+  }
   tensor->Resize(framework::make_ddim(shape));
 }
 
@@ -185,6 +205,44 @@ void ZeroCopyTensor::copy_to_cpu(T *data) {
         "The analysis predictor supports CPU, GPU and XPU now."));
   }
 }
+template <typename T>
+void ZeroCopyTensor::ShareExternalData(T *data, const std::vector<int> &shape,
+                                       std::shared_ptr<void> owner) {
+  PADDLE_ENFORCE_EQ(place_, PaddlePlace::kCPU,
+                    platform::errors::Unimplemented(
+                        "Only the CPU tensors can share external data."));
+  EAGER_GET_TENSOR;
+  tensor->clear();
+  tensor->Resize(framework::make_ddim(shape));
+  auto holder = std::make_shared<ExternalAllocation>(
+      static_cast<void *>(data), tensor->numel() * sizeof(T),
+      std::move(owner));
+  tensor->ResetHolderWithType(holder, framework::DataTypeTrait<T>::DataType());
+}
+
+void ZeroCopyTensor::ReleaseExternalData() {
+  EAGER_GET_TENSOR;
+  if (dynamic_cast<ExternalAllocation *>(tensor->Holder().get())) {
+    tensor->clear();
+  }
+}
+
+std::shared_ptr<void> ZeroCopyTensor::memory_owner() const {
+  EAGER_GET_TENSOR;
+  return tensor->Holder();
+}
+
+template PD_INFER_DECL void ZeroCopyTensor::ShareExternalData<float>(
+    float *data, const std::vector<int> &shape, std::shared_ptr<void> owner);
+template PD_INFER_DECL void ZeroCopyTensor::ShareExternalData<int64_t>(
+    int64_t *data, const std::vector<int> &shape, std::shared_ptr<void> owner);
+template PD_INFER_DECL void ZeroCopyTensor::ShareExternalData<int32_t>(
+    int32_t *data, const std::vector<int> &shape, std::shared_ptr<void> owner);
+template PD_INFER_DECL void ZeroCopyTensor::ShareExternalData<uint8_t>(
+    uint8_t *data, const std::vector<int> &shape, std::shared_ptr<void> owner);
+template PD_INFER_DECL void ZeroCopyTensor::ShareExternalData<int8_t>(
+    int8_t *data, const std::vector<int> &shape, std::shared_ptr<void> owner);
+
 template PD_INFER_DECL void ZeroCopyTensor::copy_from_cpu<float>(
     const float *data);
 template PD_INFER_DECL void ZeroCopyTensor::copy_from_cpu<int64_t>(
@@ -130,6 +130,23 @@ struct PD_INFER_DECL AnalysisConfig {
     opt_cache_dir_ = opt_cache_dir;
   }
   ///
+  /// \brief Cache the optimized program and its parameters in the
+  /// optimization cache directory, keyed by the hash of the model, the
+  /// config and the passes, so that the later predictors of the same model
+  /// and config load them instead of running the passes. Only the CPU
+  /// predictors with ir_optim use the cache. The parameter files are hashed
+  /// when their size or modification time changes, which reads them once.
+  ///
+  /// \param x Whether to cache the optimized program.
+  ///
+  void EnableOptimProgramCache(bool x = true) { use_optim_program_cache_ = x; }
+  ///
+  /// \brief A boolean state telling whether the optimized program is cached.
+  ///
+  /// \return bool Whether the optimized program is cached.
+  ///
+  bool optim_program_cache_enabled() const { return use_optim_program_cache_; }
+  ///
   /// \brief Get the model directory path.
   ///
   /// \return const std::string& The model directory path.
@@ -427,6 +444,28 @@ struct PD_INFER_DECL AnalysisConfig {
   int cpu_math_library_num_threads() const {
     return cpu_math_library_num_threads_;
   }
+  ///
+  /// \brief Bind the threads running the CPU predictor to a set of cores, and
+  /// load its weights on the NUMA node of the cores. The predictors created
+  /// in one process get sets of cores overlapping as little as possible.
+  ///
+  /// \param cores The cores to bind. If empty, the number of cpu math library
+  /// threads cores are picked within one NUMA node. The clones of the
+  /// predictor prefer the node of the predictor, which owns the weights.
+  ///
+  void EnableCpuCoreBinding(const std::vector<int>& cores = {});
+  ///
+  /// \brief A boolean state telling whether to bind the CPU cores.
+  ///
+  /// \return bool Whether to bind the CPU cores.
+  ///
+  bool cpu_core_binding_enabled() const { return cpu_core_binding_; }
+  ///
+  /// \brief The cores set by EnableCpuCoreBinding.
+  ///
+  /// \return std::vector<int> The cores to bind, empty if they are picked.
+  ///
+  const std::vector<int>& cpu_bind_cores() const { return cpu_bind_cores_; }
 
   ///
   /// \brief Transform the AnalysisConfig to NativeConfig.
@@ -524,6 +563,80 @@ struct PD_INFER_DECL AnalysisConfig {
   ///
   bool enable_memory_optim() const;
 
+  ///
+  /// \brief Cache the shapes of the intermediate tensors for up to
+  /// `capacity` different shapes and LoD of the inputs, so that the runs
+  /// with a cached input shape skip the shape inference of the operators.
+  /// The operators whose output shapes depend on the input data still infer
+  /// their shapes on every run.
+  ///
+  /// \param capacity The number of the input shapes to cache, zero turns
+  /// it off.
+  ///
+  void EnableShapePlanCache(int capacity = 16) {
+    shape_plan_cache_capacity_ = capacity;
+  }
+  ///
+  /// \brief Get the number of the input shapes whose intermediate shapes are
+  /// cached.
+  ///
+  /// \return int The capacity of the shape plan cache, zero if disabled.
+  ///
+  int shape_plan_cache_capacity() const { return shape_plan_cache_capacity_; }
+
+  ///
+  /// \brief Allow updating the persistable tensors of the predictor and its
+  /// clones while they run, by PaddlePredictor::UpdateParams and
+  /// PaddlePredictor::UpdateParamRows. A run uses the parameters of the
+  /// latest update finished before it starts. Not supported with TensorRT,
+  /// Lite or MKLDNN, which keep their own copies of the weights.
+  ///
+  /// \param x Whether to allow updating the parameters.
+  ///
+  void EnableParamsHotSwap(bool x = true) { params_hot_swap_ = x; }
+  ///
+  /// \brief A boolean state telling whether the parameters can be updated
+  /// while the predictor runs.
+  ///
+  /// \return bool Whether the parameters can be updated.
+  ///
+  bool params_hot_swap_enabled() const { return params_hot_swap_; }
+
+  ///
+  /// \brief The on-disk embedding table of a parameter.
+  ///
+  struct DiskTableConfig {
+    std::string dir;        ///< The directory of the table.
+    int64_t cache_rows{0};  ///< The rows cached in memory.
+    int num_shards{1};      ///< The number of the files of the table.
+  };
+  ///
+  /// \brief Keep the embedding table `param_name` on disk instead of in
+  /// memory. The lookup_table and lookup_table_v2 ops reading it are
+  /// replaced by lookup_table_disk, which caches the hot rows in memory and
+  /// reads the others from the files in `table_dir`. If `table_dir` does not
+  /// hold the table, it is written from the parameter file of the model
+  /// when the predictor is created.
+  ///
+  /// \param param_name The name of the embedding table in the model.
+  /// \param table_dir The directory of the files of the table.
+  /// \param cache_rows The number of the rows cached in memory.
+  /// \param num_shards The number of the files the table is written to.
+  ///
+  void SetDiskEmbeddingTable(const std::string& param_name,
+                             const std::string& table_dir,
+                             int64_t cache_rows = 1 << 20,
+                             int num_shards = 8);
+  ///
+  /// \brief The embedding tables kept on disk, by the names of the
+  /// parameters.
+  ///
+  /// \return The configs of the tables on disk.
+  ///
+  const std::map<std::string, DiskTableConfig>& disk_embedding_tables() const {
+    return disk_embedding_tables_;
+  }
+
   ///
   /// \brief Turn on profiling report.
   /// If not turned on, no profiling report will be generated.
@@ -629,6 +742,9 @@ struct PD_INFER_DECL AnalysisConfig {
 
   // memory reuse related.
   bool enable_memory_optim_{false};
+  int shape_plan_cache_capacity_{0};
+  bool params_hot_swap_{false};
+  std::map<std::string, DiskTableConfig> disk_embedding_tables_;
 
   bool use_mkldnn_{false};
   std::unordered_set<std::string> mkldnn_enabled_op_types_;
@@ -642,6 +758,8 @@ struct PD_INFER_DECL AnalysisConfig {
   bool specify_input_name_{false};
 
   int cpu_math_library_num_threads_{1};
+  bool cpu_core_binding_{false};
+  std::vector<int> cpu_bind_cores_;
 
   bool with_profile_{false};
 
@@ -675,6 +793,7 @@ struct PD_INFER_DECL AnalysisConfig {
   // So we release the memory when the predictor is set up.
   mutable bool is_valid_{true};
   std::string opt_cache_dir_;
+  bool use_optim_program_cache_{false};
 };
 
 }  // namespace paddle
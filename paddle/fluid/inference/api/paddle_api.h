@@ -23,6 +23,7 @@
  */
 
 #include <cassert>
+#include <future>  // NOLINT
 #include <map>
 #include <memory>
 #include <string>
@@ -207,6 +208,29 @@ class PD_INFER_DECL ZeroCopyTensor {
   template <typename T>
   void copy_to_cpu(T* data);
 
+  /// \brief Share the host memory with the tensor instead of copying it.
+  /// It's usually used to set the input tensor data. The memory must stay
+  /// unchanged until the run finishes. For an output tensor, the memory is
+  /// the buffer the next run writes the output into if it is large enough,
+  /// which is not guaranteed, so the data should be checked after the run.
+  /// \param data The host memory, which holds the elements in row-major order.
+  /// \param shape The shape of the data.
+  /// \param owner If given, it is held until the tensor stops using the
+  /// memory.
+  template <typename T>
+  void ShareExternalData(T* data, const std::vector<int>& shape,
+                         std::shared_ptr<void> owner = nullptr);
+
+  /// \brief Stop using the memory shared by ShareExternalData, so that the
+  /// next runs of the predictor never write it. The tensor allocates its own
+  /// memory then.
+  void ReleaseExternalData();
+
+  /// \brief Return an owner of the tensor memory, which keeps the memory
+  /// alive while it is held, e.g. by a view of the output data. The next run
+  /// of the predictor may still overwrite the memory.
+  std::shared_ptr<void> memory_owner() const;
+
   /// \brief Return the shape of the Tensor.
   std::vector<int> shape() const;
 
@@ -314,6 +338,21 @@ class PD_INFER_DECL PaddlePredictor {
   /// \return Whether the run is successful
   virtual bool ZeroCopyRun() { return false; }
 
+  ///
+  /// \brief Run the predictor on \param inputs without waiting for the
+  /// result. The inputs are copied before returning, so they can be reused
+  /// at once, and \param output_data should be kept until the returned
+  /// future is ready. The runs are executed in the order of the calls.
+  /// By default, the run is executed synchronously by Run.
+  /// \return The future of whether the run is successful
+  ///
+  virtual std::future<bool> RunAsync(const std::vector<PaddleTensor>& inputs,
+                                     std::vector<PaddleTensor>* output_data) {
+    std::promise<bool> success;
+    success.set_value(Run(inputs, output_data));
+    return success.get_future();
+  }
+
   ///
   /// \brief Clear the intermediate tensors of the predictor
   ///
@@ -331,6 +370,32 @@ class PD_INFER_DECL PaddlePredictor {
   ///
   virtual uint64_t TryShrinkMemory() { return 0; }
 
+  ///
+  /// \brief Replace persistable tensors of the predictor and its clones by
+  /// \param params, matched by their names. The runs started before the
+  /// update finish with the old values, and the later runs of every clone use
+  /// the new ones. AnalysisConfig::EnableParamsHotSwap is needed.
+  ///
+  /// \return Whether all the tensors are replaced. Nothing is replaced if
+  /// one of them does not match a persistable tensor.
+  ///
+  virtual bool UpdateParams(const std::vector<PaddleTensor>& params) {
+    return false;
+  }
+
+  ///
+  /// \brief Replace the rows \param rows of the persistable tensor \param
+  /// name, such as an embedding table, by the rows of \param values, in the
+  /// same way as UpdateParams.
+  ///
+  /// \return Whether the rows are replaced.
+  ///
+  virtual bool UpdateParamRows(const std::string& name,
+                               const std::vector<int64_t>& rows,
+                               const PaddleTensor& values) {
+    return false;
+  }
+
   /// \brief Clone an existing predictor
   /// When using clone, the same network will be created,
   /// and the parameters between them are shared.
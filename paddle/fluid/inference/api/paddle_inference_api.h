@@ -24,7 +24,10 @@ limitations under the License. */
 #include <cassert>
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -97,6 +100,27 @@ class PD_INFER_DECL Tensor {
   template <typename T>
   void CopyToCpu(T* data);
 
+  ///
+  /// \brief Share the host memory with the tensor instead of copying it.
+  /// It's usually used to set the input tensor data. The memory must stay
+  /// unchanged until the run finishes. For an output tensor, the memory is
+  /// the buffer the next run writes the output into if it is large enough,
+  /// which is not guaranteed, so the data should be checked after the run.
+  /// \param data The host memory, which holds the elements in row-major order.
+  /// \param shape The shape of the data.
+  /// \param owner If given, it is held until the tensor stops using the
+  /// memory.
+  ///
+  template <typename T>
+  void ShareExternalData(T* data, const std::vector<int>& shape,
+                         std::shared_ptr<void> owner = nullptr);
+
+  ///
+  /// \brief Return an owner of the tensor memory, which keeps the memory
+  /// alive while it is held. The next run may still overwrite the memory.
+  ///
+  std::shared_ptr<void> memory_owner() const;
+
   ///
   /// \brief Get the memory pointer directly.
   /// It's usually used to get the output data pointer.
@@ -235,6 +259,28 @@ class PD_INFER_DECL Predictor {
   ///
   uint64_t TryShrinkMemory();
 
+  ///
+  /// \brief Replace persistable tensors of the predictor and its clones
+  /// while they run. Config::EnableParamsHotSwap is needed.
+  ///
+  /// \param[in] params the new tensors, matched by their names
+  /// \return Whether all the tensors are replaced.
+  ///
+  bool UpdateParams(const std::vector<paddle::PaddleTensor>& params);
+
+  ///
+  /// \brief Replace some rows of a persistable tensor, such as an embedding
+  /// table, of the predictor and its clones while they run.
+  ///
+  /// \param[in] name the name of the tensor
+  /// \param[in] rows the indices of the rows to replace
+  /// \param[in] values the new rows, one for each index
+  /// \return Whether the rows are replaced.
+  ///
+  bool UpdateParamRows(const std::string& name,
+                       const std::vector<int64_t>& rows,
+                       const paddle::PaddleTensor& values);
+
  private:
   std::unique_ptr<paddle::PaddlePredictor> predictor_;
 };
@@ -268,6 +314,12 @@ void Tensor::CopyToCpu(T* data) {
   return tensor_->copy_to_cpu<T>(data);
 }
 
+template <typename T>
+void Tensor::ShareExternalData(T* data, const std::vector<int>& shape,
+                               std::shared_ptr<void> owner) {
+  tensor_->ShareExternalData<T>(data, shape, std::move(owner));
+}
+
 template <typename T>
 T* Tensor::mutable_data(PlaceType place) {
   return tensor_->mutable_data<T>(place);
@@ -303,9 +355,19 @@ class PD_INFER_DECL PredictorPool {
   /// \brief Get \param id-th predictor.
   Predictor* Retrive(size_t idx);
 
+  /// \brief Get the predictor of the calling thread, which is cloned from
+  /// the main predictor on the first call of the thread. The clones share
+  /// the weights and the prepared program, and only hold the intermediate
+  /// tensors of their own.
+  Predictor* RetriveForCurrentThread();
+
  private:
+  Config config_;
   std::shared_ptr<Predictor> main_pred_;
   std::vector<std::unique_ptr<Predictor>> preds_;
+  std::mutex thread_preds_mutex_;
+  std::unordered_map<std::thread::id, std::unique_ptr<Predictor>>
+      thread_preds_;
 };
 }  // namespace services
 }  // namespace paddle_infer
@@ -14,7 +14,10 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
+#include <string>
+#include <vector>
 #include "paddle/fluid/inference/api/paddle_analysis_config.h"
 #include "paddle/fluid/inference/api/paddle_api.h"
 #include "paddle/fluid/inference/capi/paddle_c_api.h"
@@ -34,8 +37,29 @@ struct PD_PaddleBuf {
   paddle::PaddleBuf buf;
 };
 
+struct PD_TensorHandle {
+  std::unique_ptr<paddle::ZeroCopyTensor> tensor;
+  // The shape passed to and returned by the tensor, reused by the calls.
+  std::vector<int> shape;
+  // The caller-owned buffer bound to an output.
+  void* output_data{nullptr};
+  PD_DataType output_dtype{PD_UNKDTYPE};
+  size_t output_capacity{0};
+  // Whether the last run succeeded and left the output in the buffer, and
+  // the bytes of the output it wrote there.
+  bool output_valid{false};
+  size_t output_length{0};
+  // The inputs of the requests of PD_ZeroCopyRunBatch, concatenated.
+  std::vector<char> batch_data;
+};
+
 struct PD_Predictor {
   std::unique_ptr<paddle::PaddlePredictor> predictor;
+  // The handles of the inputs and outputs by their names, which live as
+  // long as the predictor.
+  std::map<std::string, std::unique_ptr<PD_TensorHandle>> input_handles;
+  std::map<std::string, std::unique_ptr<PD_TensorHandle>> output_handles;
+  std::vector<std::string> output_names;
 };
 
 namespace paddle {
@@ -298,6 +298,63 @@ PADDLE_CAPI_EXPORT extern void PD_GetZeroCopyOutput(PD_Predictor* predictor,
 
 PADDLE_CAPI_EXPORT extern void PD_ZeroCopyRun(PD_Predictor* predictor);
 
+// The handle of an input or output of a predictor, which is owned by the
+// predictor and returned by all the calls for the same name, so the runs
+// through the handles allocate nothing for the names, shapes and data of the
+// tensors.
+typedef struct PD_TensorHandle PD_TensorHandle;
+
+PADDLE_CAPI_EXPORT extern PD_TensorHandle* PD_GetInputHandle(
+    PD_Predictor* predictor, const char* name);
+
+PADDLE_CAPI_EXPORT extern PD_TensorHandle* PD_GetOutputHandle(
+    PD_Predictor* predictor, const char* name);
+
+// Binds the caller-owned data to the input without copying it. The data
+// must stay unchanged until the run finishes, and is not written by the
+// predictor.
+PADDLE_CAPI_EXPORT extern void PD_ShareInputData(PD_TensorHandle* handle,
+                                                 void* data,
+                                                 PD_DataType dtype,
+                                                 const int* shape,
+                                                 int shape_size);
+
+// Binds a caller-owned buffer of capacity bytes to the output, which the
+// runs of PD_ZeroCopyRunHandles write the output into, until another buffer
+// or NULL is bound. The predictor does not use the buffer out of these runs,
+// so it may be freed once it is unbound.
+PADDLE_CAPI_EXPORT extern void PD_ShareOutputBuffer(PD_TensorHandle* handle,
+                                                    void* data,
+                                                    PD_DataType dtype,
+                                                    size_t capacity);
+
+// Runs the predictor on the data bound to the inputs. Returns false if the
+// run fails, or an output does not fit the buffer bound to it.
+PADDLE_CAPI_EXPORT extern bool PD_ZeroCopyRunHandles(PD_Predictor* predictor);
+
+// The shape of the tensor, valid until the next call on the handle.
+PADDLE_CAPI_EXPORT extern const int* PD_GetHandleShape(PD_TensorHandle* handle,
+                                                      int* shape_size);
+
+// The data of the tensor without copying it, valid until the next run. For an
+// output bound to a buffer, it is the buffer, or NULL with a zero length if
+// the last run failed, did not fit the output into the buffer, or was not a
+// PD_ZeroCopyRunHandles.
+PADDLE_CAPI_EXPORT extern const void* PD_GetHandleData(PD_TensorHandle* handle,
+                                                      PD_DataType* dtype,
+                                                      size_t* length);
+
+// Runs num_requests requests as one batch. inputs holds in_size inputs of
+// each request, and outputs out_size outputs of each request, in the order
+// of PD_GetOutputName. The inputs of the same name are concatenated along
+// their first dimension, and the outputs are split back by the rows of the
+// requests into the buffers of outputs, which are grown as needed and freed
+// by PD_DestroyZeroCopyTensor. The rows of a model should not depend on
+// each other, and the inputs should have no LoD.
+PADDLE_CAPI_EXPORT extern bool PD_ZeroCopyRunBatch(
+    PD_Predictor* predictor, const PD_ZeroCopyData* inputs, int in_size,
+    int num_requests, PD_ZeroCopyTensor* outputs, int out_size);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
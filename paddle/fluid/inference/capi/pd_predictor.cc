@@ -15,6 +15,7 @@
 #include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
 #include <map>
 #include <memory>
 #include <numeric>
@@ -76,6 +77,107 @@ struct PD_ZeroCopyFunctor {
   }
 };
 
+struct PD_ShareDataFunctor {
+  paddle::ZeroCopyTensor* tensor;
+  void* data;
+  const std::vector<int>* shape;
+
+  template <typename T>
+  void apply() {
+    tensor->ShareExternalData(static_cast<T*>(data), *shape);
+  }
+};
+
+struct PD_TensorDataFunctor {
+  const paddle::ZeroCopyTensor* tensor;
+  void** data;
+  int* numel;
+
+  template <typename T>
+  void apply() {
+    paddle::PaddlePlace place;
+    *data = tensor->data<T>(&place, numel);
+  }
+};
+
+size_t PD_DataTypeSize(PD_DataType dtype) {
+  return paddle::PaddleDtypeSize(ConvertToPaddleDType(dtype));
+}
+
+// Grows the buffer allocated by malloc to hold length bytes.
+void PD_ReserveBuffer(PD_Buffer* buffer, size_t length) {
+  if (buffer->capacity < length) {
+    std::free(buffer->data);
+    buffer->data = std::malloc(length);
+    buffer->capacity = length;
+  }
+  buffer->length = length;
+}
+
+PD_TensorHandle* PD_GetTensorHandle(PD_Predictor* predictor, const char* name,
+                                    bool is_input) {
+  PADDLE_ENFORCE_NOT_NULL(
+      predictor, paddle::platform::errors::InvalidArgument(
+                     "The pointer of predictor shouldn't be nullptr"));
+  PADDLE_ENFORCE_NOT_NULL(name,
+                          paddle::platform::errors::InvalidArgument(
+                              "The name of tensor shouldn't be nullptr"));
+  auto& handles =
+      is_input ? predictor->input_handles : predictor->output_handles;
+  auto it = handles.find(name);
+  if (it != handles.end()) {
+    return it->second.get();
+  }
+  std::unique_ptr<PD_TensorHandle> handle(new PD_TensorHandle);
+  handle->tensor = is_input ? predictor->predictor->GetInputTensor(name)
+                            : predictor->predictor->GetOutputTensor(name);
+  auto* ptr = handle.get();
+  handles[name] = std::move(handle);
+  return ptr;
+}
+
+// The data and the number of elements of the tensor of the handle.
+void* PD_GetTensorData(const PD_TensorHandle* handle, PD_DataType dtype,
+                       int* numel) {
+  void* data = nullptr;
+  VisitDataType(dtype, PD_TensorDataFunctor{handle->tensor.get(), &data, numel});
+  return data;
+}
+
+// Copies the output into the buffer bound to it, unless the run has written
+// the output there, and records the length of the output in the buffer.
+bool PD_CopyToOutputBuffer(const std::string& name, PD_TensorHandle* handle) {
+  PD_DataType dtype = ConvertToPDDataType(handle->tensor->type());
+  if (dtype != handle->output_dtype) {
+    LOG(ERROR) << "The data type of the output " << name
+               << " does not match its buffer.";
+    return false;
+  }
+  int numel = 0;
+  void* data = PD_GetTensorData(handle, dtype, &numel);
+  size_t length = numel * PD_DataTypeSize(dtype);
+  if (length > handle->output_capacity) {
+    LOG(ERROR) << "The output " << name << " of " << length
+               << " bytes does not fit its buffer of "
+               << handle->output_capacity << " bytes.";
+    return false;
+  }
+  if (data != handle->output_data) {
+    std::memcpy(handle->output_data, data, length);
+  }
+  handle->output_valid = true;
+  handle->output_length = length;
+  return true;
+}
+
+// The runs other than PD_ZeroCopyRunHandles do not write the buffers bound
+// to the outputs, which no longer hold the current outputs.
+void PD_InvalidateOutputBuffers(PD_Predictor* predictor) {
+  for (auto& item : predictor->output_handles) {
+    item.second->output_valid = false;
+  }
+}
+
 }  // namespace
 
 extern "C" {
@@ -187,6 +289,7 @@ bool PD_PredictorZeroCopyRun(const PD_AnalysisConfig* config,
 PD_Predictor* PD_NewPredictor(const PD_AnalysisConfig* config) {
   PD_Predictor* predictor = new PD_Predictor;
   predictor->predictor = paddle::CreatePaddlePredictor(config->config);
+  predictor->output_names = predictor->predictor->GetOutputNames();
   return predictor;
 }
 
@@ -313,6 +416,189 @@ void PD_GetZeroCopyOutput(PD_Predictor* predictor, PD_ZeroCopyTensor* tensor) {
 }
 
 void PD_ZeroCopyRun(PD_Predictor* predictor) {
+  PD_InvalidateOutputBuffers(predictor);
   predictor->predictor->ZeroCopyRun();
 }
+
+PD_TensorHandle* PD_GetInputHandle(PD_Predictor* predictor, const char* name) {
+  return PD_GetTensorHandle(predictor, name, true);
+}
+
+PD_TensorHandle* PD_GetOutputHandle(PD_Predictor* predictor,
+                                    const char* name) {
+  return PD_GetTensorHandle(predictor, name, false);
+}
+
+void PD_ShareInputData(PD_TensorHandle* handle, void* data, PD_DataType dtype,
+                       const int* shape, int shape_size) {
+  PADDLE_ENFORCE_NOT_NULL(handle,
+                          paddle::platform::errors::InvalidArgument(
+                              "The pointer of handle shouldn't be nullptr"));
+  handle->shape.assign(shape, shape + shape_size);
+  VisitDataType(dtype,
+                PD_ShareDataFunctor{handle->tensor.get(), data, &handle->shape});
+}
+
+void PD_ShareOutputBuffer(PD_TensorHandle* handle, void* data,
+                          PD_DataType dtype, size_t capacity) {
+  PADDLE_ENFORCE_NOT_NULL(handle,
+                          paddle::platform::errors::InvalidArgument(
+                              "The pointer of handle shouldn't be nullptr"));
+  // The tensor must not keep the previous buffer, which may be freed by the
+  // caller once it is unbound.
+  handle->tensor->ReleaseExternalData();
+  handle->output_data = data;
+  handle->output_dtype = dtype;
+  handle->output_capacity = data ? capacity : 0;
+  handle->output_valid = false;
+}
+
+bool PD_ZeroCopyRunHandles(PD_Predictor* predictor) {
+  PADDLE_ENFORCE_NOT_NULL(
+      predictor, paddle::platform::errors::InvalidArgument(
+                     "The pointer of predictor shouldn't be nullptr"));
+  // The run writes an output into its buffer if it fits, or it is copied
+  // there after the run.
+  for (auto& item : predictor->output_handles) {
+    auto* handle = item.second.get();
+    if (!handle->output_data) continue;
+    handle->shape.assign(1, static_cast<int>(handle->output_capacity /
+                                             PD_DataTypeSize(
+                                                 handle->output_dtype)));
+    VisitDataType(handle->output_dtype,
+                  PD_ShareDataFunctor{handle->tensor.get(),
+                                      handle->output_data, &handle->shape});
+  }
+  bool success = predictor->predictor->ZeroCopyRun();
+  for (auto& item : predictor->output_handles) {
+    auto* handle = item.second.get();
+    if (!handle->output_data) continue;
+    handle->output_valid = false;
+    if (success) {
+      success = PD_CopyToOutputBuffer(item.first, handle);
+    }
+    // Only this call writes the buffers, so the other runs of the predictor
+    // never write the memory of the caller.
+    handle->tensor->ReleaseExternalData();
+  }
+  return success;
+}
+
+const int* PD_GetHandleShape(PD_TensorHandle* handle, int* shape_size) {
+  PADDLE_ENFORCE_NOT_NULL(handle,
+                          paddle::platform::errors::InvalidArgument(
+                              "The pointer of handle shouldn't be nullptr"));
+  handle->shape = handle->tensor->shape();
+  *shape_size = static_cast<int>(handle->shape.size());
+  return handle->shape.data();
+}
+
+const void* PD_GetHandleData(PD_TensorHandle* handle, PD_DataType* dtype,
+                             size_t* length) {
+  PADDLE_ENFORCE_NOT_NULL(handle,
+                          paddle::platform::errors::InvalidArgument(
+                              "The pointer of handle shouldn't be nullptr"));
+  if (handle->output_data) {
+    // The tensor has released the buffer after the run which filled it.
+    *dtype = handle->output_dtype;
+    *length = handle->output_valid ? handle->output_length : 0;
+    return handle->output_valid ? handle->output_data : nullptr;
+  }
+  *dtype = ConvertToPDDataType(handle->tensor->type());
+  int numel = 0;
+  void* data = PD_GetTensorData(handle, *dtype, &numel);
+  *length = numel * PD_DataTypeSize(*dtype);
+  return data;
+}
+
+bool PD_ZeroCopyRunBatch(PD_Predictor* predictor, const PD_ZeroCopyData* inputs,
+                         int in_size, int num_requests,
+                         PD_ZeroCopyTensor* outputs, int out_size) {
+  PADDLE_ENFORCE_NOT_NULL(
+      predictor, paddle::platform::errors::InvalidArgument(
+                     "The pointer of predictor shouldn't be nullptr"));
+  PADDLE_ENFORCE_GT(in_size, 0, paddle::platform::errors::InvalidArgument(
+                                    "The batch should have inputs."));
+  PADDLE_ENFORCE_GT(num_requests, 0,
+                    paddle::platform::errors::InvalidArgument(
+                        "The batch should have requests."));
+  PADDLE_ENFORCE_EQ(
+      static_cast<size_t>(out_size), predictor->output_names.size(),
+      paddle::platform::errors::InvalidArgument(
+          "The number of outputs of a request should be %d, but got %d.",
+          predictor->output_names.size(), out_size));
+
+  // Concatenate the inputs of the requests in the buffers of the handles.
+  int rows = 0;
+  for (int r = 0; r < num_requests; ++r) {
+    rows += inputs[r * in_size].shape[0];
+  }
+  for (int i = 0; i < in_size; ++i) {
+    const PD_ZeroCopyData& first = inputs[i];
+    auto* handle = PD_GetTensorHandle(predictor, first.name, true);
+    size_t row_size = PD_DataTypeSize(first.dtype);
+    for (int k = 1; k < first.shape_size; ++k) {
+      row_size *= first.shape[k];
+    }
+    handle->batch_data.resize(rows * row_size);
+    char* dst = handle->batch_data.data();
+    for (int r = 0; r < num_requests; ++r) {
+      const PD_ZeroCopyData& input = inputs[r * in_size + i];
+      PADDLE_ENFORCE_EQ(
+          std::strcmp(input.name, first.name) == 0 &&
+              input.dtype == first.dtype &&
+              input.shape_size == first.shape_size &&
+              std::equal(first.shape + 1, first.shape + first.shape_size,
+                         input.shape + 1) &&
+              input.shape[0] == inputs[r * in_size].shape[0],
+          true, paddle::platform::errors::InvalidArgument(
+                    "The input %d of the request %d does not match the "
+                    "input %s of the first request.",
+                    i, r, first.name));
+      size_t length = input.shape[0] * row_size;
+      std::memcpy(dst, input.data, length);
+      dst += length;
+    }
+    handle->shape.assign(first.shape, first.shape + first.shape_size);
+    handle->shape[0] = rows;
+    VisitDataType(first.dtype,
+                  PD_ShareDataFunctor{handle->tensor.get(),
+                                      handle->batch_data.data(),
+                                      &handle->shape});
+  }
+  PD_InvalidateOutputBuffers(predictor);
+  if (!predictor->predictor->ZeroCopyRun()) return false;
+
+  // Split the outputs by the rows of the requests.
+  for (int j = 0; j < out_size; ++j) {
+    auto* handle = PD_GetTensorHandle(
+        predictor, predictor->output_names[j].c_str(), false);
+    handle->shape = handle->tensor->shape();
+    if (handle->shape.empty() || handle->shape[0] != rows) {
+      LOG(ERROR) << "The output " << predictor->output_names[j]
+                 << " does not have a row for each input row.";
+      return false;
+    }
+    PD_DataType dtype = ConvertToPDDataType(handle->tensor->type());
+    int numel = 0;
+    const char* src =
+        static_cast<const char*>(PD_GetTensorData(handle, dtype, &numel));
+    size_t row_size = numel / rows * PD_DataTypeSize(dtype);
+    for (int r = 0; r < num_requests; ++r) {
+      PD_ZeroCopyTensor& output = outputs[r * out_size + j];
+      int request_rows = inputs[r * in_size].shape[0];
+      output.dtype = dtype;
+      PD_ReserveBuffer(&output.shape, handle->shape.size() * sizeof(int));
+      int* shape = static_cast<int*>(output.shape.data);
+      std::copy(handle->shape.begin(), handle->shape.end(), shape);
+      shape[0] = request_rows;
+      size_t length = request_rows * row_size;
+      PD_ReserveBuffer(&output.data, length);
+      std::memcpy(output.data.data, src, length);
+      output.lod.length = 0;
+      src += length;
+    }
+  }
+  return true;
+}
 }  // extern "C"
@@ -16,11 +16,14 @@ limitations under the License. */
 
 #include <algorithm>
 #include <fstream>
+#include <unordered_set>
 #include <vector>
 #include "paddle/fluid/framework/block_desc.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
+#include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/version.h"
+#include "paddle/fluid/operators/math/disk_embedding_table.h"
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/pybind/pybind.h"
 
@@ -71,15 +74,25 @@ void LoadPersistables(framework::Executor* executor, framework::Scope* scope,
                       const framework::ProgramDesc& main_program,
                       const std::string& dirname,
                       const std::string& param_filename,
-                      bool model_from_memory = false) {
+                      bool model_from_memory,
+                      const std::unordered_set<std::string>& skip_vars) {
   const framework::BlockDesc& global_block = main_program.Block(0);
 
   framework::ProgramDesc* load_program = new framework::ProgramDesc();
   framework::BlockDesc* load_block = load_program->MutableBlock(0);
   std::vector<std::string> paramlist;
+  // The skipped variables in the combined file, which are sorted together
+  // with the loaded ones, and replaced by the empty name.
+  std::unordered_set<std::string> skipped;
 
   for (auto* var : global_block.AllVars()) {
-    if (IsPersistable(var)) {
+    if (IsPersistable(var) && skip_vars.count(var->Name())) {
+      VLOG(4) << "skip persistable variable: " << var->Name();
+      if (!param_filename.empty()) {
+        paramlist.push_back(var->Name());
+        skipped.insert(var->Name());
+      }
+    } else if (IsPersistable(var)) {
       VLOG(4) << "persistable variable's name: " << var->Name();
 
       framework::VarDesc* new_var = load_block->Var(var->Name());
@@ -110,6 +123,9 @@ void LoadPersistables(framework::Executor* executor, framework::Scope* scope,
   if (!param_filename.empty()) {
     // sort paramlist to have consistent ordering
     std::sort(paramlist.begin(), paramlist.end());
+    for (auto& param : paramlist) {
+      if (skipped.count(param)) param = framework::kEmptyVarName;
+    }
     // append just the load_combine op
     framework::OpDesc* op = load_block->AppendOp();
     op->SetType("load_combine");
@@ -124,9 +140,10 @@ void LoadPersistables(framework::Executor* executor, framework::Scope* scope,
   delete load_program;
 }
 
-std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
-                                             framework::Scope* scope,
-                                             const std::string& dirname) {
+std::unique_ptr<framework::ProgramDesc> Load(
+    framework::Executor* executor, framework::Scope* scope,
+    const std::string& dirname,
+    const std::unordered_set<std::string>& skip_vars) {
   std::string model_filename = dirname + "/__model__";
   std::string program_desc_str;
   VLOG(3) << "loading model from " << model_filename;
@@ -141,13 +158,14 @@ std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
 
   // model_from_memory is false in separate parameters.
   LoadPersistables(executor, scope, *main_program, dirname, "",
-                   false /* model_from_memory */);
+                   false /* model_from_memory */, skip_vars);
   return main_program;
 }
 
 std::unique_ptr<framework::ProgramDesc> Load(
     framework::Executor* executor, framework::Scope* scope,
-    const std::string& prog_filename, const std::string& param_filename) {
+    const std::string& prog_filename, const std::string& param_filename,
+    const std::unordered_set<std::string>& skip_vars) {
   std::string program_desc_str;
   ReadBinaryFile(prog_filename, &program_desc_str);
 
@@ -159,13 +177,14 @@ std::unique_ptr<framework::ProgramDesc> Load(
                                     main_program->Version()));
 
   LoadPersistables(executor, scope, *main_program, "", param_filename,
-                   false /* model_from_memory */);
+                   false /* model_from_memory */, skip_vars);
   return main_program;
 }
 
 std::unique_ptr<framework::ProgramDesc> LoadFromMemory(
     framework::Executor* executor, framework::Scope* scope,
-    const std::string& prog_buffer, const std::string& param_buffer) {
+    const std::string& prog_buffer, const std::string& param_buffer,
+    const std::unordered_set<std::string>& skip_vars) {
   std::unique_ptr<framework::ProgramDesc> main_program(
       new framework::ProgramDesc(prog_buffer));
   PADDLE_ENFORCE_EQ(
@@ -174,10 +193,57 @@ std::unique_ptr<framework::ProgramDesc> LoadFromMemory(
                                     main_program->Version()));
 
   LoadPersistables(executor, scope, *main_program, "", param_buffer,
-                   true /* model_filename */);
+                   true /* model_filename */, skip_vars);
   return main_program;
 }
 
+void BuildDiskEmbeddingTable(const framework::ProgramDesc& main_program,
+                             const std::string& dirname,
+                             const std::string& param_filename,
+                             const std::string& name,
+                             const std::string& table_dir, int num_shards,
+                             uint64_t source) {
+  if (param_filename.empty()) {
+    std::ifstream fin(dirname + "/" + name, std::ios::in | std::ios::binary);
+    PADDLE_ENFORCE_EQ(fin.is_open(), true,
+                      platform::errors::NotFound(
+                          "Cannot open the parameter file %s.",
+                          dirname + "/" + name));
+    operators::math::DiskEmbeddingTable::Build(&fin, table_dir, num_shards,
+                                               source);
+    return;
+  }
+
+  // The tensors in the combined file are in the order of their names, and
+  // the ones before the table are skipped without being read.
+  std::vector<std::string> paramlist;
+  for (auto* var : main_program.Block(0).AllVars()) {
+    if (IsPersistable(var)) paramlist.push_back(var->Name());
+  }
+  std::sort(paramlist.begin(), paramlist.end());
+  std::ifstream fin(param_filename, std::ios::in | std::ios::binary);
+  PADDLE_ENFORCE_EQ(
+      fin.is_open(), true,
+      platform::errors::NotFound("Cannot open the parameter file %s.",
+                                 param_filename));
+  for (auto& param : paramlist) {
+    if (param == name) {
+      operators::math::DiskEmbeddingTable::Build(&fin, table_dir, num_shards,
+                                                 source);
+      return;
+    }
+    framework::LoD lod;
+    framework::proto::VarType::TensorDesc desc;
+    framework::DeserializeDescFromStream(fin, &lod, &desc);
+    int64_t numel = 1;
+    for (auto dim : desc.dims()) numel *= dim;
+    fin.seekg(numel * framework::SizeOfType(desc.data_type()), std::ios::cur);
+  }
+  PADDLE_THROW(platform::errors::NotFound(
+      "The parameter %s is not a persistable variable of the program.",
+      name));
+}
+
 void SaveVars(const framework::Scope& scope,
               const std::vector<std::string>& vars, const std::string& dirname,
               bool predicate) {
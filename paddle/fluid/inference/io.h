@@ -16,6 +16,7 @@ limitations under the License. */
 
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 #include "paddle/fluid/framework/executor.h"
 #include "paddle/fluid/framework/program_desc.h"
@@ -27,24 +28,40 @@ namespace inference {
 
 void Init(const std::vector<std::string> argv);
 
+// Load the persistables of the program, except the ones in skip_vars.
 void LoadPersistables(framework::Executor* executor, framework::Scope* scope,
                       const framework::ProgramDesc& main_program,
                       const std::string& dirname,
                       const std::string& param_filename,
-                      bool model_from_memory);
+                      bool model_from_memory,
+                      const std::unordered_set<std::string>& skip_vars = {});
 
-std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
-                                             framework::Scope* scope,
-                                             const std::string& dirname);
+std::unique_ptr<framework::ProgramDesc> Load(
+    framework::Executor* executor, framework::Scope* scope,
+    const std::string& dirname,
+    const std::unordered_set<std::string>& skip_vars = {});
 
-std::unique_ptr<framework::ProgramDesc> Load(framework::Executor* executor,
-                                             framework::Scope* scope,
-                                             const std::string& prog_filename,
-                                             const std::string& param_filename);
+std::unique_ptr<framework::ProgramDesc> Load(
+    framework::Executor* executor, framework::Scope* scope,
+    const std::string& prog_filename, const std::string& param_filename,
+    const std::unordered_set<std::string>& skip_vars = {});
 
 std::unique_ptr<framework::ProgramDesc> LoadFromMemory(
     framework::Executor* executor, framework::Scope* scope,
-    const std::string& prog_buffer, const std::string& param_buffer);
+    const std::string& prog_buffer, const std::string& param_buffer,
+    const std::unordered_set<std::string>& skip_vars = {});
+
+// Write the persistable `name` of the program from its parameter file, in
+// dirname or param_filename as Load reads it, to an embedding table of
+// num_shards files in the existing directory table_dir, which is read by the
+// lookup_table_disk op. source is stored in the table to identify the
+// parameter file.
+void BuildDiskEmbeddingTable(const framework::ProgramDesc& main_program,
+                             const std::string& dirname,
+                             const std::string& param_filename,
+                             const std::string& name,
+                             const std::string& table_dir, int num_shards,
+                             uint64_t source = 0);
 
 // Save the variables from a scope to disk.
 void SaveVars(const framework::Scope& scope,
@@ -0,0 +1,215 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "paddle/fluid/inference/capi/paddle_c_api.h"
+#include "paddle/fluid/inference/tests/api/tester_helper.h"
+
+// Compares the per-call overhead of the C API on the small word2vec model,
+// between the copying entry points, the handles sharing the memory of the
+// caller, and the batched runs.
+
+namespace paddle {
+namespace inference {
+namespace analysis {
+
+static const char *kInputNames[] = {"firstw", "secondw", "thirdw", "forthw"};
+static const int kInputNum = 4;
+static const int kRows = 4;
+
+static PD_Predictor *NewPredictor() {
+  PD_AnalysisConfig *config = PD_NewAnalysisConfig();
+  PD_DisableGpu(config);
+  PD_SetCpuMathLibraryNumThreads(config, 1);
+  PD_SwitchUseFeedFetchOps(config, false);
+  PD_SwitchSpecifyInputNames(config, true);
+  PD_SetModel(config, FLAGS_infer_model.c_str(), NULL);
+  PD_Predictor *predictor = PD_NewPredictor(config);
+  PD_DeleteAnalysisConfig(config);
+  return predictor;
+}
+
+static void FillInput(int64_t *data, int request) {
+  for (int i = 0; i < kRows; ++i) {
+    data[i] = (request * 7 + i) % 1000;
+  }
+}
+
+// Runs through PD_SetZeroCopyInput and PD_GetZeroCopyOutput, which copy the
+// data.
+static void RunCopied(PD_Predictor *predictor, int request,
+                      PD_ZeroCopyTensor *output) {
+  int64_t data[kRows];
+  int shape[2] = {kRows, 1};
+  FillInput(data, request);
+  PD_ZeroCopyTensor input;
+  PD_InitZeroCopyTensor(&input);
+  input.data.data = data;
+  input.data.length = sizeof(data);
+  input.shape.data = shape;
+  input.shape.length = sizeof(shape);
+  input.dtype = PD_INT64;
+  for (int i = 0; i < kInputNum; ++i) {
+    input.name = const_cast<char *>(kInputNames[i]);
+    PD_SetZeroCopyInput(predictor, &input);
+  }
+  PD_ZeroCopyRun(predictor);
+  PD_GetZeroCopyOutput(predictor, output);
+}
+
+TEST(PD_ZeroCopyRunHandles, overhead) {
+  PD_Predictor *predictor = NewPredictor();
+  ASSERT_EQ(PD_GetInputNum(predictor), kInputNum);
+  ASSERT_EQ(PD_GetOutputNum(predictor), 1);
+  const char *output_name = PD_GetOutputName(predictor, 0);
+
+  PD_ZeroCopyTensor copied;
+  PD_InitZeroCopyTensor(&copied);
+  copied.name = const_cast<char *>(output_name);
+  RunCopied(predictor, 0, &copied);
+  size_t output_size = copied.data.length;
+
+  // The handles are looked up once, and bound to the memory of the caller.
+  PD_TensorHandle *inputs[kInputNum];
+  for (int i = 0; i < kInputNum; ++i) {
+    inputs[i] = PD_GetInputHandle(predictor, kInputNames[i]);
+    ASSERT_EQ(inputs[i], PD_GetInputHandle(predictor, kInputNames[i]));
+  }
+  PD_TensorHandle *output = PD_GetOutputHandle(predictor, output_name);
+  float *result = static_cast<float *>(malloc(output_size));
+  PD_ShareOutputBuffer(output, result, PD_FLOAT32, output_size);
+  int64_t data[kRows];
+  int shape[2] = {kRows, 1};
+
+  int repeat = FLAGS_repeat;
+  Timer timer;
+  timer.tic();
+  for (int r = 0; r < repeat; ++r) {
+    RunCopied(predictor, r, &copied);
+  }
+  double copied_ms = timer.toc() / repeat;
+
+  timer.tic();
+  for (int r = 0; r < repeat; ++r) {
+    FillInput(data, r);
+    for (int i = 0; i < kInputNum; ++i) {
+      PD_ShareInputData(inputs[i], data, PD_INT64, shape, 2);
+    }
+    ASSERT_TRUE(PD_ZeroCopyRunHandles(predictor));
+  }
+  double shared_ms = timer.toc() / repeat;
+  LOG(INFO) << "copied: " << copied_ms << " ms/call, shared: " << shared_ms
+            << " ms/call";
+
+  // The outputs of the last request are the same.
+  ASSERT_EQ(copied.data.length, output_size);
+  const float *expected = static_cast<const float *>(copied.data.data);
+  for (size_t i = 0; i < output_size / sizeof(float); ++i) {
+    EXPECT_NEAR(result[i], expected[i], 1e-5);
+  }
+  PD_DataType dtype;
+  size_t length = 0;
+  const void *view = PD_GetHandleData(output, &dtype, &length);
+  EXPECT_EQ(dtype, PD_FLOAT32);
+  EXPECT_EQ(length, output_size);
+  EXPECT_EQ(memcmp(view, result, length), 0);
+  int shape_size = 0;
+  const int *output_shape = PD_GetHandleShape(output, &shape_size);
+  EXPECT_EQ(shape_size, 2);
+  EXPECT_EQ(output_shape[0], kRows);
+
+  // A buffer too small for the output fails the run, and holds no output.
+  PD_ShareOutputBuffer(output, result, PD_FLOAT32, output_size / 2);
+  EXPECT_FALSE(PD_ZeroCopyRunHandles(predictor));
+  EXPECT_EQ(PD_GetHandleData(output, &dtype, &length), nullptr);
+  EXPECT_EQ(length, 0UL);
+
+  // Nor does the buffer after a run which does not write it.
+  PD_ShareOutputBuffer(output, result, PD_FLOAT32, output_size);
+  ASSERT_TRUE(PD_ZeroCopyRunHandles(predictor));
+  EXPECT_EQ(PD_GetHandleData(output, &dtype, &length), result);
+  PD_ZeroCopyRun(predictor);
+  EXPECT_EQ(PD_GetHandleData(output, &dtype, &length), nullptr);
+  PD_ShareOutputBuffer(output, NULL, PD_FLOAT32, 0);
+
+  // The buffer is not written once it is unbound.
+  memset(result, 0, output_size);
+  ASSERT_TRUE(PD_ZeroCopyRunHandles(predictor));
+  for (size_t i = 0; i < output_size / sizeof(float); ++i) {
+    ASSERT_EQ(result[i], 0.f);
+  }
+
+  copied.name = NULL;
+  PD_DestroyZeroCopyTensor(&copied);
+  free(result);
+  PD_DeletePredictor(predictor);
+}
+
+TEST(PD_ZeroCopyRunBatch, overhead) {
+  PD_Predictor *predictor = NewPredictor();
+  const int num_requests = 8;
+  int64_t data[num_requests][kRows];
+  int shape[2] = {kRows, 1};
+  PD_ZeroCopyData inputs[num_requests * kInputNum];
+  PD_ZeroCopyTensor outputs[num_requests];
+  for (int r = 0; r < num_requests; ++r) {
+    FillInput(data[r], r);
+    for (int i = 0; i < kInputNum; ++i) {
+      PD_ZeroCopyData *input = &inputs[r * kInputNum + i];
+      input->name = const_cast<char *>(kInputNames[i]);
+      input->data = data[r];
+      input->dtype = PD_INT64;
+      input->shape = shape;
+      input->shape_size = 2;
+    }
+    PD_InitZeroCopyTensor(&outputs[r]);
+  }
+
+  int repeat = FLAGS_repeat;
+  Timer timer;
+  timer.tic();
+  for (int r = 0; r < repeat; ++r) {
+    ASSERT_TRUE(PD_ZeroCopyRunBatch(predictor, inputs, kInputNum,
+                                    num_requests, outputs, 1));
+  }
+  LOG(INFO) << "batched: " << timer.toc() / repeat / num_requests
+            << " ms/request";
+
+  // Each request gets the outputs of running it alone.
+  PD_ZeroCopyTensor expected;
+  PD_InitZeroCopyTensor(&expected);
+  expected.name = const_cast<char *>(PD_GetOutputName(predictor, 0));
+  for (int r = 0; r < num_requests; ++r) {
+    RunCopied(predictor, r, &expected);
+    ASSERT_EQ(outputs[r].data.length, expected.data.length);
+    ASSERT_EQ(static_cast<int *>(outputs[r].shape.data)[0], kRows);
+    const float *out = static_cast<const float *>(outputs[r].data.data);
+    const float *ref = static_cast<const float *>(expected.data.data);
+    for (size_t i = 0; i < expected.data.length / sizeof(float); ++i) {
+      EXPECT_NEAR(out[i], ref[i], 1e-5);
+    }
+    PD_DestroyZeroCopyTensor(&outputs[r]);
+  }
+  expected.name = NULL;
+  PD_DestroyZeroCopyTensor(&expected);
+  PD_DeletePredictor(predictor);
+}
+
+}  // namespace analysis
+}  // namespace inference
+}  // namespace paddle
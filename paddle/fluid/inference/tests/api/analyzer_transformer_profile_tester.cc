@@ -36,6 +36,31 @@ void profile(bool use_mkldnn = false) {
 }
 
 TEST(Analyzer_Transformer, profile) { profile(); }
+
+// The startup time of a predictor by the passes and by the optimized program
+// cache, which is written under the model directory by the first predictor
+// enabling it.
+TEST(Analyzer_Transformer, profile_optim_program_cache) {
+  AnalysisConfig cfg;
+  SetConfig(&cfg);
+  AnalysisConfig cache_cfg(cfg);
+  cache_cfg.EnableOptimProgramCache();
+  CreatePaddlePredictor<AnalysisConfig>(cache_cfg);
+
+  double times[2] = {0, 0};
+  for (int i = 0; i < FLAGS_repeat; ++i) {
+    Timer timer;
+    timer.tic();
+    CreatePaddlePredictor<AnalysisConfig>(cfg);
+    times[0] += timer.toc();
+    timer.tic();
+    CreatePaddlePredictor<AnalysisConfig>(cache_cfg);
+    times[1] += timer.toc();
+  }
+  LOG(INFO) << "The startup time by the passes: " << times[0] / FLAGS_repeat
+            << "ms, by the optimized program cache: "
+            << times[1] / FLAGS_repeat << "ms";
+}
 #ifdef PADDLE_WITH_MKLDNN
 TEST(Analyzer_Transformer, profile_mkldnn) { profile(true); }
 #endif
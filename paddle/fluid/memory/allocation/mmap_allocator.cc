@@ -19,12 +19,19 @@
 #include <fcntl.h>
 #include <stdlib.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
 #include <random>
 #include <string>
 
+#include "gflags/gflags.h"
 #include "glog/logging.h"
 #include "paddle/fluid/platform/enforce.h"
 
+DECLARE_int32(dataloader_shm_ring_slot_num);
+DECLARE_uint64(dataloader_shm_ring_slot_size);
+
 namespace paddle {
 namespace memory {
 namespace allocation {
@@ -99,6 +106,293 @@ std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
   return std::make_shared<MemoryMapReaderAllocation>(ptr, size, ipc_name);
 }
 
+namespace {
+
+constexpr uint64_t kRingArenaMagic = 0x50445f52494e4731ULL;
+constexpr size_t kRingArenaPageSize = 4096;
+constexpr size_t kRingArenaAlignment = 64;
+
+// The header at the beginning of arena, followed by the slot states and
+// the page aligned slots.
+struct RingArenaHeader {
+  uint64_t magic;
+  uint64_t slot_num;
+  uint64_t slot_size;
+  int64_t writer_pid;
+};
+
+static_assert(sizeof(std::atomic<int32_t>) == sizeof(int32_t),
+              "std::atomic<int32_t> cannot be placed in shared memory");
+
+inline size_t AlignUp(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+inline size_t RingArenaStatesOffset() {
+  return AlignUp(sizeof(RingArenaHeader), kRingArenaAlignment);
+}
+
+inline size_t RingArenaDataOffset(size_t slot_num) {
+  return AlignUp(RingArenaStatesOffset() + slot_num * sizeof(int32_t),
+                 kRingArenaPageSize);
+}
+
+}  // namespace
+
+std::shared_ptr<MemoryMapRingArena> MemoryMapRingArena::Create(
+    size_t slot_num, size_t slot_size) {
+  PADDLE_ENFORCE_GT(slot_num, 0,
+                    platform::errors::InvalidArgument(
+                        "The slot number of ring arena should be larger than "
+                        "0, but got %d.",
+                        slot_num));
+  slot_size = AlignUp(slot_size, kRingArenaPageSize);
+  size_t size = RingArenaDataOffset(slot_num) + slot_num * slot_size;
+
+  const std::string &ipc_name = GetIPCName();
+  int fd = shm_open(ipc_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+  PADDLE_ENFORCE_NE(
+      fd, -1, platform::errors::Unavailable("File descriptor %s open failed",
+                                            ipc_name.c_str()));
+  PADDLE_ENFORCE_EQ(ftruncate(fd, size), 0,
+                    platform::errors::Unavailable(
+                        "Fruncate a file to a specified length failed!"));
+  void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  PADDLE_ENFORCE_NE(ptr, MAP_FAILED,
+                    platform::errors::Unavailable(
+                        "Memory map failed when create ring arena."));
+  close(fd);
+
+  auto *header = static_cast<RingArenaHeader *>(ptr);
+  header->magic = kRingArenaMagic;
+  header->slot_num = slot_num;
+  header->slot_size = slot_size;
+  header->writer_pid = getpid();
+  std::shared_ptr<MemoryMapRingArena> arena(
+      new MemoryMapRingArena(ptr, size, ipc_name));
+  for (size_t i = 0; i < slot_num; ++i) {
+    new (arena->SlotState(i)) std::atomic<int32_t>(0);
+  }
+  VLOG(3) << "PID: " << getpid() << ", create ring arena " << ipc_name
+          << " with " << slot_num << " slots of " << slot_size << " bytes";
+  return arena;
+}
+
+std::shared_ptr<MemoryMapRingArena> MemoryMapRingArena::Open(
+    const std::string &ipc_name) {
+  int fd = shm_open(ipc_name.c_str(), O_RDWR, 0644);
+  PADDLE_ENFORCE_NE(
+      fd, -1, platform::errors::Unavailable("File descriptor %s open failed",
+                                            ipc_name.c_str()));
+  struct stat file_stat;
+  PADDLE_ENFORCE_EQ(fstat(fd, &file_stat), 0,
+                    platform::errors::Unavailable(
+                        "Get the size of ring arena %s failed.", ipc_name));
+  size_t size = static_cast<size_t>(file_stat.st_size);
+  void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  PADDLE_ENFORCE_NE(ptr, MAP_FAILED,
+                    platform::errors::Unavailable(
+                        "Memory map failed when open ring arena."));
+  close(fd);
+  shm_unlink(ipc_name.c_str());
+
+  auto *header = static_cast<RingArenaHeader *>(ptr);
+  PADDLE_ENFORCE_EQ(header->magic, kRingArenaMagic,
+                    platform::errors::InvalidArgument(
+                        "The shared memory file %s is not a ring arena.",
+                        ipc_name));
+  VLOG(3) << "PID: " << getpid() << ", open ring arena " << ipc_name;
+  return std::shared_ptr<MemoryMapRingArena>(
+      new MemoryMapRingArena(ptr, size, ipc_name));
+}
+
+MemoryMapRingArena::~MemoryMapRingArena() {
+  PADDLE_ENFORCE_NE(munmap(base_, size_), -1,
+                    platform::errors::Unavailable(
+                        "could not unmap the ring arena %s", ipc_name_));
+}
+
+size_t MemoryMapRingArena::slot_num() const {
+  return static_cast<RingArenaHeader *>(base_)->slot_num;
+}
+
+size_t MemoryMapRingArena::slot_size() const {
+  return static_cast<RingArenaHeader *>(base_)->slot_size;
+}
+
+pid_t MemoryMapRingArena::writer_pid() const {
+  return static_cast<pid_t>(static_cast<RingArenaHeader *>(base_)->writer_pid);
+}
+
+std::atomic<int32_t> *MemoryMapRingArena::SlotState(int slot) const {
+  return reinterpret_cast<std::atomic<int32_t> *>(
+             static_cast<uint8_t *>(base_) + RingArenaStatesOffset()) +
+         slot;
+}
+
+size_t MemoryMapRingArena::SlotOffset(int slot) const {
+  return RingArenaDataOffset(slot_num()) + slot * slot_size();
+}
+
+void *MemoryMapRingArena::SlotData(int slot) const {
+  return static_cast<uint8_t *>(base_) + SlotOffset(slot);
+}
+
+int MemoryMapRingArena::AcquireSlot() {
+  auto num = slot_num();
+  for (size_t i = 0; i < num; ++i) {
+    int slot = static_cast<int>((next_slot_ + i) % num);
+    int32_t expected = 0;
+    if (SlotState(slot)->compare_exchange_strong(expected, -1,
+                                                 std::memory_order_acquire)) {
+      next_slot_ = slot + 1;
+      return slot;
+    }
+  }
+  return -1;
+}
+
+void MemoryMapRingArena::PublishSlot(int slot, int32_t ref_num) {
+  SlotState(slot)->store(ref_num, std::memory_order_release);
+}
+
+void MemoryMapRingArena::ReleaseSlot(int slot) {
+  auto prev = SlotState(slot)->fetch_sub(1, std::memory_order_release);
+  PADDLE_ENFORCE_GT(prev, 0, platform::errors::PreconditionNotMet(
+                                 "The slot %d of ring arena %s is released "
+                                 "more times than it is published.",
+                                 slot, ipc_name_));
+}
+
+MemoryMapRingReaderAllocation::~MemoryMapRingReaderAllocation() {
+  arena_->ReleaseSlot(slot_);
+}
+
+MemoryMapRingSlotWriter::MemoryMapRingSlotWriter(
+    std::shared_ptr<MemoryMapRingArena> arena)
+    : arena_(std::move(arena)) {
+  if (arena_ != nullptr) {
+    slot_ = arena_->AcquireSlot();
+    if (slot_ < 0) {
+      VLOG(3) << "PID: " << getpid() << ", no free slot in ring arena "
+              << arena_->ipc_name();
+    }
+  }
+}
+
+MemoryMapRingSlotWriter::~MemoryMapRingSlotWriter() {
+  if (slot_ >= 0) {
+    // The allocations are never sent to the reader.
+    arena_->PublishSlot(slot_, 0);
+  }
+}
+
+std::shared_ptr<MemoryMapRingWriterAllocation> MemoryMapRingSlotWriter::Allocate(
+    size_t size) {
+  if (slot_ < 0) {
+    return nullptr;
+  }
+  size_t offset = AlignUp(used_, kRingArenaAlignment);
+  if (offset + size > arena_->slot_size()) {
+    return nullptr;
+  }
+  used_ = offset + size;
+  ++alloc_num_;
+  return std::make_shared<MemoryMapRingWriterAllocation>(
+      static_cast<uint8_t *>(arena_->SlotData(slot_)) + offset, size, arena_,
+      slot_);
+}
+
+void MemoryMapRingSlotWriter::Publish() {
+  if (slot_ >= 0) {
+    arena_->PublishSlot(slot_, alloc_num_);
+    slot_ = -1;
+  }
+}
+
+std::shared_ptr<MemoryMapRingArena> GetMemoryMapRingWriterArena() {
+  static std::mutex mtx;
+  static std::shared_ptr<MemoryMapRingArena> arena;
+  if (FLAGS_dataloader_shm_ring_slot_num <= 0) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> guard(mtx);
+  // The arena may be inherited from the parent process by fork.
+  if (arena == nullptr || arena->writer_pid() != getpid()) {
+    arena = MemoryMapRingArena::Create(FLAGS_dataloader_shm_ring_slot_num,
+                                       FLAGS_dataloader_shm_ring_slot_size);
+    // Cleared at exit if it is never opened by the reader, see
+    // _remove_tensor_list_mmap_fds.
+    MemoryMapFdSet::Instance().Insert(arena->ipc_name());
+  }
+  return arena;
+}
+
+namespace {
+
+class MemoryMapRingReaderArenas {
+ public:
+  static MemoryMapRingReaderArenas &Instance() {  // NOLINT
+    static MemoryMapRingReaderArenas arenas;
+    return arenas;
+  }
+
+  std::shared_ptr<MemoryMapRingArena> Get(const std::string &ipc_name) {
+    std::lock_guard<std::mutex> guard(mtx_);
+    auto &arena = arenas_[ipc_name];
+    if (arena == nullptr) {
+      arena = MemoryMapRingArena::Open(ipc_name);
+    }
+    return arena;
+  }
+
+  void Release(const std::vector<pid_t> &writer_pids) {
+    std::lock_guard<std::mutex> guard(mtx_);
+    for (auto iter = arenas_.begin(); iter != arenas_.end();) {
+      if (std::find(writer_pids.begin(), writer_pids.end(),
+                    iter->second->writer_pid()) != writer_pids.end()) {
+        VLOG(3) << "PID: " << getpid() << ", release ring arena "
+                << iter->first;
+        iter = arenas_.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+  }
+
+ private:
+  MemoryMapRingReaderArenas() = default;
+
+  // The arenas are unlinked after opening, so they must be kept until the
+  // writers exit.
+  std::unordered_map<std::string, std::shared_ptr<MemoryMapRingArena>>
+      arenas_;
+  std::mutex mtx_;
+};
+
+}  // namespace
+
+std::shared_ptr<MemoryMapRingReaderAllocation>
+RebuildMemoryMapRingReaderAllocation(const std::string &ipc_name, int slot,
+                                     size_t offset, size_t size) {
+  auto arena = MemoryMapRingReaderArenas::Instance().Get(ipc_name);
+  PADDLE_ENFORCE_EQ(
+      slot >= 0 && static_cast<size_t>(slot) < arena->slot_num() &&
+          offset >= arena->SlotOffset(slot) &&
+          offset + size <= arena->SlotOffset(slot) + arena->slot_size(),
+      true,
+      platform::errors::OutOfRange(
+          "The memory [%d, %d) is out of the slot %d of ring arena %s.",
+          offset, offset + size, slot, ipc_name));
+  void *ptr = static_cast<uint8_t *>(arena->base()) + offset;
+  return std::make_shared<MemoryMapRingReaderAllocation>(ptr, size, arena,
+                                                         slot);
+}
+
+void ReleaseMemoryMapRingReaderArenas(const std::vector<pid_t> &writer_pids) {
+  MemoryMapRingReaderArenas::Instance().Release(writer_pids);
+}
+
 MemoryMapFdSet &MemoryMapFdSet::Instance() {  // NOLINT
   static MemoryMapFdSet set;
   return set;
@@ -16,11 +16,16 @@
 
 #ifndef _WIN32
 
+#include <sys/types.h>
+
+#include <atomic>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "paddle/fluid/memory/allocation/allocator.h"
 
@@ -64,6 +69,135 @@ std::shared_ptr<MemoryMapWriterAllocation> AllocateMemoryMapWriterAllocation(
 std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
     const std::string &ipc_name, size_t size);
 
+// A shared memory file split into fixed-size slots, which is created once
+// by each DataLoader worker and reused for all its batches. A worker packs
+// the tensors of one batch into a slot, and the main process wraps them as
+// tensors without copying. The state of each slot is stored in the file
+// header, so the slots are recycled without any extra IPC:
+//   0: free, -1: being written by the worker, n > 0: n tensors alive.
+class MemoryMapRingArena {
+ public:
+  // Create a new arena in the writer process.
+  static std::shared_ptr<MemoryMapRingArena> Create(size_t slot_num,
+                                                    size_t slot_size);
+
+  // Map an existing arena in the reader process. The file is unlinked after
+  // mapping since no one else needs to open it.
+  static std::shared_ptr<MemoryMapRingArena> Open(const std::string &ipc_name);
+
+  ~MemoryMapRingArena();
+
+  // Returns -1 if all the slots are in use.
+  int AcquireSlot();
+
+  // Hand the slot over to the reader, which will release it for ref_num
+  // times. The slot is free immediately if ref_num is 0.
+  void PublishSlot(int slot, int32_t ref_num);
+
+  void ReleaseSlot(int slot);
+
+  void *SlotData(int slot) const;
+
+  size_t SlotOffset(int slot) const;
+
+  void *base() const { return base_; }
+
+  size_t slot_num() const;
+
+  size_t slot_size() const;
+
+  pid_t writer_pid() const;
+
+  const std::string &ipc_name() const { return ipc_name_; }
+
+ private:
+  MemoryMapRingArena(void *base, size_t size, std::string ipc_name)
+      : base_(base), size_(size), ipc_name_(std::move(ipc_name)) {}
+
+  std::atomic<int32_t> *SlotState(int slot) const;
+
+  void *base_;
+  size_t size_;
+  std::string ipc_name_;
+  size_t next_slot_{0};
+};
+
+class MemoryMapRingWriterAllocation : public Allocation {
+ public:
+  explicit MemoryMapRingWriterAllocation(
+      void *ptr, size_t size, std::shared_ptr<MemoryMapRingArena> arena,
+      int slot)
+      : Allocation(ptr, size, platform::CPUPlace()),
+        arena_(std::move(arena)),
+        slot_(slot) {}
+
+  inline const std::string &ipc_name() const { return arena_->ipc_name(); }
+
+  inline int slot() const { return slot_; }
+
+  // The byte offset from the beginning of the arena.
+  inline size_t offset() const {
+    return static_cast<uint8_t *>(ptr()) -
+           static_cast<uint8_t *>(arena_->base());
+  }
+
+ private:
+  std::shared_ptr<MemoryMapRingArena> arena_;
+  int slot_;
+};
+
+class MemoryMapRingReaderAllocation : public Allocation {
+ public:
+  explicit MemoryMapRingReaderAllocation(
+      void *ptr, size_t size, std::shared_ptr<MemoryMapRingArena> arena,
+      int slot)
+      : Allocation(ptr, size, platform::CPUPlace()),
+        arena_(std::move(arena)),
+        slot_(slot) {}
+
+  ~MemoryMapRingReaderAllocation() override;
+
+ private:
+  std::shared_ptr<MemoryMapRingArena> arena_;
+  int slot_;
+};
+
+// Packs the tensors of one batch into a slot of the arena. The slot is
+// published with the number of allocations when Publish() is called, and
+// is freed directly if the writer is destroyed before publishing.
+class MemoryMapRingSlotWriter {
+ public:
+  explicit MemoryMapRingSlotWriter(std::shared_ptr<MemoryMapRingArena> arena);
+
+  ~MemoryMapRingSlotWriter();
+
+  // Returns nullptr if there is no free slot or the rest of the slot is not
+  // large enough, the caller should fall back to a standalone shared memory
+  // file.
+  std::shared_ptr<MemoryMapRingWriterAllocation> Allocate(size_t size);
+
+  void Publish();
+
+ private:
+  std::shared_ptr<MemoryMapRingArena> arena_;
+  int slot_{-1};
+  size_t used_{0};
+  int32_t alloc_num_{0};
+};
+
+// The arena of the current DataLoader worker process, which is created on
+// first use. Returns nullptr if FLAGS_dataloader_shm_ring_slot_num is 0.
+std::shared_ptr<MemoryMapRingArena> GetMemoryMapRingWriterArena();
+
+std::shared_ptr<MemoryMapRingReaderAllocation>
+RebuildMemoryMapRingReaderAllocation(const std::string &ipc_name, int slot,
+                                     size_t offset, size_t size);
+
+// Drop the arenas mapped in the main process which are created by the given
+// worker processes. The memory is released when all tensors in them are
+// destructed.
+void ReleaseMemoryMapRingReaderArenas(const std::vector<pid_t> &writer_pids);
+
 class MemoryMapFdSet {
  public:
   static MemoryMapFdSet &Instance();  // NOLINT
@@ -16,6 +16,9 @@
 
 #include "paddle/fluid/memory/allocation/mmap_allocator.h"
 
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include "gtest/gtest.h"
 
 namespace paddle {
@@ -45,6 +48,50 @@ TEST(MemoryMapAllocation, test_allocation_base) {
   }
 }
 
+TEST(MemoryMapRingArena, test_slot_reuse) {
+  size_t slot_num = 2;
+  auto arena = MemoryMapRingArena::Create(slot_num, 16UL * 1024);
+  std::string ipc_name = arena->ipc_name();
+  // 1. pack two tensors into a slot
+  MemoryMapRingSlotWriter slot_writer(arena);
+  auto first = slot_writer.Allocate(4UL * 1024);
+  auto second = slot_writer.Allocate(1000 * sizeof(int32_t));
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  ASSERT_EQ(first->slot(), second->slot());
+  ASSERT_EQ(second->offset() % 64, 0UL);
+  ASSERT_EQ(slot_writer.Allocate(arena->slot_size()), nullptr);
+  auto* writer_ptr = static_cast<int32_t*>(second->ptr());
+  for (int32_t i = 0; i < 1000; ++i) {
+    writer_ptr[i] = i;
+  }
+  slot_writer.Publish();
+  // 2. read and release the tensors in child process
+  pid_t fpid = fork();
+  if (fpid == 0) {
+    {
+      auto reader_first = RebuildMemoryMapRingReaderAllocation(
+          ipc_name, first->slot(), first->offset(), first->size());
+      auto reader_second = RebuildMemoryMapRingReaderAllocation(
+          ipc_name, second->slot(), second->offset(), second->size());
+      auto* reader_ptr = static_cast<int32_t*>(reader_second->ptr());
+      for (int32_t i = 0; i < 1000; ++i) {
+        if (reader_ptr[i] != i) _exit(1);
+      }
+    }
+    _exit(0);
+  }
+  int status = 0;
+  ASSERT_EQ(waitpid(fpid, &status, 0), fpid);
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), 0);
+  // 3. all the slots are free again
+  for (size_t i = 0; i < slot_num; ++i) {
+    ASSERT_GE(arena->AcquireSlot(), 0);
+  }
+  ASSERT_EQ(arena->AcquireSlot(), -1);
+}
+
 }  // namespace allocation
 }  // namespace memory
 }  // namespace paddle
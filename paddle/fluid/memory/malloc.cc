@@ -14,18 +14,32 @@ limitations under the License. */
 
 #include "paddle/fluid/memory/malloc.h"
 
+#include <atomic>
+
 #include "paddle/fluid/memory/allocation/allocator_facade.h"
 #include "paddle/fluid/platform/place.h"
 
 namespace paddle {
 namespace memory {
 
+static std::atomic<AllocationHook> g_allocation_hook{nullptr};
+
+static inline void CallAllocationHook(const platform::Place &place,
+                                      size_t size) {
+  auto hook = g_allocation_hook.load(std::memory_order_relaxed);
+  if (hook != nullptr) {
+    hook(place, size);
+  }
+}
+
 std::shared_ptr<Allocation> AllocShared(const platform::Place &place,
                                         size_t size) {
+  CallAllocationHook(place, size);
   return allocation::AllocatorFacade::Instance().AllocShared(place, size);
 }
 
 AllocationPtr Alloc(const platform::Place &place, size_t size) {
+  CallAllocationHook(place, size);
   return allocation::AllocatorFacade::Instance().Alloc(place, size);
 }
 
@@ -33,5 +47,9 @@ uint64_t Release(const platform::Place &place) {
   return allocation::AllocatorFacade::Instance().Release(place);
 }
 
+void SetAllocationHook(AllocationHook hook) {
+  g_allocation_hook.store(hook, std::memory_order_relaxed);
+}
+
 }  // namespace memory
 }  // namespace paddle
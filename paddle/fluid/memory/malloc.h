@@ -40,5 +40,11 @@ extern AllocationPtr Alloc(const platform::DeviceContext& dev_ctx, size_t size);
 
 extern uint64_t Release(const platform::Place& place);
 
+// A hook called by AllocShared and Alloc before allocating, e.g. to count the
+// allocations of operators in benchmark. nullptr unsets it.
+using AllocationHook = void (*)(const platform::Place& place, size_t size);
+
+extern void SetAllocationHook(AllocationHook hook);
+
 }  // namespace memory
 }  // namespace paddle
@@ -0,0 +1,329 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/benchmark/op_benchmark.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace benchmark {
+
+std::string OpBenchmarkKey(const OpTesterConfig& config) {
+  std::ostringstream os;
+  os << config.op_type << "(";
+  for (size_t i = 0; i < config.inputs.size(); ++i) {
+    const auto& input = config.inputs[i];
+    os << (i > 0 ? "," : "") << input.name << ":" << input.dtype << ":";
+    for (size_t j = 0; j < input.dims.size(); ++j) {
+      os << (j > 0 ? "x" : "") << input.dims[j];
+    }
+  }
+  os << "){";
+  // Sort the attributes to make the key stable.
+  std::map<std::string, std::string> attrs(config.attrs.begin(),
+                                           config.attrs.end());
+  bool first = true;
+  for (auto& attr : attrs) {
+    os << (first ? "" : ",") << attr.first << "=" << attr.second;
+    first = false;
+  }
+  os << "}";
+  return os.str();
+}
+
+static double Percentile(const std::vector<double>& sorted, double p) {
+  size_t idx = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+  return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+void ComputeLatencyStats(std::vector<double> latencies_ms,
+                         OpBenchmarkResult* result) {
+  result->repeat = static_cast<int>(latencies_ms.size());
+  if (latencies_ms.empty()) {
+    return;
+  }
+  std::sort(latencies_ms.begin(), latencies_ms.end());
+  result->mean_ms =
+      std::accumulate(latencies_ms.begin(), latencies_ms.end(), 0.0) /
+      latencies_ms.size();
+  result->min_ms = latencies_ms.front();
+  result->p50_ms = Percentile(latencies_ms, 0.5);
+  result->p90_ms = Percentile(latencies_ms, 0.9);
+  result->p99_ms = Percentile(latencies_ms, 0.99);
+}
+
+static int64_t Product(const std::vector<int64_t>& dims, size_t begin,
+                       size_t end) {
+  int64_t prod = 1;
+  for (size_t i = begin; i < end && i < dims.size(); ++i) {
+    prod *= dims[i];
+  }
+  return prod;
+}
+
+template <typename T>
+static T GetAttr(const OpTesterConfig& config, const std::string& name,
+                 T default_value) {
+  auto iter = config.attrs.find(name);
+  return iter == config.attrs.end() ? default_value
+                                    : StringTo<T>(iter->second);
+}
+
+static bool GetBoolAttr(const OpTesterConfig& config, const std::string& name) {
+  auto iter = config.attrs.find(name);
+  return iter != config.attrs.end() &&
+         (iter->second == "true" || iter->second == "1");
+}
+
+double EstimateOpFlops(
+    const OpTesterConfig& config,
+    const std::unordered_map<std::string, std::vector<int64_t>>& input_dims,
+    int64_t output_numel) {
+  if (config.flops > 0) {
+    return config.flops;
+  }
+  auto dims_of = [&input_dims](const std::string& name) {
+    auto iter = input_dims.find(name);
+    return iter == input_dims.end() ? std::vector<int64_t>() : iter->second;
+  };
+
+  const auto& type = config.op_type;
+  if (type == "mul") {
+    auto x_dims = dims_of("X");
+    auto y_dims = dims_of("Y");
+    auto x_num_col_dims = GetAttr<size_t>(config, "x_num_col_dims", 1);
+    auto y_num_col_dims = GetAttr<size_t>(config, "y_num_col_dims", 1);
+    return 2.0 * Product(x_dims, 0, x_num_col_dims) *
+           Product(x_dims, x_num_col_dims, x_dims.size()) *
+           Product(y_dims, y_num_col_dims, y_dims.size());
+  } else if (type == "fc") {
+    auto in_dims = dims_of("Input");
+    auto w_dims = dims_of("W");
+    auto in_num_col_dims = GetAttr<size_t>(config, "in_num_col_dims", 1);
+    // GEMM and bias
+    return (2.0 * Product(in_dims, in_num_col_dims, in_dims.size()) + 1.0) *
+           Product(in_dims, 0, in_num_col_dims) *
+           Product(w_dims, 1, w_dims.size());
+  } else if (type == "matmul" || type == "matmul_v2") {
+    auto x_dims = dims_of("X");
+    bool trans_x = type == "matmul" ? GetBoolAttr(config, "transpose_X")
+                                    : GetBoolAttr(config, "trans_x");
+    if (x_dims.empty()) {
+      return static_cast<double>(output_numel);
+    }
+    int64_t k = x_dims.back();
+    if (trans_x && x_dims.size() >= 2) {
+      k = x_dims[x_dims.size() - 2];
+    }
+    return 2.0 * output_numel * k;
+  } else if (type == "conv2d" || type == "depthwise_conv2d" ||
+             type == "conv3d") {
+    // Each output element is a dot product over Cin / groups * kernel.
+    auto filter_dims = dims_of("Filter");
+    return 2.0 * output_numel * Product(filter_dims, 1, filter_dims.size());
+  }
+  return static_cast<double>(output_numel);
+}
+
+static double* MutableField(OpBenchmarkResult* result,
+                            const std::string& name) {
+  if (name == "mean_ms") return &result->mean_ms;
+  if (name == "min_ms") return &result->min_ms;
+  if (name == "p50_ms") return &result->p50_ms;
+  if (name == "p90_ms") return &result->p90_ms;
+  if (name == "p99_ms") return &result->p99_ms;
+  if (name == "gflops") return &result->gflops;
+  if (name == "gbps") return &result->gbps;
+  if (name == "allocs_per_run") return &result->allocs_per_run;
+  return nullptr;
+}
+
+static std::string EscapeJson(const std::string& str) {
+  std::string escaped;
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped;
+}
+
+void SaveOpBenchmarkResults(const std::string& filename,
+                            const std::vector<OpBenchmarkResult>& results) {
+  std::ofstream fout(filename);
+  PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                    platform::errors::Unavailable(
+                        "Cannot open file %s to save benchmark results.",
+                        filename));
+  fout << std::setprecision(6) << "{\n";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const auto& r = results[i];
+    fout << "  \"" << EscapeJson(r.key) << "\": {\"repeat\": " << r.repeat
+         << ", \"mean_ms\": " << r.mean_ms << ", \"min_ms\": " << r.min_ms
+         << ", \"p50_ms\": " << r.p50_ms << ", \"p90_ms\": " << r.p90_ms
+         << ", \"p99_ms\": " << r.p99_ms << ", \"gflops\": " << r.gflops
+         << ", \"gbps\": " << r.gbps
+         << ", \"allocs_per_run\": " << r.allocs_per_run << "}"
+         << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  fout << "}\n";
+}
+
+namespace {
+
+// Parses the JSON written by SaveOpBenchmarkResults, which is an object of
+// objects with number values.
+class ResultsParser {
+ public:
+  explicit ResultsParser(const std::string& text) : text_(text) {}
+
+  std::map<std::string, OpBenchmarkResult> Parse() {
+    std::map<std::string, OpBenchmarkResult> results;
+    Expect('{');
+    if (!TryConsume('}')) {
+      do {
+        OpBenchmarkResult result;
+        result.key = ParseString();
+        Expect(':');
+        Expect('{');
+        if (!TryConsume('}')) {
+          do {
+            auto name = ParseString();
+            Expect(':');
+            double value = ParseNumber();
+            if (name == "repeat") {
+              result.repeat = static_cast<int>(value);
+            } else if (auto* field = MutableField(&result, name)) {
+              *field = value;
+            }
+          } while (TryConsume(','));
+          Expect('}');
+        }
+        results[result.key] = result;
+      } while (TryConsume(','));
+      Expect('}');
+    }
+    return results;
+  }
+
+ private:
+  void SkipSpaces() {
+    while (pos_ < text_.size() && std::isspace(text_[pos_])) ++pos_;
+  }
+
+  bool TryConsume(char c) {
+    SkipSpaces();
+    if (pos_ < text_.size() && text_[pos_] == c) {
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+
+  void Expect(char c) {
+    PADDLE_ENFORCE_EQ(TryConsume(c), true,
+                      platform::errors::InvalidArgument(
+                          "Expected '%c' at position %d of benchmark results.",
+                          c, pos_));
+  }
+
+  std::string ParseString() {
+    Expect('"');
+    std::string str;
+    while (pos_ < text_.size() && text_[pos_] != '"') {
+      if (text_[pos_] == '\\') ++pos_;
+      if (pos_ < text_.size()) str += text_[pos_++];
+    }
+    Expect('"');
+    return str;
+  }
+
+  double ParseNumber() {
+    SkipSpaces();
+    size_t end = pos_;
+    auto is_number_char = [](char c) {
+      return std::isdigit(c) || c == '+' || c == '-' || c == '.' || c == 'e' ||
+             c == 'E';
+    };
+    while (end < text_.size() && is_number_char(text_[end])) {
+      ++end;
+    }
+    PADDLE_ENFORCE_GT(end, pos_, platform::errors::InvalidArgument(
+                                     "Expected a number at position %d of "
+                                     "benchmark results.",
+                                     pos_));
+    double value = std::stod(text_.substr(pos_, end - pos_));
+    pos_ = end;
+    return value;
+  }
+
+  const std::string& text_;
+  size_t pos_{0};
+};
+
+}  // namespace
+
+std::map<std::string, OpBenchmarkResult> LoadOpBenchmarkResults(
+    const std::string& filename) {
+  std::ifstream fin(filename);
+  PADDLE_ENFORCE_EQ(static_cast<bool>(fin), true,
+                    platform::errors::InvalidArgument(
+                        "Cannot open benchmark results file %s.", filename));
+  std::stringstream buffer;
+  buffer << fin.rdbuf();
+  std::string text = buffer.str();
+  return ResultsParser(text).Parse();
+}
+
+int CompareOpBenchmarkResults(
+    const std::vector<OpBenchmarkResult>& results,
+    const std::map<std::string, OpBenchmarkResult>& baseline, double threshold,
+    std::ostream* os) {
+  int regressions = 0;
+  *os << std::fixed << std::setprecision(4);
+  for (auto& result : results) {
+    auto iter = baseline.find(result.key);
+    if (iter == baseline.end()) {
+      *os << "[ NEW ] " << result.key << ": p50 " << result.p50_ms << " ms\n";
+      continue;
+    }
+    const auto& base = iter->second;
+    double ratio = base.p50_ms > 0 ? result.p50_ms / base.p50_ms - 1.0 : 0.0;
+    const char* tag = "[ OK  ]";
+    if (ratio > threshold) {
+      tag = "[SLOW ]";
+      ++regressions;
+    } else if (ratio < -threshold) {
+      tag = "[FAST ]";
+    }
+    *os << tag << " " << result.key << ": p50 " << base.p50_ms << " -> "
+        << result.p50_ms << " ms (" << std::showpos << ratio * 100
+        << std::noshowpos << "%), allocs " << base.allocs_per_run << " -> "
+        << result.allocs_per_run << "\n";
+  }
+  return regressions;
+}
+
+}  // namespace benchmark
+}  // namespace operators
+}  // namespace paddle
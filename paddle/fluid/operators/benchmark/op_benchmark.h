@@ -0,0 +1,74 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/operators/benchmark/op_tester_config.h"
+
+namespace paddle {
+namespace operators {
+namespace benchmark {
+
+struct OpBenchmarkResult {
+  // Identifies the config in the baseline, see OpBenchmarkKey.
+  std::string key;
+  int repeat{0};
+  double mean_ms{0.0};
+  double min_ms{0.0};
+  double p50_ms{0.0};
+  double p90_ms{0.0};
+  double p99_ms{0.0};
+  double gflops{0.0};
+  double gbps{0.0};
+  double allocs_per_run{0.0};
+};
+
+// The key is composed of the op type, the dtypes and dims of inputs and the
+// attributes, so the same config in different files shares its baseline.
+std::string OpBenchmarkKey(const OpTesterConfig& config);
+
+// Fill the latency statistics of result with the latencies of each run.
+void ComputeLatencyStats(std::vector<double> latencies_ms,
+                         OpBenchmarkResult* result);
+
+// The floating point operations of one run. The ops which are not known are
+// counted as one operation per output element. Returns config.flops if set.
+double EstimateOpFlops(
+    const OpTesterConfig& config,
+    const std::unordered_map<std::string, std::vector<int64_t>>& input_dims,
+    int64_t output_numel);
+
+void SaveOpBenchmarkResults(const std::string& filename,
+                            const std::vector<OpBenchmarkResult>& results);
+
+std::map<std::string, OpBenchmarkResult> LoadOpBenchmarkResults(
+    const std::string& filename);
+
+// Print the difference of p50 latency between results and baseline to os.
+// Returns the number of configs which are slower than the baseline by more
+// than threshold, e.g. 0.1 means 10%.
+int CompareOpBenchmarkResults(
+    const std::vector<OpBenchmarkResult>& results,
+    const std::map<std::string, OpBenchmarkResult>& baseline, double threshold,
+    std::ostream* os);
+
+}  // namespace benchmark
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,92 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/benchmark/op_benchmark.h"
+
+#include <cstdio>
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace benchmark {
+
+TEST(op_benchmark, latency_stats) {
+  std::vector<double> latencies;
+  for (int i = 100; i > 0; --i) {
+    latencies.push_back(i);
+  }
+  OpBenchmarkResult result;
+  ComputeLatencyStats(latencies, &result);
+  EXPECT_EQ(result.repeat, 100);
+  EXPECT_DOUBLE_EQ(result.min_ms, 1.0);
+  EXPECT_DOUBLE_EQ(result.mean_ms, 50.5);
+  EXPECT_DOUBLE_EQ(result.p50_ms, 51.0);
+  EXPECT_DOUBLE_EQ(result.p90_ms, 90.0);
+  EXPECT_DOUBLE_EQ(result.p99_ms, 99.0);
+}
+
+TEST(op_benchmark, estimate_flops) {
+  OpTesterConfig config;
+  config.op_type = "mul";
+  config.attrs["x_num_col_dims"] = "1";
+  EXPECT_DOUBLE_EQ(
+      EstimateOpFlops(config, {{"X", {32, 64}}, {"Y", {64, 16}}}, 32 * 16),
+      2.0 * 32 * 64 * 16);
+
+  config.op_type = "conv2d";
+  EXPECT_DOUBLE_EQ(EstimateOpFlops(config, {{"Filter", {8, 4, 3, 3}}}, 100),
+                   2.0 * 100 * 4 * 3 * 3);
+
+  config.flops = 123.0;
+  EXPECT_DOUBLE_EQ(EstimateOpFlops(config, {}, 100), 123.0);
+}
+
+TEST(op_benchmark, compare_with_baseline) {
+  OpTesterConfig config;
+  config.op_type = "elementwise_add";
+  config.inputs.resize(2);
+  config.inputs[0].name = "X";
+  config.inputs[0].dims = {64, 64};
+  config.inputs[1].name = "Y";
+  config.inputs[1].dims = {64, 1};
+  config.attrs["axis"] = "0";
+
+  std::vector<OpBenchmarkResult> results(2);
+  results[0].key = OpBenchmarkKey(config);
+  EXPECT_EQ(results[0].key,
+            "elementwise_add(X:fp32:64x64,Y:fp32:64x1){axis=0}");
+  results[0].p50_ms = 1.0;
+  results[0].allocs_per_run = 1.0;
+  results[1].key = "relu(X:fp32:8){}";
+  results[1].p50_ms = 2.0;
+
+  std::string filename = "op_benchmark_test_baseline.json";
+  SaveOpBenchmarkResults(filename, results);
+  auto baseline = LoadOpBenchmarkResults(filename);
+  std::remove(filename.c_str());
+  ASSERT_EQ(baseline.size(), 2UL);
+  EXPECT_DOUBLE_EQ(baseline[results[0].key].p50_ms, 1.0);
+  EXPECT_DOUBLE_EQ(baseline[results[0].key].allocs_per_run, 1.0);
+
+  results[0].p50_ms = 1.5;
+  results[1].p50_ms = 2.1;
+  std::ostringstream os;
+  EXPECT_EQ(CompareOpBenchmarkResults(results, baseline, 0.1, &os), 1);
+}
+
+}  // namespace benchmark
+}  // namespace operators
+}  // namespace paddle
@@ -13,16 +13,20 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/benchmark/op_tester.h"
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include "gflags/gflags.h"
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/op_info.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/variable_helper.h"
+#include "paddle/fluid/memory/malloc.h"
 #include "paddle/fluid/platform/init.h"
 #include "paddle/fluid/platform/profiler.h"
 #include "paddle/fluid/platform/timer.h"
 #include "paddle/fluid/pybind/pybind.h"
+#include "paddle/fluid/string/string_helper.h"
 
 namespace paddle {
 namespace operators {
@@ -30,6 +34,20 @@ namespace benchmark {
 
 DEFINE_string(op_config_list, "", "Path of op config file.");
 DEFINE_int32(specified_config_id, -1, "Test the specified op config.");
+DEFINE_string(op_benchmark_output, "",
+              "Path to save the benchmark results of all configs as JSON.");
+DEFINE_string(op_benchmark_baseline, "",
+              "Path of the baseline JSON to compare the results with.");
+DEFINE_double(op_benchmark_threshold, 0.1,
+              "The relative p50 latency increase reported as regression.");
+
+// The allocations made while running the operator, counted by the hook of
+// memory::Alloc.
+static std::atomic<uint64_t> g_allocation_count{0};
+
+static void CountAllocation(const platform::Place &place, size_t size) {
+  g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+}
 
 void OpTester::Init(const std::string &filename) {
   Init(OpTesterConfig(filename));
@@ -40,12 +58,35 @@ void OpTester::Init(const OpTesterConfig &config) {
 
   auto &op_desc_info = framework::OpInfoMap::Instance();
   // Initialize the OpDesc
-  if (op_desc_info.Has(config_.op_type)) {
+  if (op_desc_info.Has(config_.op_type) &&
+      op_desc_info.Get(config_.op_type).HasOpProtoAndChecker()) {
     type_ = config_.op_type;
 
     CreateOpDesc();
     CreateInputVarDesc();
     CreateOutputVarDesc();
+  } else if (op_desc_info.Has(config_.op_type)) {
+    // The grad operators have no proto, which are made by the grad op maker
+    // of the forward operator, e.g. lookup_table_v2 of lookup_table_v2_grad.
+    std::string suffix = "_grad";
+    PADDLE_ENFORCE_EQ(
+        config_.op_type.size() > suffix.size() &&
+            config_.op_type.compare(config_.op_type.size() - suffix.size(),
+                                    suffix.size(), suffix) == 0,
+        true, platform::errors::Unimplemented(
+                  "Operator '%s' has no proto and is not a grad operator, "
+                  "which is not supported in OpTester.",
+                  config_.op_type));
+    type_ = config_.op_type.substr(0, config_.op_type.size() - suffix.size());
+    PADDLE_ENFORCE_EQ(
+        op_desc_info.Has(type_) && op_desc_info.Get(type_).HasGradOpMaker(),
+        true, platform::errors::NotFound(
+                  "The forward operator '%s' of '%s' is not registered with "
+                  "a grad op maker in OpTester.",
+                  type_, config_.op_type));
+
+    CreateOpDesc();
+    CreateGradOpDesc();
   } else {
     PADDLE_THROW(platform::errors::NotFound(
         "Operator '%s' is not registered in OpTester.", config_.op_type));
@@ -70,9 +111,10 @@ void OpTester::Run() {
   }
 
   // Warm up
-  RunImpl();
+  for (int i = std::max(config_.warmup, 1); i > 0; --i) {
+    RunImpl();
+  }
 
-  platform::Timer timer;
   if (config_.profile) {
     if (platform::is_cpu_place(place_)) {
       platform::EnableProfiler(platform::ProfilerState::kCPU);
@@ -85,24 +127,86 @@ void OpTester::Run() {
           "'CUDAPlace' is not supported in CPU only device."));
 #endif
     }
+  }
 
+  // Each run is timed separately to get the latency percentiles.
+  std::vector<double> latencies_ms;
+  latencies_ms.reserve(config_.repeat);
+  g_allocation_count.store(0, std::memory_order_relaxed);
+  memory::SetAllocationHook(&CountAllocation);
+  platform::Timer timer;
+  for (int i = config_.repeat; i > 0; --i) {
+    timer.Reset();
     timer.Start();
-    for (int i = config_.repeat; i > 0; --i) {
-      RunImpl();
-    }
+    RunImpl();
     timer.Pause();
+    latencies_ms.push_back(timer.ElapsedMS());
+  }
+  memory::SetAllocationHook(nullptr);
+  uint64_t alloc_num = g_allocation_count.load(std::memory_order_relaxed);
+
+  if (config_.profile) {
     platform::DisableProfiler(platform::EventSortingKey::kDefault,
                               "op_tester_profiler");
-  } else {
-    timer.Start();
-    for (int i = config_.repeat; i > 0; --i) {
-      RunImpl();
-    }
-    timer.Pause();
   }
-  config_.runtime = timer.ElapsedMS() / config_.repeat;
+
+  CollectResult(latencies_ms, alloc_num);
+  config_.runtime = result_.mean_ms;
   LOG(INFO) << "=== Run " << config_.repeat
-            << " times, latency: " << config_.runtime << " ms ===";
+            << " times, latency: " << config_.runtime
+            << " ms, p50: " << result_.p50_ms << " ms, p90: " << result_.p90_ms
+            << " ms, p99: " << result_.p99_ms << " ms, " << result_.gflops
+            << " GFLOPS, " << result_.gbps << " GB/s, "
+            << result_.allocs_per_run << " allocations per run ===";
+}
+
+void OpTester::CollectResult(const std::vector<double> &latencies_ms,
+                             uint64_t alloc_num) {
+  result_ = OpBenchmarkResult();
+  result_.key = OpBenchmarkKey(config_);
+  ComputeLatencyStats(latencies_ms, &result_);
+  if (latencies_ms.empty()) {
+    return;
+  }
+  result_.allocs_per_run = static_cast<double>(alloc_num) / config_.repeat;
+
+  // The memory traffic is counted as reading all inputs and writing all
+  // outputs once.
+  size_t bytes = 0;
+  std::unordered_map<std::string, std::vector<int64_t>> input_dims;
+  for (auto &name : op_desc_.InputNames()) {
+    auto *var = scope_->FindVar(op_desc_.Input(name)[0]);
+    if (var != nullptr && var->IsType<framework::LoDTensor>()) {
+      auto &tensor = var->Get<framework::LoDTensor>();
+      input_dims[name] = framework::vectorize(tensor.dims());
+      if (tensor.IsInitialized()) {
+        bytes += tensor.numel() * framework::SizeOfType(tensor.type());
+      }
+    }
+  }
+  int64_t output_numel = 0;
+  for (auto &name : op_desc_.OutputNames()) {
+    auto *var = scope_->FindVar(op_desc_.Output(name)[0]);
+    if (var != nullptr && var->IsType<framework::LoDTensor>()) {
+      auto &tensor = var->Get<framework::LoDTensor>();
+      if (tensor.IsInitialized()) {
+        // Only the first output is used to estimate the flops, the others
+        // are usually auxiliary outputs such as XShape.
+        if (output_numel == 0) {
+          output_numel = tensor.numel();
+        }
+        bytes += tensor.numel() * framework::SizeOfType(tensor.type());
+      }
+    }
+  }
+
+  double flops = EstimateOpFlops(config_, input_dims, output_numel);
+  // GFLOPS and GB/s are the same as flops and bytes per nanosecond.
+  double ns = result_.p50_ms * 1e6;
+  if (ns > 0) {
+    result_.gflops = flops / ns;
+    result_.gbps = bytes / ns;
+  }
 }
 
 void OpTester::RunImpl() {
@@ -205,7 +309,7 @@ void OpTester::CreateOutputVarDesc() {
 }
 
 void OpTester::CreateOpDesc() {
-  op_desc_.SetType(config_.op_type);
+  op_desc_.SetType(type_);
   std::unordered_map<std::string, framework::proto::AttrType> attr_types =
       GetOpProtoAttrNames();
   for (auto item : config_.attrs) {
@@ -231,8 +335,15 @@ void OpTester::CreateOpDesc() {
       case framework::proto::AttrType::STRING: {
         op_desc_.SetAttr(name, {value_str});
       } break;
+      case framework::proto::AttrType::INTS: {
+        // The values are separated by commas, e.g. axis: 0,2,3,1;
+        std::vector<int> values;
+        for (auto &str : string::split_string<std::string>(value_str, ",")) {
+          values.push_back(StringTo<int>(str));
+        }
+        op_desc_.SetAttr(name, values);
+      } break;
       case framework::proto::AttrType::BOOLEANS:
-      case framework::proto::AttrType::INTS:
       case framework::proto::AttrType::FLOATS:
       case framework::proto::AttrType::STRINGS:
         PADDLE_THROW(platform::errors::Unimplemented(
@@ -250,6 +361,60 @@ void OpTester::CreateOpDesc() {
   }
 }
 
+void OpTester::CreateGradOpDesc() {
+  // The forward op with the variables named by its proto, of which the
+  // attributes not given by config are the defaults.
+  for (auto &name : GetOpProtoInputNames()) {
+    op_desc_.SetInput(name, {type_ + "." + name});
+  }
+  for (auto &name : GetOpProtoOutputNames()) {
+    op_desc_.SetOutput(name, {type_ + "." + name});
+  }
+  op_desc_.CheckAttrs();
+
+  std::unordered_map<std::string, std::string> grad_to_var;
+  const auto &grad_op_maker =
+      framework::OpInfoMap::Instance().Get(type_).GradOpMaker();
+  auto grad_op_descs = grad_op_maker(op_desc_, {}, &grad_to_var, {});
+  auto it = std::find_if(
+      grad_op_descs.begin(), grad_op_descs.end(),
+      [&](const std::unique_ptr<framework::OpDesc> &desc) {
+        return desc->Type() == config_.op_type;
+      });
+  PADDLE_ENFORCE_NE(it, grad_op_descs.end(),
+                    platform::errors::NotFound(
+                        "The grad op maker of '%s' does not make '%s'.", type_,
+                        config_.op_type));
+  op_desc_.CopyFrom(**it);
+  type_ = config_.op_type;
+
+  // The inputs of the grad op, such as Out@GRAD, are given by config by the
+  // names of the grad op.
+  for (auto &name : op_desc_.InputNames()) {
+    const OpInputConfig *input = config_.GetInput(name);
+    PADDLE_ENFORCE_NOT_NULL(
+        input, platform::errors::NotFound(
+                   "The input %s of operator %s is not correctlly provided.",
+                   name, config_.op_type));
+    for (auto &var_name : op_desc_.Input(name)) {
+      framework::VarDesc *var = Var(var_name);
+      var->SetType(framework::proto::VarType::LOD_TENSOR);
+      var->SetPersistable(false);
+      var->SetDataType(TransToVarType(input->dtype));
+      var->SetShape(input->dims);
+      inputs_[var_name] = *input;
+    }
+  }
+  for (auto &name : op_desc_.OutputNames()) {
+    for (auto &var_name : op_desc_.Output(name)) {
+      framework::VarDesc *var = Var(var_name);
+      var->SetType(framework::proto::VarType::LOD_TENSOR);
+      var->SetPersistable(false);
+      var->SetDataType(framework::proto::VarType::FP32);
+    }
+  }
+}
+
 framework::VarDesc *OpTester::Var(const std::string &name) {
   auto it = vars_.find(name);
   if (it != vars_.end()) {
@@ -281,21 +446,22 @@ void OpTester::SetupTensor(framework::LoDTensor *tensor,
     cpu_ptr = ptr;
   }
 
+  int64_t numel = tensor->numel();
   if (initializer == "random") {
-    for (int i = 0; i < cpu_tensor.numel(); ++i) {
+    for (int64_t i = 0; i < numel; ++i) {
       cpu_ptr[i] = static_cast<T>(uniform_dist(rng) * (upper - lower) + lower);
     }
   } else if (initializer == "natural") {
-    for (int i = 0; i < cpu_tensor.numel(); ++i) {
+    for (int64_t i = 0; i < numel; ++i) {
       cpu_ptr[i] = static_cast<T>(lower + i);
     }
   } else if (initializer == "zeros") {
-    for (int i = 0; i < cpu_tensor.numel(); ++i) {
+    for (int64_t i = 0; i < numel; ++i) {
       cpu_ptr[i] = static_cast<T>(0);
     }
   } else if (initializer == "file") {
     std::ifstream is(filename);
-    for (int i = 0; i < cpu_tensor.numel(); ++i) {
+    for (int64_t i = 0; i < numel; ++i) {
       T value;
       is >> value;
       cpu_ptr[i] = static_cast<T>(value);
@@ -340,20 +506,22 @@ void OpTester::CreateVariables(framework::Scope *scope) {
     auto *var = scope->Var(var_name);
     auto *tensor = var->GetMutable<framework::LoDTensor>();
     const auto &data_type = var_desc->GetDataType();
+    const auto &input = item.second;
     if (data_type == framework::proto::VarType::INT32) {
-      SetupTensor<int>(tensor, shape, 0, 1, item.second.initializer,
-                       item.second.filename);
+      SetupTensor<int>(tensor, shape, static_cast<int>(input.lower),
+                       static_cast<int>(input.upper), input.initializer,
+                       input.filename);
     } else if (data_type == framework::proto::VarType::INT64) {
-      SetupTensor<int64_t>(tensor, shape, 0, 1, item.second.initializer,
-                           item.second.filename);
+      SetupTensor<int64_t>(tensor, shape, static_cast<int64_t>(input.lower),
+                           static_cast<int64_t>(input.upper),
+                           input.initializer, input.filename);
     } else if (data_type == framework::proto::VarType::FP32) {
-      SetupTensor<float>(tensor, shape, static_cast<float>(0.0),
-                         static_cast<float>(1.0), item.second.initializer,
-                         item.second.filename);
+      SetupTensor<float>(tensor, shape, static_cast<float>(input.lower),
+                         static_cast<float>(input.upper), input.initializer,
+                         input.filename);
     } else if (data_type == framework::proto::VarType::FP64) {
-      SetupTensor<double>(tensor, shape, static_cast<double>(0.0),
-                          static_cast<double>(1.0), item.second.initializer,
-                          item.second.filename);
+      SetupTensor<double>(tensor, shape, input.lower, input.upper,
+                          input.initializer, input.filename);
     } else {
       PADDLE_THROW(platform::errors::Unimplemented(
           "Unsupported dtype %d in OpTester.", data_type));
@@ -487,7 +655,26 @@ std::string OpTester::DebugString() {
   return ss.str();
 }
 
+static void ReportResults(const std::vector<OpBenchmarkResult> &results) {
+  if (!FLAGS_op_benchmark_output.empty()) {
+    SaveOpBenchmarkResults(FLAGS_op_benchmark_output, results);
+    LOG(INFO) << "Save benchmark results to " << FLAGS_op_benchmark_output;
+  }
+  if (!FLAGS_op_benchmark_baseline.empty()) {
+    auto baseline = LoadOpBenchmarkResults(FLAGS_op_benchmark_baseline);
+    std::ostringstream os;
+    int regressions = CompareOpBenchmarkResults(
+        results, baseline, FLAGS_op_benchmark_threshold, &os);
+    LOG(INFO) << "Compare with baseline " << FLAGS_op_benchmark_baseline
+              << ":\n"
+              << os.str();
+    EXPECT_EQ(regressions, 0) << regressions
+                              << " configs are slower than the baseline.";
+  }
+}
+
 TEST(op_tester, base) {
+  std::vector<OpBenchmarkResult> results;
   if (!FLAGS_op_config_list.empty()) {
     std::ifstream fin(FLAGS_op_config_list, std::ios::in | std::ios::binary);
     PADDLE_ENFORCE_EQ(
@@ -508,11 +695,13 @@ TEST(op_tester, base) {
       OpTester tester;
       tester.Init(op_configs[FLAGS_specified_config_id]);
       tester.Run();
+      results.push_back(tester.result());
     } else {
       for (size_t i = 0; i < op_configs.size(); ++i) {
         OpTester tester;
         tester.Init(op_configs[i]);
         tester.Run();
+        results.push_back(tester.result());
       }
     }
   } else {
@@ -526,7 +715,9 @@ TEST(op_tester, base) {
     config.inputs[1].dims = {64, 1};
     tester.Init(config);
     tester.Run();
+    results.push_back(tester.result());
   }
+  ReportResults(results);
 }
 
 }  // namespace benchmark
@@ -21,6 +21,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/ddim.h"
 #include "paddle/fluid/framework/op_desc.h"
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/operators/benchmark/op_benchmark.h"
 #include "paddle/fluid/operators/benchmark/op_tester_config.h"
 
 namespace paddle {
@@ -38,6 +39,8 @@ class OpTester {
 
   std::string DebugString();
 
+  const OpBenchmarkResult &result() const { return result_; }
+
  private:
   std::vector<std::string> GetOpProtoInputNames();
   std::vector<std::string> GetOpProtoOutputNames();
@@ -48,6 +51,7 @@ class OpTester {
   void CreateInputVarDesc();
   void CreateOutputVarDesc();
   void CreateOpDesc();
+  void CreateGradOpDesc();
 
   framework::VarDesc *Var(const std::string &name);
   void CreateVariables(framework::Scope *scope);
@@ -59,6 +63,9 @@ class OpTester {
 
   void RunImpl();
 
+  void CollectResult(const std::vector<double> &latencies_ms,
+                     uint64_t alloc_num);
+
  private:
   OpTesterConfig config_;
   std::string type_;
@@ -68,6 +75,7 @@ class OpTester {
   std::unique_ptr<framework::OperatorBase> op_;
   platform::Place place_;
   std::unique_ptr<framework::Scope> scope_;
+  OpBenchmarkResult result_;
 };
 
 }  // namespace benchmark
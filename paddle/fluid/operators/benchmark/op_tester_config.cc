@@ -56,6 +56,8 @@ OpInputConfig::OpInputConfig(std::istream& is) {
         ParseDims(is);
       } else if (sep == "lod" || sep == "lod:") {
         ParseLoD(is);
+      } else if (sep == "range" || sep == "range:") {
+        ParseRange(is);
       } else if (sep == "filename") {
         is >> filename;
         EraseEndSep(&filename);
@@ -113,6 +115,28 @@ void OpInputConfig::ParseDims(std::istream& is) {
   }
 }
 
+void OpInputConfig::ParseRange(std::istream& is) {
+  std::string range_str;
+  is >> range_str;
+  EraseEndSep(&range_str);
+
+  auto comma = range_str.find(',');
+  PADDLE_ENFORCE_NE(comma, std::string::npos,
+                    platform::errors::InvalidArgument(
+                        "The range of input %s should be lower,upper, but "
+                        "got %s.",
+                        name, range_str));
+  lower = StringTo<double>(range_str.substr(0, comma));
+  upper = StringTo<double>(range_str.substr(comma + 1));
+  PADDLE_ENFORCE_LT(lower, upper,
+                    platform::errors::InvalidArgument(
+                        "The range of input %s should not be empty, but got "
+                        "%s.",
+                        name, range_str));
+  VLOG(4) << "range of input " << name << " is: [" << lower << ", " << upper
+          << ")";
+}
+
 void OpInputConfig::ParseLoD(std::istream& is) {
   std::string lod_str;
   std::string start_sep =
@@ -179,8 +203,12 @@ bool OpTesterConfig::Init(std::istream& is) {
         is >> op_type;
       } else if (sep == "device_id" || sep == "device_id:") {
         is >> device_id;
+      } else if (sep == "warmup" || sep == "warmup:") {
+        is >> warmup;
       } else if (sep == "repeat" || sep == "repeat:") {
         is >> repeat;
+      } else if (sep == "flops" || sep == "flops:") {
+        is >> flops;
       } else if (sep == "profile" || sep == "profile:") {
         is >> profile;
       } else if (sep == "print_debug_string" || sep == "print_debug_string:") {
@@ -32,6 +32,7 @@ struct OpInputConfig {
   void ParseInitializer(std::istream& is);
   void ParseDims(std::istream& is);
   void ParseLoD(std::istream& is);
+  void ParseRange(std::istream& is);
 
   std::string name;
   std::string dtype{"fp32"};  // int32/int, int64/long, fp32/float, fp64/double
@@ -39,6 +40,10 @@ struct OpInputConfig {
   std::string filename{""};
   std::vector<int64_t> dims;
   std::vector<std::vector<size_t>> lod;
+  // The values of random are in [lower, upper), e.g. range 0,100000 for the
+  // ids of a table of 100000 rows.
+  double lower{0.0};
+  double upper{1.0};
 };
 
 struct OpTesterConfig {
@@ -55,10 +60,13 @@ struct OpTesterConfig {
   std::vector<OpInputConfig> inputs;
   std::unordered_map<std::string, std::string> attrs;
   int device_id{-1};  // CPU: -1
+  int warmup{1};
   int repeat{1};
   int profile{0};
   int print_debug_string{0};
   double runtime{0.0};
+  // The floating point operations of one run, estimated if it is 0.
+  double flops{0.0};
 };
 
 static bool Has(const std::vector<std::string>& vec, const std::string& item) {
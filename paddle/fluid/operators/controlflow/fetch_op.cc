@@ -18,15 +18,30 @@ limitations under the License. */
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/profiler.h"
 
+DECLARE_bool(executor_zero_copy_feed_fetch);
+
 namespace paddle {
 namespace operators {
 
+// Whether the fetched tensor shares its memory instead of being copied.
+static bool ShareFetchedData(const framework::LoDTensor &src_item) {
+  if (!FLAGS_executor_zero_copy_feed_fetch) return false;
+  if (!platform::is_cpu_place(src_item.place())) return false;
+#ifdef PADDLE_WITH_MKLDNN
+  if (src_item.layout() == framework::DataLayout::kMKLDNN) return false;
+#endif
+  return true;
+}
+
 // FIXME(yuyang18): Should we assume the fetch operator always generate
 // CPU outputs?
 static void DataCopy(const framework::LoDTensor &src_item,
                      const std::string &fetch_var_name,
                      framework::LoDTensor *dst_item) {
-  if (src_item.IsInitialized() && src_item.numel() > 0) {
+  if (src_item.IsInitialized() && src_item.numel() > 0 &&
+      ShareFetchedData(src_item)) {
+    dst_item->ShareDataWith(src_item);
+  } else if (src_item.IsInitialized() && src_item.numel() > 0) {
 #ifdef PADDLE_WITH_MKLDNN
     // Conversion from MKL-DNN to Paddle
     if (src_item.layout() == framework::DataLayout::kMKLDNN) {
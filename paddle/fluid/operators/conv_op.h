@@ -16,12 +16,14 @@ limitations under the License. */
 
 #include <algorithm>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/layout_utils.h"
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/cpu_conv.h"
 #include "paddle/fluid/operators/math/depthwise_conv.h"
 #include "paddle/fluid/operators/math/im2col.h"
 #include "paddle/fluid/operators/math/vol2col.h"
@@ -214,6 +216,52 @@ class ConvOpDoubleGrad : public framework::OperatorWithKernel {
       const framework::ExecutionContext& ctx) const override;
 };
 
+// The 2D convolution of NCHW input on CPU, whose algorithm is chosen by
+// math::SearchCPUConvAlgo. paddings are {top, bottom, left, right}.
+template <typename DeviceContext, typename T>
+typename std::enable_if<
+    std::is_same<DeviceContext, platform::CPUDeviceContext>::value, bool>::type
+TryCPUConv2D(const DeviceContext& dev_ctx, const Tensor& input,
+             const Tensor& filter, const std::vector<int>& strides,
+             const std::vector<int>& paddings,
+             const std::vector<int>& dilations, int groups, Tensor* output) {
+  if (filter.dims().size() != 4) return false;
+  math::CPUConv2DParam param;
+  param.batch_size = static_cast<int>(input.dims()[0]);
+  param.in_channels = static_cast<int>(input.dims()[1]);
+  param.in_h = static_cast<int>(input.dims()[2]);
+  param.in_w = static_cast<int>(input.dims()[3]);
+  param.out_channels = static_cast<int>(output->dims()[1]);
+  param.out_h = static_cast<int>(output->dims()[2]);
+  param.out_w = static_cast<int>(output->dims()[3]);
+  param.filter_h = static_cast<int>(filter.dims()[2]);
+  param.filter_w = static_cast<int>(filter.dims()[3]);
+  param.groups = groups;
+  param.stride_h = strides[0];
+  param.stride_w = strides[1];
+  param.pad_top = paddings[0];
+  param.pad_bottom = paddings[1];
+  param.pad_left = paddings[2];
+  param.pad_right = paddings[3];
+  param.dilation_h = dilations[0];
+  param.dilation_w = dilations[1];
+  auto algo =
+      math::SearchCPUConvAlgo<T>(dev_ctx, param, input, filter, output);
+  math::CPUConv2DFunctor<T>()(dev_ctx, algo, param, input, filter, output);
+  return true;
+}
+
+template <typename DeviceContext, typename T>
+typename std::enable_if<
+    !std::is_same<DeviceContext, platform::CPUDeviceContext>::value,
+    bool>::type
+TryCPUConv2D(const DeviceContext& dev_ctx, const Tensor& input,
+             const Tensor& filter, const std::vector<int>& strides,
+             const std::vector<int>& paddings,
+             const std::vector<int>& dilations, int groups, Tensor* output) {
+  return false;
+}
+
 template <typename DeviceContext, typename T>
 class GemmConvKernel : public framework::OpKernel<T> {
  public:
@@ -266,6 +314,16 @@ class GemmConvKernel : public framework::OpKernel<T> {
 
     auto& dev_ctx = context.template device_context<DeviceContext>();
 
+    if (TryCPUConv2D<DeviceContext, T>(dev_ctx, transformed_input, filter,
+                                       strides, paddings, dilations, groups,
+                                       &transformed_output)) {
+      if (channel_last) {
+        TransToChannelLast<DeviceContext, T>(context, &transformed_output,
+                                             output);
+      }
+      return;
+    }
+
     const int batch_size = static_cast<int>(transformed_input.dims()[0]);
 
     // filter_shape_vec:
@@ -19,6 +19,7 @@ limitations under the License. */
 #include <algorithm>
 #include <functional>  // for multiplies
 #include <iterator>
+#include <numeric>
 #include <vector>
 
 #include "paddle/fluid/framework/eigen.h"
@@ -167,6 +168,134 @@ inline void GetBroadcastDimsArrays(const framework::DDim &x_dims,
   }
 }
 
+// The broadcast of two operands on CPU. The dims of output which are 1 are
+// dropped and the adjacent dims in which both x and y are either broadcast or
+// not are coalesced, e.g. x = [2, 3, 4, 5], y = [1, 3, 4, 1] is computed as
+// x = [2, 12, 5], y = [1, 12, 1]. The broadcast dims have stride 0, so the
+// offsets of each row are computed only once and the innermost dim is a
+// contiguous or scalar run.
+struct ElementwiseBroadcastCPUPlan {
+  ElementwiseBroadcastCPUPlan(const int *x_dims_array, const int *y_dims_array,
+                              const int *out_dims_array, int max_dim) {
+    numel = 1;
+    std::vector<bool> x_bcast, y_bcast;
+    for (int i = 0; i < max_dim; ++i) {
+      int64_t out_dim = out_dims_array[i];
+      if (out_dim <= 0) {
+        numel = 0;
+        return;
+      }
+      if (out_dim == 1) {
+        continue;
+      }
+      bool xb = x_dims_array[i] != out_dim;
+      bool yb = y_dims_array[i] != out_dim;
+      if (!dims.empty() && x_bcast.back() == xb && y_bcast.back() == yb) {
+        dims.back() *= out_dim;
+      } else {
+        dims.push_back(out_dim);
+        x_bcast.push_back(xb);
+        y_bcast.push_back(yb);
+      }
+      numel *= out_dim;
+    }
+    if (dims.empty()) {
+      dims.push_back(1);
+      x_bcast.push_back(false);
+      y_bcast.push_back(false);
+    }
+    int nd = static_cast<int>(dims.size());
+    x_strides.resize(nd);
+    y_strides.resize(nd);
+    out_strides.resize(nd);
+    int64_t x_stride = 1, y_stride = 1, out_stride = 1;
+    for (int i = nd - 1; i >= 0; --i) {
+      x_strides[i] = x_bcast[i] ? 0 : x_stride;
+      y_strides[i] = y_bcast[i] ? 0 : y_stride;
+      out_strides[i] = out_stride;
+      x_stride *= x_bcast[i] ? 1 : dims[i];
+      y_stride *= y_bcast[i] ? 1 : dims[i];
+      out_stride *= dims[i];
+    }
+  }
+
+  int64_t inner() const { return dims.back(); }
+
+  // Add the offsets of index, which is flattened over the given axes, to
+  // the offsets of x, y and out.
+  void AddOffsets(const std::vector<int> &axes, int64_t index, int64_t *x_off,
+                  int64_t *y_off, int64_t *out_off) const {
+    for (int i = static_cast<int>(axes.size()) - 1; i >= 0; --i) {
+      int axis = axes[i];
+      int64_t idx = index % dims[axis];
+      index /= dims[axis];
+      *x_off += idx * x_strides[axis];
+      *y_off += idx * y_strides[axis];
+      *out_off += idx * out_strides[axis];
+    }
+  }
+
+  std::vector<int64_t> dims;
+  std::vector<int64_t> x_strides;
+  std::vector<int64_t> y_strides;
+  std::vector<int64_t> out_strides;
+  int64_t numel;
+};
+
+// The number of elements under which the broadcast runs in single thread.
+constexpr int64_t kElementwiseBroadcastParallelNumel = 1 << 15;
+
+template <bool kXContiguous, bool kYContiguous, bool kSwap, typename Functor,
+          typename T, typename OutType>
+inline void ElementwiseBroadcastInnerLoop(const T *x, const T *y,
+                                          OutType *out, int64_t n,
+                                          Functor func) {
+  for (int64_t i = 0; i < n; ++i) {
+    const T &a = x[kXContiguous ? i : 0];
+    const T &b = y[kYContiguous ? i : 0];
+    out[i] = kSwap ? func(b, a) : func(a, b);
+  }
+}
+
+template <bool kSwap, typename Functor, typename T, typename OutType>
+inline void ElementwiseBroadcastInnerRun(const T *x, int64_t x_stride,
+                                         const T *y, int64_t y_stride,
+                                         OutType *out, int64_t n,
+                                         Functor func) {
+  if (x_stride != 0 && y_stride != 0) {
+    ElementwiseBroadcastInnerLoop<true, true, kSwap>(x, y, out, n, func);
+  } else if (x_stride != 0) {
+    ElementwiseBroadcastInnerLoop<true, false, kSwap>(x, y, out, n, func);
+  } else if (y_stride != 0) {
+    ElementwiseBroadcastInnerLoop<false, true, kSwap>(x, y, out, n, func);
+  } else {
+    ElementwiseBroadcastInnerLoop<false, false, kSwap>(x, y, out, n, func);
+  }
+}
+
+template <bool kSwap, typename Functor, typename T, typename OutType>
+void ElementwiseBroadcastForwardCPU(const ElementwiseBroadcastCPUPlan &plan,
+                                    const T *x_data, const T *y_data,
+                                    OutType *out_data, Functor func) {
+  int nd = static_cast<int>(plan.dims.size());
+  int64_t inner = plan.inner();
+  int64_t outer = plan.numel / inner;
+  int64_t x_inner_stride = plan.x_strides[nd - 1];
+  int64_t y_inner_stride = plan.y_strides[nd - 1];
+  std::vector<int> outer_axes(nd - 1);
+  std::iota(outer_axes.begin(), outer_axes.end(), 0);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (plan.numel > kElementwiseBroadcastParallelNumel)
+#endif
+  for (int64_t i = 0; i < outer; ++i) {
+    int64_t x_off = 0, y_off = 0, out_off = 0;
+    plan.AddOffsets(outer_axes, i, &x_off, &y_off, &out_off);
+    ElementwiseBroadcastInnerRun<kSwap>(x_data + x_off, x_inner_stride,
+                                        y_data + y_off, y_inner_stride,
+                                        out_data + out_off, inner, func);
+  }
+}
+
 template <typename Functor, typename T, typename OutType = T>
 void CommonForwardBroadcastCPU(const framework::Tensor *x,
                                const framework::Tensor *y, framework::Tensor *z,
@@ -175,24 +304,21 @@ void CommonForwardBroadcastCPU(const framework::Tensor *x,
                                const platform::CPUDeviceContext &ctx,
                                Functor func,
                                const bool is_xsize_larger = true) {
-  std::vector<int> index_array(max_dim, 0);
   const T *x_data = x->data<T>();
   const T *y_data = y->data<T>();
   OutType *out_data = z->mutable_data<OutType>(ctx.GetPlace());
 
-  const int out_size = std::accumulate(out_dims_array, out_dims_array + max_dim,
-                                       1, std::multiplies<int>());
-  int x_index, y_index;
-  for (int out_index = 0; out_index < out_size; ++out_index) {
-    x_index = GetElementwiseIndex(x_dims_array, max_dim, index_array.data());
-    y_index = GetElementwiseIndex(y_dims_array, max_dim, index_array.data());
-    if (is_xsize_larger) {
-      out_data[out_index] = func(x_data[x_index], y_data[y_index]);
-    } else {
-      out_data[out_index] = func(y_data[y_index], x_data[x_index]);
-    }
-
-    UpdateElementwiseIndexArray(out_dims_array, max_dim, index_array.data());
+  ElementwiseBroadcastCPUPlan plan(x_dims_array, y_dims_array, out_dims_array,
+                                   max_dim);
+  if (plan.numel == 0) {
+    return;
+  }
+  if (is_xsize_larger) {
+    ElementwiseBroadcastForwardCPU<false>(plan, x_data, y_data, out_data,
+                                          func);
+  } else {
+    ElementwiseBroadcastForwardCPU<true>(plan, x_data, y_data, out_data,
+                                         func);
   }
 }
 
@@ -312,6 +438,120 @@ void CommonForwardBroadcastCUDA(
 
 #endif  // __NVCC__
 
+template <bool kXContiguous, bool kYContiguous, bool kAccumulate, typename T,
+          typename OP>
+inline void ElementwiseBroadcastGradInnerLoop(const T *x, const T *y,
+                                              const T *out, const T *dout,
+                                              T *d, int64_t n, OP op) {
+  for (int64_t i = 0; i < n; ++i) {
+    T value = op(x[kXContiguous ? i : 0], y[kYContiguous ? i : 0], out[i],
+                 dout[i]);
+    d[i] = kAccumulate ? d[i] + value : value;
+  }
+}
+
+template <bool kAccumulate, typename T, typename OP>
+inline void ElementwiseBroadcastGradInnerRun(const T *x, int64_t x_stride,
+                                             const T *y, int64_t y_stride,
+                                             const T *out, const T *dout,
+                                             T *d, int64_t n, OP op) {
+  if (x_stride != 0 && y_stride != 0) {
+    ElementwiseBroadcastGradInnerLoop<true, true, kAccumulate>(x, y, out, dout,
+                                                               d, n, op);
+  } else if (x_stride != 0) {
+    ElementwiseBroadcastGradInnerLoop<true, false, kAccumulate>(
+        x, y, out, dout, d, n, op);
+  } else {
+    ElementwiseBroadcastGradInnerLoop<false, true, kAccumulate>(
+        x, y, out, dout, d, n, op);
+  }
+}
+
+// Compute the gradient of x (kIsX) or y, which is the sum of op over the
+// broadcast dims of it. The reduction is partitioned by the elements of the
+// gradient, so no atomic or extra buffer is needed and the result is
+// deterministic:
+// 1. If the innermost dim is not broadcast, each task owns a chunk of a row
+//    of the gradient, and accumulates the rows of dout into it.
+// 2. Otherwise, each task owns an element of the gradient, and sums the
+//    contiguous runs of dout into a scalar.
+template <bool kIsX, typename T, typename OP>
+void ElementwiseBroadcastGradCPU(const ElementwiseBroadcastCPUPlan &plan,
+                                 const T *x_data, const T *y_data,
+                                 const T *out_data, const T *dout_data, OP op,
+                                 T *d_data) {
+  int nd = static_cast<int>(plan.dims.size());
+  const auto &d_strides = kIsX ? plan.x_strides : plan.y_strides;
+  std::vector<int> kept_axes, reduced_axes;
+  int64_t kept_num = 1, reduced_num = 1;
+  for (int i = 0; i < nd - 1; ++i) {
+    if (d_strides[i] != 0) {
+      kept_axes.push_back(i);
+      kept_num *= plan.dims[i];
+    } else {
+      reduced_axes.push_back(i);
+      reduced_num *= plan.dims[i];
+    }
+  }
+  int64_t inner = plan.inner();
+  int64_t x_inner_stride = plan.x_strides[nd - 1];
+  int64_t y_inner_stride = plan.y_strides[nd - 1];
+
+  if (d_strides[nd - 1] != 0) {
+    constexpr int64_t kChunk = 1024;
+    int64_t chunk_num = (inner + kChunk - 1) / kChunk;
+    int64_t task_num = kept_num * chunk_num;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (plan.numel > kElementwiseBroadcastParallelNumel)
+#endif
+    for (int64_t task = 0; task < task_num; ++task) {
+      int64_t begin = (task % chunk_num) * kChunk;
+      int64_t n = std::min(kChunk, inner - begin);
+      int64_t kept_x = begin * x_inner_stride;
+      int64_t kept_y = begin * y_inner_stride;
+      int64_t kept_out = begin;
+      plan.AddOffsets(kept_axes, task / chunk_num, &kept_x, &kept_y,
+                      &kept_out);
+      T *d = d_data + (kIsX ? kept_x : kept_y);
+      for (int64_t r = 0; r < reduced_num; ++r) {
+        int64_t x_off = kept_x, y_off = kept_y, out_off = kept_out;
+        plan.AddOffsets(reduced_axes, r, &x_off, &y_off, &out_off);
+        if (r == 0) {
+          ElementwiseBroadcastGradInnerRun<false>(
+              x_data + x_off, x_inner_stride, y_data + y_off, y_inner_stride,
+              out_data + out_off, dout_data + out_off, d, n, op);
+        } else {
+          ElementwiseBroadcastGradInnerRun<true>(
+              x_data + x_off, x_inner_stride, y_data + y_off, y_inner_stride,
+              out_data + out_off, dout_data + out_off, d, n, op);
+        }
+      }
+    }
+  } else {
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (plan.numel > kElementwiseBroadcastParallelNumel)
+#endif
+    for (int64_t k = 0; k < kept_num; ++k) {
+      int64_t kept_x = 0, kept_y = 0, kept_out = 0;
+      plan.AddOffsets(kept_axes, k, &kept_x, &kept_y, &kept_out);
+      T sum = static_cast<T>(0);
+      for (int64_t r = 0; r < reduced_num; ++r) {
+        int64_t x_off = kept_x, y_off = kept_y, out_off = kept_out;
+        plan.AddOffsets(reduced_axes, r, &x_off, &y_off, &out_off);
+        const T *x = x_data + x_off;
+        const T *y = y_data + y_off;
+        const T *out = out_data + out_off;
+        const T *dout = dout_data + out_off;
+        for (int64_t i = 0; i < inner; ++i) {
+          sum += op(x[i * x_inner_stride], y[i * y_inner_stride], out[i],
+                    dout[i]);
+        }
+      }
+      d_data[kIsX ? kept_x : kept_y] = sum;
+    }
+  }
+}
+
 template <typename T, typename DX_OP, typename DY_OP>
 void CommonGradBroadcastCPU(
     const framework::Tensor &x, const framework::Tensor &y,
@@ -319,35 +559,38 @@ void CommonGradBroadcastCPU(
     framework::Tensor *dx, framework::Tensor *dy, int *x_dims_array,
     int *y_dims_array, int *out_dims_array, int max_dim,
     const platform::CPUDeviceContext &ctx, DX_OP dx_op, DY_OP dy_op) {
-  std::vector<int> index_array(max_dim, 0);
   const T *x_data = x.data<T>();
   const T *y_data = y.data<T>();
   const T *out_data = out.data<T>();
   const T *dout_data = dout.data<T>();
   T *dx_data = dx == nullptr ? nullptr : dx->mutable_data<T>(ctx.GetPlace());
   T *dy_data = dy == nullptr ? nullptr : dy->mutable_data<T>(ctx.GetPlace());
-  if (dx_data != nullptr) {
-    memset(dx_data, 0, dx->numel() * sizeof(T));
-  }
-  if (dy_data != nullptr) {
-    memset(dy_data, 0, dy->numel() * sizeof(T));
-  }
-  const int out_size = std::accumulate(out_dims_array, out_dims_array + max_dim,
-                                       1, std::multiplies<int>());
-  int x_index, y_index;
-  for (int out_index = 0; out_index < out_size; ++out_index) {
-    x_index = GetElementwiseIndex(x_dims_array, max_dim, index_array.data());
-    y_index = GetElementwiseIndex(y_dims_array, max_dim, index_array.data());
+
+  ElementwiseBroadcastCPUPlan plan(x_dims_array, y_dims_array, out_dims_array,
+                                   max_dim);
+  if (plan.numel == 0) {
     if (dx_data != nullptr) {
-      dx_data[x_index] += dx_op(x_data[x_index], y_data[y_index],
-                                out_data[out_index], dout_data[out_index]);
+      memset(dx_data, 0, dx->numel() * sizeof(T));
     }
     if (dy_data != nullptr) {
-      dy_data[y_index] += dy_op(x_data[x_index], y_data[y_index],
-                                out_data[out_index], dout_data[out_index]);
+      memset(dy_data, 0, dy->numel() * sizeof(T));
     }
-
-    UpdateElementwiseIndexArray(out_dims_array, max_dim, index_array.data());
+    return;
+  }
+  // NOTE: The gradient which is not broadcast may share the buffer with
+  // dout, so it is computed after the other one, which reads dout.
+  bool x_is_broadcast = dx != nullptr && dx->numel() != plan.numel;
+  if (dy_data != nullptr && !x_is_broadcast) {
+    ElementwiseBroadcastGradCPU<false>(plan, x_data, y_data, out_data,
+                                       dout_data, dy_op, dy_data);
+  }
+  if (dx_data != nullptr) {
+    ElementwiseBroadcastGradCPU<true>(plan, x_data, y_data, out_data,
+                                      dout_data, dx_op, dx_data);
+  }
+  if (dy_data != nullptr && x_is_broadcast) {
+    ElementwiseBroadcastGradCPU<false>(plan, x_data, y_data, out_data,
+                                       dout_data, dy_op, dy_data);
   }
 }
 
@@ -1406,28 +1649,6 @@ class TransformFunctor {
     trans(ctx_, x_, x_ + nx_, y_, z_, func_);
   }
 
-  inline void RunRowWise(int n, int pre) const {
-    platform::Transform<DeviceContext> trans;
-    if (is_xsize_larger_) {
-      trans(ctx_, x_, x_ + nx_,
-            RowwiseTransformIterator<T, DeviceContext>(y_, n), z_, func_);
-    } else {
-      trans(ctx_, y_, y_ + nx_,
-            RowwiseTransformIterator<T, DeviceContext>(x_, n), z_, func_);
-    }
-  }
-
-  inline void RunMidWise(int n, int pre, int post) const {
-    platform::Transform<DeviceContext> trans;
-    if (is_xsize_larger_) {
-      trans(ctx_, x_, x_ + nx_,
-            MidWiseTransformIterator<T, DeviceContext>(y_, n, post), z_, func_);
-    } else {
-      trans(ctx_, y_, y_ + nx_,
-            MidWiseTransformIterator<T, DeviceContext>(x_, n, post), z_, func_);
-    }
-  }
-
  private:
   const T *x_;
   const T *y_;
@@ -1460,50 +1681,6 @@ struct ElemwiseGradNoBroadcast {
   T *dy_;
 };
 
-template <typename T, typename DX_OP, typename DY_OP>
-static void ElemwiseGradBroadcast1CPU(const T *x, const T *y, const T *out,
-                                      const T *dout, int h, int w,
-                                      bool is_xsize_larger, DX_OP dx_op,
-                                      DY_OP dy_op, T *dx, T *dy) {
-  if (is_xsize_larger) {
-    for (int i = 0; i < h; ++i) {
-      for (int j = 0; j < w; ++j) {
-        int x_offset = i * w + j;
-        if (dx != nullptr) {
-          dx[x_offset] =
-              dx_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
-        }
-        if (dy != nullptr) {
-          T tmp = dy_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
-          if (i == 0) {
-            dy[j] = tmp;
-          } else {
-            dy[j] += tmp;
-          }
-        }
-      }
-    }
-  } else {  // x.dims < y.dims, broadcast for x.
-    for (int i = 0; i < h; ++i) {
-      for (int j = 0; j < w; ++j) {
-        int y_offset = i * w + j;
-        if (dy != nullptr) {
-          dy[y_offset] =
-              dy_op(x[j], y[y_offset], out[y_offset], dout[y_offset]);
-        }
-        if (dx != nullptr) {
-          T tmp = dx_op(x[j], y[y_offset], out[y_offset], dout[y_offset]);
-          if (i == 0) {
-            dx[j] = tmp;
-          } else {
-            dx[j] += tmp;
-          }
-        }
-      }
-    }
-  }
-}
-
 #ifdef __NVCC__
 
 template <typename T, typename DX_OP, typename DY_OP>
@@ -1529,54 +1706,6 @@ static void ElemwiseGradBroadcast1CUDA(cudaStream_t stream, const T *x,
 
 #endif
 
-template <typename T, typename DX_OP, typename DY_OP>
-static void ElemwiseGradBroadcast2CPU(const T *x, const T *y, const T *out,
-                                      const T *dout, int pre, int n, int post,
-                                      bool is_xsize_larger, DX_OP dx_op,
-                                      DY_OP dy_op, T *dx, T *dy) {
-  if (is_xsize_larger) {
-    for (int i = 0; i < pre; ++i) {
-      for (int j = 0; j < n; ++j) {
-        for (int k = 0; k < post; ++k) {
-          int x_offset = i * n * post + j * post + k;
-          if (dx != nullptr) {
-            dx[x_offset] =
-                dx_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
-          }
-          if (dy != nullptr) {
-            T tmp = dy_op(x[x_offset], y[j], out[x_offset], dout[x_offset]);
-            if (i == 0 && k == 0) {
-              dy[j] = tmp;
-            } else {
-              dy[j] += tmp;
-            }
-          }
-        }
-      }
-    }
-  } else {  // x.dims < y.dims, broadcast for x.
-    for (int i = 0; i < pre; ++i) {
-      for (int j = 0; j < n; ++j) {
-        for (int k = 0; k < post; ++k) {
-          int y_offset = i * n * post + j * post + k;
-          if (dy != nullptr) {
-            dy[y_offset] =
-                dy_op(x[j], y[y_offset], out[y_offset], dout[y_offset]);
-          }
-          if (dx != nullptr) {
-            T tmp = dx_op(x[j], y[y_offset], out[y_offset], dout[y_offset]);
-            if (i == 0 && k == 0) {
-              dx[j] = tmp;
-            } else {
-              dx[j] += tmp;
-            }
-          }
-        }
-      }
-    }
-  }
-}
-
 #ifdef __NVCC__
 template <typename T, typename DX_OP, typename DY_OP>
 static __global__ void ElemwiseGradBroadcast2CUDAKernel(
@@ -1767,41 +1896,35 @@ void ElemwiseGradComputeWithBroadcast(
         ctx, x_dims, y_dims, x, y, out, dout, axis, dx, dy, dx_op, dy_op);
     return;
   }
-  if (post == 1) {
-    if (platform::is_gpu_place(ctx.GetPlace())) {
+  if (platform::is_cpu_place(ctx.GetPlace())) {
+    // The [pre, n, post] broadcast with [1, n, 1] is a case of the common
+    // broadcast on CPU.
+    int large_dims[3] = {pre, n, post};
+    int small_dims[3] = {1, n, 1};
+    CommonGradBroadcastCPU<T, DX_OP, DY_OP>(
+        x, y, out, dout, dx, dy, is_xsize_larger ? large_dims : small_dims,
+        is_xsize_larger ? small_dims : large_dims, large_dims, 3,
+        ctx.template device_context<platform::CPUDeviceContext>(), dx_op,
+        dy_op);
+    return;
+  }
 #ifdef __NVCC__
-      ElemwiseGradBroadcast1CUDA(
-          ctx.template device_context<DeviceContext>().stream(), x.data<T>(),
-          y.data<T>(), out.data<T>(), dout.data<T>(), pre, n, is_xsize_larger,
-          dx_op, dy_op,
-          dx == nullptr ? nullptr : dx->mutable_data<T>(ctx.GetPlace()),
-          dy == nullptr ? nullptr : dy->mutable_data<T>(ctx.GetPlace()));
-#endif
-    } else {
-      ElemwiseGradBroadcast1CPU(
-          x.data<T>(), y.data<T>(), out.data<T>(), dout.data<T>(), pre, n,
-          is_xsize_larger, dx_op, dy_op,
-          dx == nullptr ? nullptr : dx->mutable_data<T>(ctx.GetPlace()),
-          dy == nullptr ? nullptr : dy->mutable_data<T>(ctx.GetPlace()));
-    }
+  if (post == 1) {
+    ElemwiseGradBroadcast1CUDA(
+        ctx.template device_context<DeviceContext>().stream(), x.data<T>(),
+        y.data<T>(), out.data<T>(), dout.data<T>(), pre, n, is_xsize_larger,
+        dx_op, dy_op,
+        dx == nullptr ? nullptr : dx->mutable_data<T>(ctx.GetPlace()),
+        dy == nullptr ? nullptr : dy->mutable_data<T>(ctx.GetPlace()));
   } else {
-    if (platform::is_gpu_place(ctx.GetPlace())) {
-#ifdef __NVCC__
-      ElemwiseGradBroadcast2CUDA(
-          ctx.template device_context<DeviceContext>().stream(), x.data<T>(),
-          y.data<T>(), out.data<T>(), dout.data<T>(), pre, n, post,
-          is_xsize_larger, dx_op, dy_op,
-          dx == nullptr ? nullptr : dx->mutable_data<T>(ctx.GetPlace()),
-          dy == nullptr ? nullptr : dy->mutable_data<T>(ctx.GetPlace()));
-#endif
-    } else {
-      ElemwiseGradBroadcast2CPU(
-          x.data<T>(), y.data<T>(), out.data<T>(), dout.data<T>(), pre, n, post,
-          is_xsize_larger, dx_op, dy_op,
-          dx == nullptr ? nullptr : dx->mutable_data<T>(ctx.GetPlace()),
-          dy == nullptr ? nullptr : dy->mutable_data<T>(ctx.GetPlace()));
-    }
+    ElemwiseGradBroadcast2CUDA(
+        ctx.template device_context<DeviceContext>().stream(), x.data<T>(),
+        y.data<T>(), out.data<T>(), dout.data<T>(), pre, n, post,
+        is_xsize_larger, dx_op, dy_op,
+        dx == nullptr ? nullptr : dx->mutable_data<T>(ctx.GetPlace()),
+        dy == nullptr ? nullptr : dy->mutable_data<T>(ctx.GetPlace()));
   }
+#endif
 }
 
 template <typename Functor, typename DeviceContext, typename T,
@@ -1950,13 +2073,15 @@ void ElementwiseComputeEx(const framework::ExecutionContext &ctx,
 #endif
     return;
   }
-  if (post == 1) {
-    functor.RunRowWise(n, pre);
-    return;
-  } else {
-    functor.RunMidWise(n, pre, post);
-    return;
-  }
+  // The [pre, n, post] broadcast with [1, n, 1] is a case of the common
+  // broadcast on CPU.
+  int large_dims[3] = {pre, n, post};
+  int small_dims[3] = {1, n, 1};
+  CommonForwardBroadcastCPU<Functor, T, OutType>(
+      x, y, z, is_xsize_larger ? large_dims : small_dims,
+      is_xsize_larger ? small_dims : large_dims, large_dims, 3,
+      ctx.template device_context<platform::CPUDeviceContext>(), func,
+      is_xsize_larger);
 }
 
 // FusedElemwiseAndAct
@@ -0,0 +1,114 @@
+// Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/operators/elementwise/elementwise_op_function.h"
+
+namespace paddle {
+namespace operators {
+
+struct BroadcastTestSubFunctor {
+  inline float operator()(float a, float b) const { return a - b; }
+};
+
+// d(x - y) * y for dx and dout * x + out for dy, so that all of the four
+// operands are read.
+struct BroadcastTestDxFunctor {
+  inline float operator()(float x, float y, float out, float dout) const {
+    return dout * y;
+  }
+};
+
+struct BroadcastTestDyFunctor {
+  inline float operator()(float x, float y, float out, float dout) const {
+    return dout * x + out;
+  }
+};
+
+static void RandomFill(framework::Tensor *t, const framework::DDim &dims,
+                       std::mt19937 *engine) {
+  std::uniform_int_distribution<int> dist(-8, 8);
+  float *data = t->mutable_data<float>(dims, platform::CPUPlace());
+  for (int64_t i = 0; i < t->numel(); ++i) {
+    data[i] = static_cast<float>(dist(*engine));
+  }
+}
+
+// Run the broadcast of x_shape and y_shape, both of which have the rank of
+// output, and compare it with the element by element reference.
+static void TestBroadcast(const std::vector<int> &x_shape,
+                          const std::vector<int> &y_shape) {
+  int max_dim = static_cast<int>(x_shape.size());
+  std::vector<int> x_dims(x_shape), y_dims(y_shape), out_dims(max_dim);
+  for (int i = 0; i < max_dim; ++i) {
+    out_dims[i] = std::max(x_dims[i], y_dims[i]);
+  }
+  std::mt19937 engine(max_dim);
+  framework::Tensor x, y, out, dout, dx, dy;
+  RandomFill(&x, framework::make_ddim(x_dims), &engine);
+  RandomFill(&y, framework::make_ddim(y_dims), &engine);
+  RandomFill(&dout, framework::make_ddim(out_dims), &engine);
+  out.Resize(framework::make_ddim(out_dims));
+  dx.Resize(x.dims());
+  dy.Resize(y.dims());
+
+  platform::CPUDeviceContext ctx;
+  CommonForwardBroadcastCPU<BroadcastTestSubFunctor, float>(
+      &x, &y, &out, x_dims.data(), y_dims.data(), out_dims.data(), max_dim,
+      ctx, BroadcastTestSubFunctor());
+  CommonGradBroadcastCPU<float>(x, y, out, dout, &dx, &dy, x_dims.data(),
+                                y_dims.data(), out_dims.data(), max_dim, ctx,
+                                BroadcastTestDxFunctor(),
+                                BroadcastTestDyFunctor());
+
+  std::vector<float> ref_dx(x.numel(), 0), ref_dy(y.numel(), 0);
+  std::vector<int> index(max_dim, 0);
+  for (int64_t i = 0; i < out.numel(); ++i) {
+    int64_t x_idx = 0, y_idx = 0;
+    for (int d = 0; d < max_dim; ++d) {
+      x_idx = x_idx * x_dims[d] + (x_dims[d] > 1 ? index[d] : 0);
+      y_idx = y_idx * y_dims[d] + (y_dims[d] > 1 ? index[d] : 0);
+    }
+    float xv = x.data<float>()[x_idx], yv = y.data<float>()[y_idx];
+    float ov = xv - yv, dov = dout.data<float>()[i];
+    ASSERT_EQ(out.data<float>()[i], ov);
+    ref_dx[x_idx] += BroadcastTestDxFunctor()(xv, yv, ov, dov);
+    ref_dy[y_idx] += BroadcastTestDyFunctor()(xv, yv, ov, dov);
+    UpdateElementwiseIndexArray(out_dims.data(), max_dim, index.data());
+  }
+  for (int64_t i = 0; i < x.numel(); ++i) {
+    ASSERT_EQ(dx.data<float>()[i], ref_dx[i]);
+  }
+  for (int64_t i = 0; i < y.numel(); ++i) {
+    ASSERT_EQ(dy.data<float>()[i], ref_dy[i]);
+  }
+}
+
+TEST(ElementwiseBroadcastCPU, correctness) {
+  TestBroadcast({2, 3, 4, 5}, {2, 3, 4, 5});
+  TestBroadcast({2, 3, 4, 5}, {1, 3, 4, 1});
+  TestBroadcast({2, 3, 4, 5}, {2, 1, 1, 5});
+  TestBroadcast({2, 1, 4, 1}, {1, 3, 1, 5});
+  TestBroadcast({1, 1, 1}, {7, 1, 3});
+  TestBroadcast({3000, 7}, {1, 7});
+  TestBroadcast({7, 3000}, {7, 1});
+  TestBroadcast({1, 1}, {1, 1});
+  TestBroadcast({64, 3, 2000}, {1, 3, 1});
+}
+
+}  // namespace operators
+}  // namespace paddle
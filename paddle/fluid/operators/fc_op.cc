@@ -81,11 +81,14 @@ class FCOp : public framework::OperatorWithKernel {
 
     auto& activation_type = ctx->Attrs().Get<std::string>("activation_type");
     if (!activation_type.empty()) {
-      PADDLE_ENFORCE_EQ(activation_type, "relu",
-                        platform::errors::InvalidArgument(
-                            "The attribute activation_type of fc is expected "
-                            "to be \"relu\", but received %s.",
-                            activation_type.c_str()));
+      PADDLE_ENFORCE_EQ(
+          activation_type == "relu" || activation_type == "gelu_erf" ||
+              activation_type == "gelu_tanh",
+          true,
+          platform::errors::InvalidArgument(
+              "The attribute activation_type of fc is expected to be "
+              "\"relu\", \"gelu_erf\" or \"gelu_tanh\", but received %s.",
+              activation_type.c_str()));
     }
 
     if (ctx->Attrs().Get<bool>("use_mkldnn")) {
@@ -15,8 +15,10 @@ limitations under the License. */
 #pragma once
 
 #include <string>
+#include <type_traits>
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/cpu_bert_encoder.h"
 #include "paddle/fluid/operators/math/fc.h"
 
 namespace paddle {
@@ -49,6 +51,25 @@ inline void FCOutputSize(const framework::DDim& in_dims,
   out_dims.push_back(w_dims1);
 }
 
+// The bias and gelu of fc, which are fused by fc_gelu_fuse_pass, are applied
+// to the rows of output in one pass on CPU.
+template <typename DeviceContext, typename T>
+typename std::enable_if<
+    std::is_same<DeviceContext, platform::CPUDeviceContext>::value>::type
+FCBiasGelu(const DeviceContext& dev_ctx, int64_t rows, int width,
+           const T* bias, bool approximate, T* output) {
+  math::CPUBiasGelu<T>(rows, width, bias, approximate, output);
+}
+
+template <typename DeviceContext, typename T>
+typename std::enable_if<
+    !std::is_same<DeviceContext, platform::CPUDeviceContext>::value>::type
+FCBiasGelu(const DeviceContext& dev_ctx, int64_t rows, int width,
+           const T* bias, bool approximate, T* output) {
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "The gelu activation_type of fc is only supported on CPU."));
+}
+
 template <typename DeviceContext, typename T>
 class FCOpKernel : public framework::OpKernel<T> {
  public:
@@ -58,8 +79,10 @@ class FCOpKernel : public framework::OpKernel<T> {
     auto* bias = ctx.Input<Tensor>("Bias");
     auto* output = ctx.Output<framework::LoDTensor>("Out");
     int in_num_col_dims = ctx.Attr<int>("in_num_col_dims");
-    bool with_relu =
-        (ctx.Attr<std::string>("activation_type") == "relu") ? true : false;
+    auto activation_type = ctx.Attr<std::string>("activation_type");
+    bool with_relu = activation_type == "relu";
+    bool with_gelu =
+        activation_type == "gelu_erf" || activation_type == "gelu_tanh";
 
     auto w_dims = w->dims();
     bool padding_weights = ctx.Attr<bool>("padding_weights");
@@ -81,8 +104,14 @@ class FCOpKernel : public framework::OpKernel<T> {
 
     auto& dev_ctx = ctx.template device_context<DeviceContext>();
     math::FCFunctor<DeviceContext, T> fc;
+    const T* bias_data = bias ? bias->data<T>() : NULL;
     fc(dev_ctx, M, w_dims1, w_dims0, input_data, w_data, output_data,
-       bias ? bias->data<T>() : NULL, with_relu, padding_weights);
+       with_gelu ? NULL : bias_data, with_relu, padding_weights);
+    if (with_gelu) {
+      FCBiasGelu<DeviceContext, T>(dev_ctx, M, w_dims1, bias_data,
+                                   activation_type == "gelu_tanh",
+                                   output_data);
+    }
   }
 };
 
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/cpu_bert_encoder.h"
 #include "paddle/fluid/platform/errors.h"
 
 namespace paddle {
@@ -149,6 +150,32 @@ Not suggest to use in other case except has same structure as ernie.
   }
 };
 
+template <typename T>
+class EmbeddingEltWiseLayerNormCPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& context) const override {
+    auto ids = context.MultiInput<framework::Tensor>("Ids");
+    auto embs = context.MultiInput<framework::Tensor>("Embs");
+    auto* bias = context.Input<framework::Tensor>("Bias");
+    auto* scale = context.Input<framework::Tensor>("Scale");
+    auto* out = context.Output<framework::Tensor>("Out");
+    float eps = context.Attr<float>("epsilon");
+
+    std::vector<const int64_t*> ids_data;
+    std::vector<const T*> embs_data;
+    for (size_t i = 0; i < ids.size(); ++i) {
+      ids_data.push_back(ids[i]->data<int64_t>());
+      embs_data.push_back(embs[i]->data<T>());
+    }
+    auto id0_dims = ids[0]->dims();
+    int64_t rows = static_cast<int64_t>(id0_dims[0]) * id0_dims[1];
+    int hidden = embs[0]->dims()[1];
+    math::CPUEmbEltwiseLayerNorm<T>(rows, hidden, ids_data, embs_data,
+                                    scale->data<T>(), bias->data<T>(), eps,
+                                    out->mutable_data<T>(context.GetPlace()));
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -156,3 +183,6 @@ namespace ops = paddle::operators;
 REGISTER_OP_WITHOUT_GRADIENT(fused_embedding_eltwise_layernorm,
                              ops::EmbeddingEltWiseLayerNormOp,
                              ops::EmbeddingEltWiseLayerNormOpMaker);
+REGISTER_OP_CPU_KERNEL(fused_embedding_eltwise_layernorm,
+                       ops::EmbeddingEltWiseLayerNormCPUKernel<float>,
+                       ops::EmbeddingEltWiseLayerNormCPUKernel<double>);
@@ -13,6 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/jit/kernels.h"
+#include "paddle/fluid/operators/math/cpu_bert_encoder.h"
+#include "paddle/fluid/operators/math/fc.h"
 
 namespace paddle {
 namespace operators {
@@ -243,6 +246,51 @@ add_out <= elementwise_add(fc_out, Y)
   }
 };
 
+template <typename T>
+class FusedFCElementwiseLayerNormCPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &ctx) const override {
+    auto *x = ctx.Input<framework::Tensor>("X");
+    auto *w = ctx.Input<framework::Tensor>("W");
+    auto *y = ctx.Input<framework::Tensor>("Y");
+    auto *bias_0 = ctx.Input<framework::Tensor>("Bias0");
+    auto *bias_1 = ctx.Input<framework::Tensor>("Bias1");
+    auto *scale = ctx.Input<framework::Tensor>("Scale");
+    auto *out = ctx.Output<framework::Tensor>("Out");
+    auto *mean = ctx.Output<framework::Tensor>("Mean");
+    auto *variance = ctx.Output<framework::Tensor>("Variance");
+
+    auto w_dims = w->dims();
+    int N = w_dims[1];
+    int K = w_dims[0];
+    int M = framework::product(x->dims()) / K;
+    T *out_data = out->mutable_data<T>(ctx.GetPlace());
+
+    bool with_relu =
+        (ctx.Attr<std::string>("activation_type") == "relu") ? true : false;
+    auto &dev_ctx = ctx.template device_context<platform::CPUDeviceContext>();
+    math::FCFunctor<platform::CPUDeviceContext, T> fc;
+    fc(dev_ctx, M, N, K, x->data<T>(), w->data<T>(), out_data,
+       bias_0 ? bias_0->data<T>() : nullptr, with_relu && bias_0);
+    if (with_relu && !bias_0) {
+      auto relu =
+          jit::KernelFuncs<jit::VReluTuple<T>, platform::CPUPlace>::Cache().At(
+              M * N);
+      relu(out_data, out_data, M * N);
+    }
+
+    // out = layer_norm(fc_out + y), whose rows are split by begin_norm_axis.
+    auto matrix_dim = framework::flatten_to_2d(
+        y->dims(), ctx.Attr<int>("begin_norm_axis"));
+    math::CPUSkipLayerNorm<T>(
+        matrix_dim[0], static_cast<int>(matrix_dim[1]), out_data,
+        y->data<T>(), scale ? scale->data<T>() : nullptr,
+        bias_1 ? bias_1->data<T>() : nullptr, ctx.Attr<float>("epsilon"),
+        out_data, mean ? mean->mutable_data<T>(ctx.GetPlace()) : nullptr,
+        variance ? variance->mutable_data<T>(ctx.GetPlace()) : nullptr);
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -252,3 +300,6 @@ REGISTER_OPERATOR(
     ops::FusedFCElementwiseLayerNormOpMaker,
     paddle::framework::EmptyGradOpMaker<paddle::framework::OpDesc>,
     paddle::framework::EmptyGradOpMaker<paddle::imperative::OpBase>);
+REGISTER_OP_CPU_KERNEL(fused_fc_elementwise_layernorm,
+                       ops::FusedFCElementwiseLayerNormCPUKernel<float>,
+                       ops::FusedFCElementwiseLayerNormCPUKernel<double>);
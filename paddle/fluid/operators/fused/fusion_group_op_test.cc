@@ -90,15 +90,26 @@ framework::OpDesc* CreateFusionGroupOp(
   return op;
 }
 
-void PrepareDeviceCode(platform::Place place, std::string func_name,
-                       std::string cuda_kernel_str) {
+bool PrepareDeviceCode(platform::Place place, std::string func_name,
+                       std::string kernel_str) {
   paddle::platform::DeviceCodePool& pool =
       paddle::platform::DeviceCodePool::Init({place});
 
-  std::unique_ptr<paddle::platform::DeviceCode> code(
-      new paddle::platform::CUDADeviceCode(place, func_name, cuda_kernel_str));
-  code->Compile();
+  std::unique_ptr<paddle::platform::DeviceCode> code;
+  if (platform::is_cpu_place(place)) {
+    code.reset(
+        new paddle::platform::CPUDeviceCode(place, func_name, kernel_str));
+  } else {
+#ifdef PADDLE_WITH_CUDA
+    code.reset(
+        new paddle::platform::CUDADeviceCode(place, func_name, kernel_str));
+#endif
+  }
+  if (!code || !code->Compile()) {
+    return false;
+  }
   pool.Set(std::move(code));
+  return true;
 }
 
 void CheckOutputs(framework::Scope* scope,
@@ -134,15 +145,18 @@ void CheckOutputs(framework::Scope* scope,
   }
 }
 
-void TestMain(const std::vector<std::string>& input_names,
+void TestMain(const platform::Place& place,
+              const std::vector<std::string>& input_names,
               const std::vector<std::vector<int64_t>>& input_shapes,
               const std::vector<std::string>& output_names, int type,
-              std::string func_name, std::string cuda_kernel_str,
+              std::string func_name, std::string kernel_str,
               CPUKernelFunc cpu_kernel_func) {
   // Compile the device code
-  paddle::framework::InitDevices({0});
-  platform::CUDAPlace place = platform::CUDAPlace(0);
-  PrepareDeviceCode(place, func_name, cuda_kernel_str);
+  if (!PrepareDeviceCode(place, func_name, kernel_str)) {
+    LOG(WARNING) << "Skip the test because " << func_name
+                 << " cannot be compiled on " << place << ".";
+    return;
+  }
 
   // Create a ProgramDesc that has a fusion_group_op.
   framework::ProgramDesc program;
@@ -177,6 +191,51 @@ void TestMain(const std::vector<std::string>& input_names,
                cpu_kernel_func);
 }
 
+void ElementwiseCPUKernel0(size_t n, std::vector<void*> args) {
+  float* x = static_cast<float*>(args[0]);
+  float* y = static_cast<float*>(args[1]);
+  float* z = static_cast<float*>(args[2]);
+  for (size_t i = 0; i < n; ++i) {
+    float tmp_0 = x[i];
+    float tmp_1 = y[i];
+    float tmp_2 = tmp_0 + tmp_1;
+    float tmp_3 = tmp_2 > 0 ? tmp_2 : 0;
+    z[i] = tmp_3;
+  }
+}
+
+TEST(FusionGroupOp, elementwise_cpu) {
+  // z = relu(x + y)
+  std::vector<std::string> input_names = {"x", "y"};
+  std::vector<std::string> output_names = {"z"};
+  std::vector<std::vector<int64_t>> input_shapes = {{256, 256}, {256, 256}};
+  constexpr auto kernel = R"(
+#include <cstddef>
+
+static inline float relu(float x) {
+  return x * (x > 0);
+}
+
+extern "C" void elementwise_cpu_kernel_0(void** args) {
+  size_t n = *static_cast<size_t*>(args[0]);
+  const float* x = *static_cast<const float* const*>(args[1]);
+  const float* y = *static_cast<const float* const*>(args[2]);
+  float* z = *static_cast<float* const*>(args[3]);
+  for (size_t tid = 0; tid < n; ++tid) {
+    float tmp_0 = x[tid];
+    float tmp_1 = y[tid];
+    float tmp_2 = tmp_0 + tmp_1;
+    float tmp_3 = relu(tmp_2);
+    z[tid] = tmp_3;
+  }
+})";
+
+  paddle::framework::InitDevices(std::vector<int>());
+  TestMain(platform::CPUPlace(), input_names, input_shapes, output_names, 0,
+           "elementwise_cpu_kernel_0", kernel, ElementwiseCPUKernel0);
+}
+
+#ifdef PADDLE_WITH_CUDA
 TEST(FusionGroupOp, elementwise) {
   if (!platform::dynload::HasNVRTC() || !platform::dynload::HasCUDADriver()) {
     return;
@@ -203,25 +262,13 @@ void elementwise_cuda_kernel_0(size_t n, float *x, float* y, float* z) {
   }
 })";
 
-  auto elementwise_cpu_kernel_0 = [](size_t n,
-                                     std::vector<void*> args) -> void {
-    float* x = static_cast<float*>(args[0]);
-    float* y = static_cast<float*>(args[1]);
-    float* z = static_cast<float*>(args[2]);
-    for (size_t i = 0; i < n; ++i) {
-      float tmp_0 = x[i];
-      float tmp_1 = y[i];
-      float tmp_2 = tmp_0 + tmp_1;
-      float tmp_3 = tmp_2 > 0 ? tmp_2 : 0;
-      z[i] = tmp_3;
-    }
-  };
-
-  TestMain(input_names, input_shapes, output_names, 0,
-           "elementwise_cuda_kernel_0", kernel, elementwise_cpu_kernel_0);
+  paddle::framework::InitDevices({0});
+  TestMain(platform::CUDAPlace(0), input_names, input_shapes, output_names, 0,
+           "elementwise_cuda_kernel_0", kernel, ElementwiseCPUKernel0);
 }
+#endif
 
 }  // namespace operators
 }  // namespace paddle
 
-USE_CUDA_ONLY_OP(fusion_group);
+USE_OP(fusion_group);
@@ -15,6 +15,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/fused/fusion_gru_op.h"
 #include <cstring>  // for memcpy
 #include <string>
+#include <utility>
 #include <vector>
 #include "paddle/fluid/framework/op_version_registry.h"
 #include "paddle/fluid/operators/jit/kernels.h"
@@ -111,11 +112,7 @@ void FusionGRUOp::InferShape(framework::InferShapeContext* ctx) const {
   framework::DDim out_dims({x_mat_dims[0], frame_size});
   ctx->SetOutputDim("Hidden", out_dims);
   ctx->ShareLoD("X", "Hidden");
-  int xx_width;
-  if (ctx->Attrs().Get<bool>("use_seq")) {
-    xx_width = wx_dims[1];
-  } else {
-    xx_width = x_mat_dims[1] > wx_dims[1] ? wx_dims[1] : x_mat_dims[1];
+  if (!ctx->Attrs().Get<bool>("use_seq")) {
     OP_INOUT_CHECK(ctx->HasOutput("ReorderedH0"), "Output", "ReorderedH0",
                    "fusion_gru");
     OP_INOUT_CHECK(ctx->HasOutput("BatchedInput"), "Output", "BatchedInput",
@@ -125,7 +122,8 @@ void FusionGRUOp::InferShape(framework::InferShapeContext* ctx) const {
     ctx->SetOutputDim("BatchedInput", {x_mat_dims[0], wx_dims[1]});
     ctx->SetOutputDim("BatchedOut", out_dims);
   }
-  ctx->SetOutputDim("XX", {x_mat_dims[0], xx_width});
+  // Both the modes compute X * WeightX of all the time steps into XX.
+  ctx->SetOutputDim("XX", {x_mat_dims[0], wx_dims[1]});
   ctx->ShareLoD("X", "XX");
 }
 
@@ -168,19 +166,23 @@ void FusionGRUOpMaker::Make() {
            "Almost same as GRUOp."
            "Note: if have FC bias it should be added on this bias.")
       .AsDispensable();
-  AddOutput("ReorderedH0", "(Tensor) (N x D), which N is the min-batch size.")
+  AddOutput("ReorderedH0",
+            "(Tensor) (N x D), which N is the min-batch size. Deprecated, "
+            "it is not filled any more.")
       .AsIntermediate();
   AddOutput("XX",
-            "(LoDTensor) the result after X * WeightX (size is T x 3D)"
-            " or batched_X (size is T x M), this will be automatically chosen,"
+            "(LoDTensor) the result after X * WeightX (size is T x 3D),"
             " where T is the total time steps in this mini-batch,"
-            " D is the hidden size, M is the dim size of x input.")
+            " D is the hidden size.")
       .AsIntermediate();
   AddOutput("BatchedInput",
             "(LoDTensor) This is the batched result of input X"
-            "or the batched result after fc, shape (T x 3D)")
+            "or the batched result after fc, shape (T x 3D). Deprecated, it "
+            "is not filled any more.")
       .AsIntermediate();
-  AddOutput("BatchedOut", "(LoDTensor) (T X D) save batched hidden.")
+  AddOutput("BatchedOut",
+            "(LoDTensor) (T X D) save batched hidden. Deprecated, it is not "
+            "filled any more.")
       .AsIntermediate();
   AddOutput("Hidden", "(LoDTensor) (T x D) Same as GRUOp");
   AddAttr<std::string>("activation",
@@ -198,7 +200,8 @@ void FusionGRUOpMaker::Make() {
       .SetDefault(false);
   AddAttr<bool>("use_seq",
                 "(bool, default: True) "
-                "whether to use seq mode to compute GRU.")
+                "whether to use seq mode to compute GRU. Deprecated, it is "
+                "ignored and the sequences are always computed in batches.")
       .SetDefault(true);
   AddAttr<bool>("origin_mode",
                 "bool"
@@ -239,11 +242,8 @@ template <typename T>
 class FusionGRUKernel : public framework::OpKernel<T> {
  public:
   void Compute(const framework::ExecutionContext& ctx) const override {
-    if (ctx.Attr<bool>("use_seq")) {
-      SeqCompute(ctx);
-    } else {
-      BatchCompute(ctx);
-    }
+    // Always in the packed-sequence mode, see GetBatchLoD.
+    BatchCompute(ctx);
   }
 
 #define INIT_BASE_DEFINES                                     \
@@ -351,121 +351,93 @@ class FusionGRUKernel : public framework::OpKernel<T> {
     }
   }
 
+  // Computes the sequences together in the packed-sequence mode. The gates
+  // of all the time steps are computed by one GEMM in the order of the
+  // sequences, then each time step gathers the gates of its active sequences
+  // and scatters their hidden by the cached batch LoD, instead of copying
+  // the whole input and output into the order of the batches. As the
+  // sequences are sorted by the length, the active sequences of a time step
+  // are the first rows of the previous one.
   void BatchCompute(const framework::ExecutionContext& ctx) const {
     using DeviceContext = paddle::platform::CPUDeviceContext;
     INIT_BASE_DEFINES;
+    xx->Resize({total_T, D3});
     if (x_lod[0].size() == 2) {
-      xx->Resize({total_T, D3});
       SeqCompute(ctx);
       return;
     }
     INIT_OTHER_DEFINES;
-    auto* reordered_h0 = ctx.Output<Tensor>("ReorderedH0");
-    auto* batched_input = ctx.Output<LoDTensor>("BatchedInput");
-    auto* batched_out = ctx.Output<LoDTensor>("BatchedOut");
-    T* batched_input_data = batched_input->mutable_data<T>(place);
-    T* batched_out_data = batched_out->mutable_data<T>(place);
-    hidden_out->mutable_data<T>(place);
+    T* hidden_out_data = hidden_out->mutable_data<T>(place);
     auto& dev_ctx = ctx.template device_context<DeviceContext>();
     auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
-    math::LoDTensor2BatchFunctor<DeviceContext, T> to_batch;
-
     math::FCFunctor<DeviceContext, T> fc;
-    if (M > D3) {
-      fc(dev_ctx, total_T, D3, M, x_data, wx_data, xx_data,
-         bias ? bias->data<T>() : nullptr);
-      to_batch(dev_ctx, *xx, batched_input, true, is_reverse);
-    } else {
-      to_batch(dev_ctx, *x, xx, true, is_reverse);
-      batched_input->set_lod(xx->lod());
-      fc(dev_ctx, total_T, D3, M, xx_data, wx_data, batched_input_data,
-         bias ? bias->data<T>() : nullptr);
-    }
+    fc(dev_ctx, total_T, D3, M, x_data, wx_data, xx_data,
+       bias ? bias->data<T>() : nullptr);
 
-    auto batched_lod = batched_input->lod();
-    const auto& seq_order = batched_lod[2];
+    auto batched_lod = math::GetBatchLoD(x_lod[0], is_reverse);
+    const auto& batch_starts = (*batched_lod)[0];
+    const auto& seq_rows = (*batched_lod)[1];
+    const auto& seq_order = (*batched_lod)[2];
     const int max_bs = seq_order.size();
-    reordered_h0->Resize({max_bs, D});
+    const int max_seq_len = batch_starts.size() - 1;
 
-    int tstart = 0;
-    T* prev_hidden_data = nullptr;
+    // The gates and the hidden of the active sequences of a time step, and
+    // the hidden of the previous one.
+    Tensor buffer;
+    T* gates_data =
+        buffer.mutable_data<T>({max_bs * (D3 + D * 2)}, platform::CPUPlace());
+    T* cur_hidden_data = gates_data + max_bs * D3;
+    T* prev_hidden_data = cur_hidden_data + max_bs * D;
     if (h0) {
-      // reorder h0
-      T* reordered_h0_data = reordered_h0->mutable_data<T>(place);
       const T* h0_data = h0->data<T>();
-      prev_hidden_data = reordered_h0_data;
-      size_t sz = sizeof(T) * D;
-      for (int i = 0; i < max_bs; ++i) {
-        std::memcpy(reordered_h0_data, h0_data + seq_order[i] * D, sz);
-        reordered_h0_data += D;
-      }
-    } else {
-      // compute without h0
-      T* cur_in_data = batched_input_data;
-      T* cur_out_data = batched_out_data;
-      // W: {W_update, W_reset; W_state}
       for (int i = 0; i < max_bs; ++i) {
-        one_step.gates = cur_in_data;
-        one_step.ht = cur_out_data;
-        ComputeH1(&one_step, &attr);
-        // add offset
-        cur_in_data += D3;
-        cur_out_data += D;
+        std::memcpy(prev_hidden_data + i * D, h0_data + seq_order[i] * D,
+                    sizeof(T) * D);
       }
-      tstart = 1;
-      prev_hidden_data = batched_out_data;
     }
-    // Then start from next
+    // W: {W_update, W_reset; W_state}
     const T* wh_state_data = wh_data + D * D2;
-    const auto& batch_starts = batched_lod[0];
-    const int max_seq_len = batch_starts.size() - 1;
-    batched_input_data = batched_input_data + tstart * max_bs * D3;
-    batched_out_data = batched_out_data + tstart * max_bs * D;
-    for (int step = tstart; step < max_seq_len; ++step) {
+    for (int step = 0; step < max_seq_len; ++step) {
       const int cur_bs = batch_starts[step + 1] - batch_starts[step];
-      // gemm prev * (Wu + Wr)
-      blas.GEMM(CblasNoTrans, CblasNoTrans, cur_bs, D2, D, static_cast<T>(1),
-                prev_hidden_data, D, wh_data, D2, static_cast<T>(1),
-                batched_input_data, D3);
-
-      T* cur_batched_data = batched_input_data;
-      T* cur_out_data = batched_out_data;
-      T* cur_prev_hidden_data = prev_hidden_data;
+      const size_t* rows = seq_rows.data() + batch_starts[step];
       for (int i = 0; i < cur_bs; ++i) {
-        one_step.gates = cur_batched_data;
-        one_step.ht_1 = cur_prev_hidden_data;
-        one_step.ht = cur_out_data;
-        ComputeHtPart1(&one_step, &attr);
-
-        cur_batched_data += D3;
-        cur_prev_hidden_data += D;
-        cur_out_data += D;
+        std::memcpy(gates_data + i * D3, xx_data + rows[i] * D3,
+                    sizeof(T) * D3);
+      }
+      if (step == 0 && !h0) {
+        for (int i = 0; i < cur_bs; ++i) {
+          one_step.gates = gates_data + i * D3;
+          one_step.ht = cur_hidden_data + i * D;
+          ComputeH1(&one_step, &attr);
+        }
+      } else {
+        // gemm prev * (Wu + Wr)
+        blas.GEMM(CblasNoTrans, CblasNoTrans, cur_bs, D2, D, static_cast<T>(1),
+                  prev_hidden_data, D, wh_data, D2, static_cast<T>(1),
+                  gates_data, D3);
+        for (int i = 0; i < cur_bs; ++i) {
+          one_step.gates = gates_data + i * D3;
+          one_step.ht_1 = prev_hidden_data + i * D;
+          one_step.ht = cur_hidden_data + i * D;
+          ComputeHtPart1(&one_step, &attr);
+        }
+        // gemm rt * Ws
+        blas.GEMM(CblasNoTrans, CblasNoTrans, cur_bs, D, D, static_cast<T>(1),
+                  cur_hidden_data, D, wh_state_data, D, static_cast<T>(1),
+                  gates_data + D2, D3);
+        for (int i = 0; i < cur_bs; ++i) {
+          one_step.gates = gates_data + i * D3;
+          one_step.ht_1 = prev_hidden_data + i * D;
+          one_step.ht = cur_hidden_data + i * D;
+          ComputeHtPart2(&one_step, &attr);
+        }
       }
-
-      cur_batched_data = batched_input_data;
-      cur_out_data = batched_out_data;
-      blas.GEMM(CblasNoTrans, CblasNoTrans, cur_bs, D, D, static_cast<T>(1),
-                cur_out_data, D, wh_state_data, D, static_cast<T>(1),
-                cur_batched_data + D2, D3);
-
-      cur_prev_hidden_data = prev_hidden_data;
       for (int i = 0; i < cur_bs; ++i) {
-        one_step.gates = cur_batched_data;
-        one_step.ht_1 = cur_prev_hidden_data;
-        one_step.ht = cur_out_data;
-        ComputeHtPart2(&one_step, &attr);
-        cur_batched_data += D3;
-        cur_prev_hidden_data += D;
-        cur_out_data += D;
+        std::memcpy(hidden_out_data + rows[i] * D, cur_hidden_data + i * D,
+                    sizeof(T) * D);
       }
-      prev_hidden_data = batched_out_data;
-      batched_out_data = cur_out_data;
-      batched_input_data = cur_batched_data;
+      std::swap(prev_hidden_data, cur_hidden_data);
     }
-
-    math::Batch2LoDTensorFunctor<DeviceContext, T> to_seq;
-    batched_out->set_lod(batched_lod);
-    to_seq(dev_ctx, *batched_out, hidden_out);
   }
 #undef INIT_OTHER_DEFINES
 #undef INIT_BASE_DEFINES
@@ -13,7 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/fused/fusion_lstm_op.h"
+#include <cstring>
 #include <string>
+#include <utility>
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/fc.h"
@@ -121,12 +123,7 @@ void FusionLSTMOp::InferShape(framework::InferShapeContext* ctx) const {
   ctx->SetOutputDim("Cell", out_dims);
   ctx->ShareLoD("X", "Hidden");
   ctx->ShareLoD("X", "Cell");
-  int xx_width;
-  if (ctx->Attrs().Get<bool>("use_seq")) {
-    xx_width = wx_dims[1];
-  } else {
-    xx_width = x_dims[1] > wx_dims[1] ? wx_dims[1] : x_dims[1];
-
+  if (!ctx->Attrs().Get<bool>("use_seq")) {
     OP_INOUT_CHECK(ctx->HasOutput("BatchedInput"), "Output", "BatchedInput",
                    "fusion_lstm");
     OP_INOUT_CHECK(ctx->HasOutput("BatchedHidden"), "Output", "BatchedHidden",
@@ -142,7 +139,8 @@ void FusionLSTMOp::InferShape(framework::InferShapeContext* ctx) const {
     ctx->SetOutputDim("BatchedHidden", out_dims);
     ctx->SetOutputDim("BatchedCell", out_dims);
   }
-  ctx->SetOutputDim("XX", {x_dims[0], xx_width});
+  // Both the modes compute X * WeightX of all the time steps into XX.
+  ctx->SetOutputDim("XX", {x_dims[0], wx_dims[1]});
   ctx->ShareLoD("X", "XX");
 }
 
@@ -205,16 +203,25 @@ void FusionLSTMOpMaker::Make() {
             "(LoDTensor) (same as LSTMOp) the cell state of LSTM operator. "
             "The shape is (T x D), and lod is the same with the `Input`.");
   AddOutput("XX",
-            "(LoDTensor) the result after X * WeightX (size is T x 4D)"
-            " or batched_X (size is T x M), this will be automatically chosen,"
+            "(LoDTensor) the result after X * WeightX (size is T x 4D),"
             " where T is the total time steps in this mini-batch,"
-            " D is the hidden size, M is the dim size of x input.")
+            " D is the hidden size.")
+      .AsIntermediate();
+  AddOutput("BatchedInput",
+            "(LoDTensor) (T x 4D). Deprecated, it is not filled any more.")
+      .AsIntermediate();
+  AddOutput("BatchedHidden",
+            "(LoDTensor) (T x D). Deprecated, it is not filled any more.")
+      .AsIntermediate();
+  AddOutput("BatchedCell",
+            "(LoDTensor) (T x D). Deprecated, it is not filled any more.")
+      .AsIntermediate();
+  AddOutput("ReorderedH0",
+            "(LoDTensor) (N x D). Deprecated, it is not filled any more.")
+      .AsIntermediate();
+  AddOutput("ReorderedC0",
+            "(LoDTensor) (N x D). Deprecated, it is not filled any more.")
       .AsIntermediate();
-  AddOutput("BatchedInput", "(LoDTensor) (T x 4D).").AsIntermediate();
-  AddOutput("BatchedHidden", "(LoDTensor) (T x D).").AsIntermediate();
-  AddOutput("BatchedCell", "(LoDTensor) (T x D).").AsIntermediate();
-  AddOutput("ReorderedH0", "(LoDTensor) (N x D).").AsIntermediate();
-  AddOutput("ReorderedC0", "(LoDTensor) (N x D).").AsIntermediate();
   AddOutput("CheckedCell", "(Tensor) (2 x D) only for peephole.")
       .AsIntermediate();
   AddAttr<bool>("use_peepholes",
@@ -227,7 +234,8 @@ void FusionLSTMOpMaker::Make() {
       .SetDefault(false);
   AddAttr<bool>("use_seq",
                 "(bool, default: True) "
-                "whether to use seq mode to compute.")
+                "whether to use seq mode to compute. Deprecated, it is "
+                "ignored and the sequences are always computed in batches.")
       .SetDefault(true);
   AddAttr<std::string>("gate_activation",
                        "(string, default: sigmoid)"
@@ -379,133 +387,86 @@ class FuisonLSTMKernel : public framework::OpKernel<T> {
     }
   }
 
+  // Computes the sequences together in the packed-sequence mode, as the
+  // BatchCompute of fusion_gru.
   void BatchCompute(const framework::ExecutionContext& ctx) const {
     INIT_BASE_DEFINES;
+    xx->Resize({x_dims[0], D4});
     if (x->lod()[0].size() == 2) {
-      xx->Resize({x_dims[0], D4});
       SeqCompute(ctx);
       return;
     }
     INIT_OTHER_DEFINES;
-
-    auto* reordered_h0 = ctx.Output<Tensor>("ReorderedH0");
-    auto* reordered_c0 = ctx.Output<Tensor>("ReorderedC0");
-    auto* batched_input = ctx.Output<LoDTensor>("BatchedInput");
-    auto* batched_c_out = ctx.Output<LoDTensor>("BatchedCell");
-    auto* batched_h_out = ctx.Output<LoDTensor>("BatchedHidden");
     T* xx_data = xx->mutable_data<T>(place);
-    T* batched_input_data = batched_input->mutable_data<T>(place);
-    T* batched_c_out_data = batched_c_out->mutable_data<T>(place);
-    T* batched_h_out_data = batched_h_out->mutable_data<T>(place);
-    hidden_out->mutable_data<T>(place);
-    cell_out->mutable_data<T>(place);
-
-    math::LoDTensor2BatchFunctor<DeviceContext, T> to_batch;
+    T* h_out_data = hidden_out->mutable_data<T>(place);
+    T* c_out_data = cell_out->mutable_data<T>(place);
     auto& dev_ctx = ctx.template device_context<DeviceContext>();
     auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
     math::FCFunctor<DeviceContext, T> fc;
-    if (M > D4) {
-      fc(dev_ctx, x_dims[0], D4, M, x_data, wx_data, xx_data, bias->data<T>());
-      to_batch(dev_ctx, *xx, batched_input, true, is_reverse);
-    } else {
-      to_batch(dev_ctx, *x, xx, true, is_reverse);
-      batched_input->set_lod(xx->lod());
-      fc(dev_ctx, x_dims[0], D4, M, xx_data, wx_data, batched_input_data,
-         bias->data<T>());
-    }
+    fc(dev_ctx, x_dims[0], D4, M, x_data, wx_data, xx_data, bias->data<T>());
 
-    auto batched_lod = batched_input->lod();
-    const auto& seq_order = batched_lod[2];
+    auto batched_lod = math::GetBatchLoD(x->lod()[0], is_reverse);
+    const auto& batch_starts = (*batched_lod)[0];
+    const auto& seq_rows = (*batched_lod)[1];
+    const auto& seq_order = (*batched_lod)[2];
     const int max_bs = seq_order.size();
-    reordered_h0->Resize({max_bs, D});
-    reordered_c0->Resize({max_bs, D});
+    const int max_seq_len = batch_starts.size() - 1;
 
-    int tstart = 0;
-    T* prev_h_data = nullptr;
-    T* prev_c_data = nullptr;
+    // The gates, the hidden and the cell of the active sequences of a time
+    // step, and the hidden and the cell of the previous one.
+    Tensor buffer;
+    T* gates_data =
+        buffer.mutable_data<T>({max_bs * (D4 + D * 4)}, platform::CPUPlace());
+    T* cur_h_data = gates_data + max_bs * D4;
+    T* cur_c_data = cur_h_data + max_bs * D;
+    T* prev_h_data = cur_c_data + max_bs * D;
+    T* prev_c_data = prev_h_data + max_bs * D;
     if (h0) {
-      // reorder h0, c0
-      T* reordered_h0_data = reordered_h0->mutable_data<T>(place);
-      T* reordered_c0_data = reordered_c0->mutable_data<T>(place);
       const T* h0_data = h0->data<T>();
       const T* c0_data = c0->data<T>();
-      prev_h_data = reordered_h0_data;
-      prev_c_data = reordered_c0_data;
-      size_t sz = D;
-      for (int i = 0; i < max_bs; ++i) {
-        blas.VCOPY(sz, h0_data + seq_order[i] * D, reordered_h0_data);
-        blas.VCOPY(sz, c0_data + seq_order[i] * D, reordered_c0_data);
-        reordered_h0_data += D;
-        reordered_c0_data += D;
-      }
-    } else {
-      // compute without h0, c0
-      T* cur_in_data = batched_input_data;
-      T* cur_h_out_data = batched_h_out_data;
-      T* cur_c_out_data = batched_c_out_data;
       for (int i = 0; i < max_bs; ++i) {
-        one_step.gates = cur_in_data;
-        one_step.ct = cur_c_out_data;
-        one_step.ht = cur_h_out_data;
-        ComputeC1H1(&one_step, &attr);
-
-        cur_in_data += D4;
-        cur_c_out_data += D;
-        cur_h_out_data += D;
+        blas.VCOPY(D, h0_data + seq_order[i] * D, prev_h_data + i * D);
+        blas.VCOPY(D, c0_data + seq_order[i] * D, prev_c_data + i * D);
       }
-      tstart = 1;
-      prev_h_data = batched_h_out_data;
-      prev_c_data = batched_c_out_data;
     }
-
-    // compute kernel part
-    const auto& batch_starts = batched_lod[0];
-    const int max_seq_len = batch_starts.size() - 1;
-    const int offset = tstart * max_bs * D;
-    batched_input_data = batched_input_data + offset * 4;
-    batched_h_out_data = batched_h_out_data + offset;
-    batched_c_out_data = batched_c_out_data + offset;
-    for (int step = tstart; step < max_seq_len; ++step) {
+    for (int step = 0; step < max_seq_len; ++step) {
       const int cur_bs = batch_starts[step + 1] - batch_starts[step];
-      GEMM_WH_ADDON(cur_bs, prev_h_data, batched_input_data);
-      T* cur_in_data = batched_input_data;
-      T* cur_prev_c_data = prev_c_data;
-      T* cur_c_out_data = batched_c_out_data;
-      T* cur_h_out_data = batched_h_out_data;
+      const size_t* rows = seq_rows.data() + batch_starts[step];
       for (int i = 0; i < cur_bs; ++i) {
-        one_step.gates = cur_in_data;
-        one_step.ct_1 = cur_prev_c_data;
-        one_step.ct = cur_c_out_data;
-        one_step.ht = cur_h_out_data;
-        ComputeCtHt(&one_step, &attr);
-
-        // move one batch
-        cur_in_data += D4;
-        cur_prev_c_data += D;
-        cur_c_out_data += D;
-        cur_h_out_data += D;
+        std::memcpy(gates_data + i * D4, xx_data + rows[i] * D4,
+                    sizeof(T) * D4);
       }
-      // move one step
-      prev_c_data = batched_c_out_data;
-      prev_h_data = batched_h_out_data;
-      batched_c_out_data = cur_c_out_data;
-      batched_h_out_data = cur_h_out_data;
-      batched_input_data = cur_in_data;
+      if (step == 0 && !h0) {
+        for (int i = 0; i < cur_bs; ++i) {
+          one_step.gates = gates_data + i * D4;
+          one_step.ct = cur_c_data + i * D;
+          one_step.ht = cur_h_data + i * D;
+          ComputeC1H1(&one_step, &attr);
+        }
+      } else {
+        GEMM_WH_ADDON(cur_bs, prev_h_data, gates_data);
+        for (int i = 0; i < cur_bs; ++i) {
+          one_step.gates = gates_data + i * D4;
+          one_step.ct_1 = prev_c_data + i * D;
+          one_step.ct = cur_c_data + i * D;
+          one_step.ht = cur_h_data + i * D;
+          ComputeCtHt(&one_step, &attr);
+        }
+      }
+      for (int i = 0; i < cur_bs; ++i) {
+        std::memcpy(h_out_data + rows[i] * D, cur_h_data + i * D,
+                    sizeof(T) * D);
+        std::memcpy(c_out_data + rows[i] * D, cur_c_data + i * D,
+                    sizeof(T) * D);
+      }
+      std::swap(prev_h_data, cur_h_data);
+      std::swap(prev_c_data, cur_c_data);
     }
-
-    math::Batch2LoDTensorFunctor<DeviceContext, T> to_seq;
-    batched_h_out->set_lod(batched_lod);
-    to_seq(dev_ctx, *batched_h_out, hidden_out);
-    batched_c_out->set_lod(batched_lod);
-    to_seq(dev_ctx, *batched_c_out, cell_out);
   }
 
   void Compute(const framework::ExecutionContext& ctx) const override {
-    if (ctx.Attr<bool>("use_seq")) {
-      SeqCompute(ctx);
-    } else {
-      BatchCompute(ctx);
-    }
+    // Always in the packed-sequence mode, see GetBatchLoD.
+    BatchCompute(ctx);
   }
 
 #undef GEMM_WH_ADDON
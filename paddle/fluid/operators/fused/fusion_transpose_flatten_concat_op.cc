@@ -16,6 +16,7 @@ limitations under the License. */
 #include <string>
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/cpu_transpose.h"
 
 namespace paddle {
 namespace operators {
@@ -112,6 +113,51 @@ class TransposeFlattenConcatFusionOpMaker
   }
 };
 
+// Each input is permuted by the strided copy of cpu_transpose.h directly
+// into its slice of the output, which is the same as the cuDNN kernel.
+template <typename T>
+class TransposeFlattenConcatFusionCPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    auto ins = ctx.MultiInput<framework::Tensor>("X");
+    auto* out = ctx.Output<framework::Tensor>("Out");
+    T* odata = out->mutable_data<T>(ctx.GetPlace());
+    auto odims = out->dims();
+
+    std::vector<int> trans_axis = ctx.Attr<std::vector<int>>("trans_axis");
+    int flatten_axis = ctx.Attr<int>("flatten_axis");
+    int concat_axis = ctx.Attr<int>("concat_axis");
+
+    int rank = ins[0]->dims().size();
+    std::vector<int64_t> dims(rank), in_strides(rank), out_strides(rank);
+    for (size_t k = 0; k < ins.size(); ++k) {
+      auto perm_shape = GetPermuteShape(trans_axis, ins[k]->dims());
+      auto in_stride = framework::stride(ins[k]->dims());
+      for (int i = 0; i < rank; ++i) {
+        dims[i] = perm_shape[i];
+        in_strides[i] = in_stride[trans_axis[i]];
+      }
+      // If concat_axis is 1, the stride of the 0-th dim of the flattened
+      // output of each input is odims[1].
+      out_strides[rank - 1] = 1;
+      for (int i = rank - 2; i >= 0; --i) {
+        if (i + 1 == flatten_axis && concat_axis == 1) {
+          out_strides[i] = odims[1];
+        } else {
+          out_strides[i] = out_strides[i + 1] * dims[i + 1];
+        }
+      }
+      math::CPUStridedCopy<T>(dims, in_strides, out_strides,
+                              ins[k]->data<T>(), odata);
+
+      auto flat_shape = GetFlattenShape(flatten_axis, perm_shape);
+      odata += concat_axis == 0
+                   ? static_cast<int64_t>(flat_shape[0]) * flat_shape[1]
+                   : flat_shape[1];
+    }
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -121,3 +167,6 @@ REGISTER_OPERATOR(
     ops::TransposeFlattenConcatFusionOpMaker,
     paddle::framework::EmptyGradOpMaker<paddle::framework::OpDesc>,
     paddle::framework::EmptyGradOpMaker<paddle::imperative::OpBase>);
+REGISTER_OP_CPU_KERNEL(fusion_transpose_flatten_concat,
+                       ops::TransposeFlattenConcatFusionCPUKernel<float>,
+                       ops::TransposeFlattenConcatFusionCPUKernel<double>);
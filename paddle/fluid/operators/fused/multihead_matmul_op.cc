@@ -12,8 +12,11 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <array>
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/cpu_bert_encoder.h"
 #include "paddle/fluid/platform/errors.h"
 
 namespace paddle {
@@ -111,9 +114,81 @@ Example of matrix multiplication with head_number of B
   }
 };
 
+template <typename T>
+class MultiHeadMatMulV2CPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    using Tensor = framework::Tensor;
+    auto *input = context.Input<framework::Tensor>("Input");
+    auto *w = context.Input<framework::Tensor>("W");
+    auto *bias = context.Input<framework::Tensor>("Bias");
+    auto *bias_qk = context.Input<framework::Tensor>("BiasQK");
+    T scale = static_cast<T>(context.Attr<float>("alpha"));
+    int head_number = context.Attr<int>("head_number");
+
+    // should be (B * S * hidden)
+    auto input_dims = input->dims();
+    // shouble be (hidden * 3 * all_head_size)
+    auto w_dims = w->dims();
+    int batch = input_dims[0];
+    int seq_len = input_dims[1];
+    int all_head_size = w_dims[2];
+    int head_size = all_head_size / head_number;
+    // BiasQK is [batch, head_number, seq_len, seq_len], or broadcast to it
+    // from 1 of the first three dims, e.g. the mask [batch, 1, 1, seq_len].
+    auto bias_qk_dims = bias_qk->dims();
+    std::array<int64_t, 4> full_dims = {batch, head_number, seq_len, seq_len};
+    bool broadcastable = bias_qk_dims.size() == 4 &&
+                         bias_qk_dims[3] == full_dims[3];
+    for (int i = 0; broadcastable && i < 3; ++i) {
+      broadcastable = bias_qk_dims[i] == full_dims[i] || bias_qk_dims[i] == 1;
+    }
+    PADDLE_ENFORCE_EQ(
+        broadcastable, true,
+        platform::errors::InvalidArgument(
+            "The BiasQK of MultiHeadMatMul is expected to have the shape "
+            "[batch, head_number, seq_len, seq_len], [%d, %d, %d, %d], or to "
+            "be broadcast to it, but received %s.",
+            batch, head_number, seq_len, seq_len, bias_qk_dims));
+    std::array<int64_t, 3> bias_qk_strides;
+    int64_t stride = seq_len;
+    for (int i = 2; i >= 0; --i) {
+      bias_qk_strides[i] = bias_qk_dims[i] == 1 ? 0 : stride;
+      stride *= bias_qk_dims[i];
+    }
+
+    auto *out = context.Output<framework::Tensor>("Out");
+    out->Resize({batch, seq_len, all_head_size});
+    auto *output_d = out->mutable_data<T>(context.GetPlace());
+
+    // (B*S, hidden)
+    const Tensor input_matrix =
+        framework::ReshapeToMatrix(*input, 2 /*x_num_col_dims */);
+    // (hidden, 3 * all_head_size)
+    const Tensor w_matrix =
+        framework::ReshapeToMatrix(*w, 1 /*y_num_col_dims*/);
+
+    // (B * S, hidden) * (hidden, 3 * N * H) -> (B * S * 3 * N * H)
+    Tensor temp_out_tensor;
+    temp_out_tensor.Resize({batch * seq_len, 3 * all_head_size});
+    auto *temp_out_data = temp_out_tensor.mutable_data<T>(context.GetPlace());
+    auto &dev_ctx =
+        context.template device_context<platform::CPUDeviceContext>();
+    auto blas = math::GetBlas<platform::CPUDeviceContext, T>(dev_ctx);
+    blas.MatMul(input_matrix, w_matrix, &temp_out_tensor);
+
+    math::CPUMultiHeadAttention<T>(dev_ctx, batch, seq_len, head_number,
+                                   head_size, temp_out_data, bias->data<T>(),
+                                   bias_qk->data<T>(), bias_qk_strides, scale,
+                                   output_d);
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
 namespace ops = paddle::operators;
 REGISTER_OP_WITHOUT_GRADIENT(multihead_matmul, ops::MultiHeadMatMulV2Op,
                              ops::MultiHeadMatMulV2OpMaker);
+REGISTER_OP_CPU_KERNEL(multihead_matmul, ops::MultiHeadMatMulV2CPUKernel<float>,
+                       ops::MultiHeadMatMulV2CPUKernel<double>);
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/cpu_bert_encoder.h"
 #include "paddle/fluid/platform/errors.h"
 
 namespace paddle {
@@ -83,9 +84,32 @@ This op is used for skip_layernorm_fuse_pass, which fuse op pattern as followed.
   }
 };
 
+template <typename T>
+class SkipLayerNormCPUKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *x = context.Input<framework::Tensor>("X");
+    auto *y = context.Input<framework::Tensor>("Y");
+    auto *scale = context.Input<framework::Tensor>("Scale");
+    auto *bias = context.Input<framework::Tensor>("Bias");
+    auto *out = context.Output<framework::Tensor>("Out");
+    float epsilon = context.Attr<float>("epsilon");
+    int begin_norm_axis = context.Attr<int>("begin_norm_axis");
+
+    auto matrix_dim = framework::flatten_to_2d(x->dims(), begin_norm_axis);
+    out->Resize(x->dims());
+    math::CPUSkipLayerNorm<T>(matrix_dim[0], static_cast<int>(matrix_dim[1]),
+                              x->data<T>(), y->data<T>(), scale->data<T>(),
+                              bias->data<T>(), epsilon,
+                              out->mutable_data<T>(context.GetPlace()));
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
 namespace ops = paddle::operators;
 REGISTER_OP_WITHOUT_GRADIENT(skip_layernorm, ops::SkipLayerNormOp,
                              ops::SkipLayerNormOpMaker);
+REGISTER_OP_CPU_KERNEL(skip_layernorm, ops::SkipLayerNormCPUKernel<float>,
+                       ops::SkipLayerNormCPUKernel<double>);
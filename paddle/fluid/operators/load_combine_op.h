@@ -70,6 +70,18 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
     auto out_vars = context.MultiOutputVar("Out");
 
     for (size_t i = 0; i < out_var_names.size(); i++) {
+      // The tensors without an output, such as the tables read from disk by
+      // lookup_table_disk, are skipped without being read.
+      if (out_var_names[i] == framework::kEmptyVarName) {
+        framework::LoD lod;
+        framework::proto::VarType::TensorDesc desc;
+        framework::DeserializeDescFromStream(*buffer, &lod, &desc);
+        int64_t numel = 1;
+        for (auto dim : desc.dims()) numel *= dim;
+        buffer->seekg(numel * framework::SizeOfType(desc.data_type()),
+                      std::ios::cur);
+        continue;
+      }
       VLOG(4) << "loading tensor: " << out_var_names[i];
       PADDLE_ENFORCE_NOT_NULL(
           out_vars[i], platform::errors::InvalidArgument(
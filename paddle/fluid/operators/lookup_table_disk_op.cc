@@ -0,0 +1,113 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/lookup_table_disk_op.h"
+
+namespace paddle {
+namespace operators {
+
+class LookupTableDiskOp : public framework::OperatorWithKernel {
+ public:
+  using framework::OperatorWithKernel::OperatorWithKernel;
+
+  void InferShape(framework::InferShapeContext* ctx) const override {
+    OP_INOUT_CHECK(ctx->HasInput("Ids"), "Input", "Ids", "LookupTableDisk");
+    OP_INOUT_CHECK(ctx->HasOutput("Out"), "Output", "Out", "LookupTableDisk");
+
+    auto ids_dims = ctx->GetInputDim("Ids");
+    int ids_rank = ids_dims.size();
+    auto width = ctx->Attrs().Get<int64_t>("width");
+    std::vector<int64_t> output_dims;
+    if (ctx->Attrs().Get<bool>("squeeze_ids")) {
+      PADDLE_ENFORCE_EQ(
+          ids_dims[ids_rank - 1], 1,
+          platform::errors::InvalidArgument(
+              "ShapeError: The last dimensions of the 'Ids' tensor must be 1. "
+              "But received Ids's last dimensions = %d, Ids's shape = [%s].",
+              ids_dims[ids_rank - 1], ids_dims));
+      output_dims = framework::vectorize(
+          framework::slice_ddim(ids_dims, 0, ids_rank - 1));
+    } else {
+      output_dims = framework::vectorize(ids_dims);
+    }
+    output_dims.push_back(width);
+    ctx->SetOutputDim("Out", framework::make_ddim(output_dims));
+
+    if (ctx->GetOutputsVarType("Out")[0] ==
+        framework::proto::VarType::LOD_TENSOR) {
+      ctx->ShareLoD("Ids", /*->*/ "Out");
+    }
+  }
+
+ protected:
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext& ctx) const override {
+    // The table is read on CPU, and Out is copied to the next op if needed.
+    auto data_type =
+        static_cast<framework::proto::VarType::Type>(ctx.Attr<int>("dtype"));
+    return framework::OpKernelType(data_type, platform::CPUPlace());
+  }
+};
+
+class LookupTableDiskOpMaker : public framework::OpProtoAndCheckerMaker {
+ public:
+  void Make() override {
+    AddInput("Ids",
+             "An input with type int32 or int64 "
+             "contains the ids to be looked up in the table.");
+    AddOutput("Out", "The lookup results, which have the type of the table.");
+    AddAttr<std::string>("table_dir",
+                         "(string) The directory of the table, written by "
+                         "DiskEmbeddingTable::Build.");
+    AddAttr<int64_t>("cache_rows",
+                     "(int64, default 0) The number of the rows of the table "
+                     "cached in memory, shared by all the ops reading it.")
+        .SetDefault(0);
+    AddAttr<int64_t>("width", "(int64) The width of the rows of the table.");
+    AddAttr<int>("dtype", "(int) The data type of the table.");
+    AddAttr<bool>("squeeze_ids",
+                  "(bool, default false) Whether the last dimension of Ids "
+                  "is 1 and dropped in Out, as lookup_table does.")
+        .SetDefault(false);
+    AddAttr<int64_t>("padding_idx",
+                     "(int64, default -1) "
+                     "If the value is -1, it makes no effect to lookup. "
+                     "Otherwise the given value indicates padding the output "
+                     "with zeros whenever lookup encounters it in Ids.")
+        .SetDefault(-1);
+    AddComment(R"DOC(
+Lookup Table Disk Operator.
+
+This operator looks up the rows of an embedding table stored on disk, which
+replaces lookup_table and lookup_table_v2 in inference for the tables too
+large to be loaded into memory. The hot rows are cached in memory, and the
+other rows are read from the files of the table.
+
+The input Ids can carry the LoD (Level of Details) information,
+or not. And the output only shares the LoD information with input Ids.
+
+)DOC");
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators;
+REGISTER_OPERATOR(
+    lookup_table_disk, ops::LookupTableDiskOp, ops::LookupTableDiskOpMaker,
+    paddle::framework::EmptyGradOpMaker<paddle::framework::OpDesc>,
+    paddle::framework::EmptyGradOpMaker<paddle::imperative::OpBase>);
+REGISTER_OP_CPU_KERNEL(lookup_table_disk, ops::LookupTableDiskKernel<float>,
+                       ops::LookupTableDiskKernel<double>);
@@ -0,0 +1,67 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/disk_embedding_table.h"
+
+namespace paddle {
+namespace operators {
+
+template <typename T>
+class LookupTableDiskKernel : public framework::OpKernel<T> {
+ public:
+  void Compute(const framework::ExecutionContext &context) const override {
+    auto *ids_t = context.Input<framework::LoDTensor>("Ids");
+    auto *output_t = context.Output<framework::LoDTensor>("Out");
+    auto table_dir = context.Attr<std::string>("table_dir");
+    auto cache_rows = context.Attr<int64_t>("cache_rows");
+    auto padding_idx = context.Attr<int64_t>("padding_idx");
+
+    auto table =
+        math::DiskEmbeddingTables::Instance().Get(table_dir, cache_rows);
+    PADDLE_ENFORCE_EQ(
+        table->width(), context.Attr<int64_t>("width"),
+        platform::errors::InvalidArgument(
+            "The width of the embedding table in %s is %ld, but the op "
+            "expects %ld, please check whether the table is changed.",
+            table_dir, table->width(), context.Attr<int64_t>("width")));
+    PADDLE_ENFORCE_EQ(
+        table->type(), framework::DataTypeTrait<T>::DataType(),
+        platform::errors::InvalidArgument(
+            "The embedding table in %s is of %s, but the op expects %s.",
+            table_dir, framework::DataTypeToString(table->type()),
+            framework::DataTypeToString(
+                framework::DataTypeTrait<T>::DataType())));
+
+    int64_t ids_numel = ids_t->numel();
+    std::vector<int64_t> ids;
+    if (ids_t->type() == framework::proto::VarType::INT32) {
+      ids.assign(ids_t->data<int>(), ids_t->data<int>() + ids_numel);
+    } else {
+      ids.assign(ids_t->data<int64_t>(), ids_t->data<int64_t>() + ids_numel);
+    }
+    auto *output = output_t->mutable_data<T>(context.GetPlace());
+    table->Lookup(ids.data(), ids_numel, padding_idx, output);
+  }
+};
+
+}  // namespace operators
+}  // namespace paddle
@@ -22,7 +22,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows.h"
-#include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/embedding.h"
 
 namespace paddle {
 namespace operators {
@@ -64,9 +64,11 @@ class LookupTableV2Kernel : public framework::OpKernel<T> {
       auto *table = table_t->data<T>();
       auto *output = output_t->mutable_data<T>(context.GetPlace());
 
+      // The ids are checked before the rows are gathered in parallel.
+      std::vector<int64_t> rows(ids_numel);
       for (int64_t i = 0; i < ids_numel; ++i) {
         if (padding_idx != kNoPadding && ids[i] == padding_idx) {
-          memset(output + i * row_width, 0, row_width * sizeof(T));
+          rows[i] = -1;
         } else {
           PADDLE_ENFORCE_LT(
               ids[i], row_number,
@@ -82,20 +84,22 @@ class LookupTableV2Kernel : public framework::OpKernel<T> {
                   "expected >= 0 and < %ld, but got %ld. Please check input "
                   "value.",
                   row_number, ids[i]));
-          memcpy(output + i * row_width, table + ids[i] * row_width,
-                 row_width * sizeof(T));
+          rows[i] = ids[i];
         }
       }
+      math::EmbeddingGatherFunctor<platform::CPUDeviceContext, T> gather;
+      gather(context.template device_context<platform::CPUDeviceContext>(),
+             table, row_width, rows.data(), ids_numel, output);
     } else if (table_var->IsType<SelectedRows>()) {
       const auto &table_t = table_var->Get<SelectedRows>();
       int64_t row_width = table_t.value().dims()[1];
       const auto *table = table_t.value().data<T>();
       auto *output = output_t->mutable_data<T>(context.GetPlace());
 
-      auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
+      std::vector<int64_t> rows(ids_numel);
       for (int64_t i = 0; i < ids_numel; ++i) {
         if (padding_idx != kNoPadding && ids[i] == padding_idx) {
-          memset(output + i * row_width, 0, row_width * sizeof(T));
+          rows[i] = -1;
         } else {
           PADDLE_ENFORCE_GE(
               ids[i], 0,
@@ -109,10 +113,12 @@ class LookupTableV2Kernel : public framework::OpKernel<T> {
               platform::errors::InvalidArgument(
                   "the input key should be exists. But received %d.",
                   id_index));
-          blas.VCOPY(row_width, table + id_index * row_width,
-                     output + i * row_width);
+          rows[i] = id_index;
         }
       }
+      math::EmbeddingGatherFunctor<platform::CPUDeviceContext, T> gather;
+      gather(context.template device_context<platform::CPUDeviceContext>(),
+             table, row_width, rows.data(), ids_numel, output);
     }
   }
 };
@@ -204,12 +210,12 @@ class LookupTableV2GradKernel : public framework::OpKernel<T> {
       auto *d_output_data = d_output->data<T>();
       auto *d_table_data = d_table->mutable_data<T>(context.GetPlace());
 
-      memset(d_table_data, 0, d_table->numel() * sizeof(T));
-
+      std::vector<int64_t> rows(ids_num);
       for (int64_t i = 0; i < ids_num; ++i) {
         if (padding_idx != kNoPadding && ids_data[i] == padding_idx) {
-          // the gradient of padding_idx should be 0, already done by memset, so
-          // do nothing.
+          // the gradient of padding_idx should be 0, which is skipped by the
+          // negative row.
+          rows[i] = -1;
         } else {
           PADDLE_ENFORCE_LT(
               ids_data[i], N,
@@ -225,11 +231,14 @@ class LookupTableV2GradKernel : public framework::OpKernel<T> {
                   "expected >= 0 and < %ld, but got %ld. Please check input "
                   "value.",
                   N, ids_data[i]));
-          for (int j = 0; j < D; ++j) {
-            d_table_data[ids_data[i] * D + j] += d_output_data[i * D + j];
-          }
+          rows[i] = ids_data[i];
         }
       }
+      math::EmbeddingScatterAddFunctor<platform::CPUDeviceContext, T>
+          scatter_add;
+      scatter_add(
+          context.template device_context<platform::CPUDeviceContext>(),
+          d_output_data, D, rows.data(), ids_num, N, d_table_data);
     }
   }
 };
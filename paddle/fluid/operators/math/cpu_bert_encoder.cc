@@ -0,0 +1,223 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/cpu_bert_encoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "paddle/fluid/operators/jit/kernels.h"
+#include "paddle/fluid/operators/math/blas.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The rows added and normalized by one thread at a time, which stay in cache
+// between the two kernels.
+static constexpr int64_t kRowsPerBlock = 16;
+
+template <typename T>
+void CPUSkipLayerNorm(int64_t rows, int width, const T* x, const T* y,
+                      const T* scale, const T* bias, float epsilon, T* out,
+                      T* mean, T* var) {
+  std::vector<T> mean_buf, var_buf;
+  if (mean == nullptr) {
+    mean_buf.resize(rows);
+    mean = mean_buf.data();
+  }
+  if (var == nullptr) {
+    var_buf.resize(rows);
+    var = var_buf.data();
+  }
+  // KernelFuncs::Cache is not thread safe, so the kernels are fetched before
+  // the parallel loop.
+  auto add =
+      jit::KernelFuncs<jit::VAddTuple<T>, platform::CPUPlace>::Cache().At(
+          width);
+  auto layer_norm =
+      jit::KernelFuncs<jit::LayerNormTuple<T>, platform::CPUPlace>::Cache().At(
+          width);
+  int64_t blocks = (rows + kRowsPerBlock - 1) / kRowsPerBlock;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t block = 0; block < blocks; ++block) {
+    int64_t begin = block * kRowsPerBlock;
+    int64_t end = std::min(begin + kRowsPerBlock, rows);
+    T* dst = out + begin * width;
+    if (y != nullptr) {
+      for (int64_t i = begin; i < end; ++i) {
+        add(x + i * width, y + i * width, out + i * width, width);
+      }
+    } else if (out != x) {
+      std::memcpy(dst, x + begin * width, (end - begin) * width * sizeof(T));
+    }
+    layer_norm(dst, dst, mean + begin, var + begin, scale, bias,
+               static_cast<int>(end - begin), epsilon, width);
+  }
+}
+
+template <typename T>
+void CPUEmbEltwiseLayerNorm(int64_t rows, int width,
+                            const std::vector<const int64_t*>& ids,
+                            const std::vector<const T*>& embs, const T* scale,
+                            const T* bias, float epsilon, T* out) {
+  auto add =
+      jit::KernelFuncs<jit::VAddTuple<T>, platform::CPUPlace>::Cache().At(
+          width);
+  size_t input_num = ids.size();
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t i = 0; i < rows; ++i) {
+    T* dst = out + i * width;
+    std::memcpy(dst, embs[0] + ids[0][i] * width, width * sizeof(T));
+    for (size_t k = 1; k < input_num; ++k) {
+      add(embs[k] + ids[k][i] * width, dst, dst, width);
+    }
+  }
+  CPUSkipLayerNorm<T>(rows, width, out, nullptr, scale, bias, epsilon, out);
+}
+
+template <typename T>
+void CPUBiasGelu(int64_t rows, int width, const T* bias, bool approximate,
+                 T* x) {
+  auto vtanh =
+      jit::KernelFuncs<jit::VTanhTuple<T>, platform::CPUPlace>::Cache().At(
+          width);
+  int64_t blocks = (rows + kRowsPerBlock - 1) / kRowsPerBlock;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t block = 0; block < blocks; ++block) {
+    std::vector<T> temp(width);
+    int64_t end = std::min((block + 1) * kRowsPerBlock, rows);
+    for (int64_t i = block * kRowsPerBlock; i < end; ++i) {
+      T* row = x + i * width;
+      if (bias != nullptr) {
+        for (int j = 0; j < width; ++j) row[j] += bias[j];
+      }
+      if (approximate) {
+        // gelu(x) = 0.5 * x * (1 + tanh(sqrt(2 / \pi) * (x + 0.044715 * x^3)))
+        for (int j = 0; j < width; ++j) {
+          temp[j] = static_cast<T>(M_2_SQRTPI * M_SQRT1_2) *
+                    (row[j] + static_cast<T>(0.044715) * row[j] * row[j] *
+                                  row[j]);
+        }
+        vtanh(temp.data(), temp.data(), width);
+      } else {
+        // gelu(x) = 0.5 * x * (1 + erf(x / sqrt(2)))
+#if defined(PADDLE_WITH_MKLML) && !defined(_WIN32) && !defined(__APPLE__) && \
+    !defined(__OSX__) && !defined(PADDLE_WITH_CUDA)
+        for (int j = 0; j < width; ++j) {
+          temp[j] = row[j] * static_cast<T>(M_SQRT1_2);
+        }
+        CBlas<T>::VMERF(width, temp.data(), temp.data(), VML_LA);
+#else
+        for (int j = 0; j < width; ++j) {
+          temp[j] = std::erf(row[j] * static_cast<T>(M_SQRT1_2));
+        }
+#endif
+      }
+      for (int j = 0; j < width; ++j) {
+        row[j] *= static_cast<T>(0.5) * (static_cast<T>(1) + temp[j]);
+      }
+    }
+  }
+}
+
+template <typename T>
+void CPUMultiHeadAttention(const platform::CPUDeviceContext& context,
+                           int batch, int seq_len, int head_num,
+                           int head_size, T* qkv, const T* qkv_bias,
+                           const T* bias_qk,
+                           const std::array<int64_t, 3>& bias_qk_strides,
+                           T alpha, T* out) {
+  int all_head_size = head_num * head_size;
+  int ld_qkv = 3 * all_head_size;
+  int64_t rows = static_cast<int64_t>(batch) * seq_len;
+  auto add =
+      jit::KernelFuncs<jit::VAddTuple<T>, platform::CPUPlace>::Cache().At(
+          ld_qkv);
+  auto add_qk =
+      jit::KernelFuncs<jit::VAddTuple<T>, platform::CPUPlace>::Cache().At(
+          seq_len * seq_len);
+  auto add_row =
+      jit::KernelFuncs<jit::VAddTuple<T>, platform::CPUPlace>::Cache().At(
+          seq_len);
+  auto softmax =
+      jit::KernelFuncs<jit::SoftmaxTuple<T>, platform::CPUPlace>::Cache().At(
+          seq_len);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t i = 0; i < rows; ++i) {
+    add(qkv + i * ld_qkv, qkv_bias, qkv + i * ld_qkv, ld_qkv);
+  }
+
+  auto blas = GetBlas<platform::CPUDeviceContext, T>(context);
+  int heads = batch * head_num;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int head = 0; head < heads; ++head) {
+    int b = head / head_num;
+    int n = head % head_num;
+    std::vector<T> qk(static_cast<size_t>(seq_len) * seq_len);
+    const T* q = qkv + static_cast<int64_t>(b) * seq_len * ld_qkv +
+                 n * head_size;
+    const T* k = q + all_head_size;
+    const T* v = k + all_head_size;
+    // qk = alpha * q * k^T + bias_qk
+    blas.GEMM(false, true, seq_len, seq_len, head_size, alpha, q, ld_qkv, k,
+              ld_qkv, static_cast<T>(0), qk.data(), seq_len);
+    const T* head_bias_qk =
+        bias_qk + b * bias_qk_strides[0] + n * bias_qk_strides[1];
+    if (bias_qk_strides[2] == seq_len) {
+      add_qk(qk.data(), head_bias_qk, qk.data(), seq_len * seq_len);
+    } else {
+      for (int i = 0; i < seq_len; ++i) {
+        add_row(qk.data() + i * seq_len, head_bias_qk + i * bias_qk_strides[2],
+                qk.data() + i * seq_len, seq_len);
+      }
+    }
+    softmax(qk.data(), qk.data(), seq_len, seq_len, 1);
+    // out[b, :, n] = qk * v
+    blas.GEMM(false, false, seq_len, head_size, seq_len, static_cast<T>(1),
+              qk.data(), seq_len, v, ld_qkv, static_cast<T>(0),
+              out + static_cast<int64_t>(b) * seq_len * all_head_size +
+                  n * head_size,
+              all_head_size);
+  }
+}
+
+#define INSTANTIATE_CPU_BERT_ENCODER(T)                                      \
+  template void CPUSkipLayerNorm<T>(int64_t, int, const T*, const T*,        \
+                                    const T*, const T*, float, T*, T*, T*); \
+  template void CPUEmbEltwiseLayerNorm<T>(                                   \
+      int64_t, int, const std::vector<const int64_t*>&,                      \
+      const std::vector<const T*>&, const T*, const T*, float, T*);          \
+  template void CPUBiasGelu<T>(int64_t, int, const T*, bool, T*);            \
+  template void CPUMultiHeadAttention<T>(                                   \
+      const platform::CPUDeviceContext&, int, int, int, int, T*, const T*,   \
+      const T*, const std::array<int64_t, 3>&, T, T*)
+
+INSTANTIATE_CPU_BERT_ENCODER(float);
+INSTANTIATE_CPU_BERT_ENCODER(double);
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
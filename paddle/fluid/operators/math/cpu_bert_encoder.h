@@ -0,0 +1,76 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The CPU counterparts of bert_encoder_functor.h, which compose the kernels
+// of operators/jit for the fused ops of Ernie and Bert.
+
+// out = layer_norm(x + y) for rows of width elements, where y, scale and
+// bias may be null, and out may be x. The mean and the variance of the rows
+// are written to mean and var if they are not null.
+template <typename T>
+void CPUSkipLayerNorm(int64_t rows, int width, const T* x, const T* y,
+                      const T* scale, const T* bias, float epsilon, T* out,
+                      T* mean = nullptr, T* var = nullptr);
+
+// out[i] = layer_norm(embs[0][ids[0][i]] + ... + embs[n-1][ids[n-1][i]])
+// for rows of width elements.
+template <typename T>
+void CPUEmbEltwiseLayerNorm(int64_t rows, int width,
+                            const std::vector<const int64_t*>& ids,
+                            const std::vector<const T*>& embs, const T* scale,
+                            const T* bias, float epsilon, T* out);
+
+// x = gelu(x + bias) for rows of width elements, by the tanh approximation
+// if approximate, or by erf otherwise. bias may be null.
+template <typename T>
+void CPUBiasGelu(int64_t rows, int width, const T* bias, bool approximate,
+                 T* x);
+
+// The attention of multihead_matmul:
+//
+//   qkv:     [batch, seq_len, 3, head_num, head_size], Q, K and V without
+//            bias, which is added in place.
+//   qkv_bias: [3, head_num, head_size]
+//   bias_qk: [batch, head_num, seq_len, seq_len], of which the strides of
+//            batch, head_num and the rows are bias_qk_strides, 0 for the
+//            broadcast dims, e.g. {seq_len, 0, 0} for a mask [batch, 1, 1,
+//            seq_len].
+//   out:     [batch, seq_len, head_num, head_size]
+//
+// out = softmax(alpha * Q * K^T + bias_qk) * V for each head. The heads are
+// computed in parallel, reading Q, K and V in place by the leading
+// dimensions of GEMM instead of transposing them.
+template <typename T>
+void CPUMultiHeadAttention(const platform::CPUDeviceContext& context,
+                           int batch, int seq_len, int head_num,
+                           int head_size, T* qkv, const T* qkv_bias,
+                           const T* bias_qk,
+                           const std::array<int64_t, 3>& bias_qk_strides,
+                           T alpha, T* out);
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
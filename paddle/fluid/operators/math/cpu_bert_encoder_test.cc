@@ -0,0 +1,199 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/cpu_bert_encoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+template <typename T>
+static std::vector<T> RandomVector(size_t n, int seed) {
+  std::mt19937 engine(seed);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<T> v(n);
+  for (auto& x : v) x = static_cast<T>(dist(engine));
+  return v;
+}
+
+template <typename T>
+static void NaiveLayerNorm(int64_t rows, int width, const T* scale,
+                           const T* bias, float epsilon, T* x) {
+  for (int64_t i = 0; i < rows; ++i) {
+    T* row = x + i * width;
+    double mean = 0, var = 0;
+    for (int j = 0; j < width; ++j) mean += row[j];
+    mean /= width;
+    for (int j = 0; j < width; ++j) var += (row[j] - mean) * (row[j] - mean);
+    var /= width;
+    for (int j = 0; j < width; ++j) {
+      row[j] = static_cast<T>((row[j] - mean) / std::sqrt(var + epsilon) *
+                                  scale[j] +
+                              bias[j]);
+    }
+  }
+}
+
+template <typename T>
+static void ExpectNear(const std::vector<T>& out, const std::vector<T>& ref,
+                       double eps) {
+  ASSERT_EQ(out.size(), ref.size());
+  for (size_t i = 0; i < out.size(); ++i) {
+    ASSERT_NEAR(out[i], ref[i], eps) << "at " << i;
+  }
+}
+
+TEST(CPUBertEncoder, skip_layernorm) {
+  int64_t rows = 37;
+  int width = 96;
+  auto x = RandomVector<float>(rows * width, 0);
+  auto y = RandomVector<float>(rows * width, 1);
+  auto scale = RandomVector<float>(width, 2);
+  auto bias = RandomVector<float>(width, 3);
+  std::vector<float> out(rows * width), ref(rows * width);
+  for (size_t i = 0; i < ref.size(); ++i) ref[i] = x[i] + y[i];
+  NaiveLayerNorm<float>(rows, width, scale.data(), bias.data(), 1e-5f,
+                        ref.data());
+  CPUSkipLayerNorm<float>(rows, width, x.data(), y.data(), scale.data(),
+                          bias.data(), 1e-5f, out.data());
+  ExpectNear(out, ref, 1e-4);
+}
+
+TEST(CPUBertEncoder, emb_eltwise_layernorm) {
+  int64_t rows = 20;
+  int width = 64;
+  int vocab = 11;
+  std::vector<std::vector<int64_t>> ids(3, std::vector<int64_t>(rows));
+  std::vector<std::vector<double>> embs;
+  for (int k = 0; k < 3; ++k) {
+    for (int64_t i = 0; i < rows; ++i) ids[k][i] = (i * (k + 3)) % vocab;
+    embs.push_back(RandomVector<double>(vocab * width, k));
+  }
+  auto scale = RandomVector<double>(width, 5);
+  auto bias = RandomVector<double>(width, 6);
+  std::vector<double> out(rows * width), ref(rows * width, 0);
+  for (int64_t i = 0; i < rows; ++i) {
+    for (int k = 0; k < 3; ++k) {
+      for (int j = 0; j < width; ++j) {
+        ref[i * width + j] += embs[k][ids[k][i] * width + j];
+      }
+    }
+  }
+  NaiveLayerNorm<double>(rows, width, scale.data(), bias.data(), 1e-5f,
+                         ref.data());
+  CPUEmbEltwiseLayerNorm<double>(
+      rows, width, {ids[0].data(), ids[1].data(), ids[2].data()},
+      {embs[0].data(), embs[1].data(), embs[2].data()}, scale.data(),
+      bias.data(), 1e-5f, out.data());
+  ExpectNear(out, ref, 1e-9);
+}
+
+TEST(CPUBertEncoder, bias_gelu) {
+  int64_t rows = 19;
+  int width = 80;
+  auto bias = RandomVector<float>(width, 1);
+  for (bool approximate : {false, true}) {
+    auto x = RandomVector<float>(rows * width, 0);
+    std::vector<float> ref(x.size());
+    for (int64_t i = 0; i < rows; ++i) {
+      for (int j = 0; j < width; ++j) {
+        double v = x[i * width + j] + bias[j];
+        double cdf = approximate ? 1 + std::tanh(std::sqrt(2 / M_PI) *
+                                                 (v + 0.044715 * v * v * v))
+                                 : 1 + std::erf(v / std::sqrt(2.0));
+        ref[i * width + j] = static_cast<float>(0.5 * v * cdf);
+      }
+    }
+    CPUBiasGelu<float>(rows, width, bias.data(), approximate, x.data());
+    ExpectNear(x, ref, 1e-5);
+  }
+}
+
+// bias_qk_dims is [batch, head_num, seq_len, seq_len] or broadcast to it.
+static void TestMultiHeadAttention(const std::array<int, 4>& bias_qk_dims) {
+  int batch = 2, seq_len = 7, head_num = 3, head_size = 8;
+  int all_head_size = head_num * head_size;
+  float alpha = 1.0f / std::sqrt(static_cast<float>(head_size));
+  auto qkv = RandomVector<float>(batch * seq_len * 3 * all_head_size, 0);
+  auto qkv_bias = RandomVector<float>(3 * all_head_size, 1);
+  auto bias_qk = RandomVector<float>(
+      bias_qk_dims[0] * bias_qk_dims[1] * bias_qk_dims[2] * bias_qk_dims[3],
+      2);
+  std::array<int64_t, 3> bias_qk_strides;
+  int64_t stride = seq_len;
+  for (int i = 2; i >= 0; --i) {
+    bias_qk_strides[i] = bias_qk_dims[i] == 1 ? 0 : stride;
+    stride *= bias_qk_dims[i];
+  }
+  std::vector<float> ref(batch * seq_len * all_head_size);
+  for (int b = 0; b < batch; ++b) {
+    for (int n = 0; n < head_num; ++n) {
+      auto at = [&](int s, int which, int h) {
+        return qkv[((b * seq_len + s) * 3 + which) * all_head_size +
+                   n * head_size + h] +
+               qkv_bias[which * all_head_size + n * head_size + h];
+      };
+      for (int i = 0; i < seq_len; ++i) {
+        std::vector<double> p(seq_len);
+        double max = -1e30, sum = 0;
+        for (int j = 0; j < seq_len; ++j) {
+          double dot = 0;
+          for (int h = 0; h < head_size; ++h) dot += at(i, 0, h) * at(j, 1, h);
+          int bb = bias_qk_dims[0] == 1 ? 0 : b;
+          int nn = bias_qk_dims[1] == 1 ? 0 : n;
+          int ii = bias_qk_dims[2] == 1 ? 0 : i;
+          int row = (bb * bias_qk_dims[1] + nn) * bias_qk_dims[2] + ii;
+          p[j] = alpha * dot + bias_qk[row * seq_len + j];
+          max = std::max(max, p[j]);
+        }
+        for (auto& v : p) sum += (v = std::exp(v - max));
+        for (int h = 0; h < head_size; ++h) {
+          double acc = 0;
+          for (int j = 0; j < seq_len; ++j) acc += p[j] / sum * at(j, 2, h);
+          ref[(b * seq_len + i) * all_head_size + n * head_size + h] =
+              static_cast<float>(acc);
+        }
+      }
+    }
+  }
+  platform::CPUDeviceContext context(platform::CPUPlace{});
+  std::vector<float> out(ref.size());
+  CPUMultiHeadAttention<float>(context, batch, seq_len, head_num, head_size,
+                               qkv.data(), qkv_bias.data(), bias_qk.data(),
+                               bias_qk_strides, alpha, out.data());
+  ExpectNear(out, ref, 1e-5);
+}
+
+TEST(CPUBertEncoder, multihead_attention) {
+  TestMultiHeadAttention({2, 3, 7, 7});
+}
+
+TEST(CPUBertEncoder, multihead_attention_broadcast_bias_qk) {
+  // The input mask of Bert and Ernie, which is the same for heads and rows.
+  TestMultiHeadAttention({2, 1, 1, 7});
+  TestMultiHeadAttention({2, 1, 7, 7});
+  TestMultiHeadAttention({1, 3, 7, 7});
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
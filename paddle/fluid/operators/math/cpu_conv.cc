@@ -0,0 +1,551 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/cpu_conv.h"
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/operator_kernel_configs.h"
+#include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/im2col.h"
+#include "paddle/fluid/platform/timer.h"
+
+DECLARE_bool(cpu_conv_exhaustive_search);
+DECLARE_bool(cpu_conv_use_winograd);
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The size of the transformed input of Winograd in bytes, above which the
+// images of a batch are transformed and multiplied by chunks.
+constexpr int64_t kWinogradWorkspaceBytes = 16 << 20;
+// Winograd is only chosen when both input and output channels of each group
+// are not less than kWinogradMinChannels, and there are enough output tiles,
+// otherwise the transforms are not amortized and the GEMMs are too narrow.
+constexpr int kWinogradMinChannels = 16;
+constexpr int64_t kWinogradF4x3MinTiles = 48;
+constexpr int64_t kWinogradF2x3MinTiles = 64;
+
+const char* CPUConvAlgoName(CPUConvAlgo algo) {
+  switch (algo) {
+    case CPUConvAlgo::kIm2ColGemm:
+      return "im2col_gemm";
+    case CPUConvAlgo::kGemm1x1:
+      return "gemm_1x1";
+    case CPUConvAlgo::kDepthwiseDirect:
+      return "depthwise_direct";
+    case CPUConvAlgo::kWinogradF2x3:
+      return "winograd_f2x3";
+    case CPUConvAlgo::kWinogradF4x3:
+      return "winograd_f4x3";
+  }
+  return "unknown";
+}
+
+bool CPUConvAlgoSupported(CPUConvAlgo algo, const CPUConv2DParam& param) {
+  bool no_padding = param.pad_top == 0 && param.pad_bottom == 0 &&
+                    param.pad_left == 0 && param.pad_right == 0;
+  switch (algo) {
+    case CPUConvAlgo::kIm2ColGemm:
+      return true;
+    case CPUConvAlgo::kGemm1x1:
+      return param.filter_h == 1 && param.filter_w == 1 &&
+             param.stride_h == 1 && param.stride_w == 1 && no_padding;
+    case CPUConvAlgo::kDepthwiseDirect:
+      return param.groups == param.in_channels &&
+             param.out_channels % param.in_channels == 0;
+    case CPUConvAlgo::kWinogradF2x3:
+    case CPUConvAlgo::kWinogradF4x3:
+      return param.filter_h == 3 && param.filter_w == 3 &&
+             param.stride_h == 1 && param.stride_w == 1 &&
+             param.dilation_h == 1 && param.dilation_w == 1;
+  }
+  return false;
+}
+
+CPUConvAlgo CPUConvHeuristic(const CPUConv2DParam& param, bool use_winograd) {
+  if (CPUConvAlgoSupported(CPUConvAlgo::kGemm1x1, param)) {
+    return CPUConvAlgo::kGemm1x1;
+  }
+  if (param.groups > 1 &&
+      CPUConvAlgoSupported(CPUConvAlgo::kDepthwiseDirect, param)) {
+    return CPUConvAlgo::kDepthwiseDirect;
+  }
+  int in_channels = param.in_channels / param.groups;
+  int out_channels = param.out_channels / param.groups;
+  if (!use_winograd || in_channels < kWinogradMinChannels ||
+      out_channels < kWinogradMinChannels ||
+      !CPUConvAlgoSupported(CPUConvAlgo::kWinogradF4x3, param)) {
+    return CPUConvAlgo::kIm2ColGemm;
+  }
+  auto tiles = [&](int m) {
+    return static_cast<int64_t>(param.batch_size) *
+           ((param.out_h + m - 1) / m) * ((param.out_w + m - 1) / m);
+  };
+  if (tiles(4) >= kWinogradF4x3MinTiles) return CPUConvAlgo::kWinogradF4x3;
+  if (tiles(2) >= kWinogradF2x3MinTiles) return CPUConvAlgo::kWinogradF2x3;
+  return CPUConvAlgo::kIm2ColGemm;
+}
+
+template <typename T>
+static void Im2ColGemmConv(const platform::CPUDeviceContext& context,
+                           const CPUConv2DParam& param,
+                           const framework::Tensor& input,
+                           const framework::Tensor& filter,
+                           framework::Tensor* output) {
+  int in_step = param.in_channels / param.groups;
+  int out_step = param.out_channels / param.groups;
+  int out_size = param.out_h * param.out_w;
+  int col_height = in_step * param.filter_h * param.filter_w;
+  framework::Tensor col;
+  col.mutable_data<T>({in_step, param.filter_h, param.filter_w, param.out_h,
+                       param.out_w},
+                      context.GetPlace());
+  std::vector<int> dilations{param.dilation_h, param.dilation_w};
+  std::vector<int> strides{param.stride_h, param.stride_w};
+  std::vector<int> paddings{param.pad_top, param.pad_left, param.pad_bottom,
+                            param.pad_right};
+  Im2ColFunctor<ColFormat::kCFO, platform::CPUDeviceContext, T> im2col;
+  auto blas = GetBlas<platform::CPUDeviceContext, T>(context);
+  const T* filter_data = filter.data<T>();
+  T* output_data = output->data<T>();
+  for (int i = 0; i < param.batch_size; ++i) {
+    framework::Tensor in_batch = input.Slice(i, i + 1).Resize(
+        {param.in_channels, param.in_h, param.in_w});
+    for (int g = 0; g < param.groups; ++g) {
+      framework::Tensor in_slice =
+          in_batch.Slice(g * in_step, (g + 1) * in_step);
+      im2col(context, in_slice, dilations, strides, paddings, &col);
+      T* out_slice = output_data +
+                     (static_cast<int64_t>(i) * param.out_channels +
+                      g * out_step) *
+                         out_size;
+      blas.GEMM(CblasNoTrans, CblasNoTrans, out_step, out_size, col_height,
+                static_cast<T>(1), filter_data + g * out_step * col_height,
+                col.data<T>(), static_cast<T>(0), out_slice);
+    }
+  }
+}
+
+// The input of each group is the right matrix of GEMM as it is.
+template <typename T>
+static void Gemm1x1Conv(const platform::CPUDeviceContext& context,
+                        const CPUConv2DParam& param,
+                        const framework::Tensor& input,
+                        const framework::Tensor& filter,
+                        framework::Tensor* output) {
+  int in_step = param.in_channels / param.groups;
+  int out_step = param.out_channels / param.groups;
+  int out_size = param.out_h * param.out_w;
+  auto blas = GetBlas<platform::CPUDeviceContext, T>(context);
+  const T* input_data = input.data<T>();
+  const T* filter_data = filter.data<T>();
+  T* output_data = output->data<T>();
+  for (int i = 0; i < param.batch_size; ++i) {
+    for (int g = 0; g < param.groups; ++g) {
+      const T* in_slice = input_data + (static_cast<int64_t>(i) *
+                                            param.in_channels +
+                                        g * in_step) *
+                                           out_size;
+      T* out_slice = output_data + (static_cast<int64_t>(i) *
+                                        param.out_channels +
+                                    g * out_step) *
+                                       out_size;
+      blas.GEMM(CblasNoTrans, CblasNoTrans, out_step, out_size, in_step,
+                static_cast<T>(1), filter_data + g * out_step * in_step,
+                in_slice, static_cast<T>(0), out_slice);
+    }
+  }
+}
+
+// Each output channel is accumulated row by row. For each tap of the filter,
+// the output columns whose input columns are inside the image are computed
+// by one contiguous loop, so there is neither padding nor branch inside it.
+template <typename T>
+static void DepthwiseDirectConv(const platform::CPUDeviceContext& context,
+                                const CPUConv2DParam& param,
+                                const framework::Tensor& input,
+                                const framework::Tensor& filter,
+                                framework::Tensor* output) {
+  const int multiplier = param.out_channels / param.in_channels;
+  const int64_t in_size = static_cast<int64_t>(param.in_h) * param.in_w;
+  const int64_t out_size = static_cast<int64_t>(param.out_h) * param.out_w;
+  const int filter_size = param.filter_h * param.filter_w;
+  const T* input_data = input.data<T>();
+  const T* filter_data = filter.data<T>();
+  T* output_data = output->data<T>();
+
+  // The range of output columns [begin, end) of each filter column.
+  std::vector<int> col_begin(param.filter_w), col_end(param.filter_w);
+  for (int kw = 0; kw < param.filter_w; ++kw) {
+    int offset = kw * param.dilation_w - param.pad_left;
+    int begin = offset >= 0 ? 0
+                            : (-offset + param.stride_w - 1) / param.stride_w;
+    int end = param.in_w - offset <= 0
+                  ? 0
+                  : (param.in_w - offset - 1) / param.stride_w + 1;
+    col_begin[kw] = std::min(begin, param.out_w);
+    col_end[kw] = std::max(std::min(end, param.out_w), col_begin[kw]);
+  }
+
+  const int64_t channels =
+      static_cast<int64_t>(param.batch_size) * param.out_channels;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t nc = 0; nc < channels; ++nc) {
+    int n = static_cast<int>(nc / param.out_channels);
+    int oc = static_cast<int>(nc % param.out_channels);
+    const T* in_channel =
+        input_data + (static_cast<int64_t>(n) * param.in_channels +
+                      oc / multiplier) *
+                         in_size;
+    const T* weights = filter_data + static_cast<int64_t>(oc) * filter_size;
+    T* out_channel = output_data + nc * out_size;
+    for (int oh = 0; oh < param.out_h; ++oh) {
+      T* out_row = out_channel + oh * param.out_w;
+      std::fill(out_row, out_row + param.out_w, static_cast<T>(0));
+      for (int kh = 0; kh < param.filter_h; ++kh) {
+        int ih = oh * param.stride_h - param.pad_top + kh * param.dilation_h;
+        if (ih < 0 || ih >= param.in_h) continue;
+        const T* in_row = in_channel + ih * param.in_w;
+        for (int kw = 0; kw < param.filter_w; ++kw) {
+          const T w = weights[kh * param.filter_w + kw];
+          const int offset = kw * param.dilation_w - param.pad_left;
+          if (param.stride_w == 1) {
+            for (int ow = col_begin[kw]; ow < col_end[kw]; ++ow) {
+              out_row[ow] += w * in_row[ow + offset];
+            }
+          } else {
+            for (int ow = col_begin[kw]; ow < col_end[kw]; ++ow) {
+              out_row[ow] += w * in_row[ow * param.stride_w + offset];
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+// The transform matrices of Winograd F(m x m, 3 x 3), see "Fast Algorithms
+// for Convolutional Neural Networks" by Lavin and Gray. The input tile has
+// (m + 2) x (m + 2) elements.
+template <int M>
+struct WinogradMatrices;
+
+template <>
+struct WinogradMatrices<2> {
+  static constexpr double BT[4][4] = {
+      {1, 0, -1, 0}, {0, 1, 1, 0}, {0, -1, 1, 0}, {0, 1, 0, -1}};
+  static constexpr double G[4][3] = {
+      {1, 0, 0}, {0.5, 0.5, 0.5}, {0.5, -0.5, 0.5}, {0, 0, 1}};
+  static constexpr double AT[2][4] = {{1, 1, 1, 0}, {0, 1, -1, -1}};
+};
+
+template <>
+struct WinogradMatrices<4> {
+  static constexpr double BT[6][6] = {
+      {4, 0, -5, 0, 1, 0},  {0, -4, -4, 1, 1, 0}, {0, 4, -4, -1, 1, 0},
+      {0, -2, -1, 2, 1, 0}, {0, 2, -1, -2, 1, 0}, {0, 4, 0, -5, 0, 1}};
+  static constexpr double G[6][3] = {{1.0 / 4, 0, 0},
+                                     {-1.0 / 6, -1.0 / 6, -1.0 / 6},
+                                     {-1.0 / 6, 1.0 / 6, -1.0 / 6},
+                                     {1.0 / 24, 1.0 / 12, 1.0 / 6},
+                                     {1.0 / 24, -1.0 / 12, 1.0 / 6},
+                                     {0, 0, 1}};
+  static constexpr double AT[4][6] = {{1, 1, 1, 1, 1, 0},
+                                      {0, 1, -1, 2, -2, 0},
+                                      {0, 1, 1, 4, 4, 0},
+                                      {0, 1, -1, 8, -8, 1}};
+};
+
+constexpr double WinogradMatrices<2>::BT[4][4];
+constexpr double WinogradMatrices<2>::G[4][3];
+constexpr double WinogradMatrices<2>::AT[2][4];
+constexpr double WinogradMatrices<4>::BT[6][6];
+constexpr double WinogradMatrices<4>::G[6][3];
+constexpr double WinogradMatrices<4>::AT[4][6];
+
+// out = left * in * right^T, where left and right are R x C, and in is
+// C x C.
+template <typename T, int R, int C>
+static inline void WinogradTransform(const double (&left)[R][C],
+                                     const T (&in)[C][C],
+                                     const double (&right)[R][C],
+                                     T (&out)[R][R]) {
+  T tmp[R][C];
+  for (int i = 0; i < R; ++i) {
+    for (int j = 0; j < C; ++j) {
+      T sum = 0;
+      for (int k = 0; k < C; ++k) {
+        sum += static_cast<T>(left[i][k]) * in[k][j];
+      }
+      tmp[i][j] = sum;
+    }
+  }
+  for (int i = 0; i < R; ++i) {
+    for (int j = 0; j < R; ++j) {
+      T sum = 0;
+      for (int k = 0; k < C; ++k) {
+        sum += tmp[i][k] * static_cast<T>(right[j][k]);
+      }
+      out[i][j] = sum;
+    }
+  }
+}
+
+// The convolution is computed as (m + 2)^2 independent GEMMs of
+//   [out_channels, in_channels] x [in_channels, tiles]
+// between the transformed filter and the transformed input tiles, and the
+// results are transformed back into the m x m output tiles.
+template <typename T, int M>
+static void WinogradConv(const platform::CPUDeviceContext& context,
+                         const CPUConv2DParam& param,
+                         const framework::Tensor& input,
+                         const framework::Tensor& filter,
+                         framework::Tensor* output) {
+  constexpr int A = M + 2;
+  using Matrices = WinogradMatrices<M>;
+  const int in_step = param.in_channels / param.groups;
+  const int out_step = param.out_channels / param.groups;
+  const int tile_h = (param.out_h + M - 1) / M;
+  const int tile_w = (param.out_w + M - 1) / M;
+  const int64_t image_tiles = static_cast<int64_t>(tile_h) * tile_w;
+  const int64_t in_size = static_cast<int64_t>(param.in_h) * param.in_w;
+  const int64_t out_size = static_cast<int64_t>(param.out_h) * param.out_w;
+
+  // The images transformed together, which are at least one.
+  int64_t image_bytes = A * A * in_step * image_tiles * sizeof(T);
+  int chunk_size = static_cast<int>(std::max<int64_t>(
+      1, std::min<int64_t>(param.batch_size,
+                           kWinogradWorkspaceBytes / image_bytes)));
+  const int64_t max_tiles = chunk_size * image_tiles;
+
+  framework::Tensor filter_buffer, input_buffer, output_buffer;
+  T* u = filter_buffer.mutable_data<T>(
+      {A * A, param.out_channels, in_step}, context.GetPlace());
+  T* v = input_buffer.mutable_data<T>({A * A, in_step, max_tiles},
+                                      context.GetPlace());
+  T* m = output_buffer.mutable_data<T>({A * A, out_step, max_tiles},
+                                       context.GetPlace());
+  const T* input_data = input.data<T>();
+  const T* filter_data = filter.data<T>();
+  T* output_data = output->data<T>();
+
+  // U[xi][oc][ic] = (G g G^T)[xi], for all the groups.
+  const int64_t filter_num =
+      static_cast<int64_t>(param.out_channels) * in_step;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t k = 0; k < filter_num; ++k) {
+    T g[3][3];
+    const T* src = filter_data + k * 9;
+    for (int i = 0; i < 3; ++i) {
+      for (int j = 0; j < 3; ++j) g[i][j] = src[i * 3 + j];
+    }
+    T tile[A][A];
+    WinogradTransform<T, A, 3>(Matrices::G, g, Matrices::G, tile);
+    for (int i = 0; i < A; ++i) {
+      for (int j = 0; j < A; ++j) {
+        u[(i * A + j) * filter_num + k] = tile[i][j];
+      }
+    }
+  }
+
+  auto blas = GetBlas<platform::CPUDeviceContext, T>(context);
+  for (int begin = 0; begin < param.batch_size; begin += chunk_size) {
+    const int images = std::min(chunk_size, param.batch_size - begin);
+    const int64_t tiles = images * image_tiles;
+    for (int g = 0; g < param.groups; ++g) {
+      // V[xi][ic][p] = (B^T d B)[xi], where d is the input tile p.
+      const int64_t input_num = static_cast<int64_t>(in_step) * tiles;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+      for (int64_t k = 0; k < input_num; ++k) {
+        int ic = static_cast<int>(k / tiles);
+        int64_t p = k % tiles;
+        int n = begin + static_cast<int>(p / image_tiles);
+        int th = static_cast<int>(p % image_tiles) / tile_w;
+        int tw = static_cast<int>(p % image_tiles) % tile_w;
+        const T* src =
+            input_data + (static_cast<int64_t>(n) * param.in_channels +
+                          g * in_step + ic) *
+                             in_size;
+        int h0 = th * M - param.pad_top;
+        int w0 = tw * M - param.pad_left;
+        T d[A][A];
+        for (int i = 0; i < A; ++i) {
+          int h = h0 + i;
+          for (int j = 0; j < A; ++j) {
+            int w = w0 + j;
+            d[i][j] = (h >= 0 && h < param.in_h && w >= 0 && w < param.in_w)
+                          ? src[h * param.in_w + w]
+                          : static_cast<T>(0);
+          }
+        }
+        T tile[A][A];
+        WinogradTransform<T, A, A>(Matrices::BT, d, Matrices::BT, tile);
+        for (int i = 0; i < A; ++i) {
+          for (int j = 0; j < A; ++j) {
+            v[((i * A + j) * in_step + ic) * tiles + p] = tile[i][j];
+          }
+        }
+      }
+
+      blas.BatchedGEMM(CblasNoTrans, CblasNoTrans, out_step,
+                       static_cast<int>(tiles), in_step, static_cast<T>(1),
+                       u + static_cast<int64_t>(g) * out_step * in_step, v,
+                       static_cast<T>(0), m, A * A, filter_num,
+                       static_cast<int64_t>(in_step) * tiles);
+
+      // Y = A^T m A, whose edges outside of the output are dropped.
+      const int64_t output_num = static_cast<int64_t>(out_step) * tiles;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+      for (int64_t k = 0; k < output_num; ++k) {
+        int oc = static_cast<int>(k / tiles);
+        int64_t p = k % tiles;
+        int n = begin + static_cast<int>(p / image_tiles);
+        int th = static_cast<int>(p % image_tiles) / tile_w;
+        int tw = static_cast<int>(p % image_tiles) % tile_w;
+        T tile[A][A];
+        for (int i = 0; i < A; ++i) {
+          for (int j = 0; j < A; ++j) {
+            tile[i][j] = m[((i * A + j) * out_step + oc) * tiles + p];
+          }
+        }
+        T y[M][M];
+        WinogradTransform<T, M, A>(Matrices::AT, tile, Matrices::AT, y);
+        T* dst = output_data + (static_cast<int64_t>(n) * param.out_channels +
+                                g * out_step + oc) *
+                                   out_size;
+        int rows = std::min(M, param.out_h - th * M);
+        int cols = std::min(M, param.out_w - tw * M);
+        for (int i = 0; i < rows; ++i) {
+          for (int j = 0; j < cols; ++j) {
+            dst[(th * M + i) * param.out_w + tw * M + j] = y[i][j];
+          }
+        }
+      }
+    }
+  }
+}
+
+template <typename T>
+void CPUConv2DFunctor<T>::operator()(const platform::CPUDeviceContext& context,
+                                     CPUConvAlgo algo,
+                                     const CPUConv2DParam& param,
+                                     const framework::Tensor& input,
+                                     const framework::Tensor& filter,
+                                     framework::Tensor* output) {
+  PADDLE_ENFORCE_EQ(
+      CPUConvAlgoSupported(algo, param), true,
+      platform::errors::InvalidArgument(
+          "The CPU convolution algorithm %s does not support the filter of "
+          "%dx%d with strides (%d, %d) and dilations (%d, %d).",
+          CPUConvAlgoName(algo), param.filter_h, param.filter_w,
+          param.stride_h, param.stride_w, param.dilation_h,
+          param.dilation_w));
+  switch (algo) {
+    case CPUConvAlgo::kIm2ColGemm:
+      Im2ColGemmConv<T>(context, param, input, filter, output);
+      break;
+    case CPUConvAlgo::kGemm1x1:
+      Gemm1x1Conv<T>(context, param, input, filter, output);
+      break;
+    case CPUConvAlgo::kDepthwiseDirect:
+      DepthwiseDirectConv<T>(context, param, input, filter, output);
+      break;
+    case CPUConvAlgo::kWinogradF2x3:
+      WinogradConv<T, 2>(context, param, input, filter, output);
+      break;
+    case CPUConvAlgo::kWinogradF4x3:
+      WinogradConv<T, 4>(context, param, input, filter, output);
+      break;
+  }
+}
+
+template <typename T>
+CPUConvAlgo SearchCPUConvAlgo(const platform::CPUDeviceContext& context,
+                              const CPUConv2DParam& param,
+                              const framework::Tensor& input,
+                              const framework::Tensor& filter,
+                              framework::Tensor* output) {
+  static framework::AlgorithmsCache<CPUConvAlgo> cache;
+  bool exhaustive = FLAGS_cpu_conv_exhaustive_search;
+  bool use_winograd = FLAGS_cpu_conv_use_winograd;
+  auto search = [&]() -> CPUConvAlgo {
+    CPUConvAlgo best = CPUConvHeuristic(param, use_winograd);
+    if (!exhaustive) return best;
+    CPUConv2DFunctor<T> conv;
+    double best_time = -1;
+    for (auto algo :
+         {CPUConvAlgo::kIm2ColGemm, CPUConvAlgo::kGemm1x1,
+          CPUConvAlgo::kDepthwiseDirect, CPUConvAlgo::kWinogradF2x3,
+          CPUConvAlgo::kWinogradF4x3}) {
+      if (!CPUConvAlgoSupported(algo, param)) continue;
+      // The first run warms up the caches and the workspace.
+      conv(context, algo, param, input, filter, output);
+      platform::Timer timer;
+      timer.Start();
+      conv(context, algo, param, input, filter, output);
+      timer.Pause();
+      VLOG(3) << "CPU conv algo " << CPUConvAlgoName(algo) << ": "
+              << timer.ElapsedUS() << " us";
+      if (best_time < 0 || timer.ElapsedUS() < best_time) {
+        best = algo;
+        best_time = timer.ElapsedUS();
+      }
+    }
+    return best;
+  };
+  auto algo = cache.GetAlgorithm(
+      {param.batch_size, param.in_channels, param.in_h, param.in_w},
+      {param.out_channels, param.in_channels / param.groups, param.filter_h,
+       param.filter_w},
+      {param.stride_h, param.stride_w},
+      {param.pad_top, param.pad_bottom, param.pad_left, param.pad_right},
+      {param.dilation_h, param.dilation_w},
+      param.groups * 4 + static_cast<int>(use_winograd) * 2 +
+          static_cast<int>(exhaustive),
+      static_cast<int64_t>(framework::DataTypeTrait<T>::DataType()), search);
+  VLOG(4) << "CPU conv algo: " << CPUConvAlgoName(algo);
+  return algo;
+}
+
+template class CPUConv2DFunctor<float>;
+template class CPUConv2DFunctor<double>;
+
+template CPUConvAlgo SearchCPUConvAlgo<float>(
+    const platform::CPUDeviceContext& context, const CPUConv2DParam& param,
+    const framework::Tensor& input, const framework::Tensor& filter,
+    framework::Tensor* output);
+template CPUConvAlgo SearchCPUConvAlgo<double>(
+    const platform::CPUDeviceContext& context, const CPUConv2DParam& param,
+    const framework::Tensor& input, const framework::Tensor& filter,
+    framework::Tensor* output);
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
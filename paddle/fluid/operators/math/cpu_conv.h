@@ -0,0 +1,92 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The algorithms of the 2D convolution on CPU without MKLDNN.
+enum class CPUConvAlgo {
+  // im2col and GEMM, which supports all the convolutions.
+  kIm2ColGemm = 0,
+  // 1x1 filter with stride 1 and no padding, the input is the matrix of GEMM
+  // without im2col.
+  kGemm1x1 = 1,
+  // Direct convolution of each channel, for groups == input channels.
+  kDepthwiseDirect = 2,
+  // Winograd F(2x2, 3x3) and F(4x4, 3x3), for 3x3 filter with stride 1 and
+  // dilation 1.
+  kWinogradF2x3 = 3,
+  kWinogradF4x3 = 4,
+};
+
+const char* CPUConvAlgoName(CPUConvAlgo algo);
+
+// The convolution of NCHW input and OIHW filter into NCHW output.
+struct CPUConv2DParam {
+  int batch_size;
+  int in_channels;
+  int in_h;
+  int in_w;
+  int out_channels;
+  int out_h;
+  int out_w;
+  int filter_h;
+  int filter_w;
+  int groups;
+  int stride_h;
+  int stride_w;
+  int pad_top;
+  int pad_bottom;
+  int pad_left;
+  int pad_right;
+  int dilation_h;
+  int dilation_w;
+};
+
+bool CPUConvAlgoSupported(CPUConvAlgo algo, const CPUConv2DParam& param);
+
+// Choose the algorithm by the shapes. Winograd, whose results differ slightly
+// from im2col and GEMM, is only chosen if use_winograd.
+CPUConvAlgo CPUConvHeuristic(const CPUConv2DParam& param,
+                             bool use_winograd = false);
+
+template <typename T>
+class CPUConv2DFunctor {
+ public:
+  // output is allocated by the caller.
+  void operator()(const platform::CPUDeviceContext& context, CPUConvAlgo algo,
+                  const CPUConv2DParam& param, const framework::Tensor& input,
+                  const framework::Tensor& filter, framework::Tensor* output);
+};
+
+// The algorithm of param, which is cached for the shapes. It is chosen by
+// CPUConvHeuristic with FLAGS_cpu_conv_use_winograd, or by running all the
+// supported algorithms on input and taking the fastest if
+// FLAGS_cpu_conv_exhaustive_search is set.
+template <typename T>
+CPUConvAlgo SearchCPUConvAlgo(const platform::CPUDeviceContext& context,
+                              const CPUConv2DParam& param,
+                              const framework::Tensor& input,
+                              const framework::Tensor& filter,
+                              framework::Tensor* output);
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,185 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/cpu_conv.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+static const CPUConvAlgo kAllAlgos[] = {
+    CPUConvAlgo::kIm2ColGemm, CPUConvAlgo::kGemm1x1,
+    CPUConvAlgo::kDepthwiseDirect, CPUConvAlgo::kWinogradF2x3,
+    CPUConvAlgo::kWinogradF4x3};
+
+static CPUConv2DParam MakeParam(int batch_size, int in_channels, int in_hw,
+                                int out_channels, int filter_hw, int groups,
+                                int stride, int padding, int dilation = 1) {
+  CPUConv2DParam param;
+  param.batch_size = batch_size;
+  param.in_channels = in_channels;
+  param.in_h = in_hw;
+  param.in_w = in_hw + 1;
+  param.out_channels = out_channels;
+  param.filter_h = filter_hw;
+  param.filter_w = filter_hw;
+  param.groups = groups;
+  param.stride_h = param.stride_w = stride;
+  param.pad_top = param.pad_left = padding;
+  // The asymmetric padding of "SAME".
+  param.pad_bottom = param.pad_right = padding + (stride > 1 ? 1 : 0);
+  param.dilation_h = param.dilation_w = dilation;
+  int dkernel = dilation * (filter_hw - 1) + 1;
+  param.out_h =
+      (param.in_h + param.pad_top + param.pad_bottom - dkernel) / stride + 1;
+  param.out_w =
+      (param.in_w + param.pad_left + param.pad_right - dkernel) / stride + 1;
+  return param;
+}
+
+// The convolution by definition in double.
+static std::vector<double> NaiveConv(const CPUConv2DParam& p,
+                                     const std::vector<float>& input,
+                                     const std::vector<float>& filter) {
+  int in_step = p.in_channels / p.groups;
+  int out_step = p.out_channels / p.groups;
+  std::vector<double> output(
+      static_cast<size_t>(p.batch_size) * p.out_channels * p.out_h * p.out_w);
+  size_t index = 0;
+  for (int n = 0; n < p.batch_size; ++n) {
+    for (int oc = 0; oc < p.out_channels; ++oc) {
+      int g = oc / out_step;
+      for (int oh = 0; oh < p.out_h; ++oh) {
+        for (int ow = 0; ow < p.out_w; ++ow) {
+          double sum = 0;
+          for (int ic = 0; ic < in_step; ++ic) {
+            for (int kh = 0; kh < p.filter_h; ++kh) {
+              int ih = oh * p.stride_h - p.pad_top + kh * p.dilation_h;
+              if (ih < 0 || ih >= p.in_h) continue;
+              for (int kw = 0; kw < p.filter_w; ++kw) {
+                int iw = ow * p.stride_w - p.pad_left + kw * p.dilation_w;
+                if (iw < 0 || iw >= p.in_w) continue;
+                sum += static_cast<double>(
+                           input[((n * p.in_channels + g * in_step + ic) *
+                                      p.in_h +
+                                  ih) *
+                                     p.in_w +
+                                 iw]) *
+                       filter[((oc * in_step + ic) * p.filter_h + kh) *
+                                  p.filter_w +
+                              kw];
+              }
+            }
+          }
+          output[index++] = sum;
+        }
+      }
+    }
+  }
+  return output;
+}
+
+// Run all of the supported algorithms of param, and compare them with the
+// naive convolution.
+static void TestConv(const CPUConv2DParam& param) {
+  framework::Tensor input, filter, output;
+  float* input_data = input.mutable_data<float>(
+      {param.batch_size, param.in_channels, param.in_h, param.in_w},
+      platform::CPUPlace());
+  float* filter_data = filter.mutable_data<float>(
+      {param.out_channels, param.in_channels / param.groups, param.filter_h,
+       param.filter_w},
+      platform::CPUPlace());
+  float* output_data = output.mutable_data<float>(
+      {param.batch_size, param.out_channels, param.out_h, param.out_w},
+      platform::CPUPlace());
+  std::mt19937 engine(param.in_channels);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (int64_t i = 0; i < input.numel(); ++i) input_data[i] = dist(engine);
+  for (int64_t i = 0; i < filter.numel(); ++i) filter_data[i] = dist(engine);
+  std::vector<float> input_vec(input_data, input_data + input.numel());
+  std::vector<float> filter_vec(filter_data, filter_data + filter.numel());
+  auto ref = NaiveConv(param, input_vec, filter_vec);
+
+  platform::CPUDeviceContext ctx;
+  CPUConv2DFunctor<float> conv;
+  for (auto algo : kAllAlgos) {
+    if (!CPUConvAlgoSupported(algo, param)) continue;
+    conv(ctx, algo, param, input, filter, &output);
+    // The error of Winograd grows with the magnitude of the transforms.
+    double scale = algo == CPUConvAlgo::kWinogradF4x3 ? 1e-3 : 1e-4;
+    double tolerance =
+        scale * std::sqrt(static_cast<double>(param.in_channels /
+                                              param.groups * param.filter_h *
+                                              param.filter_w));
+    for (int64_t i = 0; i < output.numel(); ++i) {
+      ASSERT_NEAR(output_data[i], ref[i], tolerance)
+          << CPUConvAlgoName(algo) << " at " << i;
+    }
+  }
+}
+
+TEST(CPUConv2D, algorithm) {
+  EXPECT_EQ(CPUConvHeuristic(MakeParam(1, 64, 14, 128, 1, 1, 1, 0)),
+            CPUConvAlgo::kGemm1x1);
+  EXPECT_EQ(CPUConvHeuristic(MakeParam(1, 32, 56, 32, 3, 32, 1, 1)),
+            CPUConvAlgo::kDepthwiseDirect);
+  // Winograd is only chosen if it is enabled.
+  EXPECT_EQ(CPUConvHeuristic(MakeParam(1, 64, 28, 64, 3, 1, 1, 1)),
+            CPUConvAlgo::kIm2ColGemm);
+  EXPECT_EQ(CPUConvHeuristic(MakeParam(1, 64, 28, 64, 3, 1, 1, 1), true),
+            CPUConvAlgo::kWinogradF4x3);
+  EXPECT_EQ(CPUConvHeuristic(MakeParam(4, 64, 7, 64, 3, 1, 1, 1), true),
+            CPUConvAlgo::kWinogradF2x3);
+  EXPECT_EQ(CPUConvHeuristic(MakeParam(1, 64, 7, 64, 3, 1, 1, 1), true),
+            CPUConvAlgo::kIm2ColGemm);
+  EXPECT_EQ(CPUConvHeuristic(MakeParam(1, 3, 224, 64, 3, 1, 1, 1), true),
+            CPUConvAlgo::kIm2ColGemm);
+  EXPECT_EQ(CPUConvHeuristic(MakeParam(1, 64, 28, 64, 3, 1, 2, 1), true),
+            CPUConvAlgo::kIm2ColGemm);
+  EXPECT_FALSE(CPUConvAlgoSupported(CPUConvAlgo::kWinogradF4x3,
+                                    MakeParam(1, 64, 28, 64, 3, 1, 1, 2, 2)));
+}
+
+TEST(CPUConv2D, correctness) {
+  // 1x1
+  TestConv(MakeParam(2, 8, 7, 12, 1, 1, 1, 0));
+  TestConv(MakeParam(2, 8, 7, 12, 1, 4, 1, 0));
+  TestConv(MakeParam(1, 8, 9, 4, 1, 1, 2, 0));
+  // Depthwise with multipliers, strides, dilations and paddings.
+  TestConv(MakeParam(2, 6, 9, 6, 3, 6, 1, 1));
+  TestConv(MakeParam(2, 6, 9, 12, 3, 6, 2, 1));
+  TestConv(MakeParam(1, 4, 11, 4, 5, 4, 1, 2));
+  TestConv(MakeParam(1, 4, 11, 8, 3, 4, 1, 2, 2));
+  TestConv(MakeParam(1, 3, 2, 3, 3, 3, 1, 1));
+  // 3x3 of Winograd, with edge tiles and paddings.
+  TestConv(MakeParam(2, 5, 7, 6, 3, 1, 1, 1));
+  TestConv(MakeParam(1, 16, 13, 8, 3, 1, 1, 0));
+  TestConv(MakeParam(3, 8, 3, 8, 3, 2, 1, 1));
+  TestConv(MakeParam(1, 4, 1, 4, 3, 1, 1, 1));
+  TestConv(MakeParam(2, 32, 16, 32, 3, 1, 1, 2));
+  // Others
+  TestConv(MakeParam(2, 6, 10, 4, 5, 2, 2, 2));
+  TestConv(MakeParam(1, 3, 12, 4, 3, 1, 1, 1, 2));
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
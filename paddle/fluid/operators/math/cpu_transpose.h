@@ -0,0 +1,275 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "paddle/fluid/framework/ddim.h"
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The cache block of the 2D transposes in elements, the number of elements
+// copied by one thread at a time, and the number of elements below which the
+// copy runs in one thread.
+constexpr int64_t kCPUTransposeBlock = 64;
+constexpr int64_t kCPUTransposeChunkNumel = 1 << 14;
+constexpr int64_t kCPUTransposeParallelNumel = 1 << 15;
+
+// The width of the micro tiles, whose loops have constant trip counts so
+// that they are unrolled and vectorized by the compiler: 16x16 for the
+// elements of 1 or 2 bytes, and 8x8 for the others.
+template <typename T>
+struct CPUTransposeTile {
+  static constexpr int64_t value = sizeof(T) <= 2 ? 16 : 8;
+};
+
+#ifdef __AVX__
+// The 8x8 tile of 4-byte elements by the unpack and shuffle of AVX.
+inline void CPUTranspose8x8(const float* src, int64_t lds, float* dst,
+                            int64_t ldd) {
+  __m256 r[8], t[8];
+  for (int i = 0; i < 8; ++i) r[i] = _mm256_loadu_ps(src + i * lds);
+  for (int i = 0; i < 8; i += 2) {
+    t[i] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+    t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+  }
+  for (int i = 0; i < 8; i += 4) {
+    r[i] = _mm256_shuffle_ps(t[i], t[i + 2], 0x44);
+    r[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], 0xEE);
+    r[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], 0x44);
+    r[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], 0xEE);
+  }
+  for (int i = 0; i < 4; ++i) {
+    _mm256_storeu_ps(dst + i * ldd,
+                     _mm256_permute2f128_ps(r[i], r[i + 4], 0x20));
+    _mm256_storeu_ps(dst + (i + 4) * ldd,
+                     _mm256_permute2f128_ps(r[i], r[i + 4], 0x31));
+  }
+}
+#endif
+
+// dst[j * ldd + i] = src[i * lds + j] for the rows i in [0, rows) and the
+// columns j in [0, cols).
+template <typename T>
+inline void CPUTransposeBlock(const T* src, int64_t lds, T* dst, int64_t ldd,
+                              int64_t rows, int64_t cols) {
+  constexpr int64_t kTile = CPUTransposeTile<T>::value;
+  int64_t full_rows = rows - rows % kTile;
+  int64_t full_cols = cols - cols % kTile;
+  for (int64_t i = 0; i < full_rows; i += kTile) {
+    for (int64_t j = 0; j < full_cols; j += kTile) {
+      const T* s = src + i * lds + j;
+      T* d = dst + j * ldd + i;
+#ifdef __AVX__
+      if (sizeof(T) == 4) {
+        CPUTranspose8x8(reinterpret_cast<const float*>(s), lds,
+                        reinterpret_cast<float*>(d), ldd);
+        continue;
+      }
+#endif
+      for (int64_t c = 0; c < kTile; ++c) {
+        for (int64_t r = 0; r < kTile; ++r) d[c * ldd + r] = s[r * lds + c];
+      }
+    }
+    for (int64_t j = full_cols; j < cols; ++j) {
+      for (int64_t r = i; r < i + kTile; ++r) {
+        dst[j * ldd + r] = src[r * lds + j];
+      }
+    }
+  }
+  for (int64_t i = full_rows; i < rows; ++i) {
+    for (int64_t j = 0; j < cols; ++j) dst[j * ldd + i] = src[i * lds + j];
+  }
+}
+
+// The strided copy of CPUStridedCopy, whose unit and size 1 dims are
+// removed, and the contiguous dims are merged.
+struct CPUStridedCopyPlan {
+  CPUStridedCopyPlan(const std::vector<int64_t>& dims,
+                     const std::vector<int64_t>& in_strides,
+                     const std::vector<int64_t>& out_strides) {
+    numel = 1;
+    for (size_t k = 0; k < dims.size(); ++k) {
+      numel *= dims[k];
+      if (dims[k] == 1) continue;
+      if (!this->dims.empty() &&
+          this->in_strides.back() == in_strides[k] * dims[k] &&
+          this->out_strides.back() == out_strides[k] * dims[k]) {
+        this->dims.back() *= dims[k];
+        this->in_strides.back() = in_strides[k];
+        this->out_strides.back() = out_strides[k];
+      } else {
+        this->dims.push_back(dims[k]);
+        this->in_strides.push_back(in_strides[k]);
+        this->out_strides.push_back(out_strides[k]);
+      }
+    }
+  }
+
+  int rank() const { return static_cast<int>(dims.size()); }
+
+  int64_t numel;
+  std::vector<int64_t> dims;
+  std::vector<int64_t> in_strides;
+  std::vector<int64_t> out_strides;
+};
+
+// out[sum(i[k] * out_strides[k])] = in[sum(i[k] * in_strides[k])] for all
+// the indices i of dims. It is a transpose when out_strides are the
+// contiguous strides of dims and in_strides are the permuted strides of the
+// input, and writes into a slice of a larger tensor with other out_strides.
+//
+// When the innermost dims of in and out are the same, the rows are copied
+// by memcpy. Otherwise the two innermost dims form 2D transposes, which are
+// split into cache blocks of kCPUTransposeBlock, and further into micro
+// tiles. The blocks are copied in parallel.
+template <typename T>
+void CPUStridedCopy(const std::vector<int64_t>& dims,
+                    const std::vector<int64_t>& in_strides,
+                    const std::vector<int64_t>& out_strides, const T* in,
+                    T* out) {
+  CPUStridedCopyPlan plan(dims, in_strides, out_strides);
+  if (plan.numel == 0) return;
+  int rank = plan.rank();
+  if (rank == 0) {
+    *out = *in;
+    return;
+  }
+  // The innermost dims of in and out.
+  int in_inner = static_cast<int>(
+      std::min_element(plan.in_strides.begin(), plan.in_strides.end()) -
+      plan.in_strides.begin());
+  int out_inner = static_cast<int>(
+      std::min_element(plan.out_strides.begin(), plan.out_strides.end()) -
+      plan.out_strides.begin());
+  bool transpose = in_inner != out_inner &&
+                   plan.in_strides[in_inner] == 1 &&
+                   plan.out_strides[out_inner] == 1;
+  if (!transpose) in_inner = out_inner;
+
+  // The outer dims enumerated by the tasks, from the outermost.
+  std::vector<int64_t> outer_dims, outer_in_strides, outer_out_strides;
+  for (int k = 0; k < rank; ++k) {
+    if (k == in_inner || k == out_inner) continue;
+    outer_dims.push_back(plan.dims[k]);
+    outer_in_strides.push_back(plan.in_strides[k]);
+    outer_out_strides.push_back(plan.out_strides[k]);
+  }
+  int outer_rank = static_cast<int>(outer_dims.size());
+  int64_t outer_numel = plan.numel / plan.dims[out_inner];
+  if (transpose) outer_numel /= plan.dims[in_inner];
+
+  // The rows of the 2D transposes are along the inner dim of out, and the
+  // columns are along the inner dim of in.
+  int64_t rows = plan.dims[out_inner];
+  int64_t cols = transpose ? plan.dims[in_inner] : 1;
+  int64_t row_blocks =
+      transpose ? (rows + kCPUTransposeBlock - 1) / kCPUTransposeBlock : 1;
+  int64_t col_blocks = (cols + kCPUTransposeBlock - 1) / kCPUTransposeBlock;
+  int64_t lds = plan.in_strides[out_inner];
+  int64_t ldd = transpose ? plan.out_strides[in_inner] : 0;
+  bool contiguous_rows = !transpose && plan.in_strides[out_inner] == 1 &&
+                         plan.out_strides[out_inner] == 1;
+
+  // The blocks along the inner dim of out are the fastest, so that the
+  // consecutive blocks continue writing the same lines of out. Each chunk of
+  // blocks is copied by one thread, and walks the blocks and the outer dims
+  // by an odometer.
+  int64_t tasks = outer_numel * row_blocks * col_blocks;
+  int64_t task_numel =
+      transpose ? kCPUTransposeBlock * kCPUTransposeBlock : rows;
+  int64_t chunk_size =
+      std::max<int64_t>(1, kCPUTransposeChunkNumel / task_numel);
+  int64_t chunks = (tasks + chunk_size - 1) / chunk_size;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (plan.numel > kCPUTransposeParallelNumel)
+#endif
+  for (int64_t chunk = 0; chunk < chunks; ++chunk) {
+    int64_t task = chunk * chunk_size;
+    int64_t task_end = std::min(task + chunk_size, tasks);
+    int64_t row_block = task % row_blocks;
+    int64_t col_block = task / row_blocks % col_blocks;
+    int64_t outer = task / row_blocks / col_blocks;
+    std::vector<int64_t> index(outer_rank);
+    const T* src = in;
+    T* dst = out;
+    for (int k = outer_rank - 1; k >= 0; --k) {
+      index[k] = outer % outer_dims[k];
+      outer /= outer_dims[k];
+      src += index[k] * outer_in_strides[k];
+      dst += index[k] * outer_out_strides[k];
+    }
+    for (; task < task_end; ++task) {
+      if (transpose) {
+        int64_t row_begin = row_block * kCPUTransposeBlock;
+        int64_t col_begin = col_block * kCPUTransposeBlock;
+        CPUTransposeBlock(src + row_begin * lds + col_begin, lds,
+                          dst + col_begin * ldd + row_begin, ldd,
+                          std::min(kCPUTransposeBlock, rows - row_begin),
+                          std::min(kCPUTransposeBlock, cols - col_begin));
+      } else if (contiguous_rows) {
+        std::memcpy(dst, src, rows * sizeof(T));
+      } else {
+        int64_t out_stride = plan.out_strides[out_inner];
+        for (int64_t i = 0; i < rows; ++i) dst[i * out_stride] = src[i * lds];
+      }
+      if (++row_block < row_blocks) continue;
+      row_block = 0;
+      if (++col_block < col_blocks) continue;
+      col_block = 0;
+      for (int k = outer_rank - 1; k >= 0; --k) {
+        src += outer_in_strides[k];
+        dst += outer_out_strides[k];
+        if (++index[k] < outer_dims[k]) break;
+        src -= outer_dims[k] * outer_in_strides[k];
+        dst -= outer_dims[k] * outer_out_strides[k];
+        index[k] = 0;
+      }
+    }
+  }
+}
+
+// out = transpose(in, axis), where in has in_dims and out is contiguous.
+template <typename T>
+void CPUTranspose(const framework::DDim& in_dims, const std::vector<int>& axis,
+                  const T* in, T* out) {
+  int rank = in_dims.size();
+  std::vector<int64_t> in_stride(rank, 1);
+  for (int k = rank - 2; k >= 0; --k) {
+    in_stride[k] = in_stride[k + 1] * in_dims[k + 1];
+  }
+  std::vector<int64_t> dims(rank), in_strides(rank), out_strides(rank, 1);
+  for (int k = 0; k < rank; ++k) {
+    dims[k] = in_dims[axis[k]];
+    in_strides[k] = in_stride[axis[k]];
+  }
+  for (int k = rank - 2; k >= 0; --k) {
+    out_strides[k] = out_strides[k + 1] * dims[k + 1];
+  }
+  CPUStridedCopy(dims, in_strides, out_strides, in, out);
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
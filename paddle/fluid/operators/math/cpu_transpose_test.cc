@@ -0,0 +1,112 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/cpu_transpose.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The transpose by the index of each output element.
+template <typename T>
+static void NaiveTranspose(const framework::DDim& in_dims,
+                           const std::vector<int>& axis, const T* in, T* out) {
+  int rank = in_dims.size();
+  auto in_stride = framework::stride(in_dims);
+  std::vector<int64_t> out_dims(rank);
+  for (int k = 0; k < rank; ++k) out_dims[k] = in_dims[axis[k]];
+  int64_t numel = framework::product(in_dims);
+  for (int64_t out_idx = 0; out_idx < numel; ++out_idx) {
+    int64_t in_idx = 0;
+    int64_t tmp_idx = out_idx;
+    for (int k = rank - 1; k >= 0; --k) {
+      in_idx += tmp_idx % out_dims[k] * in_stride[axis[k]];
+      tmp_idx /= out_dims[k];
+    }
+    out[out_idx] = in[in_idx];
+  }
+}
+
+template <typename T>
+static void TestTranspose(const std::vector<int64_t>& dims,
+                          const std::vector<int>& axis) {
+  auto in_dims = framework::make_ddim(dims);
+  int64_t numel = framework::product(in_dims);
+  std::vector<T> in(numel), out(numel), ref(numel);
+  for (int64_t i = 0; i < numel; ++i) in[i] = static_cast<T>(i % 127);
+  NaiveTranspose(in_dims, axis, in.data(), ref.data());
+  CPUTranspose(in_dims, axis, in.data(), out.data());
+  for (int64_t i = 0; i < numel; ++i) {
+    ASSERT_EQ(out[i], ref[i]) << "dims: " << in_dims << " at " << i;
+  }
+}
+
+TEST(CPUTranspose, shapes) {
+  TestTranspose<float>({7}, {0});
+  TestTranspose<float>({1, 1}, {1, 0});
+  TestTranspose<float>({67, 131}, {1, 0});
+  TestTranspose<double>({64, 128}, {1, 0});
+  TestTranspose<int8_t>({3, 33, 70}, {0, 2, 1});
+  TestTranspose<int16_t>({2, 17, 5, 40}, {0, 2, 3, 1});
+  TestTranspose<float>({2, 40, 9, 13}, {0, 3, 1, 2});
+  TestTranspose<float>({2, 3, 4, 5, 6}, {4, 2, 0, 3, 1});
+  TestTranspose<double>({4, 1, 6, 1, 5, 3}, {5, 3, 1, 4, 0, 2});
+  // The same inner dim, and the dims of size 1.
+  TestTranspose<float>({3, 5, 7, 11}, {1, 0, 2, 3});
+  TestTranspose<float>({1, 5, 1, 11}, {2, 0, 3, 1});
+}
+
+TEST(CPUTranspose, random) {
+  std::mt19937 engine(0);
+  for (int n = 0; n < 300; ++n) {
+    int rank = 1 + engine() % 6;
+    std::vector<int64_t> dims(rank);
+    for (auto& d : dims) d = 1 + engine() % (rank <= 2 ? 150 : 12);
+    std::vector<int> axis(rank);
+    std::iota(axis.begin(), axis.end(), 0);
+    std::shuffle(axis.begin(), axis.end(), engine);
+    TestTranspose<float>(dims, axis);
+    TestTranspose<int64_t>(dims, axis);
+    TestTranspose<uint8_t>(dims, axis);
+  }
+}
+
+// The strided copy into a slice of the output, as the concat of
+// fusion_transpose_flatten_concat.
+TEST(CPUStridedCopy, slice) {
+  int64_t rows = 5, cols = 37, out_cols = 50, offset = 9;
+  std::vector<float> in(rows * cols), out(cols * out_cols, -1.0f);
+  for (size_t i = 0; i < in.size(); ++i) in[i] = i;
+  // out[j][offset + i] = in[i][j]
+  CPUStridedCopy<float>({cols, rows}, {1, cols}, {out_cols, 1}, in.data(),
+                        out.data() + offset);
+  for (int64_t j = 0; j < cols; ++j) {
+    for (int64_t i = 0; i < out_cols; ++i) {
+      float expected =
+          i >= offset && i < offset + rows ? in[(i - offset) * cols + j] : -1;
+      ASSERT_EQ(out[j * out_cols + i], expected);
+    }
+  }
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,400 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/disk_embedding_table.h"
+
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <list>
+#include <utility>
+
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/platform/enforce.h"
+
+#ifdef PADDLE_WITH_MKLML
+#include <omp.h>
+#endif
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The header of a shard file, which is followed by its rows.
+struct DiskEmbeddingShardHeader {
+  char magic[8];
+  int32_t version;
+  int32_t type;
+  int32_t num_shards;
+  int32_t shard_id;
+  int64_t height;
+  int64_t width;
+  int64_t rows;
+  // Identifies the parameter file the table is built from, or 0.
+  uint64_t source;
+  char reserved[8];
+};
+static_assert(sizeof(DiskEmbeddingShardHeader) == 64,
+              "The header of a shard should be of 64 bytes.");
+
+static constexpr char kDiskEmbeddingMagic[8] = {'P', 'D', 'E', 'M',
+                                                'B', 'T', 'B', 'L'};
+// The rows copied by one read when a table is built.
+constexpr int64_t kDiskEmbeddingBuildRows = 4096;
+// The rows of a shard read by one read when they are looked up.
+constexpr int64_t kDiskEmbeddingMaxReadRows = 1024;
+
+static std::string ShardPath(const std::string& dir, int shard_id) {
+  return dir + "/shard_" + std::to_string(shard_id);
+}
+
+static int64_t ShardRows(int64_t height, int num_shards, int shard_id) {
+  return height > shard_id ? (height - shard_id + num_shards - 1) / num_shards
+                           : 0;
+}
+
+// Reads the header of a shard, and returns false if it is not valid.
+static bool ReadShardHeader(const std::string& path,
+                            DiskEmbeddingShardHeader* header) {
+  std::ifstream fin(path, std::ios::in | std::ios::binary);
+  if (!fin.is_open()) return false;
+  fin.read(reinterpret_cast<char*>(header), sizeof(*header));
+  if (!fin || std::memcmp(header->magic, kDiskEmbeddingMagic,
+                          sizeof(kDiskEmbeddingMagic)) != 0 ||
+      header->version != 1) {
+    return false;
+  }
+  auto type = static_cast<framework::proto::VarType::Type>(header->type);
+  int64_t row_size = header->width * framework::SizeOfType(type);
+  fin.seekg(0, std::ios::end);
+  return static_cast<int64_t>(fin.tellg()) ==
+         static_cast<int64_t>(sizeof(*header)) + header->rows * row_size;
+}
+
+void DiskEmbeddingTable::Build(std::istream* is, const std::string& dir,
+                               int num_shards, uint64_t source) {
+  PADDLE_ENFORCE_GT(num_shards, 0,
+                    platform::errors::InvalidArgument(
+                        "The number of the shards of a table should be "
+                        "greater than 0, but got %d.",
+                        num_shards));
+  framework::LoD lod;
+  framework::proto::VarType::TensorDesc desc;
+  framework::DeserializeDescFromStream(*is, &lod, &desc);
+  PADDLE_ENFORCE_GE(desc.dims_size(), 2,
+                    platform::errors::InvalidArgument(
+                        "The embedding table should have at least 2 "
+                        "dimensions, but got %d.",
+                        desc.dims_size()));
+  int64_t height = desc.dims(0);
+  int64_t width = 1;
+  for (int i = 1; i < desc.dims_size(); ++i) width *= desc.dims(i);
+  size_t row_size = width * framework::SizeOfType(desc.data_type());
+
+  std::vector<std::unique_ptr<std::ofstream>> files;
+  for (int i = 0; i < num_shards; ++i) {
+    files.emplace_back(new std::ofstream(ShardPath(dir, i) + ".tmp",
+                                         std::ios::out | std::ios::binary));
+    PADDLE_ENFORCE_EQ(files.back()->is_open(), true,
+                      platform::errors::Unavailable(
+                          "Failed to create the shard %s of the table.",
+                          ShardPath(dir, i)));
+    DiskEmbeddingShardHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kDiskEmbeddingMagic, sizeof(header.magic));
+    header.version = 1;
+    header.type = desc.data_type();
+    header.num_shards = num_shards;
+    header.shard_id = i;
+    header.height = height;
+    header.width = width;
+    header.rows = ShardRows(height, num_shards, i);
+    header.source = source;
+    files.back()->write(reinterpret_cast<const char*>(&header),
+                        sizeof(header));
+  }
+
+  std::vector<char> buffer(kDiskEmbeddingBuildRows * row_size);
+  for (int64_t begin = 0; begin < height; begin += kDiskEmbeddingBuildRows) {
+    int64_t rows = std::min(kDiskEmbeddingBuildRows, height - begin);
+    is->read(buffer.data(), rows * row_size);
+    PADDLE_ENFORCE_EQ(static_cast<bool>(*is), true,
+                      platform::errors::Unavailable(
+                          "Failed to read the rows of the table from %d, "
+                          "please check whether the file is complete.",
+                          begin));
+    for (int64_t i = 0; i < rows; ++i) {
+      files[(begin + i) % num_shards]->write(buffer.data() + i * row_size,
+                                             row_size);
+    }
+  }
+  for (int i = 0; i < num_shards; ++i) {
+    files[i]->close();
+    PADDLE_ENFORCE_EQ(static_cast<bool>(*files[i]), true,
+                      platform::errors::Unavailable(
+                          "Failed to write the shard %s of the table.",
+                          ShardPath(dir, i)));
+  }
+  // The shards are renamed at last, so that a table built partly is not
+  // taken as a complete one.
+  for (int i = num_shards - 1; i >= 0; --i) {
+    PADDLE_ENFORCE_EQ(
+        std::rename((ShardPath(dir, i) + ".tmp").c_str(),
+                    ShardPath(dir, i).c_str()),
+        0, platform::errors::Unavailable("Failed to rename the shard %s.",
+                                         ShardPath(dir, i)));
+  }
+}
+
+bool DiskEmbeddingTable::Exists(const std::string& dir, uint64_t* source) {
+  DiskEmbeddingShardHeader first;
+  if (!ReadShardHeader(ShardPath(dir, 0), &first)) return false;
+  for (int i = 1; i < first.num_shards; ++i) {
+    DiskEmbeddingShardHeader header;
+    if (!ReadShardHeader(ShardPath(dir, i), &header) ||
+        header.num_shards != first.num_shards || header.shard_id != i ||
+        header.height != first.height || header.width != first.width ||
+        header.type != first.type || header.source != first.source) {
+      return false;
+    }
+  }
+  if (source != nullptr) *source = first.source;
+  return true;
+}
+
+struct DiskEmbeddingTable::Shard {
+  int fd{-1};
+  int64_t capacity{0};
+  std::mutex mutex;
+  // The cached rows by their indices in the shard, with the most recently
+  // used one at the front, and the slot of each of them in slots.
+  std::list<int64_t> lru;
+  std::unordered_map<int64_t, std::pair<std::list<int64_t>::iterator, int64_t>>
+      index;
+  std::vector<char> slots;
+#ifdef _WIN32
+  // The file is read by seek and read, which share the position.
+  std::mutex file_mutex;
+#endif
+};
+
+void DiskEmbeddingTable::ReadRows(Shard* shard, int64_t begin, int64_t count,
+                                  char* buffer) const {
+  int64_t offset = sizeof(DiskEmbeddingShardHeader) + begin * row_size_;
+  size_t size = count * row_size_;
+#ifdef _WIN32
+  std::lock_guard<std::mutex> lock(shard->file_mutex);
+#endif
+  while (size > 0) {
+#ifdef _WIN32
+    _lseeki64(shard->fd, offset, SEEK_SET);
+    auto bytes = _read(shard->fd, buffer, static_cast<unsigned int>(size));
+#else
+    auto bytes = pread(shard->fd, buffer, size, offset);
+#endif
+    PADDLE_ENFORCE_GT(bytes, 0,
+                      platform::errors::Unavailable(
+                          "Failed to read the rows of the embedding table in "
+                          "%s.",
+                          dir_));
+    buffer += bytes;
+    offset += bytes;
+    size -= bytes;
+  }
+}
+
+DiskEmbeddingTable::DiskEmbeddingTable(const std::string& dir,
+                                       int64_t cache_rows)
+    : dir_(dir) {
+  PADDLE_ENFORCE_EQ(Exists(dir), true,
+                    platform::errors::NotFound(
+                        "There is no complete embedding table in %s.", dir));
+  DiskEmbeddingShardHeader header;
+  ReadShardHeader(ShardPath(dir, 0), &header);
+  height_ = header.height;
+  width_ = header.width;
+  type_ = static_cast<framework::proto::VarType::Type>(header.type);
+  row_size_ = width_ * framework::SizeOfType(type_);
+  for (int i = 0; i < header.num_shards; ++i) {
+    std::unique_ptr<Shard> shard(new Shard());
+#ifdef _WIN32
+    shard->fd = _open(ShardPath(dir, i).c_str(), _O_RDONLY | _O_BINARY);
+#else
+    shard->fd = open(ShardPath(dir, i).c_str(), O_RDONLY);
+#endif
+    PADDLE_ENFORCE_GE(shard->fd, 0,
+                      platform::errors::Unavailable(
+                          "Failed to open the shard %s of the table.",
+                          ShardPath(dir, i)));
+    shard->capacity = cache_rows / header.num_shards +
+                      (i < cache_rows % header.num_shards ? 1 : 0);
+    shards_.emplace_back(std::move(shard));
+  }
+  VLOG(3) << "Open the embedding table in " << dir << " of [" << height_
+          << ", " << width_ << "] in " << shards_.size()
+          << " shards, caching " << cache_rows << " rows.";
+}
+
+DiskEmbeddingTable::~DiskEmbeddingTable() {
+  for (auto& shard : shards_) {
+#ifdef _WIN32
+    _close(shard->fd);
+#else
+    close(shard->fd);
+#endif
+  }
+}
+
+void DiskEmbeddingTable::Lookup(const int64_t* ids, int64_t num,
+                                int64_t padding_idx, void* out) {
+  auto* dst = static_cast<char*>(out);
+  int num_shards = shards_.size();
+  std::vector<std::vector<int64_t>> positions(num_shards);
+  for (int64_t i = 0; i < num; ++i) {
+    if (padding_idx != -1 && ids[i] == padding_idx) {
+      std::memset(dst + i * row_size_, 0, row_size_);
+      continue;
+    }
+    PADDLE_ENFORCE_EQ(
+        ids[i] >= 0 && ids[i] < height_, true,
+        platform::errors::InvalidArgument(
+            "The id of the embedding table in %s should be in [0, %ld), but "
+            "got %ld.",
+            dir_, height_, ids[i]));
+    positions[ids[i] % num_shards].push_back(i);
+  }
+
+  // The shards are looked up in parallel, so that their reads overlap.
+  std::vector<std::exception_ptr> errors(num_shards);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (num_shards > 1)
+#endif
+  for (int i = 0; i < num_shards; ++i) {
+    if (positions[i].empty()) continue;
+    try {
+      LookupShard(shards_[i].get(), ids, positions[i], dst);
+    } catch (...) {
+      errors[i] = std::current_exception();
+    }
+  }
+  for (auto& error : errors) {
+    if (error) std::rethrow_exception(error);
+  }
+}
+
+void DiskEmbeddingTable::LookupShard(Shard* shard, const int64_t* ids,
+                                     const std::vector<int64_t>& positions,
+                                     char* out) {
+  int64_t num_shards = shards_.size();
+  std::vector<int64_t> misses;
+  {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    for (auto pos : positions) {
+      auto it = shard->index.find(ids[pos] / num_shards);
+      if (it == shard->index.end()) {
+        misses.push_back(pos);
+        continue;
+      }
+      shard->lru.splice(shard->lru.begin(), shard->lru, it->second.first);
+      std::memcpy(out + pos * row_size_,
+                  shard->slots.data() + it->second.second * row_size_,
+                  row_size_);
+    }
+  }
+  if (misses.empty()) return;
+
+  // The missing rows are read without the lock, in the order of offsets.
+  std::sort(misses.begin(), misses.end(),
+            [ids](int64_t a, int64_t b) { return ids[a] < ids[b]; });
+  std::vector<int64_t> rows;
+  for (auto pos : misses) {
+    int64_t row = ids[pos] / num_shards;
+    if (rows.empty() || rows.back() != row) rows.push_back(row);
+  }
+  std::vector<char> buffer(rows.size() * row_size_);
+  for (size_t begin = 0; begin < rows.size();) {
+    size_t end = begin + 1;
+    while (end < rows.size() && rows[end] == rows[end - 1] + 1 &&
+           static_cast<int64_t>(end - begin) < kDiskEmbeddingMaxReadRows) {
+      ++end;
+    }
+    ReadRows(shard, rows[begin], end - begin,
+             buffer.data() + begin * row_size_);
+    begin = end;
+  }
+  rows_read_ += rows.size();
+  size_t k = 0;
+  for (auto pos : misses) {
+    while (rows[k] != ids[pos] / num_shards) ++k;
+    std::memcpy(out + pos * row_size_, buffer.data() + k * row_size_,
+                row_size_);
+  }
+
+  if (shard->capacity == 0) return;
+  std::lock_guard<std::mutex> lock(shard->mutex);
+  for (size_t i = 0; i < rows.size(); ++i) {
+    // The row may be cached by another lookup meanwhile.
+    if (shard->index.count(rows[i])) continue;
+    int64_t slot;
+    if (static_cast<int64_t>(shard->index.size()) < shard->capacity) {
+      slot = shard->index.size();
+      if (shard->slots.size() < (slot + 1) * row_size_) {
+        shard->slots.resize((slot + 1) * row_size_);
+      }
+    } else {
+      auto victim = shard->index.find(shard->lru.back());
+      slot = victim->second.second;
+      shard->index.erase(victim);
+      shard->lru.pop_back();
+    }
+    shard->lru.push_front(rows[i]);
+    shard->index[rows[i]] = std::make_pair(shard->lru.begin(), slot);
+    std::memcpy(shard->slots.data() + slot * row_size_,
+                buffer.data() + i * row_size_, row_size_);
+  }
+}
+
+DiskEmbeddingTables& DiskEmbeddingTables::Instance() {
+  static DiskEmbeddingTables tables;
+  return tables;
+}
+
+std::shared_ptr<DiskEmbeddingTable> DiskEmbeddingTables::Get(
+    const std::string& dir, int64_t cache_rows) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = tables_.find(dir);
+  if (it != tables_.end()) return it->second;
+  auto table = std::make_shared<DiskEmbeddingTable>(dir, cache_rows);
+  tables_.emplace(dir, table);
+  return table;
+}
+
+void DiskEmbeddingTables::Remove(const std::string& dir) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  tables_.erase(dir);
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
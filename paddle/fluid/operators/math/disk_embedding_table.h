@@ -0,0 +1,106 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/framework/framework.pb.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// An embedding table of [height, width] stored on disk, for the tables too
+// large to be kept in memory, of which a batch only reads a few rows. The
+// rows are spread over the shard files by id % num_shards, and the hot rows
+// of each shard are kept in an LRU cache. The rows missing in the cache are
+// read in the order of their offsets, and the adjacent ones by one read.
+class DiskEmbeddingTable {
+ public:
+  // Writes the tensor serialized in is, such as a parameter file written by
+  // the save or save_combine op, to num_shards files in the existing
+  // directory dir. The tensor is copied by pieces, and never held in memory.
+  // source identifies the parameter file, e.g. by its size and modification
+  // time, so that the table can be rebuilt when the file changes.
+  static void Build(std::istream* is, const std::string& dir, int num_shards,
+                    uint64_t source = 0);
+  // Whether dir holds all the shards of a table, whose source is returned in
+  // source if it is not nullptr.
+  static bool Exists(const std::string& dir, uint64_t* source = nullptr);
+
+  // Opens the table in dir, and caches up to cache_rows rows in memory.
+  DiskEmbeddingTable(const std::string& dir, int64_t cache_rows);
+  ~DiskEmbeddingTable();
+
+  // out[i] = table[ids[i]], or zeros if ids[i] is padding_idx. out holds
+  // num rows of width elements of type().
+  void Lookup(const int64_t* ids, int64_t num, int64_t padding_idx,
+              void* out);
+
+  int64_t height() const { return height_; }
+  int64_t width() const { return width_; }
+  framework::proto::VarType::Type type() const { return type_; }
+  // The number of rows read from the files, which missed the cache.
+  int64_t rows_read() const { return rows_read_.load(); }
+
+ private:
+  struct Shard;
+
+  void LookupShard(Shard* shard, const int64_t* ids,
+                   const std::vector<int64_t>& positions, char* out);
+  // Reads count rows of the shard from its row begin.
+  void ReadRows(Shard* shard, int64_t begin, int64_t count,
+                char* buffer) const;
+
+  std::string dir_;
+  int64_t height_{0};
+  int64_t width_{0};
+  framework::proto::VarType::Type type_;
+  size_t row_size_{0};
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::atomic<int64_t> rows_read_{0};
+};
+
+// The tables opened by the lookup_table_disk ops by their directories, which
+// are shared by all the predictors of the process.
+class DiskEmbeddingTables {
+ public:
+  static DiskEmbeddingTables& Instance();
+
+  // The table in dir, which is opened with cache_rows by the first call.
+  std::shared_ptr<DiskEmbeddingTable> Get(const std::string& dir,
+                                          int64_t cache_rows);
+  // Forgets the table in dir after it is rebuilt, so that the next Get opens
+  // it again. The table stays valid for its current holders.
+  void Remove(const std::string& dir);
+
+ private:
+  DiskEmbeddingTables() = default;
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::shared_ptr<DiskEmbeddingTable>>
+      tables_;
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,109 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/disk_embedding_table.h"
+
+#include <stdlib.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+static std::string MakeTempDir() {
+  char dir[] = "/tmp/disk_embedding_table_testXXXXXX";
+  return mkdtemp(dir);
+}
+
+// Serializes a table of [height, width] where table[i][j] = i * width + j.
+static std::string SerializeTable(int64_t height, int64_t width) {
+  platform::CPUPlace place;
+  platform::CPUDeviceContext context(place);
+  framework::LoDTensor table;
+  float* data = table.mutable_data<float>({height, width}, place);
+  for (int64_t i = 0; i < height * width; ++i) data[i] = i;
+  std::ostringstream os;
+  framework::SerializeToStream(os, table, context);
+  return os.str();
+}
+
+TEST(DiskEmbeddingTable, build_and_lookup) {
+  const int64_t height = 10007, width = 5;
+  auto dir = MakeTempDir();
+  EXPECT_FALSE(DiskEmbeddingTable::Exists(dir));
+  // The table is followed by another tensor in a combined file.
+  std::istringstream is(SerializeTable(height, width) +
+                        SerializeTable(2, 3));
+  DiskEmbeddingTable::Build(&is, dir, 3, 7);
+  uint64_t source = 0;
+  ASSERT_TRUE(DiskEmbeddingTable::Exists(dir, &source));
+  EXPECT_EQ(source, 7UL);
+  framework::LoDTensor next;
+  framework::DeserializeFromStream(
+      is, &next, platform::CPUDeviceContext(platform::CPUPlace()));
+  EXPECT_EQ(next.dims(), framework::make_ddim({2, 3}));
+
+  DiskEmbeddingTable table(dir, 6);
+  EXPECT_EQ(table.height(), height);
+  EXPECT_EQ(table.width(), width);
+  EXPECT_EQ(table.type(), framework::proto::VarType::FP32);
+
+  std::vector<int64_t> ids = {0, 3, 6, 7, 3, 10006, 2, 5};
+  std::vector<float> out(ids.size() * width, -1);
+  table.Lookup(ids.data(), ids.size(), 2, out.data());
+  for (size_t i = 0; i < ids.size(); ++i) {
+    for (int64_t j = 0; j < width; ++j) {
+      float expected = ids[i] == 2 ? 0 : ids[i] * width + j;
+      ASSERT_EQ(out[i * width + j], expected);
+    }
+  }
+  // The duplicated id 3 and the padding id 2 are not read.
+  EXPECT_EQ(table.rows_read(), 6);
+
+  // The rows in the cache are not read again.
+  std::vector<int64_t> hot = {3, 7, 10006};
+  table.Lookup(hot.data(), hot.size(), -1, out.data());
+  EXPECT_EQ(table.rows_read(), 6);
+  for (size_t i = 0; i < hot.size(); ++i) {
+    EXPECT_EQ(out[i * width], hot[i] * width);
+  }
+  std::vector<int64_t> cold = {1, 4, 8, 11};
+  table.Lookup(cold.data(), cold.size(), -1, out.data());
+  EXPECT_EQ(table.rows_read(), 10);
+
+  std::vector<int64_t> invalid = {height};
+  EXPECT_ANY_THROW(
+      table.Lookup(invalid.data(), invalid.size(), -1, out.data()));
+}
+
+TEST(DiskEmbeddingTables, shared) {
+  auto dir = MakeTempDir();
+  std::istringstream is(SerializeTable(100, 8));
+  DiskEmbeddingTable::Build(&is, dir, 1);
+  auto& tables = DiskEmbeddingTables::Instance();
+  auto table = tables.Get(dir, 16);
+  EXPECT_EQ(tables.Get(dir, 32), table);
+  EXPECT_ANY_THROW(tables.Get(dir + "/missing", 16));
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
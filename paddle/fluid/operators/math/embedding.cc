@@ -0,0 +1,166 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/embedding.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#ifdef PADDLE_WITH_MKLML
+#include <omp.h>
+#endif
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The ids gathered by one task, and the distance of the prefetched ids.
+constexpr int64_t kEmbeddingBlockSize = 64;
+constexpr int64_t kEmbeddingPrefetchDistance = 8;
+// Run in parallel when there are more elements than this.
+constexpr int64_t kEmbeddingParallelNumel = 1 << 15;
+// The buckets of the histogram of ids, by which the rows of table_grad are
+// partitioned.
+constexpr int64_t kEmbeddingScatterBuckets = 1024;
+
+static inline void PrefetchRow(const void* row, size_t bytes) {
+#if defined(__GNUC__) || defined(__clang__)
+  const char* ptr = static_cast<const char*>(row);
+  for (size_t offset = 0; offset < bytes; offset += 64) {
+    __builtin_prefetch(ptr + offset);
+  }
+#endif
+}
+
+template <typename T>
+struct EmbeddingGatherFunctor<platform::CPUDeviceContext, T> {
+  void operator()(const platform::CPUDeviceContext& context, const T* table,
+                  int64_t width, const int64_t* rows, int64_t rows_num,
+                  T* out) {
+    size_t row_bytes = width * sizeof(T);
+    int64_t blocks =
+        (rows_num + kEmbeddingBlockSize - 1) / kEmbeddingBlockSize;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (rows_num * width > kEmbeddingParallelNumel)
+#endif
+    for (int64_t block = 0; block < blocks; ++block) {
+      int64_t begin = block * kEmbeddingBlockSize;
+      int64_t end = std::min(begin + kEmbeddingBlockSize, rows_num);
+      for (int64_t i = begin;
+           i < std::min(begin + kEmbeddingPrefetchDistance, end); ++i) {
+        if (rows[i] >= 0) PrefetchRow(table + rows[i] * width, row_bytes);
+      }
+      for (int64_t i = begin; i < end; ++i) {
+        int64_t next = i + kEmbeddingPrefetchDistance;
+        if (next < end && rows[next] >= 0) {
+          PrefetchRow(table + rows[next] * width, row_bytes);
+        }
+        if (rows[i] < 0) {
+          std::memset(out + i * width, 0, row_bytes);
+        } else {
+          std::memcpy(out + i * width, table + rows[i] * width, row_bytes);
+        }
+      }
+    }
+  }
+};
+
+template <typename T>
+struct EmbeddingScatterAddFunctor<platform::CPUDeviceContext, T> {
+  void operator()(const platform::CPUDeviceContext& context, const T* out_grad,
+                  int64_t width, const int64_t* rows, int64_t rows_num,
+                  int64_t table_height, T* table_grad) {
+    int64_t numel = table_height * width;
+    int64_t chunks =
+        (numel + kEmbeddingParallelNumel - 1) / kEmbeddingParallelNumel;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (numel > kEmbeddingParallelNumel)
+#endif
+    for (int64_t c = 0; c < chunks; ++c) {
+      int64_t begin = c * kEmbeddingParallelNumel;
+      int64_t size = std::min(kEmbeddingParallelNumel, numel - begin);
+      std::memset(table_grad + begin, 0, size * sizeof(T));
+    }
+
+    // The rows of table_grad are partitioned by threads, each of which scans
+    // all of the ids and accumulates the ones in its own rows, so no atomic
+    // is needed, the out_grad is read sequentially, and the result is the
+    // same as the serial one.
+    int parts = 1;
+#ifdef PADDLE_WITH_MKLML
+    if (rows_num * width > kEmbeddingParallelNumel) {
+      parts = omp_get_max_threads();
+    }
+#endif
+    int64_t buckets = std::min(table_height, kEmbeddingScatterBuckets);
+    if (parts <= 1 || buckets <= 1) {
+      ScatterAdd(out_grad, width, rows, rows_num, 0, table_height, table_grad);
+      return;
+    }
+
+    // Balance the number of ids of each part by the histogram of the ids.
+    int64_t rows_per_bucket = (table_height + buckets - 1) / buckets;
+    std::vector<int64_t> counts(buckets, 0);
+    int64_t total = 0;
+    for (int64_t i = 0; i < rows_num; ++i) {
+      if (rows[i] >= 0) {
+        ++counts[rows[i] / rows_per_bucket];
+        ++total;
+      }
+    }
+    std::vector<int64_t> bounds(parts + 1, table_height);
+    bounds[0] = 0;
+    int64_t count = 0;
+    int part = 1;
+    for (int64_t b = 0; b < buckets && part < parts; ++b) {
+      count += counts[b];
+      while (part < parts && count * parts >= total * part) {
+        bounds[part++] = std::min((b + 1) * rows_per_bucket, table_height);
+      }
+    }
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int p = 0; p < parts; ++p) {
+      ScatterAdd(out_grad, width, rows, rows_num, bounds[p], bounds[p + 1],
+                 table_grad);
+    }
+  }
+
+ private:
+  // Accumulate the ids in [row_begin, row_end).
+  static void ScatterAdd(const T* out_grad, int64_t width, const int64_t* rows,
+                         int64_t rows_num, int64_t row_begin, int64_t row_end,
+                         T* table_grad) {
+    for (int64_t i = 0; i < rows_num; ++i) {
+      if (rows[i] < row_begin || rows[i] >= row_end) continue;
+      T* dst = table_grad + rows[i] * width;
+      const T* src = out_grad + i * width;
+      for (int64_t j = 0; j < width; ++j) {
+        dst[j] += src[j];
+      }
+    }
+  }
+};
+
+template struct EmbeddingGatherFunctor<platform::CPUDeviceContext, float>;
+template struct EmbeddingGatherFunctor<platform::CPUDeviceContext, double>;
+template struct EmbeddingScatterAddFunctor<platform::CPUDeviceContext, float>;
+template struct EmbeddingScatterAddFunctor<platform::CPUDeviceContext, double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,50 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// out[i] = table[rows[i]], each of which has width elements. The rows which
+// are negative, such as the padding_idx of lookup_table, are filled with
+// zeros. The rows are gathered by blocks in parallel, and the rows of the
+// upcoming ids are prefetched.
+template <typename DeviceContext, typename T>
+struct EmbeddingGatherFunctor {
+  void operator()(const DeviceContext& context, const T* table, int64_t width,
+                  const int64_t* rows, int64_t rows_num, T* out);
+};
+
+// table_grad = 0, then table_grad[rows[i]] += out_grad[i] for the rows which
+// are not negative. table_grad has table_height rows.
+//
+// The rows of table_grad are partitioned into ranges by the histogram of ids,
+// and each range is accumulated by one thread in the order of ids, so the
+// result is the same as the serial one.
+template <typename DeviceContext, typename T>
+struct EmbeddingScatterAddFunctor {
+  void operator()(const DeviceContext& context, const T* out_grad,
+                  int64_t width, const int64_t* rows, int64_t rows_num,
+                  int64_t table_height, T* table_grad);
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,95 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/embedding.h"
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The serial row by row copy and accumulation, which were used by
+// lookup_table_v2 before.
+static void SerialGather(const float* table, int64_t width,
+                         const std::vector<int64_t>& rows, float* out) {
+  for (size_t i = 0; i < rows.size(); ++i) {
+    if (rows[i] < 0) {
+      std::memset(out + i * width, 0, width * sizeof(float));
+    } else {
+      std::memcpy(out + i * width, table + rows[i] * width,
+                  width * sizeof(float));
+    }
+  }
+}
+
+static void SerialScatterAdd(const float* out_grad, int64_t width,
+                             const std::vector<int64_t>& rows, int64_t height,
+                             float* table_grad) {
+  std::memset(table_grad, 0, height * width * sizeof(float));
+  for (size_t i = 0; i < rows.size(); ++i) {
+    if (rows[i] < 0) continue;
+    for (int64_t j = 0; j < width; ++j) {
+      table_grad[rows[i] * width + j] += out_grad[i * width + j];
+    }
+  }
+}
+
+static void TestEmbedding(int64_t height, int64_t width, int64_t ids_num) {
+  std::mt19937 engine(ids_num);
+  // Zipf-like ids with duplications, and some paddings.
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  std::vector<int64_t> rows(ids_num);
+  for (auto& row : rows) {
+    double u = uniform(engine);
+    row = static_cast<int64_t>(u * u * u * height);
+    if (uniform(engine) < 0.01) row = -1;
+  }
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<float> table(height * width), out_grad(ids_num * width);
+  for (auto& v : table) v = dist(engine);
+  for (auto& v : out_grad) v = dist(engine);
+
+  platform::CPUDeviceContext ctx;
+  EmbeddingGatherFunctor<platform::CPUDeviceContext, float> gather;
+  EmbeddingScatterAddFunctor<platform::CPUDeviceContext, float> scatter_add;
+  std::vector<float> out(ids_num * width), ref_out(ids_num * width);
+  std::vector<float> table_grad(height * width), ref_table_grad(height * width);
+  gather(ctx, table.data(), width, rows.data(), ids_num, out.data());
+  scatter_add(ctx, out_grad.data(), width, rows.data(), ids_num, height,
+              table_grad.data());
+  SerialGather(table.data(), width, rows, ref_out.data());
+  SerialScatterAdd(out_grad.data(), width, rows, height,
+                   ref_table_grad.data());
+  // The accumulation order of each row is the same as the serial one.
+  ASSERT_EQ(out, ref_out);
+  ASSERT_EQ(table_grad, ref_table_grad);
+}
+
+TEST(Embedding, correctness) {
+  TestEmbedding(1, 4, 10);
+  TestEmbedding(10, 1, 100);
+  TestEmbedding(1000, 3, 7);
+  TestEmbedding(1000, 16, 5000);
+  TestEmbedding(300, 64, 100000);
+  TestEmbedding(100000, 8, 0);
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
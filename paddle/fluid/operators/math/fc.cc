@@ -16,6 +16,7 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/packed_gemm.h"
 
 namespace paddle {
 namespace operators {
@@ -45,7 +46,7 @@ class FCFunctor<platform::CPUDeviceContext, T> {
       }
       blas.GEMM(false, false, M, N, K, static_cast<T>(1.0), X1_data, KK, W, NN,
                 static_cast<T>(0.0), Y1_data, NN);
-    } else {
+    } else if (!PackedMatMul(context, M, N, K, X, W, Y)) {
       blas.MatMul(M, N, K, X, W, Y);
     }
     if (B == NULL) {
@@ -26,6 +26,7 @@ limitations under the License. */
 #include <utility>
 #include <vector>
 #include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/operators/math/cpu_transpose.h"
 #include "paddle/fluid/operators/math/math_function_impl.h"
 #include "paddle/fluid/platform/float16.h"
 #include "unsupported/Eigen/CXX11/Tensor"
@@ -58,6 +59,13 @@ template struct SetConstant<platform::XPUDeviceContext, platform::complex64>;
 template struct SetConstant<platform::XPUDeviceContext, platform::complex128>;
 #endif
 
+template <typename T, int Rank>
+void Transpose<platform::CPUDeviceContext, T, Rank>::operator()(
+    const platform::CPUDeviceContext& context, const framework::Tensor& in,
+    framework::Tensor* out, const std::vector<int>& axis) {
+  CPUTranspose<T>(in.dims(), axis, in.data<T>(), out->data<T>());
+}
+
 #define DEFINE_CPU_TRANS(RANK)                                                \
   template struct Transpose<platform::CPUDeviceContext, platform::float16,    \
                             RANK>;                                            \
@@ -88,26 +96,7 @@ struct TransposeNormal<platform::CPUDeviceContext, T> {
   void operator()(const platform::CPUDeviceContext& context,
                   const framework::Tensor& in, framework::Tensor* out,
                   const std::vector<int>& axis) {
-    const int rank = axis.size();
-    auto in_stride = framework::stride(in.dims());
-    auto out_stride = framework::stride(out->dims());
-    const T* in_ptr = in.data<T>();
-    T* out_ptr = out->data<T>();
-
-    auto transpose_helper = [&](int64_t beg, int64_t end) {
-      for (int64_t out_idx = beg; out_idx < end; ++out_idx) {
-        int64_t in_idx = 0;
-        int64_t tmp_idx = out_idx;
-        // calculate the input index
-        for (int i = 0; i < rank; ++i) {
-          const int64_t coordinate = tmp_idx / out_stride[i];
-          tmp_idx -= coordinate * out_stride[i];
-          in_idx += coordinate * in_stride[axis[i]];
-        }
-        out_ptr[out_idx] = in_ptr[in_idx];
-      }
-    };
-    transpose_helper(0, out->numel());
+    CPUTranspose<T>(in.dims(), axis, in.data<T>(), out->data<T>());
   }
 };
 
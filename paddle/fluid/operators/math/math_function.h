@@ -41,6 +41,15 @@ struct Transpose {
                   framework::Tensor* out, const std::vector<int>& axis);
 };
 
+// The transposes on CPU are copied by the cache blocked engine of
+// cpu_transpose.h instead of Eigen shuffle.
+template <typename T, int Rank>
+struct Transpose<platform::CPUDeviceContext, T, Rank> {
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& in, framework::Tensor* out,
+                  const std::vector<int>& axis);
+};
+
 template <typename DeviceContext, typename T>
 struct SetConstant {
   void operator()(const DeviceContext& context, framework::Tensor* tensor,
@@ -0,0 +1,119 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/packed_gemm.h"
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/operators/math/blas.h"
+
+DECLARE_bool(use_packed_gemm_weights);
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+template <typename T>
+std::shared_ptr<PackedGemmWeight> PackedGemmWeight::Create(
+    const framework::Tensor& weight, int K, int N) {
+#ifdef PADDLE_WITH_MKLML
+  PADDLE_ENFORCE_EQ(
+      weight.numel(), static_cast<int64_t>(K) * N,
+      platform::errors::InvalidArgument(
+          "The numel of the packed weight should be K * N = %d, but got %d.",
+          static_cast<int64_t>(K) * N, weight.numel()));
+  // As gru, W is packed for M = 1 and reused by the GEMMs of any M.
+  T* packed = CBlas<T>::GEMM_ALLOC(CblasBMatrix, 1, N, K);
+  PADDLE_ENFORCE_NOT_NULL(
+      packed, platform::errors::ResourceExhausted(
+                  "Failed to allocate the packed weight of [%d, %d].", K, N));
+  CBlas<T>::GEMM_PACK(CblasRowMajor, CblasBMatrix, CblasNoTrans, 1, N, K,
+                      static_cast<T>(1), weight.data<T>(), N, packed);
+
+  std::shared_ptr<PackedGemmWeight> result(new PackedGemmWeight());
+  result->K_ = K;
+  result->N_ = N;
+  result->type_ = framework::DataTypeTrait<T>::DataType();
+  result->holder_ = weight.Holder();
+  result->packed_ = std::shared_ptr<void>(
+      packed, [](void* p) { CBlas<T>::GEMM_FREE(static_cast<T*>(p)); });
+  return result;
+#else
+  return nullptr;
+#endif
+}
+
+template <typename T>
+void PackedGemmWeight::Compute(const platform::CPUDeviceContext& context,
+                               int M, const T* A, T* C) const {
+#ifdef PADDLE_WITH_MKLML
+  auto blas = GetBlas<platform::CPUDeviceContext, T>(context);
+  blas.GEMM_COMPUTE(CblasNoTrans, CblasPacked, M, N_, K_, A, K_,
+                    static_cast<const T*>(packed_.get()), N_,
+                    static_cast<T>(0), C, N_);
+#else
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "The packed GEMM is only supported with MKLML."));
+#endif
+}
+
+PackedGemmWeightCache& PackedGemmWeightCache::Instance() {
+  static PackedGemmWeightCache cache;
+  return cache;
+}
+
+template <typename T>
+std::shared_ptr<PackedGemmWeight> PackedGemmWeightCache::Pack(
+    const framework::Tensor& weight, int K, int N) {
+  if (!FLAGS_use_packed_gemm_weights ||
+      !platform::is_cpu_place(weight.place())) {
+    return nullptr;
+  }
+  const T* data = weight.data<T>();
+  auto packed = Find(data, K, N);
+  if (packed != nullptr) {
+    return std::const_pointer_cast<PackedGemmWeight>(packed);
+  }
+  auto created = PackedGemmWeight::Create<T>(weight, K, N);
+  if (created == nullptr) return nullptr;
+
+  framework::AutoWRLock lock(&lock_);
+  // Drops the weights released by their predictors.
+  for (auto it = weights_.begin(); it != weights_.end();) {
+    it = it->second.expired() ? weights_.erase(it) : std::next(it);
+  }
+  weights_[data] = created;
+  size_.store(weights_.size(), std::memory_order_relaxed);
+  return created;
+}
+
+void PackedGemmWeightCache::Erase(const void* weight) {
+  framework::AutoWRLock lock(&lock_);
+  weights_.erase(weight);
+  size_.store(weights_.size(), std::memory_order_relaxed);
+}
+
+#define INSTANTIATE_PACKED_GEMM(T)                                           \
+  template std::shared_ptr<PackedGemmWeight> PackedGemmWeight::Create<T>(    \
+      const framework::Tensor&, int, int);                                   \
+  template void PackedGemmWeight::Compute<T>(                                \
+      const platform::CPUDeviceContext&, int, const T*, T*) const;           \
+  template std::shared_ptr<PackedGemmWeight> PackedGemmWeightCache::Pack<T>( \
+      const framework::Tensor&, int, int)
+
+INSTANTIATE_PACKED_GEMM(float);
+INSTANTIATE_PACKED_GEMM(double);
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
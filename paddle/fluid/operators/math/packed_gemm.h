@@ -0,0 +1,120 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+
+#include "paddle/fluid/framework/rw_lock.h"
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The weight W of [K, N] in C = A * W, packed once by the packed GEMM of MKL
+// so that the GEMMs of any M skip packing W. It holds the allocation of W,
+// so that the address of W, which is the key of PackedGemmWeightCache, is
+// not reused while it is packed.
+class PackedGemmWeight {
+ public:
+  template <typename T>
+  static std::shared_ptr<PackedGemmWeight> Create(
+      const framework::Tensor& weight, int K, int N);
+
+  // C = A * W, where A is [M, K] and C is [M, N].
+  template <typename T>
+  void Compute(const platform::CPUDeviceContext& context, int M, const T* A,
+               T* C) const;
+
+  int K() const { return K_; }
+  int N() const { return N_; }
+  framework::proto::VarType::Type type() const { return type_; }
+
+ private:
+  PackedGemmWeight() = default;
+
+  int K_{0};
+  int N_{0};
+  framework::proto::VarType::Type type_;
+  std::shared_ptr<memory::Allocation> holder_;
+  std::shared_ptr<void> packed_;
+};
+
+// The packed weights by the address of W. The weights are packed by the
+// inference predictor when the persistables are loaded, and owned by the
+// predictor and its clones; the cache only refers to them, and the fc and
+// mul kernels look them up.
+class PackedGemmWeightCache {
+ public:
+  static PackedGemmWeightCache& Instance();
+
+  // Packs weight of [K, N], or returns nullptr if the packed GEMM is not
+  // supported, or disabled by FLAGS_use_packed_gemm_weights.
+  template <typename T>
+  std::shared_ptr<PackedGemmWeight> Pack(const framework::Tensor& weight, int K,
+                                         int N);
+
+  template <typename T>
+  std::shared_ptr<const PackedGemmWeight> Find(const T* weight, int K,
+                                               int N) const {
+    if (size_.load(std::memory_order_relaxed) == 0) return nullptr;
+    std::shared_ptr<const PackedGemmWeight> packed;
+    {
+      framework::AutoRDLock lock(&lock_);
+      auto it = weights_.find(weight);
+      if (it != weights_.end()) packed = it->second.lock();
+    }
+    if (packed && packed->K() == K && packed->N() == N &&
+        packed->type() == framework::DataTypeTrait<T>::DataType()) {
+      return packed;
+    }
+    return nullptr;
+  }
+
+  // Drops the packed weight of the address, which should be called before W
+  // is modified in place.
+  void Erase(const void* weight);
+
+ private:
+  PackedGemmWeightCache() = default;
+
+  mutable framework::RWLock lock_;
+  std::unordered_map<const void*, std::weak_ptr<PackedGemmWeight>> weights_;
+  std::atomic<size_t> size_{0};
+};
+
+// C = A * W by the packed W if it is in PackedGemmWeightCache, and returns
+// whether it is computed.
+template <typename DeviceContext, typename T>
+inline bool PackedMatMul(const DeviceContext& context, int M, int N, int K,
+                         const T* A, const T* W, T* C) {
+  return false;
+}
+
+template <typename T>
+inline bool PackedMatMul(const platform::CPUDeviceContext& context, int M,
+                         int N, int K, const T* A, const T* W, T* C) {
+  auto packed = PackedGemmWeightCache::Instance().Find(W, K, N);
+  if (packed == nullptr) return false;
+  packed->Compute(context, M, A, C);
+  return true;
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,70 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/packed_gemm.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/operators/math/blas.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+template <typename T>
+static void TestPackedMatMul(int M, int N, int K) {
+  platform::CPUPlace place;
+  platform::CPUDeviceContext context(place);
+  framework::Tensor x, w;
+  T* x_data = x.mutable_data<T>({M, K}, place);
+  T* w_data = w.mutable_data<T>({K, N}, place);
+  for (int i = 0; i < M * K; ++i) x_data[i] = static_cast<T>(i % 13 - 6);
+  for (int i = 0; i < K * N; ++i) w_data[i] = static_cast<T>(i % 7 - 3) / 4;
+  std::vector<T> out(M * N), ref(M * N);
+  GetBlas<platform::CPUDeviceContext, T>(context).MatMul(M, N, K, x_data,
+                                                         w_data, ref.data());
+
+  auto& cache = PackedGemmWeightCache::Instance();
+  EXPECT_FALSE(PackedMatMul(context, M, N, K, x_data, w_data, out.data()));
+  auto packed = cache.Pack<T>(w, K, N);
+#ifdef PADDLE_WITH_MKLML
+  ASSERT_NE(packed, nullptr);
+  // The weight of other shapes is not computed by the packed one.
+  EXPECT_EQ(cache.Find(w_data, N, K), nullptr);
+  for (int m : {1, M}) {
+    std::fill(out.begin(), out.end(), static_cast<T>(0));
+    ASSERT_TRUE(PackedMatMul(context, m, N, K, x_data, w_data, out.data()));
+    for (int i = 0; i < m * N; ++i) EXPECT_NEAR(out[i], ref[i], 1e-4);
+  }
+  cache.Erase(w_data);
+  EXPECT_FALSE(PackedMatMul(context, M, N, K, x_data, w_data, out.data()));
+  // The released weights are not found.
+  packed = cache.Pack<T>(w, K, N);
+  packed.reset();
+  EXPECT_EQ(cache.Find(w_data, K, N), nullptr);
+#else
+  EXPECT_EQ(packed, nullptr);
+  EXPECT_FALSE(PackedMatMul(context, M, N, K, x_data, w_data, out.data()));
+#endif
+}
+
+TEST(PackedGemm, float) { TestPackedMatMul<float>(9, 70, 33); }
+
+TEST(PackedGemm, double) { TestPackedMatMul<double>(5, 16, 128); }
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -14,6 +14,15 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
 
+#include <algorithm>
+#include <cstring>
+
+#ifdef PADDLE_WITH_MKLML
+#include <omp.h>
+#endif
+
+#include "paddle/fluid/operators/jit/kernels.h"
+
 namespace paddle {
 namespace operators {
 namespace math {
@@ -294,24 +303,251 @@ template struct SelectedRowsAddToTensor<platform::CPUDeviceContext, int64_t>;
 // add or mul.
 namespace scatter {
 
-template <typename DeviceContext, typename T>
-typename std::enable_if<
-    std::is_floating_point<T>::value &&
-    std::is_same<DeviceContext, platform::CPUDeviceContext>::value>::type
-elementwise_add_to(const DeviceContext& ctx, BlasT<DeviceContext, T>* blas,
-                   size_t data_len, const T* in, T* out) {
-  blas->AXPY(data_len, 1., in, out);
+// Adds a row of width elements to another, by the jit kernel if T is a
+// floating point type.
+template <typename T, typename Enable = void>
+struct RowAdder {
+  explicit RowAdder(int64_t width) : width_(width) {}
+  void operator()(const T* x, T* y) const {
+    for (int64_t i = 0; i < width_; ++i) {
+      y[i] += x[i];
+    }
+  }
+  int64_t width_;
+};
+
+template <typename T>
+struct RowAdder<T, typename std::enable_if<
+                       std::is_floating_point<T>::value>::type> {
+  // KernelFuncs::Cache is not thread safe, so the kernel is fetched before
+  // the parallel loops.
+  explicit RowAdder(int64_t width)
+      : width_(static_cast<int>(width)),
+        add_(jit::KernelFuncs<jit::VAddTuple<T>, platform::CPUPlace>::Cache()
+                 .At(width_)) {}
+  void operator()(const T* x, T* y) const { add_(x, y, y, width_); }
+  int width_;
+  typename jit::VAddTuple<T>::func_type add_;
+};
+
+// The rows of the inputs grouped by id. rows are the sorted unique ids, and
+// the group of rows[i] is the input rows order[offsets[i]], ...,
+// order[offsets[i + 1] - 1], which are the indices of the rows in all the
+// inputs concatenated, in their order.
+struct RowGroups {
+  std::vector<int64_t> rows;
+  std::vector<size_t> offsets;
+  std::vector<size_t> order;
+};
+
+constexpr int kRadixBits = 8;
+constexpr size_t kRadixBuckets = 1UL << kRadixBits;
+// The rows grouped by the threads only if there are more rows than it.
+constexpr size_t kRadixParallelRows = 1UL << 14;
+// The partitions with fewer keys are sorted by insertion.
+constexpr size_t kRadixInsertionSortSize = 32;
+
+// Sorts keys[0, n) and order[0, n) stably by the low bits of the keys, by
+// the digits of kRadixBits bits, skipping the digits all the keys share.
+// buf_keys and buf_order are the buffers of n elements.
+static void RadixSortLowBits(int bits, size_t n, uint64_t* keys, size_t* order,
+                             uint64_t* buf_keys, size_t* buf_order) {
+  if (n < 2 || bits == 0) return;
+  if (n < kRadixInsertionSortSize) {
+    // The high bits of the keys are the same.
+    for (size_t i = 1; i < n; ++i) {
+      uint64_t key = keys[i];
+      size_t index = order[i];
+      size_t j = i;
+      for (; j > 0 && keys[j - 1] > key; --j) {
+        keys[j] = keys[j - 1];
+        order[j] = order[j - 1];
+      }
+      keys[j] = key;
+      order[j] = index;
+    }
+    return;
+  }
+  uint64_t* src_keys = keys;
+  size_t* src_order = order;
+  for (int shift = 0; shift < bits; shift += kRadixBits) {
+    size_t counts[kRadixBuckets] = {0};
+    for (size_t i = 0; i < n; ++i) {
+      ++counts[(src_keys[i] >> shift) & (kRadixBuckets - 1)];
+    }
+    if (counts[(src_keys[0] >> shift) & (kRadixBuckets - 1)] == n) continue;
+    size_t sum = 0;
+    for (size_t d = 0; d < kRadixBuckets; ++d) {
+      size_t count = counts[d];
+      counts[d] = sum;
+      sum += count;
+    }
+    for (size_t i = 0; i < n; ++i) {
+      size_t pos = counts[(src_keys[i] >> shift) & (kRadixBuckets - 1)]++;
+      buf_keys[pos] = src_keys[i];
+      buf_order[pos] = src_order[i];
+    }
+    std::swap(src_keys, buf_keys);
+    std::swap(src_order, buf_order);
+  }
+  if (src_keys != keys) {
+    std::memcpy(keys, src_keys, n * sizeof(uint64_t));
+    std::memcpy(order, src_order, n * sizeof(size_t));
+  }
 }
 
-template <typename DeviceContext, typename T>
-typename std::enable_if<
-    !std::is_floating_point<T>::value &&
-    std::is_same<DeviceContext, platform::CPUDeviceContext>::value>::type
-elementwise_add_to(const DeviceContext& ctx, BlasT<DeviceContext, T>* blas,
-                   size_t data_len, const T* in, T* out) {
-  for (size_t i = 0; i < data_len; i++) {
-    out[i] += in[i];
+// Groups the row_num rows of the inputs by a radix sort of the ids, which
+// compares no ids and keeps the duplicated rows in their order. The ids are
+// partitioned by their top digit into a part of each partition for each
+// thread, then each partition is sorted by the lower digits and deduplicated
+// by a thread, so the threads share no buckets.
+static void GroupRowsByRadix(
+    const std::vector<const framework::SelectedRows*>& inputs, size_t row_num,
+    RowGroups* groups) {
+  // The ids in the offset binary, so that the order of the keys is the one
+  // of the signed ids.
+  constexpr uint64_t kSignBit = static_cast<uint64_t>(1) << 63;
+  std::vector<uint64_t> keys(row_num), part_keys(row_num);
+  std::vector<size_t> order(row_num), part_order(row_num);
+  size_t n = 0;
+  for (auto* input : inputs) {
+    for (int64_t id : input->rows()) {
+      keys[n] = static_cast<uint64_t>(id) ^ kSignBit;
+      order[n] = n;
+      ++n;
+    }
+  }
+  auto min_max = std::minmax_element(keys.begin(), keys.end());
+  uint64_t min_key = *min_max.first;
+  uint64_t range = *min_max.second - min_key;
+  int bits = 0;
+  while (bits < 64 && (range >> bits) != 0) ++bits;
+  int top_shift = bits > kRadixBits ? bits - kRadixBits : 0;
+  size_t parts = static_cast<size_t>(range >> top_shift) + 1;
+
+  int threads = 1;
+#ifdef PADDLE_WITH_MKLML
+  if (row_num > kRadixParallelRows) {
+    threads = omp_get_max_threads();
+  }
+#endif
+  size_t chunk = (row_num + threads - 1) / threads;
+  // counts[t * parts + p] is the number of the keys of partition p in the
+  // chunk of thread t, then the position of its part.
+  std::vector<size_t> counts(threads * parts, 0);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for num_threads(threads)
+#endif
+  for (int t = 0; t < threads; ++t) {
+    size_t* count = &counts[t * parts];
+    size_t end = std::min(row_num, (t + 1) * chunk);
+    for (size_t i = t * chunk; i < end; ++i) {
+      keys[i] -= min_key;
+      ++count[keys[i] >> top_shift];
+    }
+  }
+  std::vector<size_t> part_begin(parts + 1);
+  size_t sum = 0;
+  for (size_t p = 0; p < parts; ++p) {
+    part_begin[p] = sum;
+    for (int t = 0; t < threads; ++t) {
+      size_t count = counts[t * parts + p];
+      counts[t * parts + p] = sum;
+      sum += count;
+    }
   }
+  part_begin[parts] = row_num;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for num_threads(threads)
+#endif
+  for (int t = 0; t < threads; ++t) {
+    size_t* pos = &counts[t * parts];
+    size_t end = std::min(row_num, (t + 1) * chunk);
+    for (size_t i = t * chunk; i < end; ++i) {
+      size_t dst = pos[keys[i] >> top_shift]++;
+      part_keys[dst] = keys[i];
+      part_order[dst] = order[i];
+    }
+  }
+
+  // Sort and count the unique ids of each partition, in which keys and order
+  // are the buffers.
+  std::vector<size_t> part_groups(parts + 1, 0);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for num_threads(threads) schedule(dynamic)
+#endif
+  for (size_t p = 0; p < parts; ++p) {
+    size_t begin = part_begin[p];
+    size_t size = part_begin[p + 1] - begin;
+    if (size == 0) continue;
+    RadixSortLowBits(top_shift, size, &part_keys[begin], &part_order[begin],
+                     &keys[begin], &order[begin]);
+    size_t unique = 1;
+    for (size_t i = begin + 1; i < begin + size; ++i) {
+      if (part_keys[i] != part_keys[i - 1]) ++unique;
+    }
+    part_groups[p + 1] = unique;
+  }
+  for (size_t p = 0; p < parts; ++p) {
+    part_groups[p + 1] += part_groups[p];
+  }
+
+  size_t group_num = part_groups[parts];
+  groups->rows.resize(group_num);
+  groups->offsets.resize(group_num + 1);
+  groups->offsets[group_num] = row_num;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for num_threads(threads)
+#endif
+  for (size_t p = 0; p < parts; ++p) {
+    size_t g = part_groups[p];
+    for (size_t i = part_begin[p]; i < part_begin[p + 1]; ++i) {
+      if (i == part_begin[p] || part_keys[i] != part_keys[i - 1]) {
+        groups->rows[g] = static_cast<int64_t>((part_keys[i] + min_key) ^
+                                               kSignBit);
+        groups->offsets[g] = i;
+        ++g;
+      }
+    }
+  }
+  groups->order = std::move(part_order);
+}
+
+// out[i] = the sum of the rows of group i, where row_data are the rows of
+// all the inputs concatenated.
+template <typename T>
+static void SumRowGroups(const RowGroups& groups,
+                         const std::vector<const T*>& row_data, int64_t width,
+                         T* out) {
+  RowAdder<T> add(width);
+  int64_t group_num = static_cast<int64_t>(groups.rows.size());
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (row_data.size() > kRadixParallelRows)
+#endif
+  for (int64_t g = 0; g < group_num; ++g) {
+    T* dst = out + g * width;
+    size_t begin = groups.offsets[g];
+    std::memcpy(dst, row_data[groups.order[begin]], width * sizeof(T));
+    for (size_t i = begin + 1; i < groups.offsets[g + 1]; ++i) {
+      add(row_data[groups.order[i]], dst);
+    }
+  }
+}
+
+template <typename T>
+static std::vector<const T*> RowData(
+    const std::vector<const framework::SelectedRows*>& inputs, size_t row_num,
+    int64_t width) {
+  std::vector<const T*> row_data;
+  row_data.reserve(row_num);
+  for (auto* input : inputs) {
+    const T* data = input->rows().size() > 0 ? input->value().data<T>()
+                                             : nullptr;
+    for (size_t i = 0; i < input->rows().size(); ++i) {
+      row_data.push_back(data + i * width);
+    }
+  }
+  return row_data;
 }
 
 template <typename T>
@@ -355,7 +591,6 @@ struct MergeAdd<platform::CPUDeviceContext, T> {
     auto input_width = has_value_input->value().dims()[1];
     auto input_height = has_value_input->height();
     framework::SelectedRows& out = *output;
-    std::set<int64_t> merged_row_set;
     size_t row_num = 0;
     for (auto* input : inputs) {
       if (input->rows().size() == 0) {
@@ -369,17 +604,18 @@ struct MergeAdd<platform::CPUDeviceContext, T> {
                         platform::errors::InvalidArgument(
                             "All inputs should have same height."));
       row_num += input->rows().size();
-      merged_row_set.insert(input->rows().begin(), input->rows().end());
     }
+    RowGroups groups;
+    GroupRowsByRadix(inputs, row_num, &groups);
 
     out.set_height(input_height);
     out.mutable_value()->mutable_data<T>(
         framework::make_ddim(
-            {static_cast<int64_t>(merged_row_set.size()), input_width}),
+            {static_cast<int64_t>(groups.rows.size()), input_width}),
         context.GetPlace());
     auto* out_data = out.mutable_value()->data<T>();
 
-    if (merged_row_set.size() == row_num && !sorted_result) {
+    if (groups.rows.size() == row_num && !sorted_result) {
       // no duplicated ids, just concat the result together
       std::vector<int64_t> merge_rows;
       merge_rows.reserve(row_num);
@@ -402,38 +638,9 @@ struct MergeAdd<platform::CPUDeviceContext, T> {
         copied_numel += in_numel;
       }
     } else {
-      std::vector<int64_t> merge_rows(merged_row_set.begin(),
-                                      merged_row_set.end());
-
-      if (sorted_result) {
-        std::sort(merge_rows.begin(), merge_rows.end());
-      }
-
-      out.set_rows(merge_rows);
-
-      math::SetConstant<platform::CPUDeviceContext, T> constant_functor;
-      constant_functor(context, out.mutable_value(), 0.0);
-
-      std::unordered_map<int64_t, size_t> rows_to_id;
-      for (size_t i = 0; i < merge_rows.size(); ++i) {
-        rows_to_id[merge_rows[i]] = i;
-      }
-
-      auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
-      for (auto* input : inputs) {
-        if (input->rows().size() == 0) {
-          continue;
-        }
-        auto* input_data = input->value().data<T>();
-        auto& input_rows = input->rows();
-
-        for (size_t i = 0; i < input_rows.size(); i++) {
-          size_t out_i = rows_to_id[input_rows[i]];
-          elementwise_add_to<platform::CPUDeviceContext, T>(
-              context, &blas, static_cast<size_t>(input_width),
-              &input_data[i * input_width], &out_data[out_i * input_width]);
-        }
-      }
+      out.set_rows(groups.rows);
+      SumRowGroups<T>(groups, RowData<T>(inputs, row_num, input_width),
+                      input_width, out_data);
     }
   }
 };
@@ -476,7 +683,6 @@ struct MergeAverage<platform::CPUDeviceContext, T> {
     auto input_width = has_value_input->value().dims()[1];
     auto input_height = has_value_input->height();
     framework::SelectedRows& out = *output;
-    std::set<int64_t> merged_row_set;
     size_t row_num = 0;
     for (auto* input : inputs) {
       if (input->rows().size() == 0) {
@@ -490,45 +696,21 @@ struct MergeAverage<platform::CPUDeviceContext, T> {
                         platform::errors::InvalidArgument(
                             "All input should have same height."));
       row_num += input->rows().size();
-      merged_row_set.insert(input->rows().begin(), input->rows().end());
     }
+    RowGroups groups;
+    GroupRowsByRadix(inputs, row_num, &groups);
+    auto& merge_rows = groups.rows;
 
     out.set_height(input_height);
     out.mutable_value()->mutable_data<T>(
         framework::make_ddim(
-            {static_cast<int64_t>(merged_row_set.size()), input_width}),
+            {static_cast<int64_t>(merge_rows.size()), input_width}),
         context.GetPlace());
     auto* out_data = out.mutable_value()->data<T>();
 
-    std::vector<int64_t> merge_rows(merged_row_set.begin(),
-                                    merged_row_set.end());
-    std::sort(merge_rows.begin(), merge_rows.end());
-
     out.set_rows(merge_rows);
-
-    math::SetConstant<platform::CPUDeviceContext, T> constant_functor;
-    constant_functor(context, out.mutable_value(), 0.0);
-
-    std::unordered_map<int64_t, size_t> rows_to_id;
-    for (size_t i = 0; i < merge_rows.size(); ++i) {
-      rows_to_id[merge_rows[i]] = i;
-    }
-
-    auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
-    for (auto* input : inputs) {
-      if (input->rows().size() == 0) {
-        continue;
-      }
-      auto* input_data = input->value().data<T>();
-      auto& input_rows = input->rows();
-
-      for (size_t i = 0; i < input_rows.size(); i++) {
-        size_t out_i = rows_to_id[input_rows[i]];
-        elementwise_add_to<platform::CPUDeviceContext, T>(
-            context, &blas, static_cast<size_t>(input_width),
-            &input_data[i * input_width], &out_data[out_i * input_width]);
-      }
-    }
+    SumRowGroups<T>(groups, RowData<T>(inputs, row_num, input_width),
+                    input_width, out_data);
     size_t input_width_cast = static_cast<size_t>(input_width);
     T count = static_cast<T>(inputs.size());
     for (size_t i = 0; i < merge_rows.size(); i++) {
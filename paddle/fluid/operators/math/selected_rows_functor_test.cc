@@ -14,6 +14,10 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/math/selected_rows_functor.h"
 
+#include <limits>
+#include <map>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "paddle/fluid/operators/math/math_function.h"
 
@@ -463,6 +467,142 @@ TEST(selected_rows_functor, cpu_merge_add_multi_noduplicated) {
   }
 }
 
+TEST(selected_rows_functor, cpu_merge_add_many_rows) {
+  paddle::platform::CPUPlace cpu_place;
+  paddle::platform::CPUDeviceContext ctx(cpu_place);
+  // Enough rows to be grouped in parallel, with the ids in a range wider
+  // than a digit of the radix sort.
+  int64_t height = 1000000;
+  int64_t row_numel = 4;
+  int64_t input_num = 3;
+  int64_t row_num = 20000;
+
+  std::vector<std::unique_ptr<paddle::framework::SelectedRows>> selected_rows;
+  std::vector<const paddle::framework::SelectedRows*> inputs;
+  std::map<int64_t, float> expected;
+  for (int64_t k = 0; k < input_num; ++k) {
+    std::vector<int64_t> rows(row_num);
+    for (int64_t i = 0; i < row_num; ++i) {
+      rows[i] = (i * 7919 + k * 104729) % (height / (k + 1));
+    }
+    selected_rows.emplace_back(
+        new paddle::framework::SelectedRows(rows, height));
+    auto* data = selected_rows.back()->mutable_value()->mutable_data<float>(
+        paddle::framework::make_ddim({row_num, row_numel}), cpu_place);
+    for (int64_t i = 0; i < row_num; ++i) {
+      for (int64_t j = 0; j < row_numel; ++j) {
+        data[i * row_numel + j] = static_cast<float>(k + 1);
+      }
+      expected[rows[i]] += static_cast<float>(k + 1);
+    }
+    inputs.push_back(selected_rows.back().get());
+  }
+
+  paddle::framework::SelectedRows output;
+  paddle::operators::math::scatter::MergeAdd<paddle::platform::CPUDeviceContext,
+                                             float>
+      merge_add_functor;
+  merge_add_functor(ctx, inputs, &output);
+
+  ASSERT_EQ(output.rows().size(), expected.size());
+  auto* out_data = output.value().data<float>();
+  size_t i = 0;
+  for (auto& row : expected) {
+    EXPECT_EQ(output.rows()[i], row.first);
+    for (int64_t j = 0; j < row_numel; ++j) {
+      EXPECT_EQ(out_data[i * row_numel + j], row.second);
+    }
+    ++i;
+  }
+}
+
+TEST(selected_rows_functor, cpu_merge_add_signed_rows) {
+  paddle::platform::CPUPlace cpu_place;
+  paddle::platform::CPUDeviceContext ctx(cpu_place);
+  // The negative and the large ids span all the 64 bits of the keys of the
+  // radix sort, and the rows are enough to be grouped in parallel.
+  const int64_t kMax = std::numeric_limits<int64_t>::max();
+  const int64_t kMin = std::numeric_limits<int64_t>::min();
+  const int64_t kLarge = static_cast<int64_t>(1) << 40;
+  int64_t height = 1000000;
+  int64_t row_numel = 2;
+  int64_t input_num = 3;
+  int64_t row_num = 20000;
+
+  std::vector<std::unique_ptr<paddle::framework::SelectedRows>> selected_rows;
+  std::vector<const paddle::framework::SelectedRows*> inputs;
+  std::map<int64_t, float> expected;
+  for (int64_t k = 0; k < input_num; ++k) {
+    std::vector<int64_t> rows(row_num);
+    for (int64_t i = 0; i < row_num; ++i) {
+      switch (i % 5) {
+        case 0:
+          rows[i] = -((i * 7919 + k * 104729) % height) - 1;
+          break;
+        case 1:
+          rows[i] = kLarge + (i * 7919) % 1000;
+          break;
+        case 2:
+          rows[i] = kMax - i % 50;
+          break;
+        case 3:
+          rows[i] = kMin + i % 50;
+          break;
+        default:
+          rows[i] = i % 100 - 50;
+      }
+    }
+    selected_rows.emplace_back(
+        new paddle::framework::SelectedRows(rows, height));
+    auto* data = selected_rows.back()->mutable_value()->mutable_data<float>(
+        paddle::framework::make_ddim({row_num, row_numel}), cpu_place);
+    for (int64_t i = 0; i < row_num; ++i) {
+      for (int64_t j = 0; j < row_numel; ++j) {
+        data[i * row_numel + j] = static_cast<float>(k + 1);
+      }
+      expected[rows[i]] += static_cast<float>(k + 1);
+    }
+    inputs.push_back(selected_rows.back().get());
+  }
+
+  paddle::framework::SelectedRows output;
+  paddle::operators::math::scatter::MergeAdd<paddle::platform::CPUDeviceContext,
+                                             float>
+      merge_add_functor;
+  merge_add_functor(ctx, inputs, &output);
+
+  // The rows are in the order of the signed ids.
+  ASSERT_EQ(output.rows().size(), expected.size());
+  auto* out_data = output.value().data<float>();
+  size_t i = 0;
+  for (auto& row : expected) {
+    EXPECT_EQ(output.rows()[i], row.first);
+    for (int64_t j = 0; j < row_numel; ++j) {
+      EXPECT_EQ(out_data[i * row_numel + j], row.second);
+    }
+    ++i;
+  }
+
+  // A few rows, whose partitions are sorted by insertion.
+  std::vector<int64_t> few_rows{kMax, -3, 0, kMin, -3, kLarge, kMax, -1};
+  paddle::framework::SelectedRows few(few_rows, height);
+  auto* few_data = few.mutable_value()->mutable_data<float>(
+      paddle::framework::make_ddim(
+          {static_cast<int64_t>(few_rows.size()), 1}),
+      cpu_place);
+  for (size_t r = 0; r < few_rows.size(); ++r) few_data[r] = r + 1;
+  paddle::framework::SelectedRows few_output;
+  merge_add_functor(ctx, few, &few_output);
+  std::vector<int64_t> few_expected_rows{kMin, -3, -1, 0, kLarge, kMax};
+  std::vector<float> few_expected{4, 2 + 5, 8, 3, 6, 1 + 7};
+  ASSERT_EQ(std::vector<int64_t>(few_output.rows().begin(),
+                                 few_output.rows().end()),
+            few_expected_rows);
+  for (size_t r = 0; r < few_expected.size(); ++r) {
+    EXPECT_EQ(few_output.value().data<float>()[r], few_expected[r]);
+  }
+}
+
 TEST(selected_rows_functor, cpu_sum_to) {
   paddle::platform::CPUPlace cpu_place;
   paddle::platform::CPUDeviceContext ctx(cpu_place);
@@ -14,6 +14,8 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/math/sequence2batch.h"
 
+#include <list>
+
 namespace paddle {
 namespace platform {
 class CPUDeviceContext;
@@ -24,6 +26,93 @@ namespace paddle {
 namespace operators {
 namespace math {
 
+// The number of the batch LoDs cached by each thread.
+static constexpr size_t kBatchLoDCacheSize = 16;
+
+// Calculate the length of each sequence and sort the sequences by the length,
+// then calculate the start position of each batch.
+// example:  sequences = {s0, s1, s2}
+//           s0: 0 0 0 0, s1: 1 1 1 1 1, s2: 2 2 2
+//           max_seqlen = 5,
+//           batchIndex = {b0, b1, b2, b3, b4}
+//           b0: 1 0 2, b1: 1 0 2, b2: 1 0 2, b3: 1 0, b4: 1
+//           batch_start_positions[6] = {0, 3, 6, 9, 11, 12}
+//              batch_start_positions[0] = len(b0)
+//              batch_start_positions[1] = len(b0) + len(b1)
+//              batch_start_positions[2] = len(b0) + len(b1) + len(b2)
+//              ...
+//           seq2batch_idx[12] = {4, 0, 9,
+//                                5, 1, 10,
+//                                6, 2, 11,
+//                                7, 3,
+//                                8}
+//           seq_order = {1, 0, 2}, the sort order.
+//               where 1 is the second sequence,
+//                     0 is the first sequence,
+//                     2 is the third sequence.
+// The max_seqlen represents batch size after rearranging the
+// input LodTensor. It is also the maximum length of input sequence.
+static framework::LoD CalcBatchLoD(const framework::Vector<size_t>& lod,
+                                   bool is_reverse) {
+  size_t seq_num = lod.size() - 1;
+  std::vector<size_t> seq_order(seq_num);
+  for (size_t i = 0; i < seq_num; ++i) seq_order[i] = i;
+  std::stable_sort(seq_order.begin(), seq_order.end(),
+                   [&lod](size_t a, size_t b) {
+                     return lod[a + 1] - lod[a] > lod[b + 1] - lod[b];
+                   });
+
+  framework::LoD batch_lods(3);
+  // batch_lods[0] is the start positions for batch LoDTensor
+  size_t max_seqlen = lod[seq_order[0] + 1] - lod[seq_order[0]];
+  batch_lods[0].resize(max_seqlen + 1);
+  // batch_lods[1] is the raw index in the input LoDTensor
+  batch_lods[1].resize(lod[seq_num]);
+  // batch_lods[2] is the sort order for the input LoDTensor.
+  batch_lods[2].resize(seq_num);
+
+  size_t* batch_starts = batch_lods[0].data();
+  size_t* seq2batch_idx = batch_lods[1].data();
+  batch_starts[0] = 0;
+  for (size_t n = 0; n < max_seqlen; n++) {
+    size_t batch_id = batch_starts[n];
+    for (size_t i = 0; i < seq_num; ++i) {
+      size_t start = lod[seq_order[i]];
+      size_t seq_len = lod[seq_order[i] + 1] - start;
+      if (n >= seq_len) break;
+      seq2batch_idx[batch_id++] =
+          is_reverse ? start + seq_len - 1 - n : start + n;
+    }
+    batch_starts[n + 1] = batch_id;
+  }
+  std::copy(seq_order.begin(), seq_order.end(), batch_lods[2].data());
+  return batch_lods;
+}
+
+std::shared_ptr<const framework::LoD> GetBatchLoD(
+    const framework::Vector<size_t>& lod, bool is_reverse) {
+  struct Entry {
+    bool is_reverse;
+    std::vector<size_t> lod;
+    std::shared_ptr<const framework::LoD> batch_lod;
+  };
+  // The most recently used are in the front.
+  thread_local std::list<Entry> cache;
+  for (auto it = cache.begin(); it != cache.end(); ++it) {
+    if (it->is_reverse == is_reverse && it->lod.size() == lod.size() &&
+        std::equal(it->lod.begin(), it->lod.end(), lod.begin())) {
+      cache.splice(cache.begin(), cache, it);
+      return it->batch_lod;
+    }
+  }
+  auto batch_lod =
+      std::make_shared<const framework::LoD>(CalcBatchLoD(lod, is_reverse));
+  cache.push_front(
+      Entry{is_reverse, std::vector<size_t>(lod.begin(), lod.end()), batch_lod});
+  if (cache.size() > kBatchLoDCacheSize) cache.pop_back();
+  return batch_lod;
+}
+
 template <typename T>
 class CopyMatrixRowsFunctor<platform::CPUDeviceContext, T> {
  public:
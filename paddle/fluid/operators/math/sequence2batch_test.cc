@@ -0,0 +1,67 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/sequence2batch.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+static std::vector<size_t> ToVector(const framework::Vector<size_t>& v) {
+  return std::vector<size_t>(v.begin(), v.end());
+}
+
+TEST(GetBatchLoD, example) {
+  // s0: 0 0 0 0, s1: 1 1 1 1 1, s2: 2 2 2
+  framework::Vector<size_t> lod({0, 4, 9, 12});
+  auto batch_lod = GetBatchLoD(lod, false);
+  ASSERT_EQ(batch_lod->size(), 3UL);
+  EXPECT_EQ(ToVector((*batch_lod)[0]),
+            std::vector<size_t>({0, 3, 6, 9, 11, 12}));
+  EXPECT_EQ(ToVector((*batch_lod)[1]),
+            std::vector<size_t>({4, 0, 9, 5, 1, 10, 6, 2, 11, 7, 3, 8}));
+  EXPECT_EQ(ToVector((*batch_lod)[2]), std::vector<size_t>({1, 0, 2}));
+
+  auto reverse_lod = GetBatchLoD(lod, true);
+  EXPECT_EQ(ToVector((*reverse_lod)[0]), ToVector((*batch_lod)[0]));
+  EXPECT_EQ(ToVector((*reverse_lod)[1]),
+            std::vector<size_t>({8, 3, 11, 7, 2, 10, 6, 1, 9, 5, 0, 4}));
+}
+
+TEST(GetBatchLoD, cache) {
+  framework::Vector<size_t> lod({0, 2, 3, 7});
+  auto batch_lod = GetBatchLoD(lod, false);
+  // The same LoD hits the cache, and the other LoDs do not evict it until
+  // the cache is full.
+  for (size_t n = 1; n < 8; ++n) {
+    GetBatchLoD(framework::Vector<size_t>({0, n}), false);
+  }
+  EXPECT_EQ(GetBatchLoD(framework::Vector<size_t>({0, 2, 3, 7}), false),
+            batch_lod);
+  EXPECT_NE(GetBatchLoD(lod, true), batch_lod);
+  for (size_t n = 1; n < 64; ++n) {
+    GetBatchLoD(framework::Vector<size_t>({0, n}), false);
+  }
+  auto evicted = GetBatchLoD(lod, false);
+  EXPECT_NE(evicted, batch_lod);
+  EXPECT_EQ(ToVector((*evicted)[1]), ToVector((*batch_lod)[1]));
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,551 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "paddle/fluid/framework/ddim.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+
+// The CPU reduce engine. The adjacent dims of input with the same kind
+// (reduced or kept) are merged, and the dims of size 1 are dropped, e.g.
+// reducing dims [1, 2] of [8, 16, 32, 64] is computed as reducing dim 1 of
+// [8, 512, 64]. Then:
+//
+//  * If the innermost merged dim is reduced, each output element is reduced
+//    from the contiguous rows of input (row-wise).
+//  * Otherwise each row of output is accumulated from the rows of input
+//    element by element (column-wise).
+//
+// Both are vectorizable. The elements which are reduced into one output are
+// combined in a fixed pairwise tree, the subtrees of which are computed in
+// parallel when there are not enough outputs, so the results do not depend
+// on the number of threads.
+
+// The reducers of the engine, see CPUReduceTraits.
+template <typename T>
+struct CPUSumReducer {
+  static T Identity() { return static_cast<T>(0); }
+  static T Combine(T a, T b) { return a + b; }
+  static T Finalize(T v, int64_t reduce_num) { return v; }
+};
+
+template <typename T>
+struct CPUMeanReducer : public CPUSumReducer<T> {
+  static T Finalize(T v, int64_t reduce_num) {
+    return v / static_cast<T>(reduce_num);
+  }
+};
+
+template <typename T>
+struct CPUMaxReducer {
+  static T Identity() { return std::numeric_limits<T>::lowest(); }
+  static T Combine(T a, T b) { return a > b ? a : b; }
+  static T Finalize(T v, int64_t reduce_num) { return v; }
+};
+
+template <typename T>
+struct CPUMinReducer {
+  static T Identity() { return std::numeric_limits<T>::max(); }
+  static T Combine(T a, T b) { return a < b ? a : b; }
+  static T Finalize(T v, int64_t reduce_num) { return v; }
+};
+
+template <typename T>
+struct CPUProdReducer {
+  static T Identity() { return static_cast<T>(1); }
+  static T Combine(T a, T b) { return a * b; }
+  static T Finalize(T v, int64_t reduce_num) { return v; }
+};
+
+// The gradients of the engine, dx = op(x, out, dout) where out and dout are
+// broadcast to the shape of x.
+template <typename T>
+struct CPUSumGrad {
+  explicit CPUSumGrad(int64_t reduce_num) {}
+  T operator()(T x, T out, T dout) const { return dout; }
+};
+
+template <typename T>
+struct CPUMeanGrad {
+  explicit CPUMeanGrad(int64_t reduce_num)
+      : scale_(static_cast<T>(1) / static_cast<T>(reduce_num)) {}
+  T operator()(T x, T out, T dout) const { return dout * scale_; }
+
+ private:
+  T scale_;
+};
+
+template <typename T>
+struct CPUMaxOrMinGrad {
+  explicit CPUMaxOrMinGrad(int64_t reduce_num) {}
+  // Pass the gradient to all of the maximum or minimum elements, the same as
+  // MaxOrMinGradFunctor.
+  T operator()(T x, T out, T dout) const {
+    return x == out ? dout : static_cast<T>(0);
+  }
+};
+
+template <typename T>
+struct CPUProdGrad {
+  explicit CPUProdGrad(int64_t reduce_num) {}
+  T operator()(T x, T out, T dout) const { return dout * out / x; }
+};
+
+// The functors of the reduce ops, such as SumFunctor and SumGradFunctor,
+// specialize this to be computed by the engine on CPU, e.g.
+//
+//   template <>
+//   struct CPUReduceTraits<SumFunctor> {
+//     template <typename T>
+//     using Type = CPUSumReducer<T>;
+//   };
+template <typename Functor>
+struct CPUReduceTraits {};
+
+template <typename Functor, typename = void>
+struct HasCPUReduce : std::false_type {};
+
+template <typename Functor>
+struct HasCPUReduce<
+    Functor, decltype(std::declval<typename CPUReduceTraits<
+                          Functor>::template Type<float>>(),
+                      void())> : std::true_type {};
+
+struct CPUReducePlan {
+  // dims is [x_dims[0], ..., x_dims[rank - 1]] and reduce_dims is the dims to
+  // be reduced, which can be negative. All the dims are reduced if
+  // reduce_all is true.
+  CPUReducePlan(const framework::DDim& x_dims,
+                const std::vector<int>& reduce_dims, bool reduce_all) {
+    int rank = x_dims.size();
+    std::vector<bool> is_reduced(rank, reduce_all);
+    for (int d : reduce_dims) {
+      if (d < 0) d += rank;
+      PADDLE_ENFORCE_EQ(
+          d >= 0 && d < rank, true,
+          platform::errors::InvalidArgument(
+              "The reduced dim should be in [-%d, %d), but got %d.", rank,
+              rank, d));
+      is_reduced[d] = true;
+    }
+    numel = 1;
+    for (int i = 0; i < rank; ++i) {
+      int64_t size = x_dims[i];
+      numel *= size;
+      if (size == 1) continue;
+      if (!dims.empty() && reduced.back() == is_reduced[i]) {
+        dims.back() *= size;
+      } else {
+        dims.push_back(size);
+        reduced.push_back(is_reduced[i]);
+      }
+    }
+    if (dims.empty()) {
+      dims.push_back(1);
+      reduced.push_back(true);
+    }
+    out_numel = 1;
+    for (size_t i = 0; i < dims.size(); ++i) {
+      if (!reduced[i]) out_numel *= dims[i];
+    }
+    reduce_num = out_numel > 0 ? numel / out_numel : 0;
+
+    // The strides of the outer dims, the innermost dim is contiguous.
+    int outer = static_cast<int>(dims.size()) - 1;
+    int64_t x_stride = dims.back();
+    int64_t out_stride = reduced.back() ? 1 : dims.back();
+    outer_x_strides.resize(outer);
+    outer_out_strides.resize(outer);
+    for (int i = outer - 1; i >= 0; --i) {
+      outer_x_strides[i] = x_stride;
+      x_stride *= dims[i];
+      if (reduced[i]) {
+        outer_out_strides[i] = 0;
+        reduced_outer_dims.push_back(dims[i]);
+        reduced_outer_strides.push_back(outer_x_strides[i]);
+      } else {
+        outer_out_strides[i] = out_stride;
+        out_stride *= dims[i];
+        kept_outer_dims.push_back(dims[i]);
+        kept_outer_strides.push_back(outer_x_strides[i]);
+      }
+    }
+    // The above are collected from the inner to the outer, and are decomposed
+    // in the same order.
+    inner = dims.back();
+    inner_reduced = reduced.back();
+  }
+
+  // The offset in x of the index of the kept or reduced outer dims.
+  static int64_t Offset(const std::vector<int64_t>& sizes,
+                        const std::vector<int64_t>& strides, int64_t index) {
+    int64_t offset = 0;
+    for (size_t i = 0; i < sizes.size() && index > 0; ++i) {
+      offset += (index % sizes[i]) * strides[i];
+      index /= sizes[i];
+    }
+    return offset;
+  }
+
+  int64_t KeptOffset(int64_t index) const {
+    return Offset(kept_outer_dims, kept_outer_strides, index);
+  }
+
+  int64_t ReducedOffset(int64_t index) const {
+    return Offset(reduced_outer_dims, reduced_outer_strides, index);
+  }
+
+  int64_t KeptOuterNum() const {
+    return out_numel / (inner_reduced ? 1 : inner);
+  }
+
+  int64_t ReducedOuterNum() const {
+    return reduce_num / (inner_reduced ? inner : 1);
+  }
+
+  std::vector<int64_t> dims;
+  std::vector<bool> reduced;
+  std::vector<int64_t> outer_x_strides;
+  std::vector<int64_t> outer_out_strides;
+  std::vector<int64_t> kept_outer_dims;
+  std::vector<int64_t> kept_outer_strides;
+  std::vector<int64_t> reduced_outer_dims;
+  std::vector<int64_t> reduced_outer_strides;
+  int64_t inner;
+  bool inner_reduced;
+  int64_t numel;
+  int64_t out_numel;
+  int64_t reduce_num;
+};
+
+// The number of lanes of the row-wise reduction, which is enough for the
+// compiler to vectorize with AVX-512.
+constexpr int kCPUReduceLanes = 16;
+// The leaves of the pairwise tree, in elements for row-wise and in rows for
+// column-wise.
+constexpr int64_t kCPUReduceRowLeaf = 512;
+constexpr int64_t kCPUReduceColumnLeaf = 16;
+// The columns of output computed by one task of the column-wise reduction.
+constexpr int64_t kCPUReduceColumnBlock = 1024;
+// Split the pairwise tree into subtrees when there are less tasks than this,
+// and each subtree reduces no less than kCPUReduceMinSubtreeNumel elements.
+constexpr int64_t kCPUReduceMinTasks = 64;
+constexpr int64_t kCPUReduceMinSubtreeNumel = 1 << 15;
+constexpr int64_t kCPUReduceParallelNumel = 1 << 15;
+
+// The pairwise tree over [begin, end): the node is a leaf if it is no larger
+// than leaf, otherwise it is split in the middle, rounded to leaf.
+inline int64_t CPUReduceTreeSplit(int64_t begin, int64_t end, int64_t leaf) {
+  int64_t half = ((end - begin) / 2 + leaf - 1) / leaf * leaf;
+  return begin + half;
+}
+
+// The depth of the pairwise tree over [0, n), that is
+// 1 + max(depth(left), depth(right)) of the split. Either child may be the
+// larger one, so the distinct sizes of each level, which are a few, are kept.
+inline int CPUReduceTreeDepth(int64_t n, int64_t leaf) {
+  int depth = 0;
+  std::vector<int64_t> sizes{n};
+  while (!sizes.empty()) {
+    std::vector<int64_t> children;
+    for (int64_t size : sizes) {
+      if (size <= leaf) continue;
+      int64_t mid = CPUReduceTreeSplit(0, size, leaf);
+      children.push_back(mid);
+      children.push_back(size - mid);
+    }
+    if (children.empty()) break;
+    std::sort(children.begin(), children.end());
+    children.erase(std::unique(children.begin(), children.end()),
+                   children.end());
+    sizes.swap(children);
+    ++depth;
+  }
+  return depth;
+}
+
+// Reduce [begin, end) into acc[0, width) with LeafFn(begin, end, acc) on the
+// leaves. scratch has width * CPUReduceTreeDepth elements.
+template <typename Reducer, typename T, typename LeafFn>
+void CPUReducePairwise(int64_t begin, int64_t end, int64_t leaf, int64_t width,
+                       const LeafFn& leaf_fn, T* acc, T* scratch) {
+  if (end - begin <= leaf) {
+    leaf_fn(begin, end, acc);
+    return;
+  }
+  int64_t mid = CPUReduceTreeSplit(begin, end, leaf);
+  CPUReducePairwise<Reducer>(begin, mid, leaf, width, leaf_fn, acc,
+                             scratch + width);
+  CPUReducePairwise<Reducer>(mid, end, leaf, width, leaf_fn, scratch,
+                             scratch + width);
+  for (int64_t i = 0; i < width; ++i) {
+    acc[i] = Reducer::Combine(acc[i], scratch[i]);
+  }
+}
+
+// The nodes of depth max_depth, or the leaves above it, from left to right.
+inline void CPUReduceTreeNodes(
+    int64_t begin, int64_t end, int64_t leaf, int max_depth,
+    std::vector<std::pair<int64_t, int64_t>>* nodes) {
+  if (max_depth == 0 || end - begin <= leaf) {
+    nodes->emplace_back(begin, end);
+    return;
+  }
+  int64_t mid = CPUReduceTreeSplit(begin, end, leaf);
+  CPUReduceTreeNodes(begin, mid, leaf, max_depth - 1, nodes);
+  CPUReduceTreeNodes(mid, end, leaf, max_depth - 1, nodes);
+}
+
+// Combine the results of the nodes collected by CPUReduceTreeNodes in the
+// same tree, so that it is the same as CPUReducePairwise.
+template <typename Reducer, typename T>
+void CPUReduceCombineNodes(int64_t begin, int64_t end, int64_t leaf,
+                           int max_depth, int64_t width, const T* results,
+                           size_t* next, T* acc, T* scratch) {
+  if (max_depth == 0 || end - begin <= leaf) {
+    std::copy(results + (*next) * width, results + (*next + 1) * width, acc);
+    ++(*next);
+    return;
+  }
+  int64_t mid = CPUReduceTreeSplit(begin, end, leaf);
+  CPUReduceCombineNodes<Reducer>(begin, mid, leaf, max_depth - 1, width,
+                                 results, next, acc, scratch + width);
+  CPUReduceCombineNodes<Reducer>(mid, end, leaf, max_depth - 1, width, results,
+                                 next, scratch, scratch + width);
+  for (int64_t i = 0; i < width; ++i) {
+    acc[i] = Reducer::Combine(acc[i], scratch[i]);
+  }
+}
+
+// Reduce the contiguous x[0, n) into the lanes.
+template <typename Reducer, typename T>
+inline void CPUReduceContiguous(const T* x, int64_t n, T* lanes) {
+  int64_t i = 0;
+  for (; i + kCPUReduceLanes <= n; i += kCPUReduceLanes) {
+    for (int l = 0; l < kCPUReduceLanes; ++l) {
+      lanes[l] = Reducer::Combine(lanes[l], x[i + l]);
+    }
+  }
+  for (int l = 0; i < n; ++i, ++l) {
+    lanes[l] = Reducer::Combine(lanes[l], x[i]);
+  }
+}
+
+template <typename Reducer, typename T>
+inline T CPUReduceLanes(T* lanes) {
+  for (int width = kCPUReduceLanes / 2; width > 0; width /= 2) {
+    for (int l = 0; l < width; ++l) {
+      lanes[l] = Reducer::Combine(lanes[l], lanes[l + width]);
+    }
+  }
+  return lanes[0];
+}
+
+// Run task_fn(task, node, acc) for each of the tasks, the reduce range of
+// which is [0, range), and store the results of width in out.
+template <typename Reducer, typename T, typename NodeFn, typename StoreFn>
+void CPUReduceTasks(int64_t tasks, int64_t range, int64_t leaf, int64_t width,
+                    int64_t numel_per_task, const NodeFn& node_fn,
+                    const StoreFn& store_fn) {
+  int max_depth = 0;
+  int64_t nodes_num = 1;
+  while (tasks * nodes_num < kCPUReduceMinTasks &&
+         numel_per_task / (nodes_num * 2) >= kCPUReduceMinSubtreeNumel &&
+         max_depth < CPUReduceTreeDepth(range, leaf)) {
+    ++max_depth;
+    nodes_num *= 2;
+  }
+  int scratch_depth = CPUReduceTreeDepth(range, leaf) + 1;
+
+  if (max_depth == 0) {
+    // The tasks are grouped to share the scratch.
+    int64_t group_size = std::max<int64_t>(
+        std::min(kCPUReduceMinSubtreeNumel /
+                     std::max<int64_t>(numel_per_task, 1),
+                 tasks / kCPUReduceMinTasks),
+        1);
+    int64_t groups = (tasks + group_size - 1) / group_size;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (tasks * numel_per_task > kCPUReduceParallelNumel)
+#endif
+    for (int64_t group = 0; group < groups; ++group) {
+      std::vector<T> buffer(width * scratch_depth);
+      int64_t task_end = std::min(tasks, (group + 1) * group_size);
+      for (int64_t task = group * group_size; task < task_end; ++task) {
+        CPUReducePairwise<Reducer>(
+            0, range, leaf, width,
+            [&](int64_t begin, int64_t end, T* acc) {
+              node_fn(task, begin, end, acc);
+            },
+            buffer.data(), buffer.data() + width);
+        store_fn(task, buffer.data());
+      }
+    }
+    return;
+  }
+
+  // Not enough tasks, compute the subtrees in parallel and combine them.
+  std::vector<std::pair<int64_t, int64_t>> nodes;
+  CPUReduceTreeNodes(0, range, leaf, max_depth, &nodes);
+  int64_t nodes_size = static_cast<int64_t>(nodes.size());
+  std::vector<T> results(tasks * nodes_size * width);
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int64_t i = 0; i < tasks * nodes_size; ++i) {
+    int64_t task = i / nodes_size;
+    const auto& node = nodes[i % nodes_size];
+    std::vector<T> buffer(width * scratch_depth);
+    CPUReducePairwise<Reducer>(
+        node.first, node.second, leaf, width,
+        [&](int64_t begin, int64_t end, T* acc) {
+          node_fn(task, begin, end, acc);
+        },
+        results.data() + i * width, buffer.data());
+  }
+  for (int64_t task = 0; task < tasks; ++task) {
+    std::vector<T> buffer(width * (max_depth + 1));
+    size_t next = 0;
+    CPUReduceCombineNodes<Reducer>(
+        0, range, leaf, max_depth, width,
+        results.data() + task * nodes_size * width, &next, buffer.data(),
+        buffer.data() + width);
+    store_fn(task, buffer.data());
+  }
+}
+
+template <typename Reducer, typename T>
+void CPUReduceRowWise(const CPUReducePlan& plan, const T* x, T* out) {
+  // Each output is reduced from the rows of reduced outer dims, and the
+  // positions in the rows are flattened to [0, range).
+  int64_t row = plan.inner;
+  int64_t range = plan.ReducedOuterNum() * row;
+  CPUReduceTasks<Reducer, T>(
+      plan.out_numel, range, kCPUReduceRowLeaf, 1, plan.reduce_num,
+      [&](int64_t task, int64_t begin, int64_t end, T* acc) {
+        const T* x_task = x + plan.KeptOffset(task);
+        T lanes[kCPUReduceLanes];
+        std::fill(lanes, lanes + kCPUReduceLanes, Reducer::Identity());
+        int64_t r = begin / row;
+        int64_t col = begin % row;
+        for (int64_t pos = begin; pos < end; ++r, col = 0) {
+          int64_t n = std::min(row - col, end - pos);
+          CPUReduceContiguous<Reducer>(x_task + plan.ReducedOffset(r) + col, n,
+                                       lanes);
+          pos += n;
+        }
+        *acc = CPUReduceLanes<Reducer>(lanes);
+      },
+      [&](int64_t task, const T* acc) {
+        out[task] = Reducer::Finalize(*acc, plan.reduce_num);
+      });
+}
+
+template <typename Reducer, typename T>
+void CPUReduceColumnWise(const CPUReducePlan& plan, const T* x, T* out) {
+  // Each block of output rows is accumulated from the rows of reduced outer
+  // dims.
+  int64_t row = plan.inner;
+  int64_t blocks = (row + kCPUReduceColumnBlock - 1) / kCPUReduceColumnBlock;
+  int64_t width = std::min(row, kCPUReduceColumnBlock);
+  int64_t range = plan.ReducedOuterNum();
+  CPUReduceTasks<Reducer, T>(
+      plan.KeptOuterNum() * blocks, range, kCPUReduceColumnLeaf, width,
+      range * width,
+      [&](int64_t task, int64_t begin, int64_t end, T* acc) {
+        int64_t col = (task % blocks) * kCPUReduceColumnBlock;
+        int64_t n = std::min(width, row - col);
+        const T* x_task = x + plan.KeptOffset(task / blocks) + col;
+        const T* x_row = x_task + plan.ReducedOffset(begin);
+        std::copy(x_row, x_row + n, acc);
+        for (int64_t r = begin + 1; r < end; ++r) {
+          x_row = x_task + plan.ReducedOffset(r);
+          for (int64_t i = 0; i < n; ++i) {
+            acc[i] = Reducer::Combine(acc[i], x_row[i]);
+          }
+        }
+        std::fill(acc + n, acc + width, Reducer::Identity());
+      },
+      [&](int64_t task, const T* acc) {
+        int64_t col = (task % blocks) * kCPUReduceColumnBlock;
+        int64_t n = std::min(width, row - col);
+        T* out_task = out + (task / blocks) * row + col;
+        for (int64_t i = 0; i < n; ++i) {
+          out_task[i] = Reducer::Finalize(acc[i], plan.reduce_num);
+        }
+      });
+}
+
+// Reduce x into out, which has the kept dims of x in the same order.
+template <typename Reducer, typename T>
+void CPUReduce(const CPUReducePlan& plan, const T* x, T* out) {
+  if (plan.out_numel == 0) {
+    return;
+  }
+  if (plan.reduce_num == 0) {
+    std::fill(out, out + plan.out_numel, Reducer::Identity());
+  } else if (plan.inner_reduced) {
+    CPUReduceRowWise<Reducer>(plan, x, out);
+  } else {
+    CPUReduceColumnWise<Reducer>(plan, x, out);
+  }
+}
+
+// dx = grad(x, out, dout), where out and dout are broadcast along the reduced
+// dims.
+template <typename T, typename Grad>
+void CPUReduceGrad(const CPUReducePlan& plan, const T* x, const T* out,
+                   const T* dout, T* dx, const Grad& grad) {
+  int64_t row = plan.inner;
+  int64_t rows = plan.numel / std::max<int64_t>(row, 1);
+  int outer = static_cast<int>(plan.dims.size()) - 1;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for if (plan.numel > kCPUReduceParallelNumel)
+#endif
+  for (int64_t r = 0; r < rows; ++r) {
+    int64_t out_offset = 0;
+    int64_t index = r;
+    for (int i = outer - 1; i >= 0 && index > 0; --i) {
+      out_offset += (index % plan.dims[i]) * plan.outer_out_strides[i];
+      index /= plan.dims[i];
+    }
+    const T* x_row = x + r * row;
+    T* dx_row = dx + r * row;
+    if (plan.inner_reduced) {
+      T out_value = out[out_offset];
+      T dout_value = dout[out_offset];
+      for (int64_t i = 0; i < row; ++i) {
+        dx_row[i] = grad(x_row[i], out_value, dout_value);
+      }
+    } else {
+      const T* out_row = out + out_offset;
+      const T* dout_row = dout + out_offset;
+      for (int64_t i = 0; i < row; ++i) {
+        dx_row[i] = grad(x_row[i], out_row[i], dout_row[i]);
+      }
+    }
+  }
+}
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,150 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/reduce_ops/cpu_reduce.h"
+
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+
+// Reduce x of shape by the element by element reference, and compare it with
+// the engine. The gradient of max is checked too, which reads all of x, out
+// and dout.
+template <typename Reducer>
+static void TestReduce(const std::vector<int64_t>& shape,
+                       const std::vector<int>& reduce_dims,
+                       bool reduce_all = false) {
+  int rank = static_cast<int>(shape.size());
+  std::vector<bool> is_reduced(rank, reduce_all);
+  for (int d : reduce_dims) {
+    is_reduced[d < 0 ? d + rank : d] = true;
+  }
+  int64_t numel = 1, out_numel = 1;
+  for (int i = 0; i < rank; ++i) {
+    numel *= shape[i];
+    out_numel *= is_reduced[i] ? 1 : shape[i];
+  }
+  // Small integers, so that the sums are exact in any order.
+  std::mt19937 engine(rank);
+  std::uniform_int_distribution<int> dist(1, 4);
+  std::vector<double> x(numel), dout(out_numel);
+  for (auto& v : x) v = dist(engine);
+  for (auto& v : dout) v = dist(engine);
+
+  std::vector<int64_t> out_index(numel);
+  std::vector<int64_t> index(rank, 0);
+  std::vector<double> ref(out_numel, Reducer::Identity());
+  for (int64_t i = 0; i < numel; ++i) {
+    int64_t o = 0;
+    for (int d = 0; d < rank; ++d) {
+      if (!is_reduced[d]) o = o * shape[d] + index[d];
+    }
+    out_index[i] = o;
+    ref[o] = Reducer::Combine(ref[o], x[i]);
+    for (int d = rank - 1; d >= 0 && ++index[d] == shape[d]; --d) {
+      index[d] = 0;
+    }
+  }
+
+  CPUReducePlan plan(framework::make_ddim(shape), reduce_dims, reduce_all);
+  ASSERT_EQ(plan.out_numel, out_numel);
+  std::vector<double> out(out_numel);
+  CPUReduce<Reducer>(plan, x.data(), out.data());
+  for (int64_t o = 0; o < out_numel; ++o) {
+    ASSERT_EQ(out[o], Reducer::Finalize(ref[o], plan.reduce_num));
+  }
+
+  std::vector<double> dx(numel);
+  CPUReduceGrad(plan, x.data(), out.data(), dout.data(), dx.data(),
+                CPUMaxOrMinGrad<double>(plan.reduce_num));
+  for (int64_t i = 0; i < numel; ++i) {
+    double expected = x[i] == out[out_index[i]] ? dout[out_index[i]] : 0;
+    ASSERT_EQ(dx[i], expected);
+  }
+}
+
+TEST(CPUReduce, correctness) {
+  TestReduce<CPUSumReducer<double>>({2, 3, 4, 5}, {1});
+  TestReduce<CPUSumReducer<double>>({2, 3, 4, 5}, {-1});
+  TestReduce<CPUSumReducer<double>>({2, 3, 4, 5}, {0, 2});
+  TestReduce<CPUSumReducer<double>>({2, 3, 4, 5}, {1, 3});
+  TestReduce<CPUSumReducer<double>>({2, 3, 4, 5}, {}, true);
+  TestReduce<CPUSumReducer<double>>({2, 1, 4, 1}, {1});
+  TestReduce<CPUSumReducer<double>>({1, 1}, {0});
+  TestReduce<CPUMeanReducer<double>>({7, 3000}, {1});
+  TestReduce<CPUMeanReducer<double>>({3000, 7}, {0});
+  TestReduce<CPUMaxReducer<double>>({5, 2000, 3}, {0, 2});
+  TestReduce<CPUMinReducer<double>>({3, 5, 7, 11, 13, 2, 3}, {0, 2, 5});
+  TestReduce<CPUProdReducer<double>>({4, 3, 5}, {1});
+  // The pairwise tree is split into subtrees.
+  TestReduce<CPUSumReducer<double>>({1 << 22}, {0});
+  TestReduce<CPUSumReducer<double>>({1 << 17, 33}, {0});
+  // The right child of the split is the larger one.
+  TestReduce<CPUSumReducer<double>>({1025}, {0});
+  TestReduce<CPUSumReducer<double>>({33, 7}, {0});
+  TestReduce<CPUMaxReducer<double>>({33, 7}, {0});
+  TestReduce<CPUSumReducer<double>>({3, 1025}, {1});
+}
+
+TEST(CPUReduce, tree_depth) {
+  // The depth is the longest path of the splits, either child may be larger.
+  for (int64_t leaf : {kCPUReduceColumnLeaf, kCPUReduceRowLeaf}) {
+    std::function<int(int64_t)> depth = [&](int64_t n) {
+      if (n <= leaf) return 0;
+      int64_t mid = CPUReduceTreeSplit(0, n, leaf);
+      return 1 + std::max(depth(mid), depth(n - mid));
+    };
+    for (int64_t n = 1; n < 40 * leaf; ++n) {
+      ASSERT_EQ(CPUReduceTreeDepth(n, leaf), depth(n)) << n << " " << leaf;
+    }
+  }
+  EXPECT_EQ(CPUReduceTreeDepth(33, 16), 2);
+  EXPECT_EQ(CPUReduceTreeDepth(1025, 512), 2);
+}
+
+TEST(CPUReduce, pairwise) {
+  // The results of float do not depend on how the tree is split.
+  std::mt19937 engine(0);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<float> x(1 << 22);
+  for (auto& v : x) v = dist(engine);
+
+  CPUReducePlan plan(framework::make_ddim({1 << 22}), {0}, false);
+  float out = 0;
+  CPUReduce<CPUSumReducer<float>>(plan, x.data(), &out);
+  std::vector<float> acc(1 << 5);
+  CPUReducePairwise<CPUSumReducer<float>>(
+      0, static_cast<int64_t>(x.size()), kCPUReduceRowLeaf, 1,
+      [&](int64_t begin, int64_t end, float* result) {
+        float lanes[kCPUReduceLanes];
+        std::fill(lanes, lanes + kCPUReduceLanes, 0.0f);
+        CPUReduceContiguous<CPUSumReducer<float>>(x.data() + begin,
+                                                  end - begin, lanes);
+        *result = CPUReduceLanes<CPUSumReducer<float>>(lanes);
+      },
+      acc.data(), acc.data() + 1);
+  EXPECT_EQ(out, acc[0]);
+
+  double exact = 0;
+  for (float v : x) exact += v;
+  EXPECT_NEAR(out, exact, 1e-3);
+}
+
+}  // namespace operators
+}  // namespace paddle
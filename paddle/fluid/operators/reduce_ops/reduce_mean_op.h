@@ -35,5 +35,17 @@ struct MeanGradFunctor {
   }
 };
 
+template <>
+struct CPUReduceTraits<MeanFunctor> {
+  template <typename T>
+  using Type = CPUMeanReducer<T>;
+};
+
+template <>
+struct CPUReduceTraits<MeanGradFunctor> {
+  template <typename T>
+  using Type = CPUMeanGrad<T>;
+};
+
 }  // namespace operators
 }  // namespace paddle
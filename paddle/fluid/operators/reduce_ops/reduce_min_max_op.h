@@ -46,5 +46,23 @@ struct MaxOrMinGradFunctor {
   }
 };
 
+template <>
+struct CPUReduceTraits<MaxFunctor> {
+  template <typename T>
+  using Type = CPUMaxReducer<T>;
+};
+
+template <>
+struct CPUReduceTraits<MinFunctor> {
+  template <typename T>
+  using Type = CPUMinReducer<T>;
+};
+
+template <>
+struct CPUReduceTraits<MaxOrMinGradFunctor> {
+  template <typename T>
+  using Type = CPUMaxOrMinGrad<T>;
+};
+
 }  // namespace operators
 }  // namespace paddle
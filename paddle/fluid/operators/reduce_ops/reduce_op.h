@@ -17,11 +17,13 @@ limitations under the License. */
 #include <algorithm>
 #include <set>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include "paddle/fluid/framework/data_type_transform.h"
 #include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/operators/cast_op.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/reduce_ops/cpu_reduce.h"
 #include "paddle/fluid/operators/reduce_ops/reduce_op_function.h"
 
 namespace paddle {
@@ -140,6 +142,62 @@ void HandleLargeDimGrad(const framework::ExecutionContext& context,
         origin_axis);
 }
 
+// The reduce and reduce grad functors which are computed by the CPU reduce
+// engine, see cpu_reduce.h.
+template <typename DeviceContext, typename T, typename Functor>
+struct UseCPUReduce {
+  static constexpr bool value =
+      std::is_same<DeviceContext, platform::CPUDeviceContext>::value &&
+      HasCPUReduce<Functor>::value && std::is_arithmetic<T>::value &&
+      !std::is_same<T, bool>::value;
+};
+
+template <typename DeviceContext, typename T, typename Functor>
+struct UseCPUReduceGrad {
+  static constexpr bool value =
+      std::is_same<DeviceContext, platform::CPUDeviceContext>::value &&
+      HasCPUReduce<Functor>::value;
+};
+
+template <typename DeviceContext, typename T, typename Functor>
+typename std::enable_if<UseCPUReduce<DeviceContext, T, Functor>::value,
+                        bool>::type
+TryCPUReduce(const Tensor& input, const std::vector<int>& dims,
+             bool reduce_all, Tensor* output) {
+  CPUReducePlan plan(input.dims(), dims, reduce_all);
+  CPUReduce<typename CPUReduceTraits<Functor>::template Type<T>>(
+      plan, input.data<T>(), output->data<T>());
+  return true;
+}
+
+template <typename DeviceContext, typename T, typename Functor>
+typename std::enable_if<!UseCPUReduce<DeviceContext, T, Functor>::value,
+                        bool>::type
+TryCPUReduce(const Tensor& input, const std::vector<int>& dims,
+             bool reduce_all, Tensor* output) {
+  return false;
+}
+
+template <typename DeviceContext, typename T, typename Functor>
+typename std::enable_if<UseCPUReduceGrad<DeviceContext, T, Functor>::value,
+                        bool>::type
+TryCPUReduceGrad(const Tensor& x, const Tensor& out, const Tensor& dout,
+                 const std::vector<int>& dims, bool reduce_all, Tensor* dx) {
+  CPUReducePlan plan(x.dims(), dims, reduce_all);
+  typename CPUReduceTraits<Functor>::template Type<T> grad(plan.reduce_num);
+  CPUReduceGrad(plan, x.data<T>(), out.data<T>(), dout.data<T>(),
+                dx->data<T>(), grad);
+  return true;
+}
+
+template <typename DeviceContext, typename T, typename Functor>
+typename std::enable_if<!UseCPUReduceGrad<DeviceContext, T, Functor>::value,
+                        bool>::type
+TryCPUReduceGrad(const Tensor& x, const Tensor& out, const Tensor& dout,
+                 const std::vector<int>& dims, bool reduce_all, Tensor* dx) {
+  return false;
+}
+
 template <typename DeviceContext, typename T, typename Functor>
 struct ReduceKernelFunctor {
   const Tensor* input;
@@ -162,6 +220,10 @@ struct ReduceKernelFunctor {
   template <typename OutT>
   void apply() const {
     output->mutable_data<OutT>(context.GetPlace());
+    if (TryCPUReduce<DeviceContext, OutT, Functor>(*input, dims, reduce_all,
+                                                   output)) {
+      return;
+    }
     if (reduce_all) {
       // Flatten and reduce 1-D tensor
       auto x = EigenVector<OutT>::Flatten(*input);
@@ -348,6 +410,10 @@ class ReduceGradKernel : public framework::OpKernel<T> {
     // not be set as Input in grad Maker, use Out_grad to replace here
     if (!input1) input1 = input2;
 
+    if (TryCPUReduceGrad<DeviceContext, T, Functor>(*input0, *input1, *input2,
+                                                    dims, reduce_all, output)) {
+      return;
+    }
     if (reduce_all) {
       auto x = EigenVector<T>::Flatten(*input0);
       auto x_reduce = EigenVector<T>::Flatten(*input1);
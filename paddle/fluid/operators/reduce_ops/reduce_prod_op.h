@@ -35,5 +35,17 @@ struct ProdGradFunctor {
   }
 };
 
+template <>
+struct CPUReduceTraits<ProdFunctor> {
+  template <typename T>
+  using Type = CPUProdReducer<T>;
+};
+
+template <>
+struct CPUReduceTraits<ProdGradFunctor> {
+  template <typename T>
+  using Type = CPUProdGrad<T>;
+};
+
 }  // namespace operators
 }  // namespace paddle
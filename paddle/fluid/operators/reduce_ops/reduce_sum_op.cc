@@ -125,8 +125,8 @@ REGISTER_OP_CPU_KERNEL(
 
 template <typename T>
 using CPUReduceSumGradKernel =
-    ops::ReduceSumGradKernel<paddle::platform::CPUDeviceContext, T,
-                             ops::SumGradFunctor, true>;
+    ops::ReduceGradKernel<paddle::platform::CPUDeviceContext, T,
+                          ops::SumGradFunctor, true>;
 
 REGISTER_OP_CPU_KERNEL(reduce_sum_grad, CPUReduceSumGradKernel<float>,
                        CPUReduceSumGradKernel<double>,
@@ -52,5 +52,16 @@ void SetNumThreads(int num_threads) {
 #endif
 }
 
+void SetNumThreadsLocal(int num_threads) {
+#if defined(PADDLE_WITH_MKLML) && !defined(PADDLE_USE_OPENBLAS)
+  int real_num_threads = num_threads > 1 ? num_threads : 1;
+  platform::dynload::MKL_Set_Num_Threads_Local(real_num_threads);
+  // The number of threads of OpenMP is an ICV of the calling thread.
+  omp_set_num_threads(real_num_threads);
+#else
+  SetNumThreads(num_threads);
+#endif
+}
+
 }  // namespace platform
 }  // namespace paddle
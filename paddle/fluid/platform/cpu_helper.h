@@ -22,5 +22,10 @@ namespace platform {
 //! Set the number of threads in use.
 void SetNumThreads(int num_threads);
 
+//! Set the number of threads in use by the calling thread only. The math
+//! libraries without a thread local setting (such as OPENBLAS) fall back to
+//! SetNumThreads.
+void SetNumThreadsLocal(int num_threads);
+
 }  // namespace platform
 }  // namespace paddle
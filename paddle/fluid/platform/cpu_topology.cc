@@ -0,0 +1,262 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/cpu_topology.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>  // NOLINT
+
+#include "glog/logging.h"
+
+namespace paddle {
+namespace platform {
+
+std::vector<int> ParseCpuList(const std::string& cpu_list) {
+  std::vector<int> cpus;
+  std::stringstream ss(cpu_list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    range.erase(std::remove_if(range.begin(), range.end(), ::isspace),
+                range.end());
+    if (range.empty()) continue;
+    auto dash = range.find('-');
+    int first = std::stoi(range.substr(0, dash));
+    int last = dash == std::string::npos ? first
+                                         : std::stoi(range.substr(dash + 1));
+    for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+static bool ReadLine(const std::string& path, std::string* line) {
+  std::ifstream fin(path);
+  return fin.good() && std::getline(fin, *line);
+}
+
+static std::vector<int> Intersect(const std::vector<int>& cpus,
+                                  const std::vector<int>& online) {
+  std::vector<int> result;
+  for (int cpu : cpus) {
+    if (std::binary_search(online.begin(), online.end(), cpu)) {
+      result.push_back(cpu);
+    }
+  }
+  return result;
+}
+
+// The CPUs this process may run on, which may be fewer than the online ones
+// under taskset, cgroup cpusets or a container. Empty if it is unknown.
+static std::vector<int> AllowedCpus() {
+  std::vector<int> cpus;
+#ifdef __linux__
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  if (sched_getaffinity(0, sizeof(cpu_set_t), &mask) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &mask)) cpus.push_back(cpu);
+    }
+  }
+#endif
+  return cpus;
+}
+
+int CpuTopology::NumaNodeOf(int cpu) const {
+  for (size_t node = 0; node < numa_nodes.size(); ++node) {
+    if (std::find(numa_nodes[node].begin(), numa_nodes[node].end(), cpu) !=
+        numa_nodes[node].end()) {
+      return static_cast<int>(node);
+    }
+  }
+  return -1;
+}
+
+CpuTopology CpuTopology::Load(const std::string& root) {
+  const std::string cpu_dir = root + "/devices/system/cpu/";
+  const std::string node_dir = root + "/devices/system/node/";
+  CpuTopology topology;
+  std::string line;
+  std::vector<int> online;
+  if (ReadLine(cpu_dir + "online", &line)) {
+    online = ParseCpuList(line);
+  } else {
+    int num_cpus = std::max(1u, std::thread::hardware_concurrency());
+    for (int cpu = 0; cpu < num_cpus; ++cpu) online.push_back(cpu);
+  }
+  std::sort(online.begin(), online.end());
+  if (root == "/sys") {
+    auto allowed = Intersect(AllowedCpus(), online);
+    if (!allowed.empty()) online = allowed;
+  }
+
+  if (ReadLine(node_dir + "online", &line)) {
+    for (int node : ParseCpuList(line)) {
+      std::string cpu_list;
+      if (!ReadLine(node_dir + "node" + std::to_string(node) + "/cpulist",
+                    &cpu_list)) {
+        continue;
+      }
+      // The nodes of memory only have no CPU.
+      auto cpus = Intersect(ParseCpuList(cpu_list), online);
+      if (!cpus.empty()) topology.numa_nodes.push_back(cpus);
+    }
+  }
+  if (topology.numa_nodes.empty()) topology.numa_nodes.push_back(online);
+
+  // The CPUs sharing an L3 cache by the cache of level 3 of each CPU.
+  std::map<std::string, std::vector<int>> l3_domains;
+  for (int cpu : online) {
+    std::string cache_dir = cpu_dir + "cpu" + std::to_string(cpu) + "/cache/";
+    for (int index = 0; index < 10; ++index) {
+      std::string index_dir = cache_dir + "index" + std::to_string(index) + "/";
+      std::string level, shared;
+      if (!ReadLine(index_dir + "level", &level)) break;
+      if (level == "3" && ReadLine(index_dir + "shared_cpu_list", &shared)) {
+        l3_domains[shared].push_back(cpu);
+        break;
+      }
+    }
+  }
+  for (auto& domain : l3_domains) topology.l3_domains.push_back(domain.second);
+  if (topology.l3_domains.empty()) topology.l3_domains = topology.numa_nodes;
+  std::sort(topology.l3_domains.begin(), topology.l3_domains.end());
+
+  VLOG(3) << "Found " << online.size() << " online CPUs in "
+          << topology.numa_nodes.size() << " NUMA nodes and "
+          << topology.l3_domains.size() << " L3 domains.";
+  return topology;
+}
+
+const CpuTopology& CpuTopology::Instance() {
+  static CpuTopology topology = Load("/sys");
+  return topology;
+}
+
+CpuSetAllocator::CpuSetAllocator(const CpuTopology& topology)
+    : topology_(topology) {
+  int max_cpu = 0;
+  for (auto& node : topology_.numa_nodes) {
+    std::vector<int> cpus;
+    // The CPUs of a node ordered by the L3 domains, so that a reservation
+    // takes the CPUs of one domain first.
+    for (auto& domain : topology_.l3_domains) {
+      for (int cpu : domain) {
+        if (std::find(node.begin(), node.end(), cpu) != node.end()) {
+          cpus.push_back(cpu);
+        }
+      }
+    }
+    for (int cpu : node) {
+      if (std::find(cpus.begin(), cpus.end(), cpu) == cpus.end()) {
+        cpus.push_back(cpu);
+      }
+      max_cpu = std::max(max_cpu, cpu);
+    }
+    node_cpus_.push_back(cpus);
+  }
+  use_count_.resize(max_cpu + 1, 0);
+}
+
+std::vector<int> CpuSetAllocator::Reserve(int num_cpus, int numa_node) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (num_cpus <= 0) return {};
+  auto load = [&](const std::vector<int>& cpus) {
+    int count = 0;
+    for (int cpu : cpus) count += use_count_[cpu];
+    return static_cast<double>(count) / cpus.size();
+  };
+  int node = -1;
+  if (numa_node >= 0 && numa_node < static_cast<int>(node_cpus_.size()) &&
+      static_cast<int>(node_cpus_[numa_node].size()) >= num_cpus) {
+    node = numa_node;
+  } else {
+    for (size_t i = 0; i < node_cpus_.size(); ++i) {
+      if (static_cast<int>(node_cpus_[i].size()) < num_cpus) continue;
+      if (node < 0 || load(node_cpus_[i]) < load(node_cpus_[node])) {
+        node = static_cast<int>(i);
+      }
+    }
+  }
+  std::vector<int> pool;
+  if (node >= 0) {
+    pool = node_cpus_[node];
+  } else {
+    // No node has enough CPUs, so the set spans the nodes.
+    for (auto& cpus : node_cpus_) {
+      pool.insert(pool.end(), cpus.begin(), cpus.end());
+    }
+  }
+  std::stable_sort(pool.begin(), pool.end(), [&](int a, int b) {
+    return use_count_[a] < use_count_[b];
+  });
+  pool.resize(std::min(pool.size(), static_cast<size_t>(num_cpus)));
+  for (int cpu : pool) ++use_count_[cpu];
+  std::sort(pool.begin(), pool.end());
+  return pool;
+}
+
+void CpuSetAllocator::Release(const std::vector<int>& cpus) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < static_cast<int>(use_count_.size()) &&
+        use_count_[cpu] > 0) {
+      --use_count_[cpu];
+    }
+  }
+}
+
+CpuSetAllocator& CpuSetAllocator::Instance() {
+  static CpuSetAllocator allocator(CpuTopology::Instance());
+  return allocator;
+}
+
+ScopedCpuBinding::ScopedCpuBinding(const std::vector<int>& cpus) {
+#ifdef __linux__
+  if (cpus.empty()) return;
+  auto old_mask = std::make_shared<cpu_set_t>();
+  if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                             old_mask.get()) != 0) {
+    return;
+  }
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &mask);
+  }
+  if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &mask) != 0) {
+    LOG(WARNING) << "Failed to bind the thread to the CPUs, it runs unbound.";
+    return;
+  }
+  old_mask_ = old_mask;
+#endif
+}
+
+ScopedCpuBinding::~ScopedCpuBinding() {
+#ifdef __linux__
+  if (old_mask_ != nullptr) {
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                           static_cast<cpu_set_t*>(old_mask_.get()));
+  }
+#endif
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,88 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace platform {
+
+//! Parse a cpu list of sysfs, such as "0-3,8,10-11".
+std::vector<int> ParseCpuList(const std::string& cpu_list);
+
+//! The NUMA nodes and the L3 cache domains of the online CPUs.
+struct CpuTopology {
+  //! The CPUs of each NUMA node, and of each group of CPUs sharing an L3
+  //! cache.
+  std::vector<std::vector<int>> numa_nodes;
+  std::vector<std::vector<int>> l3_domains;
+
+  //! The NUMA node of cpu, or -1 if cpu is not online.
+  int NumaNodeOf(int cpu) const;
+
+  //! Load the topology from the sysfs under root ("/sys" of Linux). If it is
+  //! not available, all the online CPUs are in one node and one domain. For
+  //! "/sys" only the CPUs in the affinity mask of this process are used.
+  static CpuTopology Load(const std::string& root);
+
+  //! The topology of this machine, which is loaded once.
+  static const CpuTopology& Instance();
+};
+
+//! Hands out the sets of CPUs to the predictors running together, so that
+//! each set is within one NUMA node, preferably within one L3 domain, and
+//! overlaps the other sets as little as possible.
+class CpuSetAllocator {
+ public:
+  explicit CpuSetAllocator(const CpuTopology& topology);
+
+  //! Reserve num_cpus CPUs, from numa_node if it is not -1 and has enough
+  //! CPUs, or from the least loaded node otherwise.
+  std::vector<int> Reserve(int num_cpus, int numa_node = -1);
+
+  //! Release the CPUs returned by Reserve.
+  void Release(const std::vector<int>& cpus);
+
+  static CpuSetAllocator& Instance();
+
+ private:
+  const CpuTopology& topology_;
+  // The CPUs of each node ordered by the L3 domains, and the number of the
+  // reservations of each CPU.
+  std::vector<std::vector<int>> node_cpus_;
+  std::vector<int> use_count_;
+  std::mutex mutex_;
+};
+
+//! Bind the calling thread to cpus, and restore its affinity on
+//! destruction. The threads created by the thread meanwhile, such as the
+//! workers of OpenMP, inherit the binding. It does nothing if the binding is
+//! not supported.
+class ScopedCpuBinding {
+ public:
+  explicit ScopedCpuBinding(const std::vector<int>& cpus);
+  ~ScopedCpuBinding();
+
+  bool bound() const { return old_mask_ != nullptr; }
+
+ private:
+  std::shared_ptr<void> old_mask_;
+};
+
+}  // namespace platform
+}  // namespace paddle
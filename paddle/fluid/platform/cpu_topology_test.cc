@@ -0,0 +1,151 @@
+/* Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/cpu_topology.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <fstream>
+#include <set>
+#include <thread>  // NOLINT
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace platform {
+
+static void MakeDirs(const std::string& path) {
+  for (size_t pos = path.find('/', 1); pos != std::string::npos;
+       pos = path.find('/', pos + 1)) {
+    mkdir(path.substr(0, pos).c_str(), 0755);
+  }
+  mkdir(path.c_str(), 0755);
+}
+
+static void WriteFile(const std::string& path, const std::string& content) {
+  MakeDirs(path.substr(0, path.rfind('/')));
+  std::ofstream fout(path);
+  fout << content << "\n";
+}
+
+// 2 nodes of 4 CPUs, each node has 2 L3 domains of 2 CPUs, and node 2 has
+// memory only.
+static std::string MakeFakeSysfs() {
+  std::string root =
+      "/tmp/cpu_topology_test_" + std::to_string(getpid()) + "/sys";
+  std::string cpu_dir = root + "/devices/system/cpu/";
+  std::string node_dir = root + "/devices/system/node/";
+  WriteFile(cpu_dir + "online", "0-7");
+  WriteFile(node_dir + "online", "0-2");
+  WriteFile(node_dir + "node0/cpulist", "0-1,4-5");
+  WriteFile(node_dir + "node1/cpulist", "2-3,6-7");
+  WriteFile(node_dir + "node2/cpulist", "");
+  const char* shared[] = {"0-1", "0-1", "2-3", "2-3",
+                          "4-5", "4-5", "6-7", "6-7"};
+  for (int cpu = 0; cpu < 8; ++cpu) {
+    std::string cache_dir = cpu_dir + "cpu" + std::to_string(cpu) + "/cache/";
+    WriteFile(cache_dir + "index0/level", "1");
+    WriteFile(cache_dir + "index2/level", "2");
+    WriteFile(cache_dir + "index1/level", "1");
+    WriteFile(cache_dir + "index3/level", "3");
+    WriteFile(cache_dir + "index3/shared_cpu_list", shared[cpu]);
+  }
+  return root;
+}
+
+TEST(CpuTopology, ParseCpuList) {
+  EXPECT_EQ(ParseCpuList("0-3,8,10-11"),
+            std::vector<int>({0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(ParseCpuList("5\n"), std::vector<int>({5}));
+  EXPECT_TRUE(ParseCpuList("").empty());
+}
+
+TEST(CpuTopology, Load) {
+  auto topology = CpuTopology::Load(MakeFakeSysfs());
+  ASSERT_EQ(topology.numa_nodes.size(), 2UL);
+  EXPECT_EQ(topology.numa_nodes[0], std::vector<int>({0, 1, 4, 5}));
+  EXPECT_EQ(topology.numa_nodes[1], std::vector<int>({2, 3, 6, 7}));
+  ASSERT_EQ(topology.l3_domains.size(), 4UL);
+  EXPECT_EQ(topology.l3_domains[1], std::vector<int>({2, 3}));
+  EXPECT_EQ(topology.NumaNodeOf(6), 1);
+  EXPECT_EQ(topology.NumaNodeOf(8), -1);
+
+  auto missing = CpuTopology::Load("/tmp/cpu_topology_test_missing");
+  ASSERT_EQ(missing.numa_nodes.size(), 1UL);
+  EXPECT_EQ(missing.l3_domains, missing.numa_nodes);
+  EXPECT_FALSE(missing.numa_nodes[0].empty());
+}
+
+TEST(CpuSetAllocator, Reserve) {
+  auto topology = CpuTopology::Load(MakeFakeSysfs());
+  CpuSetAllocator allocator(topology);
+  // The sets stay within one L3 domain, and are spread over the nodes.
+  auto a = allocator.Reserve(2);
+  auto b = allocator.Reserve(2);
+  EXPECT_EQ(a, std::vector<int>({0, 1}));
+  EXPECT_EQ(b, std::vector<int>({2, 3}));
+  EXPECT_EQ(allocator.Reserve(2, 0), std::vector<int>({4, 5}));
+  // A set larger than a node spans the nodes.
+  EXPECT_EQ(allocator.Reserve(6).size(), 6UL);
+  allocator.Release(a);
+  EXPECT_EQ(allocator.Reserve(2, 0), std::vector<int>({0, 1}));
+  EXPECT_TRUE(allocator.Reserve(0).empty());
+}
+
+static double RunBusyThreads(int num_threads, bool bind) {
+  auto& allocator = CpuSetAllocator::Instance();
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&allocator, bind] {
+      std::vector<int> cpus;
+      if (bind) cpus = allocator.Reserve(1);
+      ScopedCpuBinding binding(cpus);
+      std::vector<float> buf(1 << 16, 1.f);
+      for (int iter = 0; iter < 200; ++iter) {
+        for (size_t j = 1; j < buf.size(); ++j) {
+          buf[j] = buf[j - 1] * 0.5f + buf[j];
+        }
+      }
+      EXPECT_GT(buf.back(), 0.f);
+      allocator.Release(cpus);
+    });
+  }
+  for (auto& t : threads) t.join();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return num_threads / elapsed.count();
+}
+
+TEST(ScopedCpuBinding, Throughput) {
+  auto cpus = CpuTopology::Instance().numa_nodes[0];
+  {
+    ScopedCpuBinding binding({cpus[0]});
+#ifdef __linux__
+    EXPECT_TRUE(binding.bound());
+#endif
+  }
+  int num_threads = std::max(1u, std::thread::hardware_concurrency());
+  LOG(INFO) << num_threads << " threads, unbound: "
+            << RunBusyThreads(num_threads, false)
+            << " runs/s, bound: " << RunBusyThreads(num_threads, true)
+            << " runs/s";
+}
+
+}  // namespace platform
+}  // namespace paddle
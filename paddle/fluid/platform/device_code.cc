@@ -12,15 +12,25 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <dlfcn.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
 #include <set>
+#include <sstream>
 #include <utility>
 
 #include "paddle/fluid/platform/device_code.h"
 #include "paddle/fluid/platform/enforce.h"
 
 DECLARE_string(cuda_dir);
+DECLARE_string(fusion_group_cpu_compiler);
+DECLARE_string(fusion_group_cpu_cache_dir);
 
 namespace paddle {
 namespace platform {
@@ -65,6 +75,14 @@ DeviceCodePool::DeviceCodePool(const std::vector<platform::Place>& places) {
                     errors::InvalidArgument(
                         "Expected the number of places >= 1. But received %d.",
                         places.size()));
+  AddPlaces(places);
+
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  CUDADeviceCode::CheckAvailableStatus();
+#endif
+}
+
+void DeviceCodePool::AddPlaces(const std::vector<platform::Place>& places) {
   // Remove the duplicated places
   std::set<Place> set;
   for (auto& p : places) {
@@ -79,12 +97,209 @@ DeviceCodePool::DeviceCodePool(const std::vector<platform::Place>& places) {
           "CUDAPlace or HIPPlace is not supported, please re-compile with "
           "WITH_GPU=ON or WITH_ROCM=ON."));
 #endif
+    } else if (is_cpu_place(p)) {
+      device_codes_.emplace(p, DeviceCodeMap());
     }
   }
+}
 
-#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
-  CUDADeviceCode::CheckAvailableStatus();
-#endif
+// The compiled libraries are loaded into the process, so they are cached in a
+// directory private to the user rather than a shared temporary one.
+static std::string GetCPUCodeCacheDir() {
+  std::string cache_dir = FLAGS_fusion_group_cpu_cache_dir;
+  if (cache_dir.empty()) {
+    const char* xdg_cache = std::getenv("XDG_CACHE_HOME");
+    const char* home = std::getenv("HOME");
+    if (xdg_cache != nullptr && xdg_cache[0] == '/') {
+      cache_dir = std::string(xdg_cache) + "/paddle/fusion_group";
+    } else if (home != nullptr && home[0] == '/') {
+      cache_dir = std::string(home) + "/.cache/paddle/fusion_group";
+    } else {
+      const char* tmp_dir = std::getenv("TMPDIR");
+      cache_dir =
+          (tmp_dir != nullptr && tmp_dir[0] != '\0') ? tmp_dir : "/tmp";
+      cache_dir += "/paddle_fusion_group_" + std::to_string(geteuid());
+    }
+  }
+  return cache_dir;
+}
+
+static bool MakeDirs(const std::string& dir) {
+  struct stat st;
+  for (size_t pos = dir.find('/', 1); pos != std::string::npos;
+       pos = dir.find('/', pos + 1)) {
+    std::string parent = dir.substr(0, pos);
+    if (stat(parent.c_str(), &st) != 0) {
+      mkdir(parent.c_str(), 0700);
+    }
+  }
+  if (stat(dir.c_str(), &st) != 0) {
+    mkdir(dir.c_str(), 0700);
+  }
+  return stat(dir.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+// Returns true if the path is not a symbolic link, is owned by the effective
+// user and is not writable by the others, so no one else can plant a library.
+static bool IsPrivatePath(const std::string& path, bool is_dir) {
+  struct stat st;
+  if (lstat(path.c_str(), &st) != 0) {
+    return false;
+  }
+  bool type_matched = is_dir ? S_ISDIR(st.st_mode) : S_ISREG(st.st_mode);
+  return type_matched && st.st_uid == geteuid() &&
+         (st.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
+// The code is compiled with -march=native, so the cached libraries are keyed
+// by the model and the features of the CPU as well.
+static const std::string& GetCPUIdentity() {
+  static const std::string identity = [] {
+    std::string result;
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+      if (line.empty()) {
+        break;  // Only the first processor is needed.
+      }
+      if (line.compare(0, 10, "model name") == 0 ||
+          line.compare(0, 5, "flags") == 0 ||
+          line.compare(0, 8, "Features") == 0 ||
+          line.compare(0, 8, "CPU part") == 0) {
+        result += line + "\n";
+      }
+    }
+    return result;
+  }();
+  return identity;
+}
+
+CPUDeviceCode::CPUDeviceCode(const Place& place, const std::string& name,
+                             const std::string& kernel) {
+  if (!is_cpu_place(place)) {
+    PADDLE_THROW(platform::errors::PermissionDenied(
+        "CPUDeviceCode can only launch on CPU place."));
+  }
+
+  place_ = place;
+  name_ = name;
+  kernel_ = kernel;
+}
+
+CPUDeviceCode::~CPUDeviceCode() {
+  if (handle_ != nullptr) {
+    dlclose(handle_);
+  }
+}
+
+bool CPUDeviceCode::Compile(bool include_path) {
+  if (is_compiled_) {
+    return true;
+  }
+
+  const std::string options = "-std=c++11 -O3 -march=native -fopenmp -fPIC";
+  std::ostringstream hash;
+  hash << std::hex
+       << std::hash<std::string>()(FLAGS_fusion_group_cpu_compiler + " " +
+                                   options + "\n" + GetCPUIdentity() +
+                                   kernel_);
+
+  std::string cache_dir = GetCPUCodeCacheDir();
+  if (!MakeDirs(cache_dir)) {
+    LOG_FIRST_N(WARNING, 1) << "Cannot create the directory " << cache_dir
+                            << " to cache the compiled CPU code. Please "
+                               "specify it by export "
+                               "FLAGS_fusion_group_cpu_cache_dir=xxx.";
+    return false;
+  }
+  if (!IsPrivatePath(cache_dir, true)) {
+    LOG_FIRST_N(WARNING, 1)
+        << "Refuse to cache the compiled CPU code in " << cache_dir
+        << ", which must be owned by the current user and not be writable "
+           "by the group or others. Please specify another one by export "
+           "FLAGS_fusion_group_cpu_cache_dir=xxx.";
+    return false;
+  }
+  std::string lib_path = cache_dir + "/" + name_ + "_" + hash.str() + ".so";
+
+  struct stat st;
+  if (stat(lib_path.c_str(), &st) != 0) {
+    // Compiles into files with unique names, and renames the library at last,
+    // so that the processes sharing the cache never load a partial one.
+    static std::atomic<int> counter{0};
+    std::string tmp_prefix = lib_path + "." + std::to_string(getpid()) + "." +
+                             std::to_string(counter++);
+    std::string src_path = tmp_prefix + ".cc";
+    std::string tmp_lib_path = tmp_prefix + ".so";
+    {
+      std::ofstream src(src_path);
+      src << kernel_;
+      if (!src) {
+        LOG(WARNING) << "Failed to write the CPU code to " << src_path;
+        std::remove(src_path.c_str());
+        return false;
+      }
+    }
+
+    std::string command = FLAGS_fusion_group_cpu_compiler + " " + options +
+                          " -shared '" + src_path + "' -o '" + tmp_lib_path +
+                          "' 2>&1";
+    std::string log;
+    int status = -1;
+    FILE* pipe = popen(command.c_str(), "r");
+    if (pipe != nullptr) {
+      char buffer[256];
+      while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
+        log += buffer;
+      }
+      status = pclose(pipe);
+    }
+    std::remove(src_path.c_str());
+    if (status != 0 || chmod(tmp_lib_path.c_str(), 0700) != 0 ||
+        rename(tmp_lib_path.c_str(), lib_path.c_str()) != 0) {
+      std::remove(tmp_lib_path.c_str());
+      LOG(WARNING) << "JIT compiling of CPU code failed:"
+                   << "\n  Kernel name: " << name_ << "\n  Command: "
+                   << command << "\n  Kernel body:\n"
+                   << kernel_ << "\n  Compiling log: " << log;
+      return false;
+    }
+    VLOG(3) << "Compile the CPU code of " << name_ << " to " << lib_path;
+  } else {
+    VLOG(3) << "Reuse the compiled CPU code of " << name_ << " in "
+            << lib_path;
+  }
+
+  if (!IsPrivatePath(lib_path, false)) {
+    LOG(WARNING) << "Refuse to load " << lib_path
+                 << ", which must be owned by the current user and not be "
+                    "writable by the group or others.";
+    return false;
+  }
+  handle_ = dlopen(lib_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle_ == nullptr) {
+    LOG(WARNING) << "Failed to load " << lib_path << ": " << dlerror();
+    return false;
+  }
+  function_ = reinterpret_cast<FunctionType>(dlsym(handle_, name_.c_str()));
+  if (function_ == nullptr) {
+    LOG(WARNING) << "Failed to find " << name_ << " in " << lib_path << ": "
+                 << dlerror();
+    dlclose(handle_);
+    handle_ = nullptr;
+    return false;
+  }
+
+  is_compiled_ = true;
+  return true;
+}
+
+void CPUDeviceCode::Launch(const size_t n, std::vector<void*>* args) const {
+  PADDLE_ENFORCE_EQ(
+      is_compiled_, true,
+      errors::PreconditionNotMet(
+          "Please compile the code before launching the kernel."));
+  function_(args->data());
 }
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
@@ -48,6 +48,27 @@ class DeviceCode {
   std::string kernel_;
 };
 
+// Compiles the generated C++ code into a shared library by the host compiler
+// (FLAGS_fusion_group_cpu_compiler) and loads the function named name. The
+// library is cached on disk by the hash of the code and the compiling options,
+// so the same code is compiled only once. The function must be declared as
+// extern "C" void name(void** args).
+class CPUDeviceCode : public DeviceCode {
+ public:
+  explicit CPUDeviceCode(const Place& place, const std::string& name,
+                         const std::string& kernel);
+  ~CPUDeviceCode();
+  bool Compile(bool include_path = false) override;
+  void Launch(const size_t n, std::vector<void*>* args) const override;
+
+ private:
+  using FunctionType = void (*)(void**);
+
+  bool is_compiled_{false};
+  void* handle_{nullptr};
+  FunctionType function_{nullptr};
+};
+
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 class CUDADeviceCode : public DeviceCode {
  public:
@@ -106,6 +127,8 @@ class DeviceCodePool {
   static DeviceCodePool& Init(const std::vector<platform::Place>& places) {
     if (pool == nullptr) {
       pool = new DeviceCodePool(places);
+    } else {
+      pool->AddPlaces(places);
     }
     return *pool;
   }
@@ -124,6 +147,8 @@ class DeviceCodePool {
   }
 
  private:
+  void AddPlaces(const std::vector<platform::Place>& places);
+
   static DeviceCodePool* pool;
   std::map<Place, DeviceCodeMap> device_codes_;
   DISABLE_COPY_AND_ASSIGN(DeviceCodePool);
@@ -13,7 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/platform/device_code.h"
+#include <memory>
 #include <utility>
+#include <vector>
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/platform/init.h"
@@ -43,6 +45,69 @@ void saxpy_kernel(float a, float *x, float* y, float* z, size_t n) {
 )";
 #endif
 
+constexpr auto cpu_saxpy_code = R"(
+#include <cstddef>
+extern "C" void saxpy_kernel(void** args) {
+  float a = *static_cast<float*>(args[0]);
+  float* x = *static_cast<float**>(args[1]);
+  float* y = *static_cast<float**>(args[2]);
+  float* z = *static_cast<float**>(args[3]);
+  size_t n = *static_cast<size_t*>(args[4]);
+  for (size_t tid = 0; tid < n; ++tid) {
+    z[tid] = a * x[tid] + y[tid];
+  }
+}
+)";
+
+TEST(DeviceCode, cpu) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceCode code(place, "saxpy_kernel", cpu_saxpy_code);
+  if (!code.Compile()) {
+    LOG(WARNING) << "Skip the test because no host compiler is available.";
+    return;
+  }
+  // The second code hits the library cached by the first one.
+  paddle::platform::CPUDeviceCode cached_code(place, "saxpy_kernel",
+                                              cpu_saxpy_code);
+  EXPECT_EQ(cached_code.Compile(), true);
+
+  paddle::framework::Tensor x;
+  paddle::framework::Tensor y;
+  paddle::framework::Tensor z;
+
+  float scale = 2;
+  auto dims = paddle::framework::make_ddim({256, 1024});
+  float* x_data = x.mutable_data<float>(dims, place);
+  float* y_data = y.mutable_data<float>(dims, place);
+  float* z_data = z.mutable_data<float>(dims, place);
+
+  size_t n = x.numel();
+  for (size_t i = 0; i < n; ++i) {
+    x_data[i] = static_cast<float>(i);
+    y_data[i] = static_cast<float>(0.5);
+  }
+
+  std::vector<void*> args = {&scale, &x_data, &y_data, &z_data, &n};
+  cached_code.Launch(n, &args);
+  for (size_t i = 0; i < n; i++) {
+    EXPECT_EQ(z_data[i], static_cast<float>(i) * scale + 0.5);
+  }
+}
+
+TEST(DeviceCodePool, cpu) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::DeviceCodePool& pool =
+      paddle::platform::DeviceCodePool::Init({place});
+  EXPECT_EQ(pool.size(place), 0UL);
+
+  std::unique_ptr<paddle::platform::DeviceCode> code(
+      new paddle::platform::CPUDeviceCode(place, "saxpy_kernel",
+                                          cpu_saxpy_code));
+  pool.Set(std::move(code));
+  EXPECT_EQ(pool.size(place), 1UL);
+  EXPECT_EQ(pool.Get(place, "saxpy_kernel")->GetName(), "saxpy_kernel");
+}
+
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 TEST(DeviceCode, cuda) {
   if (!paddle::platform::dynload::HasNVRTC() ||
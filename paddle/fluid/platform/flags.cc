@@ -543,6 +543,140 @@ DEFINE_int32(
     "less FLAGS_max_inplace_grad_add, than it will be use several grad_add"
     "instead of sum. Default is 0.");
 
+/**
+ * Performance related FLAG
+ * Name: backward_num_threads
+ * Since Version: 2.0.0
+ * Value Range: int32, default=1
+ * Example:
+ * Note: The number of threads used to run the backward graph of dygraph.
+ * If FLAGS_backward_num_threads > 1, the independent grad nodes are run in
+ * a thread pool, and gradients are summed by the reverse order of the
+ * forward execution sequence to keep the result deterministic.
+ */
+DEFINE_int32(backward_num_threads, 1,
+             "The number of threads used to run the backward graph of "
+             "dygraph. If it is larger than 1, the independent grad nodes "
+             "will be run in parallel. Default is 1.");
+
+/**
+ * Data processing related FLAG
+ * Name: dataloader_shm_ring_slot_num
+ * Since Version: 2.0.0
+ * Value Range: int32, default=4
+ * Example:
+ * Note: The number of slots in the shared memory ring arena of each
+ * DataLoader worker process. Each batch is written into one slot and the
+ * slot is reused after all tensors of the batch are released by the main
+ * process. If it is 0, or no slot is free, each tensor is sent by its own
+ * shared memory file.
+ */
+DEFINE_int32(dataloader_shm_ring_slot_num, 4,
+             "The number of slots in the shared memory ring arena of each "
+             "DataLoader worker, 0 means the ring arena is disabled. "
+             "Default is 4.");
+
+/**
+ * Data processing related FLAG
+ * Name: dataloader_shm_ring_slot_size
+ * Since Version: 2.0.0
+ * Value Range: uint64, default=8388608 (8MB)
+ * Example:
+ * Note: The size in bytes of each slot in the shared memory ring arena of
+ * DataLoader workers. The batches larger than it fall back to the shared
+ * memory file per tensor.
+ */
+DEFINE_uint64(dataloader_shm_ring_slot_size, 8UL << 20,
+              "The size in bytes of each slot in the shared memory ring "
+              "arena of each DataLoader worker. Default is 8MB.");
+
+/**
+ * Performance related FLAG
+ * Name: cpu_conv_exhaustive_search
+ * Since Version: 2.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If True, the algorithm of CPU conv2d without MKLDNN (im2col, 1x1
+ * GEMM, depthwise direct or Winograd) is chosen by running all of the
+ * supported ones once for each shape, otherwise it is chosen by the shapes.
+ */
+DEFINE_bool(cpu_conv_exhaustive_search, false,
+            "Whether to choose the algorithm of CPU conv2d by running all "
+            "of the supported ones. Default is false.");
+
+/**
+ * Performance related FLAG
+ * Name: cpu_conv_use_winograd
+ * Since Version: 2.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If True, the 3x3 stride 1 CPU conv2d without MKLDNN may be computed
+ * by Winograd when it is chosen by the shapes. It is faster for wide layers,
+ * but its results differ slightly from im2col and GEMM.
+ */
+DEFINE_bool(cpu_conv_use_winograd, false,
+            "Whether the algorithm of CPU conv2d chosen by the shapes may be "
+            "Winograd. Default is false.");
+
+/**
+ * Performance related FLAG
+ * Name: use_packed_gemm_weights
+ * Since Version: 2.0.0
+ * Value Range: bool, default=true
+ * Example:
+ * Note: If True, the persistable weights of the CPU fc and mul ops are packed
+ * once for the packed GEMM of MKL when the inference predictor loads them,
+ * instead of being packed by every GEMM. It takes effect only with MKLML.
+ */
+DEFINE_bool(use_packed_gemm_weights, true,
+            "Whether to pack the weights of the CPU fc and mul ops once when "
+            "the inference predictor loads them. Default is true.");
+
+/**
+ * Performance related FLAG
+ * Name: executor_zero_copy_feed_fetch
+ * Since Version: 2.0.0
+ * Value Range: bool, default=false
+ * Example:
+ * Note: If True, Executor shares the memory of the C-contiguous numpy arrays
+ * fed on CPUPlace and of the fetched CPU tensors instead of copying them.
+ * The fed arrays must not be changed during the run, and the fetched arrays
+ * may be overwritten by the next run unless they are copied.
+ */
+DEFINE_bool(executor_zero_copy_feed_fetch, false,
+            "Whether Executor shares the memory of the fed numpy arrays and "
+            "the fetched tensors on CPU instead of copying them. "
+            "Default is false.");
+
+/**
+ * Performance related FLAG
+ * Name: fusion_group_cpu_compiler
+ * Since Version: 2.0.0
+ * Value Range: string, default=c++
+ * Example: FLAGS_fusion_group_cpu_compiler=clang++
+ * Note: The host C++ compiler used by fusion_group to compile the code
+ * generated for the fused elementwise subgraphs on CPU.
+ */
+DEFINE_string(fusion_group_cpu_compiler, "c++",
+              "The host C++ compiler used to compile the CPU code generated "
+              "by fusion_group. Default is c++.");
+
+/**
+ * Performance related FLAG
+ * Name: fusion_group_cpu_cache_dir
+ * Since Version: 2.0.0
+ * Value Range: string, default=empty
+ * Example: FLAGS_fusion_group_cpu_cache_dir=/path/to/cache
+ * Note: The directory to cache the shared libraries compiled for the CPU
+ * code generated by fusion_group, keyed by the hash of the code and the CPU.
+ * If empty, $XDG_CACHE_HOME/paddle/fusion_group (or
+ * $HOME/.cache/paddle/fusion_group) is used. The directory and the libraries
+ * must be owned by the current user and not be writable by others.
+ */
+DEFINE_string(fusion_group_cpu_cache_dir, "",
+              "The directory to cache the shared libraries compiled for the "
+              "CPU code generated by fusion_group.");
+
 /**
  * Debug related FLAG
  * Name: tracer_mkldnn_ops_on
@@ -33,6 +33,14 @@
 DECLARE_bool(use_mkldnn);
 DECLARE_string(tracer_mkldnn_ops_on);
 DECLARE_string(tracer_mkldnn_ops_off);
+DECLARE_int32(dataloader_shm_ring_slot_num);
+DECLARE_uint64(dataloader_shm_ring_slot_size);
+DECLARE_bool(cpu_conv_exhaustive_search);
+DECLARE_bool(cpu_conv_use_winograd);
+DECLARE_bool(use_packed_gemm_weights);
+DECLARE_bool(executor_zero_copy_feed_fetch);
+DECLARE_string(fusion_group_cpu_compiler);
+DECLARE_string(fusion_group_cpu_cache_dir);
 // debug
 DECLARE_bool(check_nan_inf);
 DECLARE_bool(cpu_deterministic);
@@ -41,6 +49,7 @@ DECLARE_int32(multiple_of_cupti_buffer_size);
 DECLARE_bool(reader_queue_speed_test_mode);
 DECLARE_int32(call_stack_level);
 DECLARE_bool(sort_sum_gradient);
+DECLARE_int32(backward_num_threads);
 // device management
 DECLARE_int32(paddle_num_threads);
 // executor
@@ -352,7 +361,11 @@ static void RegisterGlobalVarGetterSetter() {
       FLAGS_memory_fraction_of_eager_deletion, FLAGS_use_pinned_memory,
       FLAGS_benchmark, FLAGS_inner_op_parallelism, FLAGS_tracer_profile_fname,
       FLAGS_paddle_num_threads, FLAGS_use_mkldnn, FLAGS_max_inplace_grad_add,
-      FLAGS_tracer_mkldnn_ops_on, FLAGS_tracer_mkldnn_ops_off);
+      FLAGS_tracer_mkldnn_ops_on, FLAGS_tracer_mkldnn_ops_off,
+      FLAGS_backward_num_threads, FLAGS_dataloader_shm_ring_slot_num,
+      FLAGS_dataloader_shm_ring_slot_size, FLAGS_cpu_conv_exhaustive_search,
+      FLAGS_cpu_conv_use_winograd, FLAGS_use_packed_gemm_weights, FLAGS_executor_zero_copy_feed_fetch,
+      FLAGS_fusion_group_cpu_compiler, FLAGS_fusion_group_cpu_cache_dir);
 
 #ifdef PADDLE_WITH_CUDA
   REGISTER_PUBLIC_GLOBAL_VAR(
@@ -34,6 +34,7 @@ limitations under the License. */
 #include "paddle/fluid/imperative/basic_engine.h"
 #include "paddle/fluid/imperative/bkcl_context.h"
 #include "paddle/fluid/imperative/data_loader.h"
+#include "paddle/fluid/imperative/gloo_context.h"
 #include "paddle/fluid/imperative/layer.h"
 #include "paddle/fluid/imperative/nccl_context.h"
 #include "paddle/fluid/imperative/partial_grad_engine.h"
@@ -201,6 +202,15 @@ static void InitVarBaseFromTensorWithArgDefault(
   }
 }
 
+// The value of a VarBase may be produced by the ops deferred in lazy mode,
+// which should be run before the value is observed.
+static void FlushLazyOps() {
+  auto &tracer = imperative::GetCurrentTracer();
+  if (tracer && tracer->IsLazyModeEnabled()) {
+    tracer->FlushLazyOps();
+  }
+}
+
 static std::string GetTypeName(const imperative::VarBase &var) {
   if (var.Type() == framework::proto::VarType::RAW) {
     return "RAW";
@@ -460,6 +470,10 @@ void BindImperative(py::module *m_ptr) {
                 obj.get_type()));
         py::list batch = py::cast<py::list>(obj);
         py::list tensors;
+        // NOTE: The tensors are packed into a slot of the ring arena if
+        // possible, see MemoryMapRingArena for details.
+        memory::allocation::MemoryMapRingSlotWriter slot_writer(
+            memory::allocation::GetMemoryMapRingWriterArena());
         for (size_t i = 0; i < batch.size(); ++i) {
           // 1. cast to python array
           auto array = batch[i].cast<py::array>();
@@ -478,11 +492,17 @@ void BindImperative(py::module *m_ptr) {
           // 3. allocate shared memory
           void *data_ptr = t.data<void>();
           size_t data_size = t.numel() * framework::SizeOfType(t.type());
-          auto shared_writer_holder =
-              memory::allocation::AllocateMemoryMapWriterAllocation(data_size);
-          // 4. maintain mmap fd set & backup ipc_name
-          const std::string &ipc_name = shared_writer_holder->ipc_name();
-          memory::allocation::MemoryMapFdSet::Instance().Insert(ipc_name);
+          std::shared_ptr<memory::allocation::Allocation> shared_writer_holder =
+              slot_writer.Allocate(data_size);
+          if (shared_writer_holder == nullptr) {
+            auto mmap_writer_holder =
+                memory::allocation::AllocateMemoryMapWriterAllocation(
+                    data_size);
+            // 4. maintain mmap fd set & backup ipc_name
+            const std::string &ipc_name = mmap_writer_holder->ipc_name();
+            memory::allocation::MemoryMapFdSet::Instance().Insert(ipc_name);
+            shared_writer_holder = mmap_writer_holder;
+          }
           // 5. copy data & reset holder
           memory::Copy(platform::CPUPlace(), shared_writer_holder->ptr(),
                        platform::CPUPlace(), data_ptr, data_size);
@@ -490,6 +510,7 @@ void BindImperative(py::module *m_ptr) {
           // 6. append to result list
           tensors.append(t);
         }
+        slot_writer.Publish();
         return tensors;
       },
       py::return_value_policy::take_ownership);
@@ -497,6 +518,15 @@ void BindImperative(py::module *m_ptr) {
   m.def("_remove_tensor_list_mmap_fds", [](py::list &tensor_list) {
     for (size_t i = 0; i < tensor_list.size(); ++i) {
       auto t = tensor_list[i].cast<framework::LoDTensor>();
+      auto *ring_writer_allocation =
+          dynamic_cast<memory::allocation::MemoryMapRingWriterAllocation *>(
+              t.Holder().get());
+      if (ring_writer_allocation != nullptr) {
+        // The arena is unlinked by the main process once it is opened.
+        memory::allocation::MemoryMapFdSet::Instance().Remove(
+            ring_writer_allocation->ipc_name());
+        continue;
+      }
       auto *mmap_writer_allocation =
           dynamic_cast<memory::allocation::MemoryMapWriterAllocation *>(
               t.Holder().get());
@@ -512,6 +542,10 @@ void BindImperative(py::module *m_ptr) {
 
   m.def("_cleanup_mmap_fds",
         []() { memory::allocation::MemoryMapFdSet::Instance().Clear(); });
+
+  m.def("_release_mmap_ring_arenas", [](const std::vector<pid_t> &pids) {
+    memory::allocation::ReleaseMemoryMapRingReaderArenas(pids);
+  });
 #endif
 
   m.def("start_imperative_gperf_profiler",
@@ -581,6 +615,7 @@ void BindImperative(py::module *m_ptr) {
       .def("__setitem__",
            [](std::shared_ptr<imperative::VarBase> &self, py::handle _index,
               py::object &value_obj) {
+             FlushLazyOps();
              auto self_tensor =
                  self->MutableVar()->GetMutable<framework::LoDTensor>();
              PyObject *index_ptr = !PyTuple_Check(_index.ptr())
@@ -661,6 +696,7 @@ void BindImperative(py::module *m_ptr) {
            })
       .def("__getitem__",
            [](std::shared_ptr<imperative::VarBase> &self, py::handle _index) {
+             FlushLazyOps();
              std::vector<int> slice_axes, slice_starts, slice_ends,
                  slice_strides, decrease_axis, infer_flags;
              auto tensor =
@@ -699,6 +735,7 @@ void BindImperative(py::module *m_ptr) {
            })
       .def("_inplace_version",
            [](imperative::VarBase &self) -> uint32_t {
+             FlushLazyOps();
              const auto &var = self.MutableVar();
              PADDLE_ENFORCE_EQ(
                  var->IsInitialized(), true,
@@ -721,6 +758,7 @@ void BindImperative(py::module *m_ptr) {
             )DOC")
       .def("numpy",
            [](imperative::VarBase &self) -> py::array {
+             FlushLazyOps();
              const auto &tensor =
                  self.MutableVar()->Get<framework::LoDTensor>();
              PADDLE_ENFORCE_EQ(
@@ -753,6 +791,7 @@ void BindImperative(py::module *m_ptr) {
       .def("detach",
            [](const imperative::VarBase
                   &self) -> std::shared_ptr<imperative::VarBase> {
+             FlushLazyOps();
              PADDLE_ENFORCE_EQ(
                  self.Var().IsInitialized(), true,
                  platform::errors::InvalidArgument(
@@ -872,6 +911,7 @@ void BindImperative(py::module *m_ptr) {
       )DOC")
       .def("clone",
            [](std::shared_ptr<imperative::VarBase> &self) {
+             FlushLazyOps();
              const auto &tensor = self->Var().Get<framework::LoDTensor>();
              PADDLE_ENFORCE_EQ(
                  tensor.IsInitialized(), true,
@@ -923,6 +963,7 @@ void BindImperative(py::module *m_ptr) {
               bool retain_graph) {
              // TODO(jiabin): when we impl more backward execution we can
              // select them
+             FlushLazyOps();
              auto *engine = tracer.GetEngine();
              engine->Init(&self, retain_graph);
              VLOG(3) << "Start backward";
@@ -933,6 +974,7 @@ void BindImperative(py::module *m_ptr) {
       .def("_grad_name", &imperative::VarBase::GradVarName)
       .def("_grad_value",
            [](imperative::VarBase &self) {
+             FlushLazyOps();
              return self.MutableGradVar()->Get<framework::LoDTensor>();
            },
            py::return_value_policy::reference)
@@ -960,11 +1002,13 @@ void BindImperative(py::module *m_ptr) {
            py::return_value_policy::copy)
       .def("_is_sparse",
            [](imperative::VarBase &self) {
+             FlushLazyOps();
              return self.Var().IsType<framework::SelectedRows>();
            })
       .def("_allreduce",
            [](imperative::VarBase &self,
               const imperative::ParallelStrategy &strategy) {
+             FlushLazyOps();
              if (strategy.nranks_ > 1) {
 #ifdef PADDLE_WITH_NCCL
 #if NCCL_VERSION_CODE >= 2212
@@ -990,6 +1034,7 @@ void BindImperative(py::module *m_ptr) {
            py::call_guard<py::gil_scoped_release>())
       .def("cpu",
            [](const std::shared_ptr<imperative::VarBase> &self) {
+             FlushLazyOps();
              if (platform::is_cpu_place(self->Place())) {
                return self;
              } else {
@@ -1016,6 +1061,7 @@ void BindImperative(py::module *m_ptr) {
               )DOC")
       .def("pin_memory",
            [](const std::shared_ptr<imperative::VarBase> &self) {
+             FlushLazyOps();
 #ifndef PADDLE_WITH_CUDA
              PADDLE_THROW(platform::errors::PermissionDenied(
                  "Cannot copy this Tensor to pinned memory in CPU version "
@@ -1050,6 +1096,7 @@ void BindImperative(py::module *m_ptr) {
       .def("cuda",
            [](const std::shared_ptr<imperative::VarBase> &self, int device_id,
               bool blocking) {
+             FlushLazyOps();
 #ifndef PADDLE_WITH_CUDA
              PADDLE_THROW(platform::errors::PermissionDenied(
                  "Cannot copy this Tensor to GPU in CPU version Paddle, "
@@ -1079,6 +1126,7 @@ void BindImperative(py::module *m_ptr) {
              if (platform::is_same_place(self->Place(), place)) {
                return self;
              } else {
+               FlushLazyOps();
                auto new_var = self->NewVarBase(place, blocking);
                new_var->SetOverridedStopGradient(self->OverridedStopGradient());
                return new_var;
@@ -1109,10 +1157,16 @@ void BindImperative(py::module *m_ptr) {
               y = x.cuda(1)
               print(y.place)        # CUDAPlace(1)
        )DOC")
-      .def("copy_", &imperative::VarBase::CopyFrom)
+      .def("copy_",
+           [](imperative::VarBase &self, const imperative::VarBase &src,
+              bool blocking) {
+             FlushLazyOps();
+             self.CopyFrom(src, blocking);
+           })
       .def("_copy_to",
            [](const std::shared_ptr<imperative::VarBase> &self,
               const platform::CPUPlace &place, bool blocking) {
+             FlushLazyOps();
              auto new_var = self->NewVarBase(place, blocking);
              // Note(zhiqiu): Since NewVarBase may use GpuCopyAsync to
              // copy data from the tensor of self to the tensor of new varbase,
@@ -1131,6 +1185,7 @@ void BindImperative(py::module *m_ptr) {
       .def("_copy_to",
            [](const std::shared_ptr<imperative::VarBase> &self,
               const platform::CUDAPinnedPlace &place, bool blocking) {
+             FlushLazyOps();
              auto new_var = self->NewVarBase(place, blocking);
              if (!blocking) {
                IncreaseVarbaseReferenceCountUntilCopyComplete(self, place);
@@ -1141,6 +1196,7 @@ void BindImperative(py::module *m_ptr) {
       .def("_copy_to",
            [](const std::shared_ptr<imperative::VarBase> &self,
               const platform::XPUPlace &place, bool blocking) {
+             FlushLazyOps();
              auto new_var = self->NewVarBase(place, blocking);
              if (!blocking) {
                IncreaseVarbaseReferenceCountUntilCopyComplete(self, place);
@@ -1151,6 +1207,7 @@ void BindImperative(py::module *m_ptr) {
       .def("_copy_to",
            [](const std::shared_ptr<imperative::VarBase> &self,
               const platform::CUDAPlace &place, bool blocking) {
+             FlushLazyOps();
              auto new_var = self->NewVarBase(place, blocking);
              if (!blocking) {
                IncreaseVarbaseReferenceCountUntilCopyComplete(self, place);
@@ -1158,7 +1215,11 @@ void BindImperative(py::module *m_ptr) {
              return new_var;
            },
            py::return_value_policy::copy)
-      .def("value", [](imperative::VarBase &self) { return self.MutableVar(); },
+      .def("value",
+           [](imperative::VarBase &self) {
+             FlushLazyOps();
+             return self.MutableVar();
+           },
            py::return_value_policy::reference)
       .def_property("name", &imperative::VarBase::Name,
                     &imperative::VarBase::SetName)
@@ -1170,6 +1231,7 @@ void BindImperative(py::module *m_ptr) {
       .def_property_readonly(
           "shape",
           [](imperative::VarBase &self) {
+            FlushLazyOps();
             if (self.Var().IsType<framework::LoDTensor>()) {
               return framework::vectorize<int>(
                   self.Var().Get<framework::LoDTensor>().dims());
@@ -1212,17 +1274,24 @@ void BindImperative(py::module *m_ptr) {
               print(x.is_leaf) # True
               print(y.is_leaf) # False
        )DOC")
-      .def_property_readonly(
-          "place", [](imperative::VarBase &self) { return self.Place(); },
-          py::return_value_policy::copy)
+      .def_property_readonly("place",
+                             [](imperative::VarBase &self) {
+                               FlushLazyOps();
+                               return self.Place();
+                             },
+                             py::return_value_policy::copy)
       .def_property_readonly("_place_str",
                              [](imperative::VarBase &self) {
+                               FlushLazyOps();
                                std::stringstream ostr;
                                ostr << self.Place();
                                return ostr.str();
                              })
       .def_property_readonly("type", &imperative::VarBase::Type)
-      .def_property_readonly("dtype", &imperative::VarBase::DataType);
+      .def_property_readonly("dtype", [](imperative::VarBase &self) {
+        FlushLazyOps();
+        return self.DataType();
+      });
 
   py::class_<imperative::Layer, Layer /* <--- trampoline*/> layer(m, "Layer");
   layer.def(py::init<>())
@@ -1244,6 +1313,9 @@ void BindImperative(py::module *m_ptr) {
       .def_property("_enable_program_desc_tracing",
                     &imperative::Tracer::IsProgramDescTracingEnabled,
                     &imperative::Tracer::SetEnableProgramDescTracing)
+      .def_property("_enable_lazy_mode", &imperative::Tracer::IsLazyModeEnabled,
+                    &imperative::Tracer::SetEnableLazyMode)
+      .def("_flush_lazy_ops", &imperative::Tracer::FlushLazyOps)
       .def_property("_enable_autocast", &imperative::Tracer::IsAutoCastEnabled,
                     &imperative::Tracer::SetEnableAutoCast)
       .def_property("_has_grad", &imperative::Tracer::HasGrad,
@@ -1412,7 +1484,8 @@ void BindImperative(py::module *m_ptr) {
       },
       py::call_guard<py::gil_scoped_release>());
 
-#if (defined PADDLE_WITH_NCCL) || (defined PADDLE_WITH_XPU_BKCL)
+#if (defined PADDLE_WITH_NCCL) || (defined PADDLE_WITH_XPU_BKCL) || \
+    (defined PADDLE_WITH_GLOO)
   py::class_<imperative::ParallelContext,
              std::shared_ptr<imperative::ParallelContext>>(m,
                                                            "ParallelContext");
@@ -1451,6 +1524,15 @@ void BindImperative(py::module *m_ptr) {
                     const platform::XPUPlace &>())
       .def("init", [](imperative::BKCLParallelContext &self) { self.Init(); });
 #endif
+
+#if defined(PADDLE_WITH_GLOO)
+  py::class_<imperative::GLOOParallelContext, imperative::ParallelContext,
+             std::shared_ptr<imperative::GLOOParallelContext>>(
+      m, "GLOOParallelContext")
+      .def(py::init<const imperative::ParallelStrategy &,
+                    const platform::CPUPlace &>())
+      .def("init", [](imperative::GLOOParallelContext &self) { self.Init(); });
+#endif
 }
 
 }  // namespace pybind
@@ -160,6 +160,64 @@ void PaddleInferTensorCreate(
   tensor.CopyFromCpu(static_cast<const T *>(data.data()));
 }
 
+// Holds a python object, e.g. the numpy array whose memory is shared with a
+// tensor, until the tensor stops using the memory.
+std::shared_ptr<void> PyObjectOwner(const py::object &obj) {
+  return std::shared_ptr<void>(new py::object(obj), [](void *ptr) {
+    py::gil_scoped_acquire gil;
+    delete static_cast<py::object *>(ptr);
+  });
+}
+
+template <typename TensorT, typename T>
+void TensorShareExternalData(
+    TensorT &tensor,  // NOLINT
+    py::array_t<T, py::array::c_style | py::array::forcecast> data) {
+  std::vector<int> shape;
+  std::copy_n(data.shape(), data.ndim(), std::back_inserter(shape));
+  tensor.template ShareExternalData<T>(const_cast<T *>(data.data()), shape,
+                                       PyObjectOwner(data));
+}
+
+// Returns a numpy array sharing the memory of the CPU tensor. The array keeps
+// the memory alive, but the next run of the predictor may overwrite it.
+template <typename TensorT>
+py::array TensorToNumpyView(const TensorT &tensor) {
+  py::dtype dt = PaddleDTypeToNumpyDType(tensor.type());
+  auto tensor_shape = tensor.shape();
+  py::array::ShapeContainer shape(tensor_shape.begin(), tensor_shape.end());
+  PaddlePlace place;
+  int size = 0;
+  void *data = nullptr;
+  switch (tensor.type()) {
+    case PaddleDType::INT32:
+      data = tensor.template data<int32_t>(&place, &size);
+      break;
+    case PaddleDType::INT64:
+      data = tensor.template data<int64_t>(&place, &size);
+      break;
+    case PaddleDType::FLOAT32:
+      data = tensor.template data<float>(&place, &size);
+      break;
+    case PaddleDType::UINT8:
+      data = tensor.template data<uint8_t>(&place, &size);
+      break;
+    default:
+      PADDLE_THROW(platform::errors::Unimplemented(
+          "Unsupported data type. Now only supports INT32, INT64, UINT8 and "
+          "FLOAT32."));
+  }
+  PADDLE_ENFORCE_EQ(place, PaddlePlace::kCPU,
+                    platform::errors::Unimplemented(
+                        "Only the CPU tensors can be viewed as numpy arrays, "
+                        "please use copy_to_cpu instead."));
+  auto *owner = new std::shared_ptr<void>(tensor.memory_owner());
+  py::capsule base(owner, [](void *ptr) {
+    delete static_cast<std::shared_ptr<void> *>(ptr);
+  });
+  return py::array(dt, std::move(shape), data, base);
+}
+
 size_t PaddleGetDTypeSize(PaddleDType dt) {
   size_t size{0};
   switch (dt) {
@@ -481,10 +539,32 @@ void BindAnalysisConfig(py::module *m) {
            py::arg("x") = true)
       .def("ir_optim", &AnalysisConfig::ir_optim)
       .def("enable_memory_optim", &AnalysisConfig::EnableMemoryOptim)
+      .def("enable_shape_plan_cache", &AnalysisConfig::EnableShapePlanCache,
+           py::arg("capacity") = 16)
+      .def("shape_plan_cache_capacity",
+           &AnalysisConfig::shape_plan_cache_capacity)
+      .def("enable_params_hot_swap", &AnalysisConfig::EnableParamsHotSwap,
+           py::arg("x") = true)
+      .def("params_hot_swap_enabled", &AnalysisConfig::params_hot_swap_enabled)
+      .def("set_disk_embedding_table", &AnalysisConfig::SetDiskEmbeddingTable,
+           py::arg("param_name"), py::arg("table_dir"),
+           py::arg("cache_rows") = 1 << 20, py::arg("num_shards") = 8)
+      .def("disk_embedding_tables",
+           [](const AnalysisConfig &self) {
+             std::map<std::string, std::string> tables;
+             for (auto &table : self.disk_embedding_tables()) {
+               tables[table.first] = table.second.dir;
+             }
+             return tables;
+           })
       .def("enable_profile", &AnalysisConfig::EnableProfile)
       .def("disable_glog_info", &AnalysisConfig::DisableGlogInfo)
       .def("glog_info_disabled", &AnalysisConfig::glog_info_disabled)
       .def("set_optim_cache_dir", &AnalysisConfig::SetOptimCacheDir)
+      .def("enable_optim_program_cache",
+           &AnalysisConfig::EnableOptimProgramCache, py::arg("x") = true)
+      .def("optim_program_cache_enabled",
+           &AnalysisConfig::optim_program_cache_enabled)
       .def("switch_use_feed_fetch_ops", &AnalysisConfig::SwitchUseFeedFetchOps,
            py::arg("x") = true)
       .def("use_feed_fetch_ops_enabled",
@@ -526,6 +606,11 @@ void BindAnalysisConfig(py::module *m) {
            &AnalysisConfig::SetCpuMathLibraryNumThreads)
       .def("cpu_math_library_num_threads",
            &AnalysisConfig::cpu_math_library_num_threads)
+      .def("enable_cpu_core_binding", &AnalysisConfig::EnableCpuCoreBinding,
+           py::arg("cores") = std::vector<int>({}))
+      .def("cpu_core_binding_enabled",
+           &AnalysisConfig::cpu_core_binding_enabled)
+      .def("cpu_bind_cores", &AnalysisConfig::cpu_bind_cores)
       .def("to_native_config", &AnalysisConfig::ToNativeConfig)
       .def("enable_quantizer", &AnalysisConfig::EnableMkldnnQuantizer)
       .def("enable_mkldnn_bfloat16", &AnalysisConfig::EnableMkldnnBfloat16)
@@ -592,6 +677,8 @@ void BindAnalysisPredictor(py::module *m) {
       .def("clear_intermediate_tensor",
            &AnalysisPredictor::ClearIntermediateTensor)
       .def("try_shrink_memory", &AnalysisPredictor::TryShrinkMemory)
+      .def("update_params", &AnalysisPredictor::UpdateParams)
+      .def("update_param_rows", &AnalysisPredictor::UpdateParamRows)
       .def("create_feed_fetch_var", &AnalysisPredictor::CreateFeedFetchVar)
       .def("prepare_feed_fetch", &AnalysisPredictor::PrepareFeedFetch)
       .def("prepare_argument", &AnalysisPredictor::PrepareArgument)
@@ -620,6 +707,8 @@ void BindPaddleInferPredictor(py::module *m) {
       .def("run", &paddle_infer::Predictor::Run)
       .def("clone", &paddle_infer::Predictor::Clone)
       .def("try_shrink_memory", &paddle_infer::Predictor::TryShrinkMemory)
+      .def("update_params", &paddle_infer::Predictor::UpdateParams)
+      .def("update_param_rows", &paddle_infer::Predictor::UpdateParamRows)
       .def("clear_intermediate_tensor",
            &paddle_infer::Predictor::ClearIntermediateTensor);
 }
@@ -631,6 +720,13 @@ void BindZeroCopyTensor(py::module *m) {
       .def("copy_from_cpu", &ZeroCopyTensorCreate<int64_t>)
       .def("copy_from_cpu", &ZeroCopyTensorCreate<float>)
       .def("copy_to_cpu", &ZeroCopyTensorToNumpy)
+      .def("share_external_data",
+           &TensorShareExternalData<ZeroCopyTensor, int32_t>)
+      .def("share_external_data",
+           &TensorShareExternalData<ZeroCopyTensor, int64_t>)
+      .def("share_external_data",
+           &TensorShareExternalData<ZeroCopyTensor, float>)
+      .def("numpy_view", &TensorToNumpyView<ZeroCopyTensor>)
       .def("shape", &ZeroCopyTensor::shape)
       .def("set_lod", &ZeroCopyTensor::SetLoD)
       .def("lod", &ZeroCopyTensor::lod)
@@ -644,6 +740,13 @@ void BindPaddleInferTensor(py::module *m) {
       .def("copy_from_cpu", &PaddleInferTensorCreate<int64_t>)
       .def("copy_from_cpu", &PaddleInferTensorCreate<float>)
       .def("copy_to_cpu", &PaddleInferTensorToNumpy)
+      .def("share_external_data",
+           &TensorShareExternalData<paddle_infer::Tensor, int32_t>)
+      .def("share_external_data",
+           &TensorShareExternalData<paddle_infer::Tensor, int64_t>)
+      .def("share_external_data",
+           &TensorShareExternalData<paddle_infer::Tensor, float>)
+      .def("numpy_view", &TensorToNumpyView<paddle_infer::Tensor>)
       .def("shape", &paddle_infer::Tensor::shape)
       .def("set_lod", &paddle_infer::Tensor::SetLoD)
       .def("lod", &paddle_infer::Tensor::lod)
@@ -654,6 +757,9 @@ void BindPredictorPool(py::module *m) {
   py::class_<paddle_infer::services::PredictorPool>(*m, "PredictorPool")
       .def(py::init<const paddle_infer::Config &, size_t>())
       .def("retrive", &paddle_infer::services::PredictorPool::Retrive,
+           py::return_value_policy::reference)
+      .def("retrive_for_current_thread",
+           &paddle_infer::services::PredictorPool::RetriveForCurrentThread,
            py::return_value_policy::reference);
 }
 
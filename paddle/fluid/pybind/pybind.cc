@@ -383,18 +383,16 @@ PYBIND11_MODULE(core_noavx, m) {
   m.def("from_dlpack", [](py::capsule *dltensor) {
     DLManagedTensor *dmt = reinterpret_cast<DLManagedTensor *>(
         PyCapsule_GetPointer(dltensor->ptr(), "dltensor"));
+    if (dmt == nullptr) PyErr_Clear();
+    PADDLE_ENFORCE_NOT_NULL(
+        dmt, platform::errors::InvalidArgument(
+                 "from_dlpack received an invalid capsule. Note that a "
+                 "DLPack tensor can be consumed only once."));
     PyCapsule_SetName(dltensor->ptr(), "used_dltensor");
-    DLTensor dl = dmt->dl_tensor;
+    // The tensor shares the memory of the capsule when it is compact, and
+    // releases it by the deleter of the capsule.
     Tensor tensor;
-
-    if (dl.ctx.device_type == kDLCPU) {
-      paddle::framework::TensorFromDLPack(dl, &tensor);
-    }
-#ifdef PADDLE_WITH_CUDA
-    if (dl.ctx.device_type == kDLGPU) {
-      paddle::framework::TensorFromDLPack(dl, &tensor);
-    }
-#endif
+    paddle::framework::TensorFromDLManagedTensor(dmt, &tensor);
     return tensor;
   });
 
@@ -981,6 +979,17 @@ PYBIND11_MODULE(core_noavx, m) {
               platform::errors::PreconditionNotMet(
                   "LoDTensor is not on CPU."
                   "Now only LoDTensor on CPU can be serialized."));
+            int type_idx = static_cast<int>(t.type());
+            auto* ring_writer_allocation =
+              dynamic_cast<memory::allocation::MemoryMapRingWriterAllocation *>(
+                holder.get());
+            if (ring_writer_allocation != nullptr) {
+              return py::make_tuple(ring_writer_allocation->ipc_name(),
+                                    ring_writer_allocation->size(),
+                                    type_idx, vectorize(t.dims()), t.lod(),
+                                    ring_writer_allocation->slot(),
+                                    ring_writer_allocation->offset());
+            }
             auto* mmap_writer_allocation =
               dynamic_cast<memory::allocation::MemoryMapWriterAllocation *>(
                 holder.get());
@@ -988,14 +997,13 @@ PYBIND11_MODULE(core_noavx, m) {
               platform::errors::PreconditionNotMet(
                 "LoDTensor is not in shared memory."
                 "Now only LoDTensor on shared memory can be serialized."));
-            int type_idx = static_cast<int>(t.type());
 
             return py::make_tuple(mmap_writer_allocation->ipc_name(),
                                   mmap_writer_allocation->size(),
                                   type_idx, vectorize(t.dims()), t.lod());
           },
           [](py::tuple t) {  // __setstate__
-            if (t.size() != 5)
+            if (t.size() != 5 && t.size() != 7)
               throw std::runtime_error("Invalid LoDTensor state!");
 
             // 1. Create a new C++ instance
@@ -1004,13 +1012,23 @@ PYBIND11_MODULE(core_noavx, m) {
             // 2. Rebuild Allocation
             const std::string &ipc_name = t[0].cast<std::string>();
             size_t size = t[1].cast<size_t>();
-            auto shared_reader_holder =
-              memory::allocation::RebuildMemoryMapReaderAllocation(
-                ipc_name, size);
+            std::shared_ptr<memory::allocation::Allocation>
+              shared_reader_holder;
+            if (t.size() == 7) {
+              // The tensor is in a slot of the ring arena, which is
+              // unlinked once opened, so it is not kept in the fd set.
+              shared_reader_holder =
+                memory::allocation::RebuildMemoryMapRingReaderAllocation(
+                  ipc_name, t[5].cast<int>(), t[6].cast<size_t>(), size);
+            } else {
+              shared_reader_holder =
+                memory::allocation::RebuildMemoryMapReaderAllocation(
+                  ipc_name, size);
 
-            // 3. Maintain global fd set
-            VLOG(3) << "LoDTensor ipc name: " << ipc_name;
-            memory::allocation::MemoryMapFdSet::Instance().Insert(ipc_name);
+              // 3. Maintain global fd set
+              VLOG(3) << "LoDTensor ipc name: " << ipc_name;
+              memory::allocation::MemoryMapFdSet::Instance().Insert(ipc_name);
+            }
 
             // 4. Rebuild LoDTensor
             tensor.ResetHolderWithType(shared_reader_holder,
@@ -2556,7 +2574,9 @@ All parameter, weight, gradient are variables in Paddle.
           R"DOC((bool, optional): Whether to enable fusing subgraph to a
                 fusion_group. Now we only support fusing subgraph that composed
                 of elementwise-like operators, such as elementwise_add/mul
-                without broadcast and activations.
+                without broadcast and activations. On CPU, the generated code
+                is compiled by the host compiler (FLAGS_fusion_group_cpu_compiler)
+                and cached in FLAGS_fusion_group_cpu_cache_dir.
 
                 Examples:
                     .. code-block:: python
@@ -54,6 +54,15 @@ def _start_kv_server(port, http_server_d, size):
     http_server.stop()
 
 
+def _is_cpuonly(backend):
+    # NOTE: the gloo backend can be selected explicitly by setting
+    # PADDLE_DISTRI_BACKEND=gloo, so that the CPU data parallel training
+    # also works in the GPU or XPU version.
+    if backend == 'gloo':
+        return True
+    return not core.is_compiled_with_cuda() and not core.is_compiled_with_xpu()
+
+
 def init_parallel_env():
     """
     Initialize parallel training environment in dynamic graph mode.
@@ -120,12 +129,15 @@ def init_parallel_env():
         )
         return
 
-    # 1. gpu xpu check, must be gpu or xpu
-    if not core.is_compiled_with_cuda() and not core.is_compiled_with_xpu():
+    # 1. gpu xpu check, CPU-only training must be compiled with gloo
+    backend = os.environ.get('PADDLE_DISTRI_BACKEND', 'auto')
+    is_cpu_only = _is_cpuonly(backend)
+    if is_cpu_only and not hasattr(core, "GLOOParallelContext"):
         raise NotImplementedError(
-            "Cannot initialize parallel environment in CPU-only version, now only "
-            "supports initializing the GPU and XPU parallel environment. Please recompile "
-            "or reinstall paddle with GPU or XPU support.")
+            "Cannot initialize parallel environment in CPU-only version without "
+            "GLOO, now only supports initializing the GPU, XPU and GLOO parallel "
+            "environment. Please recompile or reinstall paddle with GPU, XPU or "
+            "GLOO support.")
 
     # 2. check env
     def _check_var_exists(var_name):
@@ -135,7 +147,9 @@ def init_parallel_env():
                              "environment variable %s is needed, but not set." %
                              var_name)
 
-    if core.is_compiled_with_cuda():
+    if is_cpu_only:
+        pass
+    elif core.is_compiled_with_cuda():
         _check_var_exists("FLAGS_selected_gpus")
     elif core.is_compiled_with_xpu():
         _check_var_exists('FLAGS_selected_xpus')
@@ -146,8 +160,9 @@ def init_parallel_env():
     _check_var_exists("PADDLE_TRAINER_ENDPOINTS")
 
     # 3: init gloo context (step 1: httpsever start)
+    # NOTE: the CPU parallel context also uses the http server for rendezvous
     init_gloo = int(os.getenv("PADDLE_WITH_GLOO", "0"))
-    if init_gloo:
+    if init_gloo or is_cpu_only:
         ep_rank_0 = parallel_env.trainer_endpoints[0].split(":")
         ep_rank = parallel_env.trainer_endpoints[parallel_env.rank].split(":")
         manager = Manager()
@@ -155,8 +170,15 @@ def init_parallel_env():
         http_server_d = manager.dict()
         http_server_d["running"] = False
         if parallel_env.rank == 0:
-            # The scope for worker used by http server is '_worker'
-            size = {'_worker': parallel_env.world_size}
+            # The scope for worker used by http server is '_worker', and the
+            # CPU parallel context has its own scope '_dygraph' prefixed by
+            # PADDLE_GLOO_PREFIX, so that both of them can rendezvous
+            size = {}
+            if init_gloo:
+                size['_worker'] = parallel_env.world_size
+            if is_cpu_only:
+                gloo_prefix = os.getenv("PADDLE_GLOO_PREFIX", "")
+                size[gloo_prefix + '_dygraph'] = parallel_env.world_size
             http_server = Process(
                 target=_start_kv_server,
                 args=(int(ep_rank_0[1]), http_server_d, size))
@@ -180,14 +202,20 @@ def init_parallel_env():
     # directly, if they want to switch default place,
     # they need to call a function to change default place,
     # here just set correctly place to users
-    if core.is_compiled_with_cuda():
+    if is_cpu_only:
+        place = core.CPUPlace()
+    elif core.is_compiled_with_cuda():
         place = core.CUDAPlace(parallel_env.device_id)
     elif core.is_compiled_with_xpu():
         place = core.XPUPlace(parallel_env.device_id)
     _set_expected_place(place)
 
-    # init nccl or bkcl context
-    if core.is_compiled_with_cuda():
+    # init nccl, bkcl or gloo context
+    if is_cpu_only:
+        wait_server_ready([parallel_env.trainer_endpoints[0]])
+        parallel_helper._set_parallel_ctx(
+            core.GLOOParallelContext(strategy, place))
+    elif core.is_compiled_with_cuda():
         parallel_helper._set_parallel_ctx(
             core.NCCLParallelContext(strategy, place))
     elif core.is_compiled_with_xpu():
@@ -213,9 +241,9 @@ def init_parallel_env():
         gloo_strategy.run_seconds = default_run_timeout_seconds
         gloo = core.GlooParallelContext(gloo_strategy)
         gloo.init()
-        if parallel_env.rank == 0:
-            http_server_d["running"] = False
-            http_server.join()
+    if (init_gloo or is_cpu_only) and parallel_env.rank == 0:
+        http_server_d["running"] = False
+        http_server.join()
 
 
 def get_rank():
@@ -204,6 +204,15 @@ def __bootstrap__():
         'call_stack_level',
         'sort_sum_gradient',
         'max_inplace_grad_add',
+        'backward_num_threads',
+        'dataloader_shm_ring_slot_num',
+        'dataloader_shm_ring_slot_size',
+        'cpu_conv_exhaustive_search',
+        'cpu_conv_use_winograd',
+        'use_packed_gemm_weights',
+        'executor_zero_copy_feed_fetch',
+        'fusion_group_cpu_compiler',
+        'fusion_group_cpu_cache_dir',
     ]
     if 'Darwin' not in sysstr:
         read_env_flags.append('use_pinned_memory')
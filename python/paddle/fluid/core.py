@@ -281,6 +281,7 @@ if avx_supported():
             from .core_avx import _convert_to_tensor_list
             from .core_avx import _cleanup_mmap_fds
             from .core_avx import _remove_tensor_list_mmap_fds
+            from .core_avx import _release_mmap_ring_arenas
     except Exception as e:
         if has_avx_core:
             sys.stderr.write(
@@ -335,6 +336,7 @@ if load_noavx:
             from .core_noavx import _convert_to_tensor_list
             from .core_noavx import _cleanup_mmap_fds
             from .core_noavx import _remove_tensor_list_mmap_fds
+            from .core_noavx import _release_mmap_ring_arenas
     except Exception as e:
         if has_noavx_core:
             sys.stderr.write(
@@ -591,6 +591,10 @@ class _DataLoaderIterMultiProcess(_DataLoaderIterBase):
                 for q in self._indices_queues:
                     q.cancel_join_thread()
                     q.close()
+
+                # the shared memory ring arenas of workers are unlinked once
+                # mapped, release them after all workers exit
+                core._release_mmap_ring_arenas([w.pid for w in self._workers])
             finally:
                 core._erase_process_pids(id(self))
                 self._shutdown = True
@@ -58,9 +58,11 @@ def prepare_context(strategy=None):
         elif isinstance(place, core.XPUPlace):
             parallel_helper._set_parallel_ctx(
                 core.BKCLParallelContext(strategy, place))
+        elif isinstance(place, core.CPUPlace):
+            parallel_helper._set_parallel_ctx(
+                core.GLOOParallelContext(strategy, place))
         else:
-            # TODO(Yancey1989): add Gloo Parallel Context to support CPU parallel computation
-            assert ("Only support CUDAPlace or XPUPlace for now.")
+            assert ("Only support CUDAPlace, XPUPlace or CPUPlace for now.")
         parallel_helper._init_parallel_ctx()
     return strategy
 
@@ -442,7 +442,12 @@ def _as_lodtensor(data, place, dtype=None):
 
     # convert numpy.ndarray to tensor
     tensor = core.LoDTensor()
-    tensor.set(data, place)
+    # NOTE: with FLAGS_executor_zero_copy_feed_fetch, a C-contiguous array is
+    # shared instead of copied, and it is kept alive by the tensor.
+    zero_copy = core.globals()['FLAGS_executor_zero_copy_feed_fetch'] and \
+        isinstance(place, core.CPUPlace) and \
+        data.flags['C_CONTIGUOUS'] and data.flags['ALIGNED']
+    tensor.set(data, place, zero_copy)
     return tensor
 
 
@@ -149,6 +149,19 @@ class TestLoDTensor(unittest.TestCase):
                     np.array(gtensor_from_dlpack),
                     np.array([[1], [2], [3], [4]]).astype('int')))
 
+    def test_dlpack_zero_copy(self):
+        tensor = fluid.create_lod_tensor(
+            np.arange(6).astype('float32'), [], fluid.CPUPlace())
+        address = np.asarray(tensor).ctypes.data
+        tensor_from_dlpack = fluid.core.from_dlpack(tensor._to_dlpack())
+        # A compact tensor is shared, and the capsule keeps its memory.
+        del tensor
+        self.assertEqual(np.asarray(tensor_from_dlpack).ctypes.data, address)
+        self.assertTrue(
+            np.array_equal(
+                np.array(tensor_from_dlpack),
+                np.arange(6).astype('float32')))
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -472,7 +472,9 @@ class TestParallelDyGraphRunnerBase(object):
     def run_trainer(self, args):
 
         seed = 90
-        if fluid.core.is_compiled_with_cuda():
+        if os.getenv("PADDLE_DISTRI_BACKEND", "auto") == "gloo":
+            place = fluid.CPUPlace()
+        elif fluid.core.is_compiled_with_cuda():
             device_id = int(os.getenv("FLAGS_selected_gpus", "0"))
             place = fluid.CUDAPlace(device_id)
         elif fluid.core.is_compiled_with_xpu():
@@ -503,6 +505,13 @@ class TestParallelDyGraphRunnerBase(object):
                 dygraph.parallel.prepare_context(strategy)
                 model = dygraph.parallel.DataParallel(model, strategy)
                 print_to_err(type(self).__name__, "model built in dygraph")
+            elif args.update_method == "gloo":
+                print_to_err(
+                    type(self).__name__,
+                    "begin to prepare context in dygraph with gloo")
+                paddle.distributed.init_parallel_env()
+                model = paddle.DataParallel(model)
+                print_to_err(type(self).__name__, "model built in dygraph")
             out_losses = []
             print_to_err(type(self).__name__, "begin to run dygraph training")
             for step_id, data in enumerate(train_reader()):
@@ -609,7 +618,9 @@ def runtime_main(test_class):
         '--update_method',
         type=str,
         default="local",
-        choices=["pserver", "nccl2", "bkcl", "local", "nccl2_reduce_layer"])
+        choices=[
+            "pserver", "nccl2", "bkcl", "gloo", "local", "nccl2_reduce_layer"
+        ])
     parser.add_argument('--trainer_id', type=int, required=False, default=0)
     parser.add_argument('--trainers', type=int, required=False, default=1)
     parser.add_argument('--nccl_comm_num', type=int, required=False, default=1)
@@ -707,6 +718,7 @@ class TestDistBase(unittest.TestCase):
         self._use_reader_alloc = True
         self._nccl2_mode = False
         self._bkcl_mode = False
+        self._gloo_mode = False
         self._pipeline_mode = False
         self._mp_mode = False
         # FIXME(typhoonzero): I added this stupid argument to enable
@@ -1014,6 +1026,13 @@ class TestDistBase(unittest.TestCase):
             })
         else:
             env.update({'CPU_NUM': '1'})
+            if self._gloo_mode:
+                env.update({
+                    "PADDLE_TRAINERS_NUM": "{}".format(trainer_num),
+                    "PADDLE_TRAINER_ID": "{}".format(trainer_id),
+                    "PADDLE_TRAINER_ENDPOINTS": self._ps_endpoints,
+                    "PADDLE_CURRENT_ENDPOINT": ep,
+                })
 
         if self._use_dgc:
             tr_cmd += " --use_dgc"
@@ -1189,6 +1208,9 @@ class TestDistBase(unittest.TestCase):
                          log_name=""):
 
         required_envs = self._get_required_envs(check_error_log, need_envs)
+        if self._gloo_mode:
+            # both the local and the distributed trainers run on CPU
+            required_envs["PADDLE_DISTRI_BACKEND"] = "gloo"
 
         local_losses \
             = self._run_local(model_file, required_envs,
@@ -1216,6 +1238,13 @@ class TestDistBase(unittest.TestCase):
                 update_method='bkcl',
                 check_error_log=check_error_log,
                 log_name=log_name)
+        elif self._gloo_mode:
+            tr0_losses, tr1_losses = self._run_cluster_nccl2(
+                model_file,
+                required_envs,
+                update_method='gloo',
+                check_error_log=check_error_log,
+                log_name=log_name)
 
         elif self._pipeline_mode:
             tr0_losses, tr1_losses = self._run_pipeline(
@@ -0,0 +1,67 @@
+#   Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+
+import paddle
+import paddle.fluid as fluid
+import paddle.fluid.core as core
+from paddle.fluid.executor import _as_lodtensor
+
+paddle.enable_static()
+
+
+class TestExecutorZeroCopyFeedFetch(unittest.TestCase):
+    def setUp(self):
+        fluid.set_flags({'FLAGS_executor_zero_copy_feed_fetch': True})
+
+    def tearDown(self):
+        fluid.set_flags({'FLAGS_executor_zero_copy_feed_fetch': False})
+
+    def test_feed_is_shared(self):
+        array = np.random.random((16, 8)).astype('float32')
+        tensor = _as_lodtensor(array, core.CPUPlace())
+        self.assertEqual(np.asarray(tensor).ctypes.data, array.ctypes.data)
+        # A non-contiguous array is copied.
+        sliced = array[:, ::2]
+        tensor = _as_lodtensor(sliced, core.CPUPlace())
+        self.assertNotEqual(np.asarray(tensor).ctypes.data,
+                            sliced.ctypes.data)
+        self.assertTrue(np.array_equal(np.array(tensor), sliced))
+
+    def test_run(self):
+        main_program = fluid.Program()
+        startup_program = fluid.Program()
+        with fluid.program_guard(main_program, startup_program):
+            x = fluid.data(name='x', shape=[None, 8], dtype='float32')
+            y = fluid.layers.scale(x, scale=2.0)
+            z = fluid.layers.reduce_sum(y)
+        exe = fluid.Executor(fluid.CPUPlace())
+        exe.run(startup_program)
+        for _ in range(3):
+            array = np.random.random((16, 8)).astype('float32')
+            y_out, z_out = exe.run(main_program,
+                                   feed={'x': array},
+                                   fetch_list=[y, z])
+            self.assertTrue(np.allclose(y_out, array * 2.0))
+            self.assertTrue(np.allclose(z_out, np.sum(array * 2.0), rtol=1e-4))
+            # The fed array is left unchanged.
+            self.assertTrue(np.allclose(y_out / 2.0, array))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -32,8 +32,6 @@ def stable_softmax(x):
     return exps / np.sum(exps)
 
 
-@unittest.skipIf(not core.is_compiled_with_cuda(),
-                 "Paddle core is not compiled with CUDA")
 class TestFusedMultiheadMatmulOp(OpTest):
     def config(self):
         self.seq_len = 128
@@ -42,6 +40,9 @@ class TestFusedMultiheadMatmulOp(OpTest):
         self.batch_size = 1
         self.scale = 0.125
 
+    def bias_qk_shape(self):
+        return (self.batch_size, self.head_number, self.seq_len, self.seq_len)
+
     def setUp(self):
         self.op_type = "multihead_matmul"
         self.config()
@@ -62,9 +63,7 @@ class TestFusedMultiheadMatmulOp(OpTest):
         self.BiasK = np.random.random((1, w)).astype("float32")
         self.BiasV = np.random.random((1, w)).astype("float32")
         self.CombinedB = np.vstack((self.BiasQ, self.BiasK, self.BiasV))
-        self.BiasQK = np.random.random(
-            (self.batch_size, self.head_number, self.seq_len,
-             self.seq_len)).astype("float32")
+        self.BiasQK = np.random.random(self.bias_qk_shape()).astype("float32")
         # Compute Q path
         fc_q = self.Q + self.BiasQ
         reshape_q = np.reshape(fc_q, (self.batch_size, self.seq_len,
@@ -108,8 +107,9 @@ class TestFusedMultiheadMatmulOp(OpTest):
         self.outputs = {"Out": reshape_qkv}
 
     def test_check_output(self):
-        place = core.CUDAPlace(0)
-        self.check_output_with_place(place, atol=2e-3)
+        self.check_output_with_place(core.CPUPlace(), atol=2e-3)
+        if core.is_compiled_with_cuda():
+            self.check_output_with_place(core.CUDAPlace(0), atol=2e-3)
 
 
 class TestFusedMultiHeadMatmulOp2(TestFusedMultiheadMatmulOp):
@@ -121,5 +121,22 @@ class TestFusedMultiHeadMatmulOp2(TestFusedMultiheadMatmulOp):
         self.scale = 0.125
 
 
+class TestFusedMultiHeadMatmulOpBroadcastBiasQK(TestFusedMultiheadMatmulOp):
+    # The input mask of Bert and Ernie, which is broadcast to the heads and
+    # the rows by the CPU kernel.
+    def config(self):
+        self.seq_len = 128
+        self.size_per_head = 64
+        self.head_number = 12
+        self.batch_size = 2
+        self.scale = 0.125
+
+    def bias_qk_shape(self):
+        return (self.batch_size, 1, 1, self.seq_len)
+
+    def test_check_output(self):
+        self.check_output_with_place(core.CPUPlace(), atol=2e-3)
+
+
 if __name__ == '__main__':
     unittest.main()
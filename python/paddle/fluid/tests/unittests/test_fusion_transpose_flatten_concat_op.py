@@ -20,8 +20,6 @@ from op_test import OpTest
 import paddle.fluid.core as core
 
 
-@unittest.skipIf(not core.is_compiled_with_cuda(),
-                 "core is not compiled with CUDA")
 class TestFusionTransposeFlattenConcationOp(OpTest):
     def setUp(self):
         self.init_test_case()
@@ -50,8 +48,9 @@ class TestFusionTransposeFlattenConcationOp(OpTest):
         self.outputs = {'Out': out}
 
     def test_check_output(self):
-        place = core.CUDAPlace(0)
-        self.check_output_with_place(place, 1e-6)
+        self.check_output_with_place(core.CPUPlace(), 1e-6)
+        if core.is_compiled_with_cuda():
+            self.check_output_with_place(core.CUDAPlace(0), 1e-6)
 
     def init_test_case(self):
         self.shapes = [(3, 4, 17, 17), (3, 8, 7, 7), (3, 12, 5, 5)]
@@ -60,8 +59,6 @@ class TestFusionTransposeFlattenConcationOp(OpTest):
         self.concat_axis = 1
 
 
-@unittest.skipIf(not core.is_compiled_with_cuda(),
-                 "core is not compiled with CUDA")
 class TestCase1(TestFusionTransposeFlattenConcationOp):
     def init_test_case(self):
         self.shapes = [(3, 4, 18, 17), (3, 8, 18, 7), (6, 12, 9, 5)]
@@ -70,8 +67,6 @@ class TestCase1(TestFusionTransposeFlattenConcationOp):
         self.concat_axis = 1
 
 
-@unittest.skipIf(not core.is_compiled_with_cuda(),
-                 "core is not compiled with CUDA")
 class TestCase2(TestFusionTransposeFlattenConcationOp):
     def init_test_case(self):
         self.shapes = [(3, 8, 20, 17), (3, 8, 19, 17), (3, 8, 40, 17)]
@@ -80,8 +75,6 @@ class TestCase2(TestFusionTransposeFlattenConcationOp):
         self.concat_axis = 0
 
 
-@unittest.skipIf(not core.is_compiled_with_cuda(),
-                 "core is not compiled with CUDA")
 class TestCase3(TestFusionTransposeFlattenConcationOp):
     def init_test_case(self):
         self.shapes = [(3, 8, 20, 17), (3, 8, 19, 17), (3, 8, 40, 17)]
@@ -90,8 +83,6 @@ class TestCase3(TestFusionTransposeFlattenConcationOp):
         self.concat_axis = 1
 
 
-@unittest.skipIf(not core.is_compiled_with_cuda(),
-                 "core is not compiled with CUDA")
 class TestCase4(TestFusionTransposeFlattenConcationOp):
     def init_test_case(self):
         self.shapes = [(3, 8, 9, 17), (8, 3, 9, 17), (4, 6, 9, 17)]
@@ -100,8 +91,6 @@ class TestCase4(TestFusionTransposeFlattenConcationOp):
         self.concat_axis = 1
 
 
-@unittest.skipIf(not core.is_compiled_with_cuda(),
-                 "core is not compiled with CUDA")
 class TestCase5(TestFusionTransposeFlattenConcationOp):
     def init_test_case(self):
         self.shapes = [(3, 8, 9, 17, 2), (3, 8, 2, 17, 9), (3, 17, 9, 8, 2)]
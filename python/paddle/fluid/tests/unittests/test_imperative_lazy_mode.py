@@ -0,0 +1,98 @@
+# Copyright (c) 2021 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import numpy as np
+
+import paddle
+from paddle.fluid.framework import _dygraph_tracer
+
+
+class TestImperativeLazyMode(unittest.TestCase):
+    # The ops on the tensors which stop gradient are deferred in lazy mode,
+    # and each accessor below must see their results.
+    def setUp(self):
+        paddle.disable_static(paddle.CPUPlace())
+        self.tracer = _dygraph_tracer()
+        self.tracer._enable_lazy_mode = True
+        self.x_np = np.random.uniform(-1, 1, [4, 5]).astype('float32')
+        self.x = paddle.to_tensor(self.x_np)
+
+    def tearDown(self):
+        self.tracer._enable_lazy_mode = False
+        paddle.enable_static()
+
+    def lazy_ops(self, x):
+        return paddle.nn.functional.relu(x * 2.0 + 1.0)
+
+    def expected(self, x_np):
+        return np.maximum(x_np * 2.0 + 1.0, 0.0)
+
+    def test_numpy(self):
+        y = self.lazy_ops(self.x)
+        self.assertEqual(y.shape, [4, 5])
+        self.assertTrue(np.allclose(y.numpy(), self.expected(self.x_np)))
+
+    def test_clone(self):
+        y = self.lazy_ops(self.x)
+        z = y.clone()
+        self.assertTrue(np.allclose(z.numpy(), self.expected(self.x_np)))
+
+    def test_getitem(self):
+        y = self.lazy_ops(self.x)
+        z = y[1:3, 2]
+        self.assertTrue(
+            np.allclose(z.numpy(), self.expected(self.x_np)[1:3, 2]))
+
+    def test_setitem(self):
+        y = self.lazy_ops(self.x)
+        y[0] = 10.0
+        expected = self.expected(self.x_np)
+        expected[0] = 10.0
+        self.assertTrue(np.allclose(y.numpy(), expected))
+
+    def test_setitem_after_pending_reader(self):
+        # The pending op reading y runs before y is written.
+        y = self.lazy_ops(self.x)
+        y.numpy()
+        z = y * 3.0
+        y[1] = np.zeros([5], dtype='float32')
+        self.assertTrue(
+            np.allclose(z.numpy(), self.expected(self.x_np) * 3.0))
+        self.assertTrue(np.allclose(y.numpy()[1], np.zeros([5])))
+
+    def test_copy(self):
+        y = self.lazy_ops(self.x)
+        z = paddle.zeros([4, 5], dtype='float32')
+        z.copy_(y, True)
+        self.assertTrue(np.allclose(z.numpy(), self.expected(self.x_np)))
+
+    def test_copy_after_pending_reader(self):
+        y = self.lazy_ops(self.x)
+        z = y + 1.0
+        y.copy_(paddle.zeros([4, 5], dtype='float32'), True)
+        self.assertTrue(
+            np.allclose(z.numpy(), self.expected(self.x_np) + 1.0))
+        self.assertTrue(np.allclose(y.numpy(), np.zeros([4, 5])))
+
+    def test_disable(self):
+        y = self.lazy_ops(self.x)
+        self.tracer._enable_lazy_mode = False
+        self.assertTrue(np.allclose(y.numpy(), self.expected(self.x_np)))
+
+
+if __name__ == '__main__':
+    unittest.main()